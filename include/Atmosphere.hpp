@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+struct AtmosphereStats {
+    bool fromCache = false;
+    float milliseconds = 0.0f; // integrating or loading the tables
+    unsigned int threads = 0;  // that integrated them, 0 when loaded
+};
+
+// Single-scattering model of an Earth-like atmosphere (Rayleigh, Mie and ozone) baked into lookup tables, so the
+// time of day can vary continuously at the cost of a few texture fetches:
+// - transmittance from any altitude to space, by altitude and cosine of the zenith angle
+// - in-scattered Rayleigh and Mie light for an observer near the ground, by view elevation, sun elevation and
+//   the azimuth between them, without the phase functions, which the sky shader applies per pixel
+// - the sky's irradiance on the ground, by sun elevation
+// The integration runs on the worker threads at startup and is cached on disk; this class does not touch
+// OpenGL, Sky uploads the scattering tables. Distances are in kilometres and angles in radians.
+class Atmosphere {
+public:
+    static constexpr int TRANSMITTANCE_MU = 256;
+    static constexpr int TRANSMITTANCE_ALTITUDE = 64;
+    static constexpr int SCATTERING_VIEW = 64;    // view elevation from the horizon up, denser near the horizon
+    static constexpr int SCATTERING_SUN = 64;     // sun elevation from MIN_SUN_ELEVATION up
+    static constexpr int SCATTERING_AZIMUTH = 16; // from towards the sun to away from it
+    static constexpr float MIN_SUN_ELEVATION = -0.35f; // about 20 degrees below the horizon, well into the night
+    static constexpr float OBSERVER_ALTITUDE = 0.5f;
+    static constexpr float GROUND_RADIUS = 6360.0f;
+    static constexpr float TOP_RADIUS = 6420.0f;
+    static constexpr float MIE_ASYMMETRY = 0.8f;
+
+    Atmosphere();
+
+    // Loads the tables from cacheDirectory, or integrates them and saves them there
+    bool create(const std::string& cacheDirectory);
+    bool isReady() const { return !transmittance.empty(); }
+    const AtmosphereStats& getStats() const { return stats; }
+
+    // Fraction of light that reaches space from altitude along the direction with cosine zenith angle mu
+    glm::vec3 getTransmittance(float altitude, float mu) const;
+    // Sunlight reaching the observer, relative to sunlight above the atmosphere
+    glm::vec3 getSunTransmittance(float sunElevation) const { return getTransmittance(OBSERVER_ALTITUDE, std::sin(sunElevation)); }
+    // Irradiance of the sky alone on level ground, in the units of the scattering tables
+    glm::vec3 getSkyIrradiance(float sunElevation) const;
+
+    // Texels of the scattering tables with view elevation varying fastest, then sun elevation, then azimuth
+    const std::vector<glm::vec3>& getRayleighScattering() const { return rayleighScattering; }
+    const std::vector<glm::vec3>& getMieScattering() const { return mieScattering; }
+
+private:
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t sizes[5];
+        float observerAltitude;
+        uint64_t parameters; // parameterHash() of the tables it holds
+    };
+    static const uint32_t FILE_VERSION = 2;
+
+    static uint64_t parameterHash();
+
+    std::vector<glm::vec3> transmittance;
+    std::vector<glm::vec3> rayleighScattering;
+    std::vector<glm::vec3> mieScattering;
+    std::vector<glm::vec3> skyIrradiance;
+    AtmosphereStats stats;
+
+    void integrate();
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+};
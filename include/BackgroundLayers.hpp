@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+#include <noise/noise.h>
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+#include "ShaderRegistry.hpp"
+
+// Placement and look of one receding mountain range
+struct BackgroundLayer {
+    float xStart;    // world x of the left end of the ridge
+    float width;     // world width covered by the ridge
+    float yBase;     // world y of the flat bottom edge
+    float zPosition; // world z of the ridge plane
+    glm::vec3 color;
+    float fade;      // 0 = full layer color, 1 = haze color
+};
+
+// How World lays out the ranges when it regenerates them
+struct BackgroundLayerParameters {
+    int layerCount;
+    float spacing;   // z distance between layers, starting behind the distant terrain
+    float minHeight; // ridge valley height
+    float maxHeight; // ridge peak height
+    float haze;      // fade of the farthest layer towards the haze color
+};
+
+// Uniforms of the background layer shader that BackgroundLayers sets itself, resolved by whoever links the shader
+struct BackgroundLayerUniforms {
+    ShaderUniform<int> profiles;
+    ShaderUniform<int> layerCount;
+    ShaderUniform<float> sampleCount;
+
+    void resolve(GLuint shader);
+};
+
+// Mountain ranges behind the distant terrain, each one a 1D ridge profile rather than a full Terrain.
+// Every layer's heights live in one row of a shared R32F texture, and all layers are drawn with a single
+// instanced draw of one shared triangle strip; the vertex shader reads its ridge row by gl_InstanceID.
+class BackgroundLayers {
+public:
+    static const int PROFILE_SAMPLES = 1024;
+    static const int MAX_LAYERS = 16;
+
+    BackgroundLayers();
+    ~BackgroundLayers();
+
+    // Samples one ridge per layer between minHeight and maxHeight above the layer's yBase
+    void generate(noise::module::Perlin& perlin, const std::vector<BackgroundLayer>& newLayers, float minHeight, float maxHeight);
+    void render(GLuint shader, const BackgroundLayerUniforms& uniforms);
+
+    int getLayerCount() const { return static_cast<int>(layers.size()); }
+    const std::vector<BackgroundLayer>& getLayers() const { return layers; }
+
+private:
+    GLuint vao, stripVbo, instanceVbo, profileTexture;
+    std::vector<BackgroundLayer> layers;
+    std::vector<float> profiles; // PROFILE_SAMPLES heights per layer, one texture row each
+
+    void setupMesh();
+    void uploadLayers();
+    void cleanup();
+};
@@ -4,9 +4,15 @@
 #include <glm/glm.hpp>
 #include <vector>
 #include <string>
-#include <map>
 #include <random>
 #include "Enums.hpp"
+#include "StarCatalog.hpp"
+#include "SatellitePropagator.hpp"
+#include "SpacecraftCatalog.hpp"
+#include "ExhaustTrails.hpp"
+#include "MeteorShower.hpp"
+#include "SkyEntityStore.hpp"
+#include "ShaderRegistry.hpp"
 
 // Forward declaration
 class World;
@@ -30,6 +36,52 @@ public:
     bool getShowPlanetNames() { return showPlanetNames; }
     bool getShowSatelliteNames() { return showSatelliteNames; }
 
+    // Poisson-disk stars behind the constellations; regenerates the starfield of the current sky pattern
+    void setRandomStarCount(int count);
+    int getRandomStarCount() const { return randomStarCount; }
+    size_t getStarCount() const { return stars.size(); }
+    // The sky's generator, shared with the debug GUI so all of a run's randomness follows from its one seed
+    static std::mt19937& getRng() { return rng; }
+    float getStarGenerationMilliseconds() const { return starGenerationMilliseconds; }
+
+    static constexpr int MIN_RANDOM_STARS = 50; // the sky patterns place constellations over the first stars
+    static constexpr int MAX_RANDOM_STARS = 1000000; // about 2 s to generate on one core
+
+    // Real sky for the Earth scenes: catalog stars projected for an observer instead of the hand-placed patterns.
+    // Returns false if the catalog could not be loaded.
+    bool setRealSkyEnabled(bool enabled);
+    bool isRealSkyEnabled() const { return realSkyEnabled; }
+    bool isRealSkyActive() const { return realSkyEnabled && scene != Scene::ALIEN && starCatalog.isLoaded(); }
+    SkyObserver& getSkyObserver() { return skyObserver; }
+    void setRealSkyTime(int dayOfYear, float hourUtc);
+    int getRealSkyDayOfYear() const;
+    int getRealSkyDaysInYear() const; // 365 or 366
+    float getRealSkyHourUtc() const;
+    float getRealSkyTimeScale() const { return realSkyTimeScale; }
+    void setRealSkyTimeScale(float scale) { realSkyTimeScale = scale; }
+    float getRealSkyLimitingMagnitude() const { return realSkyLimitingMagnitude; }
+    void setRealSkyLimitingMagnitude(float magnitude) { realSkyLimitingMagnitude = magnitude; }
+    const StarCatalogStats& getStarCatalogStats() const { return starCatalog.getStats(); }
+    size_t getStarCatalogCount() const { return starCatalog.getCount(); }
+    // Real satellite passes from resources/satellites/active.tle replace the scripted satellites when it was loaded
+    bool isRealSatellitesActive() const { return isRealSkyActive() && satellitePropagator.getCount() > 0; }
+    const SatellitePropagatorStats& getSatellitePropagatorStats() const { return satellitePropagator.getStats(); }
+
+    // Ships added to the alien scene's sky, each with an exhaust trail, to stress the trail rendering
+    void setStressShipCount(int count);
+    int getStressShipCount() const { return stressShipCount; }
+    const ExhaustTrailStats& getExhaustTrailStats() const { return exhaustTrails.getStats(); }
+    static constexpr int MAX_STRESS_SHIPS = 2000;
+
+    // Thousands of planets, satellites and Starlink ships of each kind added to the sky, to profile the entity store
+    void setStressSkyCount(int count);
+    int getStressSkyCount() const { return stressSkyCount; }
+    const SkyEntityStats& getSkyEntityStats() const { return skyEntities.getStats(); }
+    static constexpr int MAX_STRESS_SKY = 10000;
+
+    // Sporadic shooting stars and the meteor shower of the night sky
+    MeteorShower& getMeteorShower() { return meteorShower; }
+
     void setScene(Scene newScene) {
         scene = newScene;
         selectRandomSkyPattern(); // Re-select pattern when scene changes
@@ -59,46 +111,8 @@ private:
         std::string name;
     };
 
-    struct ShootingStar {
-        glm::vec2 position;
-        glm::vec2 velocity;
-        float brightness;
-        float lifetime;
-    };
-
-    struct ExhaustSegment {
-        glm::vec2 startPos;
-        glm::vec2 endPos;
-        float lifetime;
-        float alpha;
-    };
 
-    struct Satellite {
-        std::string name;
-        float speed;
-        glm::vec2 position;
-        glm::vec2 heading;
-        glm::vec3 textColor;
-        float size;
-        float brightness;
-        bool isISS;
-        float lastDisplayedTime;
-        std::vector<ExhaustSegment> trail;
-    };
-
-    struct StarlinkTrain {
-        std::vector<glm::vec2> positions;
-        glm::vec2 heading;
-        float speed;
-        float brightness;
-        float size;
-        float spacing;
-        int count;
-        float lastDisplayedTime;
-        std::vector<std::vector<ExhaustSegment>> trails;
-    };
-
-    struct Planet { // distant and rendered without PNG, like Praxis, Boreth, Mars, Jupiter, etc.
+    struct Planet { // distant and rendered without PNG, like Praxis, Boreth, Mars, Jupiter, etc.; added to skyEntities
         glm::vec2 position;
         float brightness;
         glm::vec3 color;
@@ -106,6 +120,12 @@ private:
         std::string name;
     };
 
+    enum class CloseCelestialType {
+        SUN,
+        MOON,
+        PLANET
+    };
+
     struct CloseCelestial {  // sun, moon, and single alien planet Qo'noS
         std::string name;
         glm::vec2 position;
@@ -115,7 +135,7 @@ private:
         float brightness;
         std::string texturePath;
         GLuint texture;
-        std::string celestialType;
+        CloseCelestialType type;
     };
 
     World* world;
@@ -125,21 +145,47 @@ private:
     // Random number generator
     static std::mt19937 rng; // Static to ensure one instance across all objects
 
+    struct StarUniforms {
+        ShaderUniform<float> alpha;
+        ShaderUniform<float> sunMoonPosition;
+        ShaderUniform<float> aspectRatio;
+    };
     GLuint starShader;
-    GLuint starVAO, starVBO;
+    StarUniforms starUniforms;
+    GLuint starVAO, starVBO;               // stars, uploaded once per sky pattern
+    GLsizei staticStarCount;
+    GLuint dynamicStarVAO;                 // entity store and real sky, streamed per frame through StreamBuffer
+    std::vector<float> dynamicStarVertices;
     GLuint smokeShader;
-    GLuint smokeVAO, smokeVBO;
+    ExhaustTrailUniforms exhaustUniforms;
+    GLuint meteorShader;
+    MeteorShowerUniforms meteorUniforms;
+    MeteorShower meteorShower;
+    ExhaustTrails exhaustTrails;
     std::vector<Star> stars;
+    int randomStarCount = MIN_RANDOM_STARS;
+    float starGenerationMilliseconds = 0.0f;
+
+    StarCatalog starCatalog;
+    SkyObserver skyObserver;
+    bool realSkyEnabled = false;
+    float realSkyTimeScale = 60.0f;        // sky seconds per second
+    float realSkyLimitingMagnitude = 5.0f; // at a 60 degree field of view; narrower views reach fainter stars
+    std::vector<ProjectedStar> projectedStars;
+    SatellitePropagator satellitePropagator;
+    std::vector<VisibleSatellite> visibleSatellites;
 
     std::vector<Constellation> constellations;
     float constellationScale = 1.0f;  // scale for constellation span (to increase/decrease size)
     float constellationStarScale = 0.75f;  // scale for stars used in a constellation (to increase/decrease size)
 
-    std::vector<ShootingStar> shootingStars;
-    std::vector<Satellite> satellites;
-    std::vector<StarlinkTrain> starlinkTrains;
-    std::vector<Planet> planets;
-    float shootingStarTimer;
+    // Planets, satellites, Starlink ships and stress ships; the handles below pick out the scripted ones
+    SkyEntityStore skyEntities;
+    std::vector<SkyEntityHandle> departedEntities; // reused every update
+    std::vector<glm::vec2> wrapOffsets;            // per departed entity
+    std::vector<SkyEntityHandle> satellites;
+    SkyEntityHandle starlinkLeader; // of the train or fleet on screen
+    uint32_t starlinkTrainLabel, defenseForceLabel; // interned once, carried by the leader
     float satelliteTimer;
     float starlinkTimer;
     float totalTime;
@@ -147,19 +193,44 @@ private:
     GLuint glowTexture; // sun glow texture
 
     std::vector<CloseCelestial> closeCelestials;
-    GLuint closeCelestialShader;
+    struct CloseCelestialUniforms {
+        ShaderUniform<glm::mat4> model;
+        ShaderUniform<glm::vec3> tintColor;
+        ShaderUniform<float> opacity;
+    };
+    // Variant keys of the close celestial program: the textured disc, and the sun's glow drawn under it
+    static const uint32_t CLOSE_CELESTIAL_TEXTURE = 0;
+    static const uint32_t CLOSE_CELESTIAL_GLOW = 1;
+    ShaderPermutations<CloseCelestialUniforms> closeCelestialShaders;
     GLuint closeCelestialVAO, closeCelestialVBO, closeCelestialEBO;
 
     bool showConstellationNames;
     bool showPlanetNames;
     bool showSatelliteNames;
 
-    std::map<std::string, float> satelliteDisplayHistory;
+    // Extra ships crossing the alien sky to load the exhaust trail path
+    std::vector<SkyEntityHandle> stressShips;
+    int stressShipCount = 0;
+    std::vector<SkyEntityHandle> stressSkyEntities;
+    int stressSkyCount = 0;
+
+    static const size_t MAX_SATELLITES = 2; // scripted satellites on screen at once
+    SpacecraftCatalog earthSpacecraft;
+    SpacecraftCatalog alienSpacecraft;
+    float starlinkReadyTime = 0.0f; // totalTime at which the next train or fleet may appear
 
     void initializeStars();
     void initializeCloseCelestials();
-    void updateShootingStars(float dt, TimeOfDay currentTime);
     void updateSatellites(float dt, TimeOfDay currentTime);
+    void clearSatellites();
+    void clearStarlinkTrains();
+    void addPlanet(const Planet& planet);
+    void destroySkyEntity(SkyEntityHandle handle); // with its trail, releasing its spacecraft
+    void updateSkyEntities(float dt);
+    void spawnStressShip(uint32_t index, bool anywhere); // from a side edge, or anywhere for the first wave
+    void respawnStressShips();
+    void respawnStressSky();
+    SpacecraftCatalog& getSpacecraftCatalog() { return scene == Scene::ALIEN ? alienSpacecraft : earthSpacecraft; }
     void updateStarlinkTrains(float dt, TimeOfDay currentTime);
 
     void selectRandomSkyPattern();
@@ -14,6 +14,11 @@
 const int WINDOW_WIDTH = 1728; // 90% of 1920
 const int WINDOW_HEIGHT = 972; // 90% of 1080
 
+// Default camera, also used to bound the screen-space error of simplified terrain meshes
+const float DEFAULT_CAMERA_ZOOM = 1713.225f;
+const float DEFAULT_CAMERA_PITCH = 11.690f;
+const float CAMERA_FOV_DEGREES = 45.0f;
+
 const int INITIAL_PLAYER_COUNT = 2; // Initial number of players
 const float GRAVITY = 9.81f; // Gravity constant
 const float PIXELS_PER_METER = 100.0f; // 100 pixels = 1 meter in Box2D
@@ -1,11 +1,18 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <vector>
 #include "Enums.hpp"
 
 class Game;  // Forward declaration
 
+// A run of bytes for DataManager::WriteFileAtomically
+struct FileBlock {
+    const void* data;
+    size_t bytes;
+};
+
 class DataManager {
 public:
     DataManager();
@@ -14,4 +21,9 @@ public:
     static void LogError(const std::string& className, const std::string& methodName, const std::string& message);
     static void LogDebug(DebugCategory category, const std::string& className, const std::string& methodName, const std::string& message);
     static void LogWarning(const std::string& className, const std::string& methodName, const std::string& message); // New method
+
+    // Writes header and then payload to path, creating its directory if needed. The data goes to a temporary
+    // file that is then renamed over path, so an interrupted run never leaves a torn file behind. Failures are
+    // logged as warnings and return false; the cache files written this way are simply rebuilt next time.
+    static bool WriteFileAtomically(const std::string& path, const FileBlock& header, const std::vector<FileBlock>& payload);
 };
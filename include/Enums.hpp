@@ -16,6 +16,13 @@ enum class TerrainGenerationMode {
     DISTANT
 };
 
+enum class VegetationType {
+    TREE,
+    GRASS,
+    ROCK,
+    COUNT
+};
+
 enum class TimeOfDay {
     DAWN,
     MID_DAY,
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+#include "ShaderRegistry.hpp"
+
+struct ExhaustTrailStats {
+    size_t trails = 0;
+    size_t segments = 0;      // drawn in the last render
+    size_t uploadBytes = 0;   // in the last render
+    int drawCalls = 0;
+    float milliseconds = 0.0f; // CPU time to build and upload the last frame's vertices
+};
+
+// Uniforms of the exhaust trail shader, resolved by whoever links it
+struct ExhaustTrailUniforms {
+    ShaderUniform<float> time;
+
+    void resolve(GLuint shader);
+};
+
+// Exhaust trails of the alien scene's ships, for every ship in one place.
+// Each trail is a fixed-capacity ring of segments in flat structure-of-arrays storage indexed by
+// trail * SEGMENTS_PER_TRAIL + slot, so adding a segment overwrites the oldest one and expiry pops from the tail,
+// both O(1). Segments record their birth time and the shader fades them by age, so nothing is rewritten per frame.
+// Every live segment of every trail is written to one line list, uploaded once and drawn with one call.
+class ExhaustTrails {
+public:
+    static constexpr uint32_t INVALID_TRAIL = 0xFFFFFFFFu;
+    static constexpr int SEGMENTS_PER_TRAIL = 64;
+    static constexpr float SEGMENT_INTERVAL = 0.05f; // seconds between segments of one trail
+
+    ExhaustTrails();
+    ~ExhaustTrails();
+
+    // Starts a trail at position; segments fade out over lifetime seconds
+    uint32_t createTrail(const glm::vec2& position, const glm::vec3& color, float lifetime, float time);
+    void destroyTrail(uint32_t trail);
+    void clear();
+
+    // Extends the trail to position, adding a segment at most every SEGMENT_INTERVAL
+    void extend(uint32_t trail, const glm::vec2& position, float time);
+    // Drops the segments that have faded out
+    void update(float time);
+
+    // The shader takes aPos, aBirthTime, aLifetime and aColor at locations 0 to 3 and a "time" uniform
+    void render(GLuint shader, const ExhaustTrailUniforms& uniforms, float time);
+    const ExhaustTrailStats& getStats() const { return stats; }
+
+private:
+    struct TrailVertex {
+        glm::vec2 position;
+        float birthTime;
+        float lifetime;
+        uint32_t color; // RGBA8
+    };
+
+    // Per segment slot
+    std::vector<glm::vec2> segmentStarts;
+    std::vector<glm::vec2> segmentEnds;
+    std::vector<float> segmentBirthTimes;
+    // Per trail
+    std::vector<int> heads;   // next slot to write
+    std::vector<int> counts;  // live segments, ending at head - 1
+    std::vector<float> lifetimes;
+    std::vector<uint32_t> colors;
+    std::vector<glm::vec2> lastPoints;
+    std::vector<float> lastSegmentTimes;
+    std::vector<char> active;
+    std::vector<uint32_t> freeTrails;
+    size_t activeCount;
+
+    std::vector<TrailVertex> vertices; // reused every frame
+    GLuint vao; // attributes point into StreamBuffer
+    ExhaustTrailStats stats;
+};
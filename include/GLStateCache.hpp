@@ -0,0 +1,107 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <unordered_map>
+
+// Fixed-function state a render stage expects to start from. Anything a stage changes further is its own
+// business, as long as it goes through GLStateCache.
+struct RenderState {
+    bool depthTest = true;
+    bool depthWrite = true;
+    GLenum depthFunc = GL_LESS;
+    float depthNear = 0.0f;
+    float depthFar = 1.0f;
+    bool blend = true;
+    GLenum blendSource = GL_SRC_ALPHA;
+    GLenum blendDestination = GL_ONE_MINUS_SRC_ALPHA;
+    bool cullFace = false;
+};
+
+struct GLStateCacheStats {
+    int issued = 0; // state changes passed on to the driver in the last frame
+    int elided = 0; // calls dropped in the last frame because they would not have changed anything
+};
+
+// Shadow copy of the GL state that is switched often while drawing: capabilities, depth and blend settings,
+// the viewport, the program and the vertex array. A call that would set what is already set never reaches
+// the driver. Only correct while every change of that state goes through here; code that changes it behind
+// the cache's back (a third-party renderer that does not restore what it touches) must call invalidate().
+class GLStateCache {
+public:
+    static GLStateCache& shared();
+
+    void enable(GLenum capability) { setCapability(capability, true); }
+    void disable(GLenum capability) { setCapability(capability, false); }
+    void depthMask(GLboolean write);
+    void depthFunc(GLenum func);
+    void depthRange(float nearValue, float farValue);
+    void blendFunc(GLenum source, GLenum destination);
+    void blendEquation(GLenum mode);
+    void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+    void useProgram(GLuint program);
+    void bindVertexArray(GLuint vertexArray);
+    // Delete through here so a name the driver hands out again is not taken for still bound
+    void deleteProgram(GLuint program);
+    void deleteVertexArrays(GLsizei count, const GLuint* vertexArrays);
+
+    // Sets a stage's state, issuing only what differs from the current one
+    void apply(const RenderState& state);
+
+    // Forgets everything, so the next call of each kind is issued whatever it sets
+    void invalidate();
+    // Publishes the counts of the frame that ended and starts counting the next one
+    void newFrame();
+    const GLStateCacheStats& getStats() const { return stats; }
+
+private:
+    template <typename T>
+    struct Cached {
+        T value{};
+        bool known = false;
+    };
+    struct DepthRange {
+        float nearValue, farValue;
+        bool operator==(const DepthRange& other) const { return nearValue == other.nearValue && farValue == other.farValue; }
+    };
+    struct BlendFunction {
+        GLenum source, destination;
+        bool operator==(const BlendFunction& other) const { return source == other.source && destination == other.destination; }
+    };
+    struct Viewport {
+        GLint x, y;
+        GLsizei width, height;
+        bool operator==(const Viewport& other) const {
+            return x == other.x && y == other.y && width == other.width && height == other.height;
+        }
+    };
+
+    std::unordered_map<GLenum, bool> capabilities; // absent until first set
+    Cached<GLboolean> depthWrite;
+    Cached<GLenum> depthFunction;
+    Cached<DepthRange> currentDepthRange;
+    Cached<BlendFunction> blendFunction;
+    Cached<GLenum> blendMode;
+    Cached<Viewport> currentViewport;
+    Cached<GLuint> currentProgram;
+    Cached<GLuint> currentVertexArray;
+    GLStateCacheStats frameStats; // being counted
+    GLStateCacheStats stats;      // of the last complete frame
+
+    GLStateCache() = default;
+    GLStateCache(const GLStateCache&) = delete;
+    GLStateCache& operator=(const GLStateCache&) = delete;
+
+    void setCapability(GLenum capability, bool enabled);
+    // Records value and returns true if it differs from the cached one, counting the call either way
+    template <typename T>
+    bool change(Cached<T>& cached, const T& value) {
+        if (cached.known && cached.value == value) {
+            ++frameStats.elided;
+            return false;
+        }
+        cached.value = value;
+        cached.known = true;
+        ++frameStats.issued;
+        return true;
+    }
+};
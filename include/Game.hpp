@@ -6,6 +6,7 @@
 #include <imgui.h>
 #include <imgui_impl_sdl3.h>
 #include <imgui_impl_opengl3.h>
+#include <chrono>
 #include "World.hpp"
 #include "Renderer.hpp"
 #include "DataManager.hpp"
@@ -27,6 +28,7 @@ private:
     SDL_Window* window;
     SDL_GLContext context;
     bool running;
+    std::chrono::high_resolution_clock::time_point startTime; // of initialize(), for the time to the first frame
 
     std::unique_ptr<World> world;
     std::unique_ptr<Renderer> renderer;
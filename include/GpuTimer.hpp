@@ -0,0 +1,29 @@
+#pragma once
+
+#include <GL/glew.h>
+
+// Measures GPU time spent between begin() and end() with GL_TIME_ELAPSED queries.
+// Results are read back a few frames late so querying never stalls the pipeline.
+// GL_TIME_ELAPSED queries cannot be nested, so only one timer may be active at a time.
+class GpuTimer {
+public:
+    GpuTimer();
+    ~GpuTimer();
+
+    void begin();
+    void end();
+
+    // Smoothed GPU time in milliseconds of the most recent completed measurement
+    float getMilliseconds() const { return milliseconds; }
+
+private:
+    static const int QUERY_COUNT = 4;
+
+    GLuint queries[QUERY_COUNT];
+    bool pending[QUERY_COUNT];
+    int writeIndex;
+    bool active;
+    float milliseconds;
+
+    void collectResults();
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include "TextRenderer.hpp"
+
+struct HotkeyBarStats {
+    size_t glyphs = 0;
+    int drawCalls = 0;    // in the last render
+    int layouts = 0;      // since start, rebuilt on a font or viewport change
+    int colorUploads = 0; // since start, one per change of the enabled items
+};
+
+// The row-wrapped, centered hotkey labels at the bottom of the screen, kept as retained geometry.
+// Glyph quads are laid out once into a static buffer and only rebuilt when the font or viewport changes.
+// Colors live in a separate per-vertex buffer that is rewritten only when an item is switched on or off,
+// so a frame with nothing changed is one draw with no upload and no allocation.
+class HotkeyBar {
+public:
+    static constexpr int MAX_ITEMS = 32;
+
+    HotkeyBar();
+    ~HotkeyBar();
+
+    // Sets the labels in display order and invalidates the layout
+    void setItems(const std::vector<std::string>& labels);
+    void invalidate() { layoutFont = -1; }
+
+    // Bit i of enabled is set when item i is on; the shader is the text shader of TextRenderer
+    void render(GLuint shader, const TextUniforms& uniforms, TextRenderer& text, int font, uint32_t enabled, int viewportWidth, int viewportHeight);
+    const HotkeyBarStats& getStats() const { return stats; }
+
+private:
+    static constexpr float SCALE = 0.5f;
+    static constexpr float SPACING = 20.0f;
+    static constexpr float ROW_HEIGHT = 20.0f;
+    static constexpr float BASE_Y = 30.0f;
+
+    std::vector<std::string> labels;
+    std::vector<GLint> itemFirstVertex; // per item, and the end of the last one
+
+    int layoutFont;
+    int layoutWidth, layoutHeight;
+    uint32_t uploadedEnabled;
+    bool colorsValid;
+
+    std::vector<glm::vec4> geometryScratch;
+    std::vector<uint32_t> colorScratch;
+    GLuint vao, geometryVbo, colorVbo;
+    GLsizei vertexCount;
+    HotkeyBarStats stats;
+
+    void layout(TextRenderer& text, int font, int viewportWidth, int viewportHeight);
+    void uploadColors(uint32_t enabled);
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Higher wins a contested spot
+enum class LabelPriority : uint8_t {
+    CONSTELLATION,
+    SPACECRAFT,  // satellites, Starlink trains and fleets
+    PLANET,      // distant planets and Qo'noS
+    FLAGSHIP,    // the ISS, the Bird-of-Prey and the real stations
+    COUNT
+};
+
+struct PlacedLabel {
+    const std::string* text; // valid until the next add()
+    glm::vec2 position;      // bottom center, in window pixels
+    float scale;
+    glm::vec3 color;
+};
+
+struct LabelPlacerStats {
+    size_t candidates = 0;
+    size_t placed = 0;
+    size_t pending = 0;  // free, but waiting out the show delay
+    size_t hidden = 0;   // blocked by a higher-priority label, the terrain or the window edge
+    float milliseconds = 0.0f;
+};
+
+// Decluttering for the sky labels. Every frame the candidates are taken in priority order and each tries a few
+// spots around its anchor (above, below, right, left). A spot is taken if it lies in the window, above the
+// terrain skyline and clear of every label placed before it. The placed labels are kept as a uniform grid with
+// one bit per cell, so testing a spot is a few masked words per row it covers and costs the same however many
+// labels are on screen. Against flicker, labels shown last frame go first within their
+// priority and try their last spot first, and a label that was hidden must find a spot for SHOW_DELAY_FRAMES
+// frames in a row before it appears; until then it holds its spot so lower priorities do not take it.
+class LabelPlacer {
+public:
+    static constexpr int CELL_SIZE = 8; // pixels
+    static constexpr uint8_t SHOW_DELAY_FRAMES = 8;
+
+    LabelPlacer();
+
+    // Per frame, before place(): the window and, per column across it, the lowest y a label may start at
+    void setViewport(int width, int height);
+    void setSkyline(const std::vector<float>& skyline);
+
+    // anchor is the labelled object, gap the distance from it to the label, size the label at its scale
+    void add(const std::string& text, const glm::vec2& anchor, float gap, const glm::vec2& size, float scale,
+        const glm::vec3& color, LabelPriority priority);
+    // Resolves this frame's candidates and starts the next frame
+    const std::vector<PlacedLabel>& place();
+    const LabelPlacerStats& getStats() const { return stats; }
+
+private:
+    static constexpr int SPOT_COUNT = 4;
+    static constexpr uint32_t FORGET_FRAMES = 120; // history of labels not seen for this long is dropped
+
+    struct Candidate {
+        std::string text;
+        uint64_t key;
+        glm::vec2 anchor;
+        float gap;
+        glm::vec2 size;
+        float scale;
+        glm::vec3 color;
+        LabelPriority priority;
+    };
+
+    struct History {
+        uint32_t lastFrame;
+        uint8_t spot;
+        uint8_t freeFrames;
+        bool visible;
+    };
+
+    std::vector<Candidate> candidates; // reused, so the strings keep their capacity
+    size_t candidateCount;
+    std::vector<uint32_t> order;
+    std::vector<History*> states;   // per candidate
+    std::vector<uint8_t> buckets;   // per candidate
+    std::vector<uint32_t> bucketStarts;
+    std::unordered_map<uint64_t, History> history;
+    uint32_t frame;
+
+    int viewportWidth, viewportHeight;
+    int cellsY, wordsPerRow;
+    std::vector<uint64_t> occupancy; // one bit per cell taken by a label, rows of wordsPerRow words
+    std::vector<float> skyline;
+
+    std::vector<PlacedLabel> placed;
+    LabelPlacerStats stats;
+
+    glm::vec4 spotRect(const Candidate& candidate, int spot) const;
+    // rect is min x, min y, max x, max y
+    bool isFree(const glm::vec4& rect) const;
+    void insert(const glm::vec4& rect);
+    static uint64_t spanMask(int word, int minCell, int maxCell);
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+#include "ShaderRegistry.hpp"
+
+struct MeteorShowerStats {
+    size_t ringSlots = 0;     // between tail and head, including ended meteors waiting behind a longer-lived one
+    size_t spawned = 0;       // in the last update
+    size_t uploadBytes = 0;   // in the last render
+    int drawCalls = 0;
+    float milliseconds = 0.0f; // CPU time of the last update's spawning
+};
+
+// Uniforms of the meteor shader, resolved by whoever links it
+struct MeteorShowerUniforms {
+    ShaderUniform<float> time;
+    ShaderUniform<float> alpha;
+    ShaderUniform<glm::vec2> viewportSize;
+
+    void resolve(GLuint shader);
+};
+
+// Meteors of the night sky: the occasional sporadic one and, when enabled, a shower from a radiant point.
+// A meteor flies in a straight line, so it is fully described by its spawn state: start position, velocity,
+// spawn time, lifetime, brightness and streak length. These are written once into a ring buffer of
+// structure-of-arrays instance data in spawn order, and the shader evaluates position, streak and brightness
+// from the spawn time every frame. The CPU never touches a live meteor again; it only uploads the new ones and
+// advances the tail past meteors whose lifetime has ended. New meteors are generated in parallel chunks, each
+// chunk with its own random stream.
+class MeteorShower {
+public:
+    static constexpr int MIN_SHOWER_METEORS = 1000;
+    static constexpr int MAX_SHOWER_METEORS = 50000;
+    static constexpr float MAX_LIFETIME = 2.0f; // seconds; sporadic meteors live up to this, shower ones up to 1.6
+    // Instances in the ring. The tail only passes ended meteors in spawn order, so one long-lived meteor holds
+    // everything spawned after it, and the ring spans up to MAX_LIFETIME of spawning, not just the live ones.
+    static constexpr size_t CAPACITY = 131072;
+
+    MeteorShower();
+    ~MeteorShower();
+
+    void setShowerEnabled(bool enabled) { showerEnabled = enabled; }
+    bool isShowerEnabled() const { return showerEnabled; }
+    // Meteors in the sky at once during the shower
+    void setShowerMeteors(int count);
+    int getShowerMeteors() const { return showerMeteors; }
+    // Normalized sky coordinates the shower streaks away from; it may lie off screen
+    void setRadiant(const glm::vec2& position) { radiant = position; }
+    const glm::vec2& getRadiant() const { return radiant; }
+
+    void clear();
+    // Meteors only fall at night; otherwise everything is cleared
+    void update(float dt, float time, bool night);
+    // The shader takes aCorner, aMotion and aTiming at locations 0 to 2 and "time", "alpha" and "viewportSize" uniforms
+    void render(GLuint shader, const MeteorShowerUniforms& uniforms, float time, float alpha);
+    const MeteorShowerStats& getStats() const { return stats; }
+
+private:
+    static constexpr int SPAWN_CHUNK = 1024;
+    static constexpr float MEAN_SHOWER_LIFETIME = 1.0f; // seconds, for the spawn rate
+    static_assert(CAPACITY >= MAX_SHOWER_METEORS / MEAN_SHOWER_LIFETIME * MAX_LIFETIME * 1.25f,
+        "the ring must hold MAX_LIFETIME of spawning at the top shower rate, with room for a slow frame");
+
+    // Structure-of-arrays instance data, the layout of the two attribute blocks in instanceVbo
+    std::vector<glm::vec4> motions; // start x, start y, velocity x, velocity y
+    std::vector<glm::vec4> timings; // spawn time, lifetime, brightness, streak length
+    size_t head, tail;              // ring positions, counting up; slot = position % CAPACITY
+    size_t uploadedHead;
+
+    bool showerEnabled;
+    int showerMeteors;
+    glm::vec2 radiant;
+    float spawnDebt;      // shower meteors due but not yet spawned, carried to the next update
+    float sporadicTimer;
+    std::vector<std::mt19937> streams; // one per spawn chunk
+
+    GLuint vao, cornerVbo, instanceVbo;
+    MeteorShowerStats stats;
+
+    void spawnSporadic(float time);
+    void spawnShower(size_t count, float time);
+    void upload(size_t first, size_t count);
+    void bindInstances(size_t firstSlot);
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+struct NoiseTextureParameters {
+    uint32_t seed = 1337;
+    int size = 512;   // texels along each side of the tile, a power of two
+    int period = 32;  // lattice cells across the tile in the red channel; each further channel has twice as many
+};
+
+struct NoiseTextureStats {
+    int size = 0;
+    bool fromCache = false;
+    float milliseconds = 0.0f; // baking or loading, and uploading
+    unsigned int threads = 0;  // that baked it, 0 when loaded
+};
+
+// A seamlessly tiling value-noise tile with one fBm octave per channel: red has period lattice cells across,
+// green twice as many, blue four and alpha eight times, each interpolated like the shaders' noise() was.
+// So one fetch at st / period yields noise(st), noise(2 st), noise(4 st) and noise(8 st), and a second fetch
+// at sixteen times that covers the next octaves. The tile is baked on the worker threads once per parameter
+// set and kept in a cache file named after the seed and parameters; later runs only load and upload it.
+class NoiseTexture {
+public:
+    NoiseTexture();
+    ~NoiseTexture();
+
+    // Loads the tile from cacheDirectory, or bakes and saves it there, and uploads it with mipmaps and repeat wrapping
+    bool create(const NoiseTextureParameters& params, const std::string& cacheDirectory);
+    GLuint getTexture() const { return texture; }
+    const NoiseTextureParameters& getParameters() const { return parameters; }
+    const NoiseTextureStats& getStats() const { return stats; }
+
+    // RGBA8 texels, row by row
+    static std::vector<uint8_t> bake(const NoiseTextureParameters& params);
+
+private:
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t seed;
+        uint32_t size;
+        uint32_t period;
+        uint32_t reserved;
+    };
+    static const uint32_t FILE_VERSION = 1;
+
+    GLuint texture;
+    NoiseTextureParameters parameters;
+    NoiseTextureStats stats;
+
+    static std::string cachePath(const NoiseTextureParameters& params, const std::string& cacheDirectory);
+    static bool load(const std::string& path, const NoiseTextureParameters& params, std::vector<uint8_t>& texels);
+    static bool save(const std::string& path, const NoiseTextureParameters& params, const std::vector<uint8_t>& texels);
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Bridson's Poisson-disk sampling over a rectangle, accelerated by a background grid that holds at most one
+// point per cell. The rectangle is cut into tiles that are filled in four passes (by tile column/row parity)
+// on the shared ThreadPool. Tiles in the same pass are at least one tile apart, so they never read or write
+// each other's grid cells, and the result is a valid Poisson-disk set across tile borders.
+class PoissonDiskSampler {
+public:
+    // Probability in [0, 1] that a sampled point is kept; used to thin the set towards a density falloff
+    using KeepFunction = std::function<float(const glm::vec2&)>;
+
+    // Returns points at least radius apart inside [0, width) x [0, height), grouped by tile in row-major tile order.
+    // tileSize is a hint in the same units; it is raised so a tile spans at least three grid cells.
+    // The same arguments always give the same points, whatever the thread count.
+    // keep is called from worker threads and must be safe to call concurrently.
+    static std::vector<glm::vec2> sample(float width, float height, float radius, uint32_t seed, float tileSize, int attempts = 16,
+        const KeepFunction& keep = nullptr);
+};
@@ -11,6 +11,12 @@
 #include "World.hpp"
 #include "Sky.hpp"
 #include "CelestialObjectManager.hpp"
+#include "GpuTimer.hpp"
+#include "TextRenderer.hpp"
+#include "HotkeyBar.hpp"
+#include "LabelPlacer.hpp"
+#include "ShaderRegistry.hpp"
+#include "GLStateCache.hpp"
 #include "imgui.h"
 
 class Renderer {
@@ -27,8 +33,11 @@ public:
     void setCurrentTimeOfDayIndex(int index) { currentTimeOfDayIndex = index; }
     void toggleUseKlingonNames() { useKlingonNames = !useKlingonNames; }
     void setScene(Scene newScene);  // public so InputManager can access it
+    void setTimeToFirstFrame(float milliseconds) { timeToFirstFrame = milliseconds; }
     void renderBottomTerrain();
     void renderDistantTerrain();
+    void renderBackgroundLayers();
+    void renderVegetation();
 
 private:
 
@@ -37,13 +46,18 @@ private:
         DISTANT_CELESTIALS,
         CLOSE_CELESTIALS,
         CELESTIAL_TEXT,
+        BACKGROUND_LAYERS,
         DISTANT_TERRAIN,
         CLOUDS,
         BOTTOM_TERRAIN,
+        VEGETATION,
         HOTKEYS_TEXT,
         IMGUI,
         COUNT
     };
+    // State each stage starts from; render() applies it through GLStateCache, so only what differs from the
+    // stage before reaches the driver
+    static RenderState getStageState(RenderStage stage);
 
     friend class CelestialObjectManager;
 
@@ -55,8 +69,45 @@ private:
     std::unique_ptr<Sky> sky;
     CelestialObjectManager* celestialObjectManager;
 
-    GLuint textShader, textVAO, textVBO;
-    GLuint terrainShader;
+    GLuint textShader;
+    TextUniforms textUniforms;
+    TextRenderer textRenderer; // glyph atlas of both fonts
+    int textFont, klingonTextFont;
+    HotkeyBar hotkeyBar;       // retained, re-laid out only when its font or the window changes
+    LabelPlacer labelPlacer;   // keeps the sky labels clear of each other and of the terrain
+    std::vector<float> labelSkyline;
+    static constexpr int LABEL_SKYLINE_COLUMNS = 128;
+    // Handles of the uniforms each program takes beyond the Frame block, resolved once after linking
+    struct TerrainPassUniforms {
+        ShaderUniform<glm::mat4> model;
+        ShaderUniform<glm::mat3> normalMatrix;
+        ShaderUniform<float> depthFade;    // distant variant only
+        ShaderUniform<float> terrainDepth; // distant variant only
+        TerrainUniforms terrain;
+    };
+    struct BackgroundLayerPassUniforms {
+        ShaderUniform<glm::vec3> hazeColor;
+        BackgroundLayerUniforms layers;
+    };
+    struct VegetationPassUniforms {
+        ShaderUniform<glm::mat4> model;
+        ShaderUniform<glm::vec3> cameraRight;
+        VegetationUniforms vegetation;
+    };
+    // Variant keys of the terrain program; the distant terrain fades with depth, the bottom terrain does not
+    static const uint32_t TERRAIN_BOTTOM = 0;
+    static const uint32_t TERRAIN_DISTANT = 1;
+    ShaderPermutations<TerrainPassUniforms> terrainShaders;
+    GLuint backgroundLayerShader;
+    BackgroundLayerPassUniforms backgroundLayerUniforms;
+    GLuint vegetationShader;
+    VegetationPassUniforms vegetationUniforms;
+    GpuTimer bottomTerrainTimers[2]; // [0] full-resolution mesh, [1] coarse mesh with detail normals
+    GpuTimer backgroundLayerTimer;
+    bool backgroundLayersEnabled;
+    GpuTimer vegetationTimer;
+    bool vegetationEnabled;
+    float vegetationDensity;
     GLuint smokeShader, smokeVAO, smokeVBO, smokeEBO, smokeTexture;
 
     glm::mat4 projection;
@@ -68,7 +119,24 @@ private:
     float cameraYaw;
     float cameraPitch;
     float terrainHardness;
+    float distantMaxPixelError;
+    int randomStarCount;
 
+    struct OcclusionCullingStats {
+        int totalChunks = 0;
+        int occludedChunks = 0;
+        int outsideChunks = 0;
+        size_t savedTriangles = 0;
+        float cpuMilliseconds = 0.0f;
+    };
+    static const int OCCLUSION_BIN_PIXELS = 4;
+    bool occlusionCullingEnabled;
+    OcclusionCullingStats occlusionStats;
+    std::vector<float> occlusionHorizon;    // per screen bin: highest pixel row covered by the bottom terrain
+    std::vector<float> occlusionRowHorizon; // scratch for one profile row
+    std::vector<char> distantChunkVisibility;
+
+    float timeToFirstFrame; // from the start of Game::initialize, -1 until the first frame is out
     int currentTimeOfDayIndex;
     int sceneNamesIndex;
 
@@ -76,15 +144,26 @@ private:
     bool regenerationTriggered;
     bool regenerateDistantTriggered;
 
+    // Queues text for the next flushText(), which draws everything queued in one call
     void renderText(const std::string& text, float x, float y, float scale, glm::vec3 color, bool celestial = false);
+    void flushText();
+    // Offers a sky label to the placer; gap is its distance above the anchor when nothing is in the way
+    void addLabel(const std::string& text, float x, float y, float gap, float scale, glm::vec3 color, LabelPriority priority);
     void renderHotKeys();
     void renderCloseCelestials();
     void renderDistantCelestials();
     void renderCelestialText();
     void displayTest_GUI();
 
+    glm::mat4 getBottomTerrainModel() const;
+    glm::mat4 getDistantTerrainModel() const;
+    bool buildOcclusionHorizon();
+    void cullDistantTerrainChunks(const glm::mat4& distantModel);
+
     void resetCameraControls();
-    bool initializeTerrainShader();
+    void initializeTerrainShader();
+    void initializeBackgroundLayerShader();
+    void initializeVegetationShader();
     bool initializeTextRendering();
     void cleanupOpenGLResources();
     void cleanupSmokeResources();
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "StarCatalog.hpp"
+
+struct VisibleSatellite {
+    glm::vec2 position; // normalized sky coordinates
+    float altitude;     // degrees above the horizon
+    uint32_t index;     // into the propagator's satellites
+};
+
+struct SatellitePropagatorStats {
+    size_t loaded = 0;
+    size_t deepSpaceSkipped = 0; // orbital periods of 225 minutes or more need SDP4, which is not implemented
+    size_t propagated = 0;       // in the last update
+    size_t aboveHorizon = 0;
+    size_t visible = 0;          // above the horizon, sunlit and on screen
+    float milliseconds = 0.0f;
+};
+
+// Near-Earth SGP4 propagation (WGS-72, as used to fit the elements) for the satellites of a local TLE file.
+// Elements and the constants SGP4 derives from them are kept as structure-of-arrays, and each update propagates
+// the satellites that are due in one branch-free batch loop split across the ThreadPool.
+// A satellite well below the horizon cannot rise faster than MAX_ALTITUDE_RATE, so it is only propagated again
+// once it could be close to the horizon; only satellites near or above it are propagated every update.
+class SatellitePropagator {
+public:
+    // Reads name / line 1 / line 2 triples (or bare line pairs); returns false if no usable satellite was found
+    bool loadTle(const std::string& path);
+    size_t getCount() const { return names.size(); }
+    const std::string& getName(uint32_t index) const { return names[index]; }
+    bool isStation(uint32_t index) const { return stations[index] != 0; } // ISS and Tiangong: bright and labelled
+
+    // Propagates to observer.julianDate and replaces visible with the sunlit satellites above the horizon on screen
+    void update(const SkyObserver& observer, const SkyProjection& projection, std::vector<VisibleSatellite>& visible);
+    const SatellitePropagatorStats& getStats() const { return stats; }
+
+    // Resets the schedule so every satellite is propagated on the next update, for jumps in time or place
+    void invalidateSchedule();
+
+private:
+    static constexpr double MAX_ALTITUDE_RATE = 1.0;    // degrees per second, an ISS pass overhead
+    static constexpr double NEAR_HORIZON = -5.0;        // degrees; closer than this is propagated every update
+    static constexpr double MAX_SCHEDULE_STEP = 120.0;  // seconds
+
+    struct Elements {
+        std::vector<double> epoch; // Julian date
+        std::vector<double> meanMotion, eccentricity, inclination, node, argPerigee, meanAnomaly, bstar;
+        std::vector<double> mdot, argpdot, nodedot, nodecf, cc1, cc4, cc5, omgcof, xmcof, eta, delmo, sinmao;
+        std::vector<double> t2cof, t3cof, t4cof, t5cof, d2, d3, d4, aycof, xlcof, con41, x1mth2, x7thm1, cosio, sinio;
+    };
+
+    Elements elements;
+    std::vector<std::string> names;
+    std::vector<char> stations;
+    std::vector<double> nextUpdate; // Julian date at which each satellite is propagated again
+    std::vector<float> east, north, up; // topocentric direction of the last propagation
+    std::vector<char> sunlit;
+    std::vector<uint32_t> dueIndices;
+    double lastJulianDate = 0.0;
+    float lastLatitude = 0.0f, lastLongitude = 0.0f;
+    SatellitePropagatorStats stats;
+
+    bool addSatellite(const std::string& name, const std::string& line1, const std::string& line2);
+};
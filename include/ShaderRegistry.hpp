@@ -0,0 +1,235 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+// Location of one uniform of one program, resolved once after the program is linked. A uniform the compiler
+// optimized out keeps location -1, which glUniform* ignores. set() applies to the program in use.
+template <typename T>
+struct ShaderUniform {
+    GLint location = -1;
+    void set(const T& value) const;
+};
+
+template <> inline void ShaderUniform<float>::set(const float& value) const { glUniform1f(location, value); }
+template <> inline void ShaderUniform<int>::set(const int& value) const { glUniform1i(location, value); }
+template <> inline void ShaderUniform<bool>::set(const bool& value) const { glUniform1i(location, value ? 1 : 0); }
+template <> inline void ShaderUniform<glm::vec2>::set(const glm::vec2& value) const { glUniform2fv(location, 1, &value[0]); }
+template <> inline void ShaderUniform<glm::vec3>::set(const glm::vec3& value) const { glUniform3fv(location, 1, &value[0]); }
+template <> inline void ShaderUniform<glm::vec4>::set(const glm::vec4& value) const { glUniform4fv(location, 1, &value[0]); }
+template <> inline void ShaderUniform<glm::mat3>::set(const glm::mat3& value) const { glUniformMatrix3fv(location, 1, GL_FALSE, &value[0][0]); }
+template <> inline void ShaderUniform<glm::mat4>::set(const glm::mat4& value) const { glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]); }
+
+// The Frame uniform block shared by the world-space shaders, updated once per frame. Laid out as std140,
+// where a vec3 takes a whole 16 bytes, hence the padding.
+struct FrameUniforms {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec3 cameraPos;
+    float padding0;
+    glm::vec3 lightPos;
+    float padding1;
+    glm::vec3 lightColor;
+    float padding2;
+};
+
+struct ShaderRegistryStats {
+    int programs = 0;             // alive
+    int uniforms = 0;             // locations resolved at link time across them
+    int compiled = 0;             // programs compiled and linked since startup
+    int loaded = 0;               // programs loaded from the program binary cache instead
+    int failed = 0;               // programs that did not compile or link
+    int pending = 0;              // submitted or deferred, not yet needed
+    bool parallel = false;        // the driver compiles on threads of its own (KHR_parallel_shader_compile)
+    float milliseconds = 0.0f;    // spent submitting programs and waiting for their results
+    size_t frameUniformBytes = 0; // uploaded to the Frame block per frame
+};
+
+// Owns the shader programs: compiles and links them, logging failures the same way everywhere, and looks up
+// every active uniform once after linking, so drawing code keeps typed handles instead of asking the driver
+// for locations by name each frame. Programs that declare the Frame block are bound to its buffer.
+// Where the driver supports program binaries, linked programs are kept on disk keyed by a hash of their source
+// and of the driver, and loaded from there on the next run; a binary the driver rejects is simply compiled again.
+//
+// Compiling is asynchronous: submit() issues the compile and link and returns at once, and the result is only
+// waited for when the program is first used, so the driver works through every program submitted at startup
+// together (on its own threads where KHR_parallel_shader_compile is present) instead of one status query at a
+// time. Programs not needed for the first frame can be deferred until submitDeferred().
+class ShaderRegistry {
+public:
+    static constexpr GLuint FRAME_UNIFORM_BINDING = 0;
+    // GLSL declaration of the Frame block, to follow the #version line of the shaders that use it
+    static const char* const FRAME_UNIFORM_BLOCK;
+
+    // Runs once the program has linked, with it in use, to resolve handles and set constant uniforms
+    using LinkedCallback = std::function<void(GLuint program)>;
+
+    static ShaderRegistry& shared();
+
+    // Issues the compile and link, or the load from the binary cache, without waiting for either; name labels
+    // the program in the log. A program that fails keeps its name until destroyed, but use() refuses it.
+    GLuint submit(const std::string& name, const std::string& vertexSource, const std::string& fragmentSource,
+        LinkedCallback onLinked = nullptr);
+    // As submit(), but nothing is compiled until submitDeferred() or the first use()
+    GLuint defer(const std::string& name, const std::string& vertexSource, const std::string& fragmentSource,
+        LinkedCallback onLinked = nullptr);
+    // Deferred programs are submitted; later defer() calls submit at once
+    void submitDeferred();
+    // As submit() and waits for the result. Returns 0 on failure.
+    GLuint create(const std::string& name, const std::string& vertexSource, const std::string& fragmentSource,
+        LinkedCallback onLinked = nullptr);
+    void destroy(GLuint program);
+
+    // Binds the program, first waiting for it if it is still compiling. False, with no program bound, if it failed.
+    bool use(GLuint program);
+    // Whether use() would not wait: false for a deferred program and, with parallel compilation, for one the
+    // driver is still working on. Lets optional passes skip a frame instead of stalling it.
+    bool isReady(GLuint program);
+
+    // Off, every program is compiled and waited for where it is submitted, as before; for comparing start-up times
+    void setDeferredCompilation(bool enabled) { deferredCompilation = enabled; }
+    bool isDeferredCompilation() const { return deferredCompilation; }
+
+    // The source with the given #define lines inserted after its #version line, where the preprocessor wants them
+    static std::string withDefines(const std::string& source, const std::string& defines);
+
+    template <typename T>
+    ShaderUniform<T> uniform(GLuint program, const std::string& name) const {
+        ShaderUniform<T> handle;
+        handle.location = findLocation(program, name);
+        return handle;
+    }
+
+    void updateFrameUniforms(const FrameUniforms& frame);
+    const ShaderRegistryStats& getStats() const { return stats; }
+    // Deletes every program; needs the GL context still current
+    void cleanup();
+
+private:
+    enum class ProgramState {
+        DEFERRED,
+        LINKING,
+        LINKED,
+        FAILED
+    };
+    struct ProgramInfo {
+        std::string name;
+        ProgramState state = ProgramState::DEFERRED;
+        bool fromCache = false;
+        // Kept until the link result is known: the sources in case the cached binary is rejected
+        std::string vertexSource, fragmentSource;
+        GLuint vertexShader = 0, fragmentShader = 0;
+        uint64_t sourceHash = 0;
+        std::string cachePath; // empty without program binary support
+        LinkedCallback onLinked;
+        std::unordered_map<std::string, GLint> locations;
+    };
+    struct BinaryHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t sourceHash;
+        uint64_t driverHash; // of the vendor, renderer and version strings
+        uint32_t format;
+        uint32_t length;
+    };
+    static const uint32_t BINARY_FILE_VERSION = 1;
+
+    std::unordered_map<GLuint, ProgramInfo> programs;
+    GLint uniformBufferAlignment; // of Frame block offsets into StreamBuffer
+    ShaderRegistryStats stats;
+    bool driverQueried;
+    bool binarySupport;
+    uint64_t driverHash;
+    bool deferredCompilation;
+    bool deferredSubmitted;
+
+    ShaderRegistry();
+    ShaderRegistry(const ShaderRegistry&) = delete;
+    ShaderRegistry& operator=(const ShaderRegistry&) = delete;
+
+    void queryDriver();
+    GLuint add(const std::string& name, const std::string& vertexSource, const std::string& fragmentSource, LinkedCallback onLinked);
+    void beginLink(GLuint program, ProgramInfo& info);
+    void compileAndLink(GLuint program, ProgramInfo& info);
+    bool finish(GLuint program, ProgramInfo& info);
+    void logFailure(GLuint program, const ProgramInfo& info);
+    bool loadBinary(GLuint program, const ProgramInfo& info);
+    void saveBinary(GLuint program, const ProgramInfo& info);
+    void resolveUniforms(GLuint program, ProgramInfo& info);
+    GLint findLocation(GLuint program, const std::string& name) const;
+};
+
+// Variants of one program specialized by #define lines, so a choice that is constant for a whole draw is made by
+// the preprocessor instead of by a uniform branch in every vertex or fragment. The caller numbers the variants
+// with a small key and turns a key into its defines; each variant is an ordinary program of the registry, compiled
+// on its first use unless prepared earlier, and kept in the binary cache on its own as its source differs.
+template <typename Uniforms>
+class ShaderPermutations {
+public:
+    struct Variant {
+        GLuint program = 0;
+        Uniforms uniforms;
+    };
+    using DefineBuilder = std::function<std::string(uint32_t key)>;
+    // Runs once a variant has linked, with it in use, to resolve its handles and set its constant uniforms
+    using LinkedCallback = std::function<void(GLuint program, Uniforms& uniforms)>;
+
+    void initialize(const std::string& name, const std::string& vertexSource, const std::string& fragmentSource,
+        DefineBuilder defines, LinkedCallback onLinked = nullptr) {
+        baseName = name;
+        baseVertexSource = vertexSource;
+        baseFragmentSource = fragmentSource;
+        defineBuilder = std::move(defines);
+        linkedCallback = std::move(onLinked);
+    }
+    bool isInitialized() const { return !baseName.empty(); }
+
+    // Submits the variant ahead of its first use, or defers it along with the other programs not needed at once
+    GLuint prepare(uint32_t key, bool deferred = false) {
+        auto found = variants.find(key);
+        if (found != variants.end()) return found->second.program;
+
+        // Map nodes do not move, so the callback can fill in the handles where they stay
+        Variant& variant = variants[key];
+        Uniforms* uniforms = &variant.uniforms;
+        LinkedCallback callback = linkedCallback;
+        ShaderRegistry::LinkedCallback onLinked = [callback, uniforms](GLuint program) {
+            if (callback) callback(program, *uniforms);
+        };
+        const std::string defines = defineBuilder ? defineBuilder(key) : std::string();
+        const std::string name = baseName + " #" + std::to_string(key);
+        const std::string vertexSource = ShaderRegistry::withDefines(baseVertexSource, defines);
+        const std::string fragmentSource = ShaderRegistry::withDefines(baseFragmentSource, defines);
+        ShaderRegistry& registry = ShaderRegistry::shared();
+        variant.program = deferred ? registry.defer(name, vertexSource, fragmentSource, std::move(onLinked))
+                                   : registry.submit(name, vertexSource, fragmentSource, std::move(onLinked));
+        return variant.program;
+    }
+
+    // Binds the variant for key, compiling it or waiting for it first if need be. Null, with no program bound, if it failed.
+    const Variant* use(uint32_t key) {
+        prepare(key);
+        const Variant& variant = variants[key];
+        return ShaderRegistry::shared().use(variant.program) ? &variant : nullptr;
+    }
+    // Whether use() would not wait; a variant never asked for is submitted so it is ready some frames later
+    bool isReady(uint32_t key) { return ShaderRegistry::shared().isReady(prepare(key)); }
+
+    void destroy() {
+        ShaderRegistry& registry = ShaderRegistry::shared();
+        for (auto& entry : variants) registry.destroy(entry.second.program);
+        variants.clear();
+    }
+    size_t getVariantCount() const { return variants.size(); }
+
+private:
+    std::string baseName;
+    std::string baseVertexSource, baseFragmentSource;
+    DefineBuilder defineBuilder;
+    LinkedCallback linkedCallback;
+    std::unordered_map<uint32_t, Variant> variants;
+};
@@ -2,7 +2,24 @@
 
 #include <GL/glew.h>
 #include <glm/glm.hpp>
+#include <string>
 #include "Enums.hpp"
+#include "GpuTimer.hpp"
+#include "NoiseTexture.hpp"
+#include "Atmosphere.hpp"
+#include "ShaderRegistry.hpp"
+
+// How the clouds are rendered. All but FULL evaluate the cloud noise into a smaller offscreen target that is
+// upsampled onto the screen; the checkerboard modes evaluate only half of that target each frame and fill the
+// other half from the previous frame, moved along by the cloud drift.
+enum class CloudQuality {
+    FULL,
+    HALF,
+    QUARTER,
+    HALF_CHECKERBOARD,
+    QUARTER_CHECKERBOARD,
+    COUNT
+};
 
 class Sky {
 public:
@@ -10,19 +27,53 @@ public:
     ~Sky();
 
     bool initialize();
-    void render(TimeOfDay timeOfDay, float transitionProgress);
-    void renderClouds(TimeOfDay timeOfDay, float transitionProgress, float totalTime);
+    // Shades the sky from the atmosphere's scattering tables for the sun at sunElevation (radians) and
+    // sunProgress (0 at sunrise on the left to 1 at sunset on the right), fading to the night gradient below
+    // Both draw without depth test or depth writes and leave them off; the next render stage sets what it needs
+    void render(TimeOfDay timeOfDay, const Atmosphere& atmosphere, float sunElevation, float sunProgress);
+    void renderClouds(TimeOfDay timeOfDay, float totalTime);
     void cleanup();
 
     float getSunMoonPosition() const { return sunMoonPosition; }
 
+    void setCloudQuality(CloudQuality quality) { cloudQuality = quality; }
+    CloudQuality getCloudQuality() const { return cloudQuality; }
+    // Smoothed GPU time of the whole cloud pass, as last measured while the quality was in use
+    float getCloudMilliseconds(CloudQuality quality) const { return cloudTimers[static_cast<int>(quality)].getMilliseconds(); }
+    const NoiseTextureStats& getCloudNoiseStats() const { return cloudNoise.getStats(); }
+    static const char* getCloudQualityName(CloudQuality quality);
+
 private:
+    // Handles of the per-frame uniforms; the constant ones are set once after linking
+    struct SkyUniforms {
+        ShaderUniform<float> sunElevation;
+        ShaderUniform<float> sunAzimuth;
+        ShaderUniform<float> nightAmount;
+        ShaderUniform<float> aspectRatio;
+    };
+    struct CloudUniforms {
+        ShaderUniform<float> time;
+        ShaderUniform<float> aspectRatio;
+    };
+    struct CloudDensityUniforms {
+        ShaderUniform<float> time;
+        ShaderUniform<float> aspectRatio;
+        ShaderUniform<glm::vec2> targetSize;
+        ShaderUniform<bool> checkerboard;
+        ShaderUniform<int> parity;
+    };
+    struct CloudResolveUniforms {
+        ShaderUniform<glm::vec2> targetSize;
+        ShaderUniform<int> parity;
+        ShaderUniform<glm::vec2> drift;
+        ShaderUniform<bool> historyValid;
+    };
+    struct CloudCompositeUniforms {}; // only constant ones
+
     GLuint skyShader;
+    SkyUniforms skyUniforms;
     GLuint skyVAO, skyVBO, skyEBO;
-    glm::vec3 skyColorTop;
-    glm::vec3 skyColorBottom;
-    glm::vec3 targetSkyColorTop;
-    glm::vec3 targetSkyColorBottom;
+    GLuint rayleighTexture, mieTexture; // the atmosphere's scattering tables, uploaded on first use
     float skyTransitionTime;
     float skyTransitionDuration;
     bool skyTransitioning;
@@ -30,14 +81,36 @@ private:
     TimeOfDay targetTimeOfDay;
     float sunMoonPosition;
     float targetSunMoonPosition;
-    float transitionProgress;
     float aspectRatio;
     bool immediateFadeFromNight;
 
     // Cloud rendering
-    GLuint cloudShader;
+    // Variants by cloud shading key, shared with the composite shader below
+    ShaderPermutations<CloudUniforms> cloudShaders;
     GLuint cloudVAO, cloudVBO, cloudEBO;
+    NoiseTexture cloudNoise; // baked once and kept across scene switches
+
+    // Reduced-resolution clouds: cloud cover in one channel, written by the density shader (or, checkerboarded,
+    // by the resolve shader from the fresh half and last frame's target) and drawn by the composite shader
+    CloudQuality cloudQuality;
+    GLuint cloudDensityShader, cloudResolveShader;
+    CloudDensityUniforms cloudDensityUniforms;
+    CloudResolveUniforms cloudResolveUniforms;
+    ShaderPermutations<CloudCompositeUniforms> cloudCompositeShaders;
+    GLuint cloudFramebuffers[2], cloudTextures[2]; // this frame's and last frame's cover, swapped every frame
+    GLuint cloudFreshFramebuffer, cloudFreshTexture; // checkerboard: this frame's half, two target pixels per texel
+    int cloudTargetWidth, cloudTargetHeight;
+    int cloudCurrent;
+    bool cloudHistoryValid;
+    float cloudHistoryTime;
+    unsigned int cloudFrame;
+    GpuTimer cloudTimers[static_cast<int>(CloudQuality::COUNT)];
 
     bool initializeClouds();
+    bool createCloudTargets(int width, int height);
+    void destroyCloudTargets();
+    void renderReducedClouds(TimeOfDay timeOfDay, float totalTime);
+    GLuint linkCloudProgram(const std::string& fragmentSource, const std::string& name, ShaderRegistry::LinkedCallback onLinked);
     bool initializeSky();
+    void uploadAtmosphere(const Atmosphere& atmosphere);
 };
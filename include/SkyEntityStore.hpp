@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+enum class SkyEntityKind : uint8_t {
+    PLANET,    // distant planets, fixed in the sky
+    SATELLITE, // satellites and single spacecraft crossing the sky
+    STARLINK,  // ships of a Starlink train or fleet, grouped under the leader
+    SHIP,      // alien ships with exhaust trails
+    COUNT
+};
+
+// Stays valid while its entity lives; a destroyed entity's slot is reused with a new generation
+struct SkyEntityHandle {
+    uint32_t slot = 0xFFFFFFFFu;
+    uint32_t generation = 0;
+};
+
+// A new entity; the fields from label on are cold and only read when spawning, despawning and labelling
+struct SkyEntityDesc {
+    SkyEntityKind kind = SkyEntityKind::PLANET;
+    glm::vec2 position = glm::vec2(0.0f);
+    glm::vec2 velocity = glm::vec2(0.0f); // normalized screen units per second
+    float brightness = 1.0f;
+    float size = 2.0f;
+    glm::vec3 color = glm::vec3(1.0f);
+    uint32_t label = 0xFFFFFFFFu;         // in the store's label table; labelled when set
+    glm::vec3 labelColor = glm::vec3(1.0f);
+    uint32_t reference = 0xFFFFFFFFu;     // spacecraft ID for satellites
+    uint32_t trail = 0xFFFFFFFFu;         // in ExhaustTrails
+    bool stress = false;                  // spawned by the stress sky or the stress ships
+    SkyEntityHandle group;                // leader of the group, destroyed last; none makes the entity its own leader
+};
+
+struct SkyEntityStats {
+    size_t entities = 0;
+    size_t kinds[static_cast<size_t>(SkyEntityKind::COUNT)] = {};
+    size_t departed = 0;             // in the last update
+    float updateMilliseconds = 0.0f; // moving every entity and finding the departed ones
+    float vertexMilliseconds = 0.0f; // writing the point vertices
+};
+
+// Every moving or labelled object of the distant sky, in one structure-of-arrays store.
+// Fields are split by how often they are touched: positions and velocities every update, brightness, size and
+// color every render, and kind, group, label, label color, reference and trail only when something spawns,
+// departs or is labelled. Label texts are interned once in a table of their own, so spawning copies no strings. Entities are packed densely and removed by swap with the last one; handles go through
+// a slot table, so they stay valid while other entities come and go. Dense indices do not.
+class SkyEntityStore {
+public:
+    static constexpr uint32_t NO_REFERENCE = 0xFFFFFFFFu;
+    static constexpr uint32_t NO_LABEL = 0xFFFFFFFFu;
+
+    // Index of text in the label table, added on first use. The table outlives clear(); it only holds the
+    // distinct names of planets and groups, so it stays small.
+    uint32_t internLabel(const std::string& text);
+    const std::string& getLabelText(uint32_t label) const { return labelTexts[label]; }
+
+    SkyEntityHandle create(const SkyEntityDesc& desc);
+    void destroy(SkyEntityHandle handle);
+    bool isAlive(SkyEntityHandle handle) const;
+    void clear();
+
+    size_t size() const { return positions.size(); }
+    // Dense index of a live entity, valid until the next destroy
+    uint32_t indexOf(SkyEntityHandle handle) const { return slotIndices[handle.slot]; }
+    SkyEntityHandle handleAt(uint32_t index) const { return { indexSlots[index], slotGenerations[indexSlots[index]] }; }
+
+    const glm::vec2& getPosition(uint32_t index) const { return positions[index]; }
+    const glm::vec2& getVelocity(uint32_t index) const { return velocities[index]; }
+    // Position of the entity's group leader, its own when it leads
+    const glm::vec2& getGroupPosition(uint32_t index) const { return positions[slotIndices[groups[index]]]; }
+    void setMotion(uint32_t index, const glm::vec2& position, const glm::vec2& velocity);
+    SkyEntityKind getKind(uint32_t index) const { return kinds[index]; }
+    // Slot of the group's leader, the entity's own slot when it leads or has no group
+    uint32_t getGroup(uint32_t index) const { return groups[index]; }
+    uint32_t getLabel(uint32_t index) const { return labels[index]; }
+    const glm::vec3& getLabelColor(uint32_t index) const { return labelColors[index]; }
+    uint32_t getReference(uint32_t index) const { return references[index]; }
+    uint32_t getTrail(uint32_t index) const { return trails[index]; }
+    void setTrail(uint32_t index, uint32_t trail) { trails[index] = trail; }
+    bool isStress(uint32_t index) const { return stress[index] != 0; }
+
+    // Moves every entity and collects the moving ones whose whole group has left the screen
+    void update(float dt, std::vector<SkyEntityHandle>& departed);
+    // Appends position, brightness, size and color as the star shader's point vertices
+    void appendPointVertices(std::vector<float>& vertices, bool withPlanets);
+    const SkyEntityStats& getStats() const { return stats; }
+
+private:
+    // Hot: every update
+    std::vector<glm::vec2> positions;
+    std::vector<glm::vec2> velocities;
+    // Warm: every render
+    std::vector<float> brightnesses;
+    std::vector<float> sizes;
+    std::vector<glm::vec3> colors;
+    // Cold
+    std::vector<SkyEntityKind> kinds;
+    std::vector<uint32_t> groups;
+    std::vector<uint32_t> labels;
+    std::vector<glm::vec3> labelColors;
+    std::vector<uint32_t> references;
+    std::vector<uint32_t> trails;
+    std::vector<uint8_t> stress;
+
+    // Slot table: dense index and generation per slot, and the slot of every dense index
+    std::vector<uint32_t> slotIndices;
+    std::vector<uint32_t> slotGenerations;
+    std::vector<uint32_t> freeSlots;
+    std::vector<uint32_t> indexSlots;
+
+    std::vector<std::string> labelTexts;
+    std::unordered_map<std::string, uint32_t> labelIds;
+
+    std::vector<uint8_t> groupOnScreen; // per slot, scratch for update
+    SkyEntityStats stats;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Spacecraft that cross the sky on scripted paths, loaded once from one group ("earth" or "alien") of a JSON file.
+// Entries are addressed by dense integer IDs and kept as structure-of-arrays; names are interned at load time so
+// nothing compares strings after that. Cooldowns are a dense array of times, and the spacecraft that may spawn
+// are kept in an unordered set with O(1) removal, so acquiring and releasing never allocates.
+class SpacecraftCatalog {
+public:
+    static constexpr uint32_t INVALID_ID = 0xFFFFFFFFu;
+
+    bool load(const std::string& path, const std::string& group);
+    bool isLoaded() const { return !names.empty(); }
+    size_t getCount() const { return names.size(); }
+    uint32_t findId(const std::string& name) const;
+
+    const std::string& getName(uint32_t id) const { return names[id]; }
+    float getSpeed(uint32_t id) const { return speeds[id]; }
+    float getInclination(uint32_t id) const { return inclinations[id]; }
+    const glm::vec3& getTextColor(uint32_t id) const { return textColors[id]; }
+    float getSize(uint32_t id) const { return sizes[id]; }
+    float getBrightness(uint32_t id) const { return brightnesses[id]; }
+    bool isFlagship(uint32_t id) const { return flagships[id] != 0; } // the ISS and the Bird-of-Prey
+
+    // Makes every spacecraft available again, for a new sky
+    void reset();
+    // Picks a random spacecraft that is neither on screen nor cooling down, or returns INVALID_ID
+    uint32_t acquire(float now, std::mt19937& rng);
+    // The spacecraft left the screen; it may spawn again once its cooldown, counted from its spawn, has passed
+    void release(uint32_t id);
+    size_t getAvailableCount() const { return available.size(); }
+
+private:
+    static constexpr uint32_t ON_SCREEN = 0xFFFFFFFFu;
+    static constexpr uint32_t COOLING = 0xFFFFFFFEu;
+
+    struct Cooling {
+        float readyTime;
+        uint32_t id;
+        bool operator<(const Cooling& other) const { return readyTime > other.readyTime; } // min-heap on readyTime
+    };
+
+    std::vector<std::string> names;
+    std::vector<float> speeds;       // normalized screen widths per second
+    std::vector<float> inclinations; // degrees, sets the climb of the path
+    std::vector<glm::vec3> textColors;
+    std::vector<float> sizes;
+    std::vector<float> brightnesses;
+    std::vector<float> cooldowns;    // seconds between spawns of the same spacecraft
+    std::vector<char> flagships;
+    std::unordered_map<std::string, uint32_t> ids;
+
+    std::vector<float> readyTimes;         // dense: when each spacecraft may spawn again
+    std::vector<uint32_t> available;       // spacecraft that may spawn, in no particular order
+    std::vector<uint32_t> availableSlots;  // position of each spacecraft in available, or ON_SCREEN / COOLING
+    std::vector<Cooling> cooling;          // released spacecraft waiting for their cooldown, as a heap
+
+    void makeAvailable(uint32_t id);
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Where, when and in which direction the real sky is seen from
+struct SkyObserver {
+    float latitude = 53.5f;         // degrees, north positive (Edmonton, Alberta)
+    float longitude = -113.5f;      // degrees, east positive
+    double julianDate = 2460676.5;  // 2025-01-01 00:00 UTC
+    float viewAzimuth = 0.0f;       // degrees from north through east at the center of the screen
+    float verticalFov = 60.0f;      // degrees of altitude between the horizon line and the top of the screen
+};
+
+// Maps directions in the observer's horizon frame to normalized sky coordinates: altitude linearly from the horizon
+// line to the top of the screen, and the angle around the view azimuth at the same angular scale
+struct SkyProjection {
+    float horizonY;
+    float verticalFov;   // radians
+    float horizontalFov; // radians
+    float cosHalfHorizontal;
+    float sinAzimuth, cosAzimuth;
+
+    SkyProjection(const SkyObserver& observer, float horizonY, float aspectRatio);
+
+    // Directions relative to the view (forward is the screen center); false if below the horizon or off screen
+    bool viewToScreen(float forward, float right, float up, glm::vec2& position) const;
+    bool horizonToScreen(float east, float north, float up, glm::vec2& position) const {
+        return viewToScreen(north * cosAzimuth + east * sinAzimuth, east * cosAzimuth - north * sinAzimuth, up, position);
+    }
+
+    // Greenwich mean sidereal time in radians
+    static double greenwichSiderealTime(double julianDate);
+};
+
+struct ProjectedStar {
+    glm::vec2 position; // normalized sky coordinates, like the hand-placed patterns
+    float magnitude;
+    uint32_t color;     // RGBA8
+};
+
+struct StarCatalogStats {
+    size_t processed = 0; // stars at or brighter than the limiting magnitude
+    size_t visible = 0;   // of those, above the horizon and on screen
+    float limitingMagnitude = 0.0f;
+    float milliseconds = 0.0f;
+};
+
+// Star catalog memory-mapped from a compact binary file for the real-sky mode of the Earth scenes.
+// The file is a FileHeader followed by count floats each of x, y and z (J2000 equatorial unit vectors) and magnitude,
+// then count RGBA8 colors, all sorted by magnitude with the brightest star first. The sort lets a limiting magnitude
+// cut the per-frame work down to a prefix of the arrays, and the unit vectors turn RA/Dec to alt/az into one
+// rotation of structure-of-arrays data instead of per-star trigonometry.
+class StarCatalog {
+public:
+    StarCatalog();
+    ~StarCatalog();
+
+    // Maps binaryPath; if it does not exist yet, it is first converted from the HYG database CSV at csvPath
+    bool load(const std::string& binaryPath, const std::string& csvPath);
+    void unload();
+    bool isLoaded() const { return mapping != nullptr; }
+    size_t getCount() const { return count; }
+
+    // Appends the stars no fainter than limitingMagnitude that are above the horizon and on screen
+    void project(const SkyObserver& observer, const SkyProjection& projection, float limitingMagnitude,
+        std::vector<ProjectedStar>& output);
+    const StarCatalogStats& getStats() const { return stats; }
+
+    static bool convertHygCsv(const std::string& csvPath, const std::string& binaryPath);
+
+private:
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t count;
+        uint32_t reserved;
+    };
+    static const uint32_t FILE_VERSION = 1;
+    static const int BLOCK_SIZE = 256;
+
+    void* mapping;
+    size_t mappingSize;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+    size_t count;
+    const float* x;
+    const float* y;
+    const float* z;
+    const float* magnitudes;
+    const uint32_t* colors;
+    StarCatalogStats stats;
+};
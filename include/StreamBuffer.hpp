@@ -0,0 +1,77 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <vector>
+
+struct StreamBufferStats {
+    size_t bytes = 0;          // streamed in the last frame
+    int allocations = 0;       // in the last frame
+    size_t regionBytes = 0;    // available to each frame
+    bool persistent = false;   // mapped once for good (ARB_buffer_storage) rather than mapped per upload
+    int waits = 0;             // frames that had to wait for the GPU to release their region, since startup
+    int orphans = 0;           // times the storage was orphaned instead, without persistent mapping
+    int resizes = 0;           // since startup
+    float waitMilliseconds = 0.0f; // spent in those waits
+};
+
+// One buffer for all vertex and uniform data that is rebuilt every frame, split into a region per frame in
+// flight. Uploads are placed one after another in the current frame's region, and a fence set at the end of
+// the frame keeps the region from being written again until the GPU has drawn from it, FRAMES frames later.
+// So nothing uploaded here waits for a draw that still reads the buffer, as glBufferSubData into a buffer in
+// use may. Where ARB_buffer_storage is present the buffer is mapped persistently and an upload is a memcpy;
+// otherwise each upload maps its range unsynchronized, and if the GPU is still on the region when its turn
+// comes round the whole buffer is orphaned rather than waited for.
+//
+// The buffer may be replaced by a larger one when a frame outgrows its region, so users bind getBuffer() and
+// point their attributes at the returned offset for every draw instead of keeping them in a vertex array.
+// The old buffer is kept, still bound wherever it was, until the GPU has finished the frames that used it.
+class StreamBuffer {
+public:
+    static constexpr int FRAMES = 3;
+    static constexpr size_t INITIAL_REGION_BYTES = 1 << 20;
+
+    static StreamBuffer& shared();
+
+    // Starts the next frame's region, first making sure the GPU is done with it
+    void beginFrame();
+    // Fences the frame's region once everything drawn from it has been issued
+    void endFrame();
+
+    // Copies bytes into the current frame's region at a multiple of alignment and returns the offset into
+    // getBuffer() where they went
+    GLintptr upload(const void* data, size_t bytes, size_t alignment = 16);
+    GLuint getBuffer() const { return buffer; }
+
+    const StreamBufferStats& getStats() const { return stats; }
+    // Deletes the buffer and its fences; needs the GL context still current
+    void cleanup();
+
+private:
+    GLuint buffer;
+    unsigned char* mapped; // whole buffer, when persistently mapped
+    size_t regionBytes;
+    int region;            // of the current frame
+    size_t regionUsed;
+    GLsync fences[FRAMES];
+    // Buffers replaced by a larger one, each deleted once the fence of the frame that replaced it has signalled
+    struct RetiredBuffer {
+        GLuint buffer;
+        GLsync fence; // null until that frame ends
+    };
+    std::vector<RetiredBuffer> retired;
+    StreamBufferStats frameStats; // being counted
+    StreamBufferStats stats;
+
+    StreamBuffer();
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    void create(size_t bytesPerRegion);
+    void destroy();
+    void unmap();
+    // Moves the buffer to retired instead of deleting it; create() makes the next one
+    void retire();
+    void deleteFences();
+    void deleteRetired(bool all);
+};
@@ -4,6 +4,28 @@
 #include <noise/noise.h>
 #include <glm/glm.hpp>
 #include <GL/glew.h>
+#include "TerrainSimplifier.hpp"
+#include "ShaderRegistry.hpp"
+
+// A square block of grid cells whose triangles are contiguous in the index buffer of the mesh being drawn
+struct TerrainChunk {
+    GLsizei indexOffset;
+    GLsizei indexCount;
+    glm::vec3 boundsMin; // terrain-local space
+    glm::vec3 boundsMax;
+};
+
+// Uniforms of the terrain shader that Terrain sets itself, resolved by whoever links the shader
+struct TerrainUniforms {
+    ShaderUniform<bool> useDetailMap;
+    ShaderUniform<glm::vec2> detailScale;
+    ShaderUniform<glm::vec2> detailOffset;
+    ShaderUniform<glm::vec3> lowColor;
+    ShaderUniform<glm::vec3> highColor;
+    ShaderUniform<int> detailMap;
+
+    void resolve(GLuint shader);
+};
 
 class Terrain {
 public:
@@ -11,12 +33,43 @@ public:
     ~Terrain();
 
     void generate(noise::module::Perlin& perlin, float baseHeight, float minHeight, float maxHeight, const glm::vec3& lowColor, const glm::vec3& highColor, const std::vector<float>* heightmap);
-    void render(GLuint shader);
+    void render(GLuint shader, const TerrainUniforms& uniforms);
+    // Draws only the chunks flagged in visibleChunks (one entry per getChunks() element), merging adjacent runs
+    void renderChunks(GLuint shader, const TerrainUniforms& uniforms, const std::vector<char>& visibleChunks);
     std::vector<float> getHeightmap(int resolution) const;
     void deform(float x, float radius, float intensity, bool addTerrain);
 
+    // Detail normal mapping: render a mesh that is meshStride times coarser in X and Z and recover
+    // the full-resolution shading from a baked normal/height texture in the fragment shader
+    void setDetailNormalMapping(bool enabled, int stride);
+    bool isDetailNormalMapping() const { return useDetailNormalMapping; }
+    int getMeshStride() const { return meshStride; }
+    size_t getRenderedVertexCount() const;
+    size_t getRenderedTriangleCount() const;
+
+    // Uploads a mesh produced by TerrainSimplifier for the current heights; dropped again on generate() or deform()
+    void setSimplifiedMesh(const SimplifiedTerrainMesh& mesh);
+    void setUseSimplifiedMesh(bool use) { useSimplifiedMesh = use; }
+    bool hasSimplifiedMesh() const { return simplifiedVao != 0; }
+    bool isUsingSimplifiedMesh() const { return useSimplifiedMesh && simplifiedVao != 0; }
+
+    // Chunks of the mesh render() would draw; empty for the coarse detail-mapped mesh, which is not chunked
+    const std::vector<TerrainChunk>& getChunks() const;
+
+    // Conservative silhouette for occlusion culling: every getOccluderStep()-th row of the drawn mesh, reduced to the
+    // minimum height over spans of getOccluderStep() columns (inclusive of both span ends). Stored row-major.
+    int getOccluderStep() const { return occluderStep; }
+    int getOccluderSpanCount() const { return occluderSpanCount; }
+    const std::vector<float>& getOccluderHeights() const { return occluderHeights; }
+
+    static constexpr int CHUNK_SIZE = 64; // cells per chunk side, shared with TerrainSimplifier tiles
+
     int getWidth() const { return width; }
     int getDepth() const { return depth; }
+    const std::vector<float>& getHeights() const { return heights; }
+    const std::vector<float>& getNormals() const { return normals; }
+    float getColorMinHeight() const { return colorMinHeight; }
+    float getColorHeightRange() const { return colorHeightRange; }
     const std::vector<float>& getVertices() const { return vertices; }
     const std::vector<unsigned int>& getIndices() const { return indices; }
     glm::vec3& getLowColor() { return lowColor; }
@@ -35,8 +88,34 @@ private:
     GLuint vao, vbo, ebo;
     glm::vec3 lowColor;
     glm::vec3 highColor;
+    float colorMinHeight;
+    float colorHeightRange;
+
+    bool useDetailNormalMapping;
+    int meshStride;
+    GLuint coarseVao, coarseVbo, coarseEbo;
+    GLsizei coarseIndexCount;
+    size_t coarseVertexCount;
+    GLuint detailTexture;
+
+    bool useSimplifiedMesh;
+    GLuint simplifiedVao, simplifiedVbo, simplifiedEbo;
+    GLsizei simplifiedIndexCount;
+    size_t simplifiedVertexCount;
+
+    std::vector<TerrainChunk> chunks;
+    std::vector<TerrainChunk> simplifiedChunks;
+    int occluderStep;
+    int occluderSpanCount;
+    std::vector<float> occluderHeights;
 
     void computeNormals();
     void setupMesh();
+    void setupCoarseMesh();
+    void setupDetailTexture();
+    void cleanupDetailResources();
+    void cleanupSimplifiedMesh();
+    void computeChunkBounds(std::vector<TerrainChunk>& target) const;
+    void buildOccluderProfile();
     void cleanup();
 };
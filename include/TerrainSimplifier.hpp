@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+struct TerrainSimplificationStats {
+    size_t sourceTriangles = 0;
+    size_t simplifiedTriangles = 0;
+    size_t simplifiedVertices = 0;
+    float buildMilliseconds = 0.0f;
+    unsigned int threadCount = 0;
+};
+
+struct SimplifiedTerrainMesh {
+    std::vector<unsigned int> gridIndices; // full-resolution grid vertex (x + z * width) behind each output vertex
+    std::vector<unsigned int> indices;     // triangle list indexing into gridIndices
+    std::vector<unsigned int> tileIndexOffsets; // start of each tile's triangles in indices (row-major tiles, plus end)
+    TerrainSimplificationStats stats;
+};
+
+// Top-down RTIN (right-triangulated irregular network) simplification of a terrain heightfield.
+// The grid is cut into power-of-two tiles that are refined in parallel on the shared ThreadPool.
+// Errors on shared tile edges are reconciled before extraction, so neighbouring tiles always split
+// the same edges and the resulting mesh is crack-free.
+class TerrainSimplifier {
+public:
+    // rowErrorScale converts a height error on each grid row into the unit maxError is given in
+    // (e.g. pixels per world unit for a given camera). An empty vector compares raw height errors.
+    static SimplifiedTerrainMesh simplify(const std::vector<float>& heights, int width, int depth,
+        const std::vector<float>& rowErrorScale, float maxError, int tileSize = 64);
+};
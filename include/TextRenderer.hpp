@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include "ShaderRegistry.hpp"
+
+// Uniforms of the text shader, which TextRenderer and HotkeyBar both draw with; resolved by whoever links it
+struct TextUniforms {
+    ShaderUniform<glm::mat4> projection;
+    ShaderUniform<int> text;
+
+    void resolve(GLuint shader);
+};
+
+struct TextRendererStats {
+    size_t strings = 0;      // queued this frame
+    size_t glyphs = 0;       // drawn this frame
+    size_t uploadBytes = 0;  // this frame
+    int drawCalls = 0;       // this frame, one per flushed layer
+    int textureUploads = 0;  // glyphs added to the atlas this frame; zero once every glyph in use is cached
+    size_t atlasGlyphs = 0;
+    float milliseconds = 0.0f; // CPU time this frame to lay out and upload
+};
+
+// Text from TTF fonts through one glyph atlas shared by every font.
+// Each glyph is rasterized once, with the same hard-edged Solid rendering the labels always had, into a
+// single-channel atlas texture; printable ASCII is packed up front and other characters on first use.
+// Strings are laid out into quads of one vertex buffer, each vertex with its own color, and render() draws
+// everything queued since the last render() with one call. No texture is created after the atlas.
+class TextRenderer {
+public:
+    static constexpr int ATLAS_SIZE = 1024;
+
+    TextRenderer();
+    ~TextRenderer();
+
+    // Returns the font's index for the other calls, or -1 if the atlas could not be created
+    int addFont(TTF_Font* font);
+    // Width in pixels at scale 1, as the glyphs are laid out
+    float measure(int font, const std::string& text);
+    // Height of the glyph cells in pixels at scale 1, the same for every glyph of a font
+    float getLineHeight(int font) const;
+    // Appends the glyph quads of text as (x, y, u, v), six vertices per drawn glyph, for retained geometry
+    void layout(int font, const std::string& text, float x, float y, float scale, std::vector<glm::vec4>& out);
+    // Queues text with its bottom-left corner, or bottom center when centered, at (x, y) in window pixels
+    void add(int font, const std::string& text, float x, float y, float scale, const glm::vec3& color, bool centered = false);
+
+    // The shader takes aPos, aTexCoords and aColor at locations 0 to 2, and "projection" and "text" uniforms
+    void render(GLuint shader, const TextUniforms& uniforms, const glm::mat4& projection);
+    // Starts this frame's stats
+    void newFrame();
+    const TextRendererStats& getStats() const { return stats; }
+    GLuint getAtlasTexture() const { return atlasTexture; }
+
+private:
+    struct Glyph {
+        glm::vec2 uvMin, uvMax;
+        float width, height; // of the glyph cell, in pixels
+        float advance;
+        bool valid;
+    };
+
+    struct TextVertex {
+        glm::vec2 position;
+        glm::vec2 texCoords;
+        uint32_t color; // RGBA8
+    };
+
+    std::vector<TTF_Font*> fonts;
+    std::vector<std::vector<Glyph>> asciiGlyphs; // per font, characters 32 to 126
+    std::unordered_map<uint64_t, Glyph> otherGlyphs; // (font << 32) | codepoint
+
+    // Shelf packing: glyphs fill rows left to right, and a new row starts above the tallest glyph of the last one
+    int shelfX, shelfY, shelfHeight;
+    std::vector<uint8_t> rasterScratch;
+
+    std::vector<TextVertex> vertices; // queued since the last render
+    std::vector<glm::vec4> quadScratch;
+    GLuint atlasTexture, vao; // attributes point into StreamBuffer
+    TextRendererStats stats;
+
+    const Glyph& getGlyph(int font, uint32_t codepoint);
+    Glyph rasterize(int font, uint32_t codepoint);
+};
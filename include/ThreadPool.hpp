@@ -0,0 +1,48 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for CPU-heavy generation work (terrain simplification, etc.).
+// Nothing here touches OpenGL; results are handed back to the main thread for upload.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned int threadCount);
+    ~ThreadPool();
+
+    // Process-wide pool sized to the hardware, created on first use
+    static ThreadPool& shared();
+
+    // Runs task on a worker and returns a future for its result
+    template<typename F>
+    auto submit(F&& task) -> std::future<decltype(task())> {
+        using Result = decltype(task());
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+        enqueue([packaged]() { (*packaged)(); });
+        return result;
+    }
+
+    // Splits [0, count) into chunks of chunkSize and calls body(begin, end, chunkIndex) for each.
+    // The calling thread works on chunks too, so this is safe to call from inside a worker task.
+    // Blocks until every chunk has finished.
+    void parallelFor(int count, int chunkSize, const std::function<void(int, int, int)>& body);
+
+    unsigned int getThreadCount() const { return static_cast<unsigned int>(workers.size()); }
+
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping;
+
+    void enqueue(std::function<void()> task);
+    void workerLoop();
+};
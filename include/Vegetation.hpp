@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+#include "Enums.hpp"
+#include "Terrain.hpp"
+#include "ShaderRegistry.hpp"
+
+struct VegetationInstance {
+    glm::vec4 positionScale; // terrain-local base position, uniform scale
+    glm::vec4 params;        // rotation (radians), brightness, unused, unused
+};
+
+struct VegetationStats {
+    size_t instanceCount[static_cast<int>(VegetationType::COUNT)] = {};
+    size_t meshInstancesDrawn = 0;
+    size_t billboardInstancesDrawn = 0;
+    int visibleChunks = 0;
+    int totalChunks = 0;
+    int drawCalls = 0;
+    size_t candidateCount = 0;
+    float samplingMilliseconds = 0.0f;
+    float placementMilliseconds = 0.0f;
+    int updatedChunks = 0; // chunks re-placed by the last generate() or updateRegion()
+};
+
+// Uniforms of the vegetation shader that Vegetation sets per plant type, resolved by whoever links the shader
+struct VegetationUniforms {
+    ShaderUniform<glm::vec3> primaryColor;
+    ShaderUniform<glm::vec3> secondaryColor;
+    ShaderUniform<int> shape;
+    ShaderUniform<bool> billboard;
+
+    void resolve(GLuint shader);
+};
+
+// Trees, grass and rocks scattered on the bottom terrain.
+// Candidate positions come from a Poisson-disk sampler and only depend on the terrain footprint, so they are kept
+// across regenerations; height and slope only decide which candidates are used. Placement runs per terrain chunk
+// on the ThreadPool, and a deformation only re-places the chunks it touched.
+// Each type is one instance buffer ordered by chunk. Rendering culls whole chunks against the view frustum and picks
+// a full mesh, a camera-facing billboard or nothing by chunk distance, merging neighbouring chunks into one draw.
+class Vegetation {
+public:
+    Vegetation();
+    ~Vegetation();
+
+    void generate(const Terrain& terrain, Scene newScene);
+    // Re-places the chunks overlapping terrain-local x in [xMin, xMax] after the terrain changed there
+    void updateRegion(const Terrain& terrain, float xMin, float xMax);
+    void setDensity(const Terrain& terrain, float newDensity);
+    float getDensity() const { return density; }
+
+    // Shader uniforms other than the per-type colors and LOD flags are set by the caller
+    void render(GLuint shader, const VegetationUniforms& uniforms, const glm::mat4& model, const glm::mat4& viewProjection, const glm::vec3& cameraPos);
+
+    const VegetationStats& getStats() const { return stats; }
+    size_t getInstanceCount() const;
+
+private:
+    static const int TYPE_COUNT = static_cast<int>(VegetationType::COUNT);
+
+    enum class Lod {
+        MESH,
+        BILLBOARD,
+        HIDDEN
+    };
+
+    struct TypeData {
+        std::vector<glm::vec2> candidates;          // terrain-local x/z, grouped by chunk
+        std::vector<int> chunkCandidateOffsets;     // chunkCount + 1 entries into candidates
+        std::vector<std::vector<VegetationInstance>> chunkInstances;
+        std::vector<GLsizei> chunkInstanceOffsets;  // chunkCount + 1 entries into the instance buffer
+        std::vector<Lod> chunkLods;                 // per frame
+        GLuint meshVao, billboardVao, meshVbo, instanceVbo;
+        GLsizei meshVertexCount;
+    };
+
+    TypeData types[TYPE_COUNT];
+    GLuint billboardVbo;
+    std::vector<glm::vec3> chunkBoundsMin; // terrain-local, covering every placed instance of the chunk
+    std::vector<glm::vec3> chunkBoundsMax;
+    std::vector<char> chunkVisible;
+    int chunksX, chunksZ;
+    int sampledWidth, sampledDepth;
+    uint32_t placementSeed;
+    Scene scene;
+    float density;
+    VegetationStats stats;
+
+    void sampleCandidates(const Terrain& terrain);
+    void placeChunks(const Terrain& terrain, const std::vector<int>& chunkList);
+    void placeChunk(const Terrain& terrain, int chunk);
+    void uploadInstances();
+    void setupMeshes();
+    void bindInstanceAttributes(TypeData& data, GLsizei firstInstance);
+    void cleanup();
+};
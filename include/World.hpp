@@ -2,12 +2,17 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <future>
 #include <memory>
 #include <vector>
 #include "box2d/box2d.h"
 #include "Terrain.hpp"
+#include "BackgroundLayers.hpp"
+#include "Vegetation.hpp"
 #include "Enums.hpp"
 #include "CelestialObjectManager.hpp"
+#include "Atmosphere.hpp"
 
 // this struct should be moved into the appropriate class
 struct NoiseParameters {
@@ -35,6 +40,7 @@ public:
 
     bool initialize();
     void update(float dt);
+    // Moves the clock to the band's time of day; with the day cycle enabled the clock carries on from there
     void setTimeOfDay(TimeOfDay newTime);
 
     Scene getScene() const { return scene; }
@@ -44,16 +50,41 @@ public:
     bool isImmediateFadeFromNight() const { return immediateFadeFromNight; }
     float getTotalTime() const { return totalTime; }
     glm::vec3 getLightColor() const { return lightColor; }
+    const Atmosphere& getAtmosphere() const { return atmosphere; }
+    // Continuous time of day in [0, 1): 0 is midnight, 0.25 sunrise, 0.5 noon and 0.75 sunset
+    float getDayTime() const { return dayTime; }
+    void setDayTime(float time);
+    // Radians above the horizon, negative at night
+    float getSunElevation() const;
+    // 0 at sunrise to 1 at sunset, clamped at night
+    float getSunProgress() const;
+    void setDayCycleEnabled(bool enabled) { dayCycleEnabled = enabled; }
+    bool isDayCycleEnabled() const { return dayCycleEnabled; }
+    void setDayLength(float seconds) { dayLength = std::max(seconds, 1.0f); }
+    float getDayLength() const { return dayLength; }
     Terrain* getBottomTerrain() { return bottomTerrain.get(); }
     Terrain* getDistantTerrain() { return distantTerrain.get(); }
     DistantTerrainParameters& getDistantParams() { return distantParams; }
+    BackgroundLayers* getBackgroundLayers() { return backgroundLayers.get(); }
+    Vegetation* getVegetation() { return vegetation.get(); }
+    void setVegetationDensity(float density) { vegetation->setDensity(*bottomTerrain, density); }
+    // Raises or lowers the bottom terrain around terrain-local x and re-places the vegetation it touched
+    void deformBottomTerrain(float x, float radius, float intensity, bool addTerrain);
+    BackgroundLayerParameters& getBackgroundParams() { return backgroundParams; }
     NoiseParameters& getBottomNoiseParams() { return noiseParamsBottom; }
     NoiseParameters& getDistantNoiseParams() { return noiseParamsDistant; }
     void triggerRegeneration(TerrainGenerationMode mode);
     void resetBottomNoiseParameters();
     void resetDistantNoiseParameters();
     void resetDistantTerrainParams();
+    void resetBackgroundLayerParams();
+    void regenerateBackgroundLayers();
     void resetScene();
+    void setDistantSimplification(bool enabled, float maxPixelError);
+    bool isDistantSimplificationEnabled() const { return distantSimplificationEnabled; }
+    float getDistantMaxPixelError() const { return distantMaxPixelError; }
+    bool isDistantSimplificationPending() const { return distantSimplification.valid(); }
+    const TerrainSimplificationStats& getDistantSimplificationStats() const { return distantSimplificationStats; }
     CelestialObjectManager* getCelestialObjectManager() { return celestialObjectManager.get(); }
 
 private:
@@ -71,7 +102,12 @@ private:
     bool skyTransitioning;
     float transitionProgress;
     glm::vec3 lightColor;
-    glm::vec3 targetLightColor;
+    Atmosphere atmosphere;
+    float dayTime;
+    float transitionStartDayTime; // manual transitions ease the clock from here by transitionDayTimeDelta
+    float transitionDayTimeDelta;
+    bool dayCycleEnabled;
+    float dayLength; // seconds per day while the day cycle runs
     std::vector<std::string> sceneNames;
     Scene scene;
     glm::vec3 defaultSummerLowColor;
@@ -88,11 +124,26 @@ private:
     glm::vec3 terrainHighColor;
     std::unique_ptr<Terrain> bottomTerrain;
     std::unique_ptr<Terrain> distantTerrain;
+    std::unique_ptr<BackgroundLayers> backgroundLayers;
+    std::unique_ptr<Vegetation> vegetation;
     std::unique_ptr<CelestialObjectManager> celestialObjectManager;
     NoiseParameters noiseParamsBottom;
     NoiseParameters noiseParamsDistant;
     DistantTerrainParameters distantParams;
+    BackgroundLayerParameters backgroundParams;
 
+    // Distant terrain simplification runs on the ThreadPool; the result is uploaded on the main thread
+    std::future<SimplifiedTerrainMesh> distantSimplification;
+    bool distantSimplificationEnabled;
+    float distantMaxPixelError;
+    TerrainSimplificationStats distantSimplificationStats;
+
+    void beginTimeOfDayTransition(TimeOfDay newTime);
+    void updateLightColor();
     void initializeNoiseParameters();
     void setupPhysicsTerrain();
+    void generateBackgroundLayers(noise::module::Perlin& perlin);
+    void startDistantSimplification();
+    void pollDistantSimplification();
+    std::vector<float> computeDistantErrorScale() const;
 };
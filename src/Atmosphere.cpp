@@ -0,0 +1,250 @@
+#include "Atmosphere.hpp"
+#include "DataManager.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+// Scattering and absorption coefficients per kilometre at sea level, for red, green and blue
+static const glm::vec3 RAYLEIGH_SCATTERING(5.802e-3f, 13.558e-3f, 33.1e-3f);
+static const float RAYLEIGH_SCALE_HEIGHT = 8.0f;
+static const float MIE_SCATTERING = 3.996e-3f;
+static const float MIE_EXTINCTION = 4.40e-3f;
+static const float MIE_SCALE_HEIGHT = 1.2f;
+static const glm::vec3 OZONE_ABSORPTION(0.650e-3f, 1.881e-3f, 0.085e-3f);
+static const float HALF_PI = 1.5707964f;
+static const float PI = 3.1415927f;
+
+static float rayleighDensity(float altitude) {
+    return std::exp(-altitude / RAYLEIGH_SCALE_HEIGHT);
+}
+
+static float mieDensity(float altitude) {
+    return std::exp(-altitude / MIE_SCALE_HEIGHT);
+}
+
+// A layer 30 km thick centred 25 km up
+static float ozoneDensity(float altitude) {
+    return std::max(0.0f, 1.0f - std::abs(altitude - 25.0f) / 15.0f);
+}
+
+static glm::vec3 extinction(float altitude) {
+    return RAYLEIGH_SCATTERING * rayleighDensity(altitude) + glm::vec3(MIE_EXTINCTION * mieDensity(altitude)) +
+        OZONE_ABSORPTION * ozoneDensity(altitude);
+}
+
+// Distance from radius r along cosine zenith mu to where the ray leaves the sphere of the given radius
+static float distanceToSphere(float r, float mu, float radius) {
+    float discriminant = r * r * (mu * mu - 1.0f) + radius * radius;
+    return std::max(0.0f, -r * mu + std::sqrt(std::max(discriminant, 0.0f)));
+}
+
+static bool hitsGround(float r, float mu) {
+    return mu < 0.0f && r * r * (mu * mu - 1.0f) + Atmosphere::GROUND_RADIUS * Atmosphere::GROUND_RADIUS >= 0.0f;
+}
+
+Atmosphere::Atmosphere() {
+}
+
+glm::vec3 Atmosphere::getTransmittance(float altitude, float mu) const {
+    if (transmittance.empty()) return glm::vec3(1.0f);
+    // Rows are spaced by the square root of the altitude, so most of them fall where the air is dense
+    float row = std::sqrt(glm::clamp(altitude / (TOP_RADIUS - GROUND_RADIUS), 0.0f, 1.0f)) * (TRANSMITTANCE_ALTITUDE - 1);
+    float column = glm::clamp((mu + 1.0f) * 0.5f, 0.0f, 1.0f) * (TRANSMITTANCE_MU - 1);
+    int row0 = std::min(static_cast<int>(row), TRANSMITTANCE_ALTITUDE - 2);
+    int column0 = std::min(static_cast<int>(column), TRANSMITTANCE_MU - 2);
+    float fy = row - row0, fx = column - column0;
+    const glm::vec3* texels = &transmittance[static_cast<size_t>(row0) * TRANSMITTANCE_MU + column0];
+    glm::vec3 bottom = texels[0] * (1.0f - fx) + texels[1] * fx;
+    glm::vec3 top = texels[TRANSMITTANCE_MU] * (1.0f - fx) + texels[TRANSMITTANCE_MU + 1] * fx;
+    return bottom * (1.0f - fy) + top * fy;
+}
+
+glm::vec3 Atmosphere::getSkyIrradiance(float sunElevation) const {
+    if (skyIrradiance.empty()) return glm::vec3(0.0f);
+    float index = glm::clamp((sunElevation - MIN_SUN_ELEVATION) / (HALF_PI - MIN_SUN_ELEVATION), 0.0f, 1.0f) * (SCATTERING_SUN - 1);
+    int index0 = std::min(static_cast<int>(index), SCATTERING_SUN - 2);
+    float f = index - index0;
+    return skyIrradiance[index0] * (1.0f - f) + skyIrradiance[index0 + 1] * f;
+}
+
+void Atmosphere::integrate() {
+    ThreadPool& pool = ThreadPool::shared();
+    const float atmosphereHeight = TOP_RADIUS - GROUND_RADIUS;
+
+    // Transmittance: optical depth to the top of the atmosphere, zero where the ray hits the ground
+    const int transmittanceSteps = 40;
+    transmittance.assign(static_cast<size_t>(TRANSMITTANCE_MU) * TRANSMITTANCE_ALTITUDE, glm::vec3(0.0f));
+    pool.parallelFor(TRANSMITTANCE_ALTITUDE, 4, [&](int begin, int end, int) {
+        for (int row = begin; row < end; ++row) {
+            float rowFraction = static_cast<float>(row) / (TRANSMITTANCE_ALTITUDE - 1);
+            float r = GROUND_RADIUS + rowFraction * rowFraction * atmosphereHeight;
+            for (int column = 0; column < TRANSMITTANCE_MU; ++column) {
+                float mu = -1.0f + 2.0f * column / (TRANSMITTANCE_MU - 1);
+                if (hitsGround(r, mu)) continue;
+                float length = distanceToSphere(r, mu, TOP_RADIUS);
+                float dt = length / transmittanceSteps;
+                glm::vec3 opticalDepth(0.0f);
+                for (int step = 0; step < transmittanceSteps; ++step) {
+                    float t = (step + 0.5f) * dt;
+                    float altitude = std::sqrt(r * r + t * t + 2.0f * r * mu * t) - GROUND_RADIUS;
+                    opticalDepth += extinction(altitude) * dt;
+                }
+                transmittance[static_cast<size_t>(row) * TRANSMITTANCE_MU + column] =
+                    glm::vec3(std::exp(-opticalDepth.x), std::exp(-opticalDepth.y), std::exp(-opticalDepth.z));
+            }
+        }
+    });
+
+    // Scattering: the sun at azimuth zero, the observer on the y axis; steps grow quadratically along the
+    // view ray so the dense air near the observer is sampled finely even on the long rays along the horizon
+    const int scatteringSteps = 48;
+    const size_t scatteringSize = static_cast<size_t>(SCATTERING_VIEW) * SCATTERING_SUN * SCATTERING_AZIMUTH;
+    rayleighScattering.assign(scatteringSize, glm::vec3(0.0f));
+    mieScattering.assign(scatteringSize, glm::vec3(0.0f));
+    const float observerRadius = GROUND_RADIUS + OBSERVER_ALTITUDE;
+    pool.parallelFor(SCATTERING_SUN * SCATTERING_AZIMUTH, 8, [&](int begin, int end, int) {
+        for (int slice = begin; slice < end; ++slice) {
+            int sunIndex = slice % SCATTERING_SUN;
+            int azimuthIndex = slice / SCATTERING_SUN;
+            float sunElevation = MIN_SUN_ELEVATION + (HALF_PI - MIN_SUN_ELEVATION) * sunIndex / (SCATTERING_SUN - 1);
+            float azimuth = PI * azimuthIndex / (SCATTERING_AZIMUTH - 1);
+            glm::vec3 sunDirection(0.0f, std::sin(sunElevation), std::cos(sunElevation));
+            for (int viewIndex = 0; viewIndex < SCATTERING_VIEW; ++viewIndex) {
+                float u = static_cast<float>(viewIndex) / (SCATTERING_VIEW - 1);
+                float viewElevation = u * u * HALF_PI;
+                glm::vec3 view(std::cos(viewElevation) * std::sin(azimuth), std::sin(viewElevation), std::cos(viewElevation) * std::cos(azimuth));
+                float length = distanceToSphere(observerRadius, view.y, TOP_RADIUS);
+
+                glm::vec3 opticalDepth(0.0f), rayleigh(0.0f), mie(0.0f);
+                for (int step = 0; step < scatteringSteps; ++step) {
+                    float t = length * ((step + 0.5f) * (step + 0.5f)) / (scatteringSteps * scatteringSteps);
+                    float dt = length * (2.0f * step + 1.0f) / (scatteringSteps * scatteringSteps);
+                    glm::vec3 position = glm::vec3(0.0f, observerRadius, 0.0f) + view * t;
+                    float r = glm::length(position);
+                    float altitude = r - GROUND_RADIUS;
+
+                    glm::vec3 stepDepth = extinction(altitude) * dt;
+                    opticalDepth += stepDepth * 0.5f;
+                    glm::vec3 viewTransmittance(std::exp(-opticalDepth.x), std::exp(-opticalDepth.y), std::exp(-opticalDepth.z));
+                    opticalDepth += stepDepth * 0.5f;
+
+                    glm::vec3 sunTransmittance = getTransmittance(altitude, glm::dot(position / r, sunDirection));
+                    glm::vec3 lit = viewTransmittance * sunTransmittance * dt;
+                    rayleigh += lit * rayleighDensity(altitude);
+                    mie += lit * mieDensity(altitude);
+                }
+                size_t texel = (static_cast<size_t>(azimuthIndex) * SCATTERING_SUN + sunIndex) * SCATTERING_VIEW + viewIndex;
+                rayleighScattering[texel] = rayleigh * RAYLEIGH_SCATTERING;
+                mieScattering[texel] = mie * MIE_SCATTERING;
+            }
+        }
+    });
+
+    // Sky irradiance: the scattered light, with its phase functions, integrated over the upper hemisphere
+    // weighted by the cosine of the zenith angle; the azimuths cover half the sky, the other half mirrors it
+    skyIrradiance.assign(SCATTERING_SUN, glm::vec3(0.0f));
+    const float g = MIE_ASYMMETRY;
+    for (int sunIndex = 0; sunIndex < SCATTERING_SUN; ++sunIndex) {
+        float sunElevation = MIN_SUN_ELEVATION + (HALF_PI - MIN_SUN_ELEVATION) * sunIndex / (SCATTERING_SUN - 1);
+        glm::vec3 sunDirection(0.0f, std::sin(sunElevation), std::cos(sunElevation));
+        glm::vec3 irradiance(0.0f);
+        for (int azimuthIndex = 0; azimuthIndex < SCATTERING_AZIMUTH; ++azimuthIndex) {
+            float azimuth = PI * azimuthIndex / (SCATTERING_AZIMUTH - 1);
+            float azimuthWeight = (azimuthIndex == 0 || azimuthIndex == SCATTERING_AZIMUTH - 1 ? 0.5f : 1.0f) * PI / (SCATTERING_AZIMUTH - 1);
+            for (int viewIndex = 0; viewIndex < SCATTERING_VIEW; ++viewIndex) {
+                float u = static_cast<float>(viewIndex) / (SCATTERING_VIEW - 1);
+                float viewElevation = u * u * HALF_PI;
+                float elevationWeight = (viewIndex == 0 || viewIndex == SCATTERING_VIEW - 1 ? 0.5f : 1.0f) * PI * u / (SCATTERING_VIEW - 1);
+                glm::vec3 view(std::cos(viewElevation) * std::sin(azimuth), std::sin(viewElevation), std::cos(viewElevation) * std::cos(azimuth));
+                float mu = glm::dot(view, sunDirection);
+                float rayleighPhase = 3.0f / (16.0f * PI) * (1.0f + mu * mu);
+                float miePhase = 3.0f / (8.0f * PI) * ((1.0f - g * g) * (1.0f + mu * mu)) /
+                    ((2.0f + g * g) * std::pow(1.0f + g * g - 2.0f * g * mu, 1.5f));
+                size_t texel = (static_cast<size_t>(azimuthIndex) * SCATTERING_SUN + sunIndex) * SCATTERING_VIEW + viewIndex;
+                glm::vec3 radiance = rayleighScattering[texel] * rayleighPhase + mieScattering[texel] * miePhase;
+                irradiance += radiance * (std::sin(viewElevation) * std::cos(viewElevation) * elevationWeight * azimuthWeight * 2.0f);
+            }
+        }
+        skyIrradiance[sunIndex] = irradiance;
+    }
+}
+
+// FNV-1a, 64-bit, over every constant the tables are integrated from, so changing one misses the cache
+uint64_t Atmosphere::parameterHash() {
+    const float parameters[] = {
+        RAYLEIGH_SCATTERING.r, RAYLEIGH_SCATTERING.g, RAYLEIGH_SCATTERING.b, RAYLEIGH_SCALE_HEIGHT,
+        MIE_SCATTERING, MIE_EXTINCTION, MIE_SCALE_HEIGHT, MIE_ASYMMETRY,
+        OZONE_ABSORPTION.r, OZONE_ABSORPTION.g, OZONE_ABSORPTION.b,
+        GROUND_RADIUS, TOP_RADIUS, OBSERVER_ALTITUDE, MIN_SUN_ELEVATION,
+        static_cast<float>(TRANSMITTANCE_MU), static_cast<float>(TRANSMITTANCE_ALTITUDE),
+        static_cast<float>(SCATTERING_VIEW), static_cast<float>(SCATTERING_SUN), static_cast<float>(SCATTERING_AZIMUTH)
+    };
+    uint64_t hash = 14695981039346656037ull;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(parameters);
+    for (size_t i = 0; i < sizeof(parameters); ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool Atmosphere::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    FileHeader header;
+    const uint32_t sizes[5] = { TRANSMITTANCE_MU, TRANSMITTANCE_ALTITUDE, SCATTERING_VIEW, SCATTERING_SUN, SCATTERING_AZIMUTH };
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.magic, "CATM", 4) != 0 ||
+        header.version != FILE_VERSION || std::memcmp(header.sizes, sizes, sizeof(sizes)) != 0 || header.observerAltitude != OBSERVER_ALTITUDE ||
+        header.parameters != parameterHash()) {
+        DataManager::LogWarning("Atmosphere", "load", path + " does not match the atmosphere tables; integrating them again");
+        return false;
+    }
+
+    std::vector<glm::vec3> loadedTransmittance(static_cast<size_t>(TRANSMITTANCE_MU) * TRANSMITTANCE_ALTITUDE);
+    std::vector<glm::vec3> loadedRayleigh(static_cast<size_t>(SCATTERING_VIEW) * SCATTERING_SUN * SCATTERING_AZIMUTH);
+    std::vector<glm::vec3> loadedMie(loadedRayleigh.size());
+    std::vector<glm::vec3> loadedIrradiance(SCATTERING_SUN);
+    for (std::vector<glm::vec3>* table : { &loadedTransmittance, &loadedRayleigh, &loadedMie, &loadedIrradiance }) {
+        if (!file.read(reinterpret_cast<char*>(table->data()), table->size() * sizeof(glm::vec3))) {
+            DataManager::LogWarning("Atmosphere", "load", path + " is truncated; integrating the tables again");
+            return false;
+        }
+    }
+    transmittance.swap(loadedTransmittance);
+    rayleighScattering.swap(loadedRayleigh);
+    mieScattering.swap(loadedMie);
+    skyIrradiance.swap(loadedIrradiance);
+    return true;
+}
+
+bool Atmosphere::save(const std::string& path) const {
+    FileHeader header = { { 'C', 'A', 'T', 'M' }, FILE_VERSION,
+        { TRANSMITTANCE_MU, TRANSMITTANCE_ALTITUDE, SCATTERING_VIEW, SCATTERING_SUN, SCATTERING_AZIMUTH }, OBSERVER_ALTITUDE, parameterHash() };
+    std::vector<FileBlock> tables;
+    for (const std::vector<glm::vec3>* table : { &transmittance, &rayleighScattering, &mieScattering, &skyIrradiance }) {
+        tables.push_back({ table->data(), table->size() * sizeof(glm::vec3) });
+    }
+    return DataManager::WriteFileAtomically(path, { &header, sizeof(header) }, tables);
+}
+
+bool Atmosphere::create(const std::string& cacheDirectory) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    char fileName[64];
+    std::snprintf(fileName, sizeof(fileName), "atmosphere_v%u_%016llx.bin", FILE_VERSION, static_cast<unsigned long long>(parameterHash()));
+    std::string path = (std::filesystem::path(cacheDirectory) / fileName).string();
+    stats = AtmosphereStats();
+    stats.fromCache = load(path);
+    if (!stats.fromCache) {
+        integrate();
+        stats.threads = ThreadPool::shared().getThreadCount() + 1;
+        save(path);
+    }
+    stats.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+    DataManager::LogDebug(DebugCategory::RENDERING, "Atmosphere", "create",
+        std::string(stats.fromCache ? "Loaded " : "Integrated ") + path + " in " + std::to_string(stats.milliseconds) + " ms");
+    return true;
+}
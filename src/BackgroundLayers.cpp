@@ -0,0 +1,121 @@
+#include "BackgroundLayers.hpp"
+#include "GLStateCache.hpp"
+#include <algorithm>
+
+BackgroundLayers::BackgroundLayers() : vao(0), stripVbo(0), instanceVbo(0), profileTexture(0) {
+}
+
+BackgroundLayers::~BackgroundLayers() {
+    cleanup();
+}
+
+void BackgroundLayers::generate(noise::module::Perlin& perlin, const std::vector<BackgroundLayer>& newLayers, float minHeight, float maxHeight) {
+    layers.assign(newLayers.begin(), newLayers.begin() + std::min(static_cast<int>(newLayers.size()), MAX_LAYERS));
+    profiles.assign(layers.size() * PROFILE_SAMPLES, 0.0f);
+
+    for (size_t layer = 0; layer < layers.size(); ++layer) {
+        // Farther layers are wider, so sample more noise across them to keep the ridges a similar size on screen
+        double featureScale = layers[layer].width * 0.004;
+        for (int i = 0; i < PROFILE_SAMPLES; ++i) {
+            double u = static_cast<double>(i) / (PROFILE_SAMPLES - 1);
+            float noiseValue = static_cast<float>(perlin.GetValue(u * featureScale, 0.0, static_cast<double>(layer) * 7.31 + 0.5));
+            // Normalize noiseValue from [-1, 1] to [0, 1], as Terrain::generate does
+            float normalizedNoise = (noiseValue + 1.0f) / 2.0f;
+            profiles[layer * PROFILE_SAMPLES + i] = minHeight + normalizedNoise * (maxHeight - minHeight);
+        }
+    }
+
+    if (!vao) setupMesh();
+    uploadLayers();
+}
+
+void BackgroundLayerUniforms::resolve(GLuint shader) {
+    ShaderRegistry& registry = ShaderRegistry::shared();
+    profiles = registry.uniform<int>(shader, "profiles");
+    layerCount = registry.uniform<int>(shader, "layerCount");
+    sampleCount = registry.uniform<float>(shader, "sampleCount");
+}
+
+void BackgroundLayers::render(GLuint shader, const BackgroundLayerUniforms& uniforms) {
+    if (!vao || layers.empty()) return;
+    if (!ShaderRegistry::shared().use(shader)) return;
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, profileTexture);
+    uniforms.profiles.set(0);
+    uniforms.layerCount.set(getLayerCount());
+    uniforms.sampleCount.set(static_cast<float>(PROFILE_SAMPLES));
+
+    GLStateCache::shared().bindVertexArray(vao);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, PROFILE_SAMPLES * 2, getLayerCount());
+    GLStateCache::shared().bindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void BackgroundLayers::setupMesh() {
+    // One strip shared by every layer: a bottom and a ridge vertex per profile sample
+    std::vector<float> strip;
+    strip.reserve(PROFILE_SAMPLES * 4);
+    for (int i = 0; i < PROFILE_SAMPLES; ++i) {
+        strip.push_back(static_cast<float>(i));
+        strip.push_back(0.0f); // bottom edge
+        strip.push_back(static_cast<float>(i));
+        strip.push_back(1.0f); // ridge
+    }
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &stripVbo);
+    glGenBuffers(1, &instanceVbo);
+    glGenTextures(1, &profileTexture);
+
+    GLStateCache::shared().bindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, stripVbo);
+    glBufferData(GL_ARRAY_BUFFER, strip.size() * sizeof(float), strip.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // Per-layer placement (xStart, yBase, z, width) and appearance (color, fade)
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+    glBufferData(GL_ARRAY_BUFFER, MAX_LAYERS * 8 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(4 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+
+    GLStateCache::shared().bindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindTexture(GL_TEXTURE_2D, profileTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void BackgroundLayers::uploadLayers() {
+    std::vector<float> instances;
+    instances.reserve(layers.size() * 8);
+    for (const BackgroundLayer& layer : layers) {
+        instances.insert(instances.end(), { layer.xStart, layer.yBase, layer.zPosition, layer.width,
+            layer.color.r, layer.color.g, layer.color.b, layer.fade });
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(float), instances.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (layers.empty()) return;
+    glBindTexture(GL_TEXTURE_2D, profileTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, PROFILE_SAMPLES, getLayerCount(), 0, GL_RED, GL_FLOAT, profiles.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void BackgroundLayers::cleanup() {
+    if (vao) GLStateCache::shared().deleteVertexArrays(1, &vao);
+    if (stripVbo) glDeleteBuffers(1, &stripVbo);
+    if (instanceVbo) glDeleteBuffers(1, &instanceVbo);
+    if (profileTexture) glDeleteTextures(1, &profileTexture);
+    vao = stripVbo = instanceVbo = profileTexture = 0;
+}
@@ -3,31 +3,38 @@
 #include <iostream>
 #include "DataManager.hpp"
 #include "Constants.hpp"
-#include <tuple>
 #include <SDL3_image/SDL_image.h>
 #include <algorithm>  // for clamp
 #include <random>
+#include <chrono>
+#include "PoissonDiskSampler.hpp"
+#include "GLStateCache.hpp"
+#include "StreamBuffer.hpp"
 
 // Define the static rng member
 std::mt19937 CelestialObjectManager::rng(static_cast<unsigned int>(time(0)));
 
 CelestialObjectManager::CelestialObjectManager(Scene scene, World* world)
-    : scene(scene), world(world), starShader(0), starVAO(0), starVBO(0),
-    smokeShader(0), smokeVAO(0), smokeVBO(0), totalTime(0.0f),
-    shootingStarTimer(0.0f), satelliteTimer(0.0f), starlinkTimer(0.0f),
+    : scene(scene), world(world), starShader(0), starVAO(0), starVBO(0), staticStarCount(0),
+    dynamicStarVAO(0),
+    smokeShader(0), meteorShader(0), totalTime(0.0f),
+    satelliteTimer(0.0f), starlinkTimer(0.0f),
     showConstellationNames(false), showPlanetNames(false), showSatelliteNames(false),
-    closeCelestialShader(0), closeCelestialVAO(0), closeCelestialVBO(0), closeCelestialEBO(0) {
+    closeCelestialVAO(0), closeCelestialVBO(0), closeCelestialEBO(0) {
+    starlinkTrainLabel = skyEntities.internLabel("STARLINK TRAIN");
+    defenseForceLabel = skyEntities.internLabel("KLINGON DEFENSE FORCE");
 }
 
 CelestialObjectManager::~CelestialObjectManager() {
-    if (starShader) glDeleteProgram(starShader);
-    if (starVAO) glDeleteVertexArrays(1, &starVAO);
+    ShaderRegistry& registry = ShaderRegistry::shared();
+    registry.destroy(starShader);
+    if (starVAO) GLStateCache::shared().deleteVertexArrays(1, &starVAO);
     if (starVBO) glDeleteBuffers(1, &starVBO);
-    if (smokeShader) glDeleteProgram(smokeShader);
-    if (smokeVAO) glDeleteVertexArrays(1, &smokeVAO);
-    if (smokeVBO) glDeleteBuffers(1, &smokeVBO);
-    if (closeCelestialShader) glDeleteProgram(closeCelestialShader);
-    if (closeCelestialVAO) glDeleteVertexArrays(1, &closeCelestialVAO);
+    if (dynamicStarVAO) GLStateCache::shared().deleteVertexArrays(1, &dynamicStarVAO);
+    registry.destroy(smokeShader);
+    registry.destroy(meteorShader);
+    closeCelestialShaders.destroy();
+    if (closeCelestialVAO) GLStateCache::shared().deleteVertexArrays(1, &closeCelestialVAO);
     if (closeCelestialVBO) glDeleteBuffers(1, &closeCelestialVBO);
     if (closeCelestialEBO) glDeleteBuffers(1, &closeCelestialEBO);
     for (auto& celestial : closeCelestials) {
@@ -39,17 +46,26 @@ bool CelestialObjectManager::initialize() {
     // Clear all celestial objects and reset timers
     stars.clear();
     constellations.clear();
-    planets.clear();
+    skyEntities.clear();
     satellites.clear();
-    starlinkTrains.clear();
-    shootingStars.clear();
+    starlinkLeader = SkyEntityHandle();
+    meteorShower.clear();
     closeCelestials.clear();
-    satelliteDisplayHistory.clear();
-    shootingStarTimer = 0.0f;
     satelliteTimer = 0.0f;
     starlinkTimer = 0.0f;
     totalTime = 0.0f;
 
+    // Each scene's spacecraft are read once; later scene switches reuse them
+    SpacecraftCatalog& spacecraft = getSpacecraftCatalog();
+    if (!spacecraft.isLoaded()) {
+#ifdef _WIN32
+        spacecraft.load("resources\\catalogs\\spacecraft.json", scene == Scene::ALIEN ? "alien" : "earth");
+#else
+        spacecraft.load("./resources/catalogs/spacecraft.json", scene == Scene::ALIEN ? "alien" : "earth");
+#endif
+    }
+    satellites.reserve(MAX_SATELLITES);
+
     selectRandomSkyPattern();
     initializeStars();
     initializeCloseCelestials();
@@ -86,11 +102,15 @@ void CelestialObjectManager::selectRandomSkyPattern() {
 void CelestialObjectManager::initializeStars() {
     stars.clear();
     constellations.clear();
-    planets.clear();
+    skyEntities.clear();
     satellites.clear();
-    starlinkTrains.clear();
-    shootingStars.clear();
-    satelliteDisplayHistory.clear();
+    starlinkLeader = SkyEntityHandle();
+    meteorShower.clear();
+    getSpacecraftCatalog().reset();
+    starlinkReadyTime = 0.0f;
+    exhaustTrails.clear();
+    respawnStressShips();
+    respawnStressSky();
 
     setupRandomStars();
 
@@ -100,63 +120,137 @@ void CelestialObjectManager::initializeStars() {
         setupEarthSkyPattern();
     }
 
+    // The real sky looks the same way as the hand-placed Earth pattern it replaces
+    switch (currentPattern) {
+        case SkyPattern::EARTH_EAST: skyObserver.viewAzimuth = 90.0f; break;
+        case SkyPattern::EARTH_SOUTH: skyObserver.viewAzimuth = 180.0f; break;
+        case SkyPattern::EARTH_WEST: skyObserver.viewAzimuth = 270.0f; break;
+        default: skyObserver.viewAzimuth = 0.0f; break;
+    }
+
     initializeStarBuffers();
 }
 
-void CelestialObjectManager::setupRandomStars() {
-    const int numStars = 50;
-    const float minDist = 0.1f;
-    const int k = 30;
-    std::vector<glm::vec2> activeList;
-    std::vector<glm::vec2> points;
-
-    activeList.push_back(glm::vec2(0.5f, 0.5f));
-    points.push_back(activeList[0]);
-
-    std::uniform_int_distribution<int> idxDist(0, 1000); // For selecting activeList index
-    std::uniform_real_distribution<float> angleDist(0.0f, 2.0f * M_PI);
-    std::uniform_real_distribution<float> radiusDist(minDist, minDist * 2.0f);
-    std::uniform_real_distribution<float> probDist(0.0f, 1.0f);
-    std::uniform_real_distribution<float> brightnessDist(0.0f, 1.0f);
+// Julian date of 1 January, 0h UTC, of a Gregorian year (Meeus, Astronomical Algorithms, ch. 7)
+static double julianDateOfNewYear(int year) {
+    int previous = year - 1;
+    int century = static_cast<int>(std::floor(previous / 100.0));
+    int correction = 2 - century + static_cast<int>(std::floor(century / 4.0));
+    return std::floor(365.25 * (previous + 4716)) + std::floor(30.6001 * 14) + 1 + correction - 1524.5;
+}
 
-    while (!activeList.empty() && points.size() < numStars) {
-        int idx = idxDist(rng) % activeList.size();
-        glm::vec2 center = activeList[idx];
-        bool placed = false;
+// Gregorian year a Julian date falls in
+static int calendarYear(double julianDate) {
+    int year = 2000 + static_cast<int>(std::floor((julianDate - 2451544.5) / 365.2425));
+    while (julianDateOfNewYear(year + 1) <= julianDate) ++year;
+    while (julianDateOfNewYear(year) > julianDate) --year;
+    return year;
+}
 
-        for (int i = 0; i < k; ++i) {
-            float angle = angleDist(rng);
-            float radius = radiusDist(rng);
-            glm::vec2 newPoint = center + glm::vec2(cos(angle), sin(angle)) * radius;
+bool CelestialObjectManager::setRealSkyEnabled(bool enabled) {
+    realSkyEnabled = false;
+    if (!enabled) return true;
 
-            if (newPoint.y < 0.3f) {
-                if (probDist(rng) > 0.02f) {
-                    continue;
-                }
-            }
-            float yProbability = newPoint.y * newPoint.y;
-            if (probDist(rng) > yProbability) continue;
+    if (!starCatalog.isLoaded()) {
+#ifdef _WIN32
+        const std::string catalogPath = "resources\\stars\\stars.bin";
+        const std::string csvPath = "resources\\stars\\hygdata_v41.csv";
+#else
+        const std::string catalogPath = "./resources/stars/stars.bin";
+        const std::string csvPath = "./resources/stars/hygdata_v41.csv";
+#endif
+        if (!starCatalog.load(catalogPath, csvPath)) return false;
+    }
+    // Satellites are optional; without a TLE file the scripted ones keep flying
+    if (satellitePropagator.getCount() == 0) {
+#ifdef _WIN32
+        satellitePropagator.loadTle("resources\\satellites\\active.tle");
+#else
+        satellitePropagator.loadTle("./resources/satellites/active.tle");
+#endif
+    }
+    realSkyEnabled = true;
+    return true;
+}
 
-            if (newPoint.x < 0.0f || newPoint.x > 1.0f || newPoint.y < 0.0f || newPoint.y > 1.0f) continue;
+// The day and hour are taken within the year the sky clock is currently in
+void CelestialObjectManager::setRealSkyTime(int dayOfYear, float hourUtc) {
+    int year = calendarYear(skyObserver.julianDate);
+    dayOfYear = std::clamp(dayOfYear, 1, getRealSkyDaysInYear());
+    skyObserver.julianDate = julianDateOfNewYear(year) + (dayOfYear - 1) + hourUtc / 24.0;
+}
 
-            bool tooClose = false;
-            for (const auto& point : points) {
-                if (glm::distance(newPoint, point) < minDist) {
-                    tooClose = true;
-                    break;
-                }
-            }
+int CelestialObjectManager::getRealSkyDayOfYear() const {
+    double newYear = julianDateOfNewYear(calendarYear(skyObserver.julianDate));
+    return static_cast<int>(std::floor(skyObserver.julianDate - newYear)) + 1;
+}
 
-            if (!tooClose) {
-                activeList.push_back(newPoint);
-                points.push_back(newPoint);
-                placed = true;
-            }
-        }
+int CelestialObjectManager::getRealSkyDaysInYear() const {
+    int year = calendarYear(skyObserver.julianDate);
+    return static_cast<int>(julianDateOfNewYear(year + 1) - julianDateOfNewYear(year));
+}
 
-        if (!placed) {
-            activeList.erase(activeList.begin() + idx);
-        }
+float CelestialObjectManager::getRealSkyHourUtc() const {
+    // Julian dates start at noon, so civil days start at .5
+    double days = skyObserver.julianDate + 0.5;
+    return static_cast<float>((days - std::floor(days)) * 24.0);
+}
+
+void CelestialObjectManager::setRandomStarCount(int count) {
+    randomStarCount = std::clamp(count, MIN_RANDOM_STARS, MAX_RANDOM_STARS);
+    initializeStars();
+}
+
+void CelestialObjectManager::setupRandomStars() {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    std::uniform_real_distribution<float> probDist(0.0f, 1.0f);
+    std::uniform_real_distribution<float> brightnessDist(0.0f, 1.0f);
+
+    // Stars thin out towards the horizon: a star at height y is kept with probability y^2, and below
+    // horizonCutoff only 2% of those survive. Above the cutoff a Poisson-disk set is thinned by y^2, which
+    // keeps the minimum distance between the stars that remain.
+    const float horizonCutoff = 0.3f;
+    const float horizonKeep = 0.02f;
+    const float packingDensity = 0.76f; // points per radius^2 the sampler packs into an area with 8 attempts
+    const float keptFraction = (1.0f - horizonCutoff * horizonCutoff * horizonCutoff) / 3.0f; // integral of y^2 over [cutoff, 1]
+    const float overshoot = 1.15f; // sample a few extra, then take a random subset of exactly randomStarCount
+    float minDist = std::sqrt(packingDensity * keptFraction / (randomStarCount * overshoot));
+
+    std::vector<glm::vec2> points = PoissonDiskSampler::sample(1.0f, 1.0f - horizonCutoff, minDist, static_cast<uint32_t>(rng()),
+        1.0f / 32.0f, 8, [horizonCutoff](const glm::vec2& point) {
+            float y = point.y + horizonCutoff;
+            float yProbability = y * y;
+            return yProbability;
+        });
+    for (auto& point : points) {
+        point.y += horizonCutoff;
+    }
+
+    // Below the cutoff the density is too low for the minimum distance to matter, so those stars are scattered
+    // directly, with y distributed as y^2
+    float expectedBelowCutoff = packingDensity / (minDist * minDist) * horizonKeep * horizonCutoff * horizonCutoff * horizonCutoff / 3.0f;
+    int belowCutoff = static_cast<int>(expectedBelowCutoff + probDist(rng));
+    for (int i = 0; i < belowCutoff; ++i) {
+        points.push_back(glm::vec2(probDist(rng), horizonCutoff * std::cbrt(probDist(rng))));
+    }
+
+    // Partial Fisher-Yates: the first randomStarCount entries become a random subset in random order, so the larger
+    // stars at the front of the list are not all taken from the first tiles
+    size_t count = std::min(points.size(), static_cast<size_t>(randomStarCount));
+    for (size_t i = 0; i < count; ++i) {
+        std::uniform_int_distribution<size_t> pickDist(i, points.size() - 1);
+        std::swap(points[i], points[pickDist(rng)]);
+    }
+    points.resize(count);
+
+    // The packing density is an estimate; top up with the same falloff if the sampler fell short, since the
+    // sky patterns overwrite the first stars with constellations
+    while (points.size() < static_cast<size_t>(randomStarCount)) {
+        glm::vec2 newPoint(probDist(rng), probDist(rng));
+        if (newPoint.y < horizonCutoff && probDist(rng) > horizonKeep) continue;
+        float yProbability = newPoint.y * newPoint.y;
+        if (probDist(rng) > yProbability) continue;
+        points.push_back(newPoint);
     }
 
     stars.resize(points.size());
@@ -185,8 +279,9 @@ void CelestialObjectManager::setupRandomStars() {
         addedDistantStars++;
     }
 
+    starGenerationMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
     DataManager::LogDebug(DebugCategory::RENDERING, "CelestialObjectManager", "setupRandomStars",
-        "Stars initialized: stars.size()=" + std::to_string(stars.size()));
+        "Stars initialized: stars.size()=" + std::to_string(stars.size()) + " in " + std::to_string(starGenerationMilliseconds) + " ms");
 }
 
 void CelestialObjectManager::setupEarthSkyPattern() {
@@ -210,7 +305,7 @@ void CelestialObjectManager::setupAlienSkyPattern() {
 }
 
 void CelestialObjectManager::setupEarthNorth() {
-    // Edmonton, Alberta (latitude ~53.5N) looking North
+    // Edmonton, Alberta (latitude ~53.5°N) looking North
     // Prominent constellations: Ursa Major, Cassiopeia, Cepheus, Draco
     // Planets: Typically, planets are near the ecliptic, so few may be visible directly north, but we'll include a possible sighting like Jupiter
 
@@ -285,7 +380,7 @@ void CelestialObjectManager::setupEarthNorth() {
     jupiter.color = glm::vec3(1.0f, 0.9f, 0.8f);
     jupiter.size = 6.0f;
     jupiter.name = "JUPITER";
-    planets.push_back(jupiter);
+    addPlanet(jupiter);
 }
 
 void CelestialObjectManager::setupEarthEast() {
@@ -362,7 +457,7 @@ void CelestialObjectManager::setupEarthEast() {
     venus.color = glm::vec3(1.0f, 1.0f, 0.9f);
     venus.size = 4.0f;
     venus.name = "VENUS";
-    planets.push_back(venus);
+    addPlanet(venus);
 
     Planet mars;
     mars.position = glm::vec2(0.85f, 0.60f);
@@ -370,7 +465,7 @@ void CelestialObjectManager::setupEarthEast() {
     mars.color = glm::vec3(1.0f, 0.5f, 0.5f);
     mars.size = 4.0f;
     mars.name = "MARS";
-    planets.push_back(mars);
+    addPlanet(mars);
 
     Planet jupiter;
     jupiter.position = glm::vec2(0.80f, 0.60f); 
@@ -378,7 +473,7 @@ void CelestialObjectManager::setupEarthEast() {
     jupiter.color = glm::vec3(1.0f, 0.9f, 0.8f);
     jupiter.size = 6.0f;
     jupiter.name = "JUPITER";
-    planets.push_back(jupiter);
+    addPlanet(jupiter);
 }
 
 void CelestialObjectManager::setupEarthSouth() {
@@ -459,7 +554,7 @@ void CelestialObjectManager::setupEarthSouth() {
     jupiter.color = glm::vec3(1.0f, 0.9f, 0.8f);
     jupiter.size = 6.0f;
     jupiter.name = "JUPITER";
-    planets.push_back(jupiter);
+    addPlanet(jupiter);
 
     Planet saturn;
     saturn.position = glm::vec2(0.60f, 0.60f); 
@@ -467,7 +562,7 @@ void CelestialObjectManager::setupEarthSouth() {
     saturn.color = glm::vec3(1.0f, 0.9f, 0.7f);
     saturn.size = 4.0f;
     saturn.name = "SATURN";
-    planets.push_back(saturn);
+    addPlanet(saturn);
 }
 
 void CelestialObjectManager::setupEarthWest() {
@@ -536,7 +631,7 @@ void CelestialObjectManager::setupEarthWest() {
     venus.color = glm::vec3(1.0f, 1.0f, 0.9f);
     venus.size = 4.0f;
     venus.name = "VENUS";
-    planets.push_back(venus);
+    addPlanet(venus);
 
     Planet saturn;
     saturn.position = glm::vec2(0.25f, 0.60f);
@@ -544,7 +639,7 @@ void CelestialObjectManager::setupEarthWest() {
     saturn.color = glm::vec3(1.0f, 0.9f, 0.7f);
     saturn.size = 4.0f;
     saturn.name = "SATURN";
-    planets.push_back(saturn);
+    addPlanet(saturn);
 }
 
 void CelestialObjectManager::setupAlienPattern1() {
@@ -597,7 +692,7 @@ void CelestialObjectManager::setupAlienPattern1() {
     ruraPenthe.color = glm::vec3(0.7f, 0.3f, 0.5f); // Purplish
     ruraPenthe.size = 5.0f;
     ruraPenthe.name = "RURA PENTHE";
-    planets.push_back(ruraPenthe);
+    addPlanet(ruraPenthe);
 
     Planet kronos;
     kronos.position = glm::vec2(0.85f, 0.65f);
@@ -605,7 +700,7 @@ void CelestialObjectManager::setupAlienPattern1() {
     kronos.color = glm::vec3(0.6f, 0.4f, 0.8f); // Bluish-purple
     kronos.size = 4.5f;
     kronos.name = "KRONOS";
-    planets.push_back(kronos);
+    addPlanet(kronos);
 
     Planet khitomer;
     khitomer.position = glm::vec2(0.30f, 0.55f);
@@ -613,7 +708,7 @@ void CelestialObjectManager::setupAlienPattern1() {
     khitomer.color = glm::vec3(0.9f, 0.6f, 0.3f); // Orange
     khitomer.size = 4.0f;
     khitomer.name = "KHITOMER";
-    planets.push_back(khitomer);
+    addPlanet(khitomer);
 }
 
 void CelestialObjectManager::setupAlienPattern2() {
@@ -670,7 +765,7 @@ void CelestialObjectManager::setupAlienPattern2() {
     praxis.color = glm::vec3(0.5f, 0.7f, 0.3f); // Greenish
     praxis.size = 4.0f;
     praxis.name = "PRAXIS";
-    planets.push_back(praxis);
+    addPlanet(praxis);
 
     Planet klinzhai;
     klinzhai.position = glm::vec2(0.30f, 0.70f);
@@ -678,7 +773,7 @@ void CelestialObjectManager::setupAlienPattern2() {
     klinzhai.color = glm::vec3(0.8f, 0.4f, 0.4f); // Reddish
     klinzhai.size = 5.0f;
     klinzhai.name = "KLINZHAI";
-    planets.push_back(klinzhai);
+    addPlanet(klinzhai);
 
     Planet tyghokor;
     tyghokor.position = glm::vec2(0.45f, 0.65f);
@@ -686,7 +781,7 @@ void CelestialObjectManager::setupAlienPattern2() {
     tyghokor.color = glm::vec3(0.3f, 0.6f, 0.9f); // Bluish
     tyghokor.size = 4.5f;
     tyghokor.name = "TY'GOKOR";
-    planets.push_back(tyghokor);
+    addPlanet(tyghokor);
 }
 
 void CelestialObjectManager::setupAlienPattern3() {
@@ -741,7 +836,7 @@ void CelestialObjectManager::setupAlienPattern3() {
     boreth.color = glm::vec3(0.8f, 0.5f, 0.4f); // Reddish
     boreth.size = 4.0f;
     boreth.name = "BORETH";
-    planets.push_back(boreth);
+    addPlanet(boreth);
 
     Planet morska;
     morska.position = glm::vec2(0.80f, 0.75f);
@@ -749,7 +844,7 @@ void CelestialObjectManager::setupAlienPattern3() {
     morska.color = glm::vec3(0.4f, 0.7f, 0.5f); // Greenish-blue
     morska.size = 5.0f;
     morska.name = "MORSKA";
-    planets.push_back(morska);
+    addPlanet(morska);
 
     Planet krios;
     krios.position = glm::vec2(0.50f, 0.55f);
@@ -757,7 +852,7 @@ void CelestialObjectManager::setupAlienPattern3() {
     krios.color = glm::vec3(0.9f, 0.5f, 0.7f); // Pinkish
     krios.size = 4.5f;
     krios.name = "KRIOS";
-    planets.push_back(krios);
+    addPlanet(krios);
 }
 
 void CelestialObjectManager::setupAlienPattern4() {
@@ -810,7 +905,7 @@ void CelestialObjectManager::setupAlienPattern4() {
     kolarus.color = glm::vec3(0.5f, 0.8f, 0.6f); // Light green
     kolarus.size = 4.5f;
     kolarus.name = "KOLARUS";
-    planets.push_back(kolarus);
+    addPlanet(kolarus);
 
     Planet rakhar;
     rakhar.position = glm::vec2(0.75f, 0.60f);
@@ -818,7 +913,7 @@ void CelestialObjectManager::setupAlienPattern4() {
     rakhar.color = glm::vec3(0.7f, 0.3f, 0.7f); // Magenta
     rakhar.size = 4.0f;
     rakhar.name = "RAKHAR";
-    planets.push_back(rakhar);
+    addPlanet(rakhar);
 
     Planet betaThoridor;
     betaThoridor.position = glm::vec2(0.35f, 0.55f);
@@ -826,43 +921,66 @@ void CelestialObjectManager::setupAlienPattern4() {
     betaThoridor.color = glm::vec3(0.9f, 0.7f, 0.3f); // Golden
     betaThoridor.size = 5.0f;
     betaThoridor.name = "BETA THORIDOR";
-    planets.push_back(betaThoridor);
+    addPlanet(betaThoridor);
+}
+
+// Layout shared by the static star buffer and the streamed vertices: position, brightness, point size, color.
+// base is where the vertices start in the buffer bound to GL_ARRAY_BUFFER.
+static void setStarVertexAttributes(GLintptr base = 0) {
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)base);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)(base + 2 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)(base + 3 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)(base + 4 * sizeof(float)));
+    glEnableVertexAttribArray(3);
 }
 
 void CelestialObjectManager::initializeStarBuffers() {
-    satellites.clear();
+    clearSatellites();
     satelliteTimer = 0.0f;
 
+    // Called again on every scene switch; release the previous pattern's buffers first. The programs do not
+    // depend on the scene, so they are compiled on the first call only and kept until destruction.
+    if (starVAO) GLStateCache::shared().deleteVertexArrays(1, &starVAO);
+    if (starVBO) glDeleteBuffers(1, &starVBO);
+
+    // Stars never move once the sky pattern is set up, so they are uploaded once here; the planets are streamed
+    // with the rest of the entity store. Brightness is stored unfaded; render() applies starAlpha through the alpha uniform.
     std::vector<float> starVertices;
+    starVertices.reserve(stars.size() * 7);
     for (size_t i = 0; i < stars.size(); ++i) {
         const auto& star = stars[i];
         starVertices.push_back(star.position.x);
         starVertices.push_back(star.position.y);
         starVertices.push_back(star.brightness);
-        float size = (i >= 50) ? 3.0f : 4.0f;
+        float size = (i >= 50) ? 3.0f : 4.0f; // Distant stars are smaller
         starVertices.push_back(size);
-        starVertices.push_back(1.0f);
+        starVertices.push_back(1.0f); // Color (white)
         starVertices.push_back(1.0f);
         starVertices.push_back(1.0f);
     }
 
+    staticStarCount = static_cast<GLsizei>(starVertices.size() / 7);
+
     DataManager::LogDebug(DebugCategory::RENDERING, "CelestialObjectManager", "initializeStarBuffers",
         "Star vertices: starVertices.size()=" + std::to_string(starVertices.size()));
 
     glGenVertexArrays(1, &starVAO);
     glGenBuffers(1, &starVBO);
-    glBindVertexArray(starVAO);
+    GLStateCache::shared().bindVertexArray(starVAO);
     glBindBuffer(GL_ARRAY_BUFFER, starVBO);
     glBufferData(GL_ARRAY_BUFFER, starVertices.size() * sizeof(float), starVertices.data(), GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)(4 * sizeof(float)));
-    glEnableVertexAttribArray(3);
-    glBindVertexArray(0);
+    setStarVertexAttributes();
+    GLStateCache::shared().bindVertexArray(0);
+
+    // The entity store's planets, satellites and ships are streamed every frame through StreamBuffer
+    dynamicStarVertices.clear();
+    dynamicStarVertices.reserve(256 * 7);
+    if (!dynamicStarVAO) glGenVertexArrays(1, &dynamicStarVAO);
+
+    if (starShader) return;
 
     const char* vertexShaderSource = R"(
         #version 330 core
@@ -873,11 +991,12 @@ void CelestialObjectManager::initializeStarBuffers() {
         out float Brightness;
         out vec3 Color;
         out vec2 Pos;
+        uniform float alpha;
         void main() {
             vec2 ndcPos = aPos * 2.0 - 1.0;
             gl_Position = vec4(ndcPos, 0.999, 1.0);
             gl_PointSize = aSize;
-            Brightness = aBrightness;
+            Brightness = aBrightness * alpha; // Fade with the sky; the fragment shader fades the color once more
             Color = aColor;
             Pos = aPos;
         }
@@ -911,277 +1030,192 @@ void CelestialObjectManager::initializeStarBuffers() {
         }
     )";
 
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
-    glCompileShader(vertexShader);
-    GLint success;
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
-        std::cerr << "Star vertex shader compilation failed: " << infoLog << std::endl;
-        return;
-    }
-
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
-    glCompileShader(fragmentShader);
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
-        std::cerr << "Star fragment shader compilation failed: " << infoLog << std::endl;
-        return;
-    }
-
-    starShader = glCreateProgram();
-    glAttachShader(starShader, vertexShader);
-    glAttachShader(starShader, fragmentShader);
-    glLinkProgram(starShader);
-    glGetProgramiv(starShader, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(starShader, 512, nullptr, infoLog);
-        std::cerr << "Star shader program linking failed: " << infoLog << std::endl;
-        return;
-    }
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    ShaderRegistry& registry = ShaderRegistry::shared();
+    starShader = registry.submit("Star", vertexShaderSource, fragmentShaderSource, [this](GLuint program) {
+        ShaderRegistry& registry = ShaderRegistry::shared();
+        starUniforms.alpha = registry.uniform<float>(program, "alpha");
+        starUniforms.sunMoonPosition = registry.uniform<float>(program, "sunMoonPosition");
+        starUniforms.aspectRatio = registry.uniform<float>(program, "aspectRatio");
+    });
 
-    // Set up VAO/VBO for exhaust trails (line strip)
-    glGenVertexArrays(1, &smokeVAO);
-    glGenBuffers(1, &smokeVBO);
-
-    glBindVertexArray(smokeVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, smokeVBO);
-    glBufferData(GL_ARRAY_BUFFER, 1000 * 4 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glBindVertexArray(0);
-
-    // Create shader for exhaust trails
+    // Create shader for exhaust trails; segments fade from half opacity to nothing over their lifetime
     const char* exhaustVertexShaderSource = R"(
         #version 330 core
         layout(location = 0) in vec2 aPos;
-        layout(location = 1) in float aAlpha;
-        out float Alpha;
+        layout(location = 1) in float aBirthTime;
+        layout(location = 2) in float aLifetime;
+        layout(location = 3) in vec4 aColor;
+        uniform float time;
+        out vec4 Color;
         void main() {
             vec2 ndcPos = aPos * 2.0 - 1.0;
             gl_Position = vec4(ndcPos, 0.998, 1.0);
-            Alpha = aAlpha;
+            float age = time - aBirthTime;
+            Color = vec4(aColor.rgb, 0.5 * clamp(1.0 - age / aLifetime, 0.0, 1.0));
         }
     )";
 
     const char* exhaustFragmentShaderSource = R"(
         #version 330 core
         out vec4 FragColor;
-        in float Alpha;
-        uniform vec3 color;
+        in vec4 Color;
         void main() {
-            FragColor = vec4(color, Alpha);
+            FragColor = Color;
         }
     )";
 
-    vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &exhaustVertexShaderSource, nullptr);
-    glCompileShader(vertexShader);
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
-        std::cerr << "Exhaust vertex shader compilation failed: " << infoLog << std::endl;
-        return;
-    }
+    // Only the alien scene has trails, and they fade in over several frames anyway: not worth holding up the first frame
+    smokeShader = registry.defer("Exhaust", exhaustVertexShaderSource, exhaustFragmentShaderSource, [this](GLuint program) {
+        exhaustUniforms.resolve(program);
+    });
 
-    fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &exhaustFragmentShaderSource, nullptr);
-    glCompileShader(fragmentShader);
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
-        std::cerr << "Exhaust fragment shader compilation failed: " << infoLog << std::endl;
-        return;
-    }
+    // Create shader for meteors: one instanced streak each, placed and faded from its spawn state
+    const char* meteorVertexShaderSource = R"(
+        #version 330 core
+        layout(location = 0) in vec2 aCorner; // x from the tail (0) to the head (1), y across the streak
+        layout(location = 1) in vec4 aMotion; // start position, velocity
+        layout(location = 2) in vec4 aTiming; // spawn time, lifetime, brightness, streak length
+        uniform float time;
+        uniform float alpha;
+        uniform vec2 viewportSize;
+        out float Brightness;
+        void main() {
+            float age = time - aTiming.x;
+            float progress = age / aTiming.y;
+            if (progress < 0.0 || progress >= 1.0) {
+                gl_Position = vec4(2.0, 2.0, 2.0, 1.0); // Outside the clip volume
+                Brightness = 0.0;
+                return;
+            }
+            // Streak in pixels so its width does not depend on the direction
+            vec2 headPixels = (aMotion.xy + aMotion.zw * age) * viewportSize;
+            vec2 velocityPixels = aMotion.zw * viewportSize;
+            vec2 direction = normalize(velocityPixels);
+            float streakPixels = min(aTiming.w * viewportSize.y, length(velocityPixels) * age);
+            vec2 pixel = headPixels - direction * streakPixels * (1.0 - aCorner.x) + vec2(-direction.y, direction.x) * aCorner.y;
+            gl_Position = vec4(pixel / viewportSize * 2.0 - 1.0, 0.998, 1.0);
+            // Flares up quickly, then fades out; the streak fades towards its tail
+            Brightness = aTiming.z * min(progress * 8.0, 1.0) * (1.0 - progress) * aCorner.x * alpha;
+        }
+    )";
 
-    smokeShader = glCreateProgram();
-    glAttachShader(smokeShader, vertexShader);
-    glAttachShader(smokeShader, fragmentShader);
-    glLinkProgram(smokeShader);
-    glGetProgramiv(smokeShader, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(smokeShader, 512, nullptr, infoLog);
-        std::cerr << "Exhaust shader program linking failed: " << infoLog << std::endl;
-        return;
-    }
+    const char* meteorFragmentShaderSource = R"(
+        #version 330 core
+        out vec4 FragColor;
+        in float Brightness;
+        void main() {
+            FragColor = vec4(1.0, 0.97, 0.9, clamp(Brightness, 0.0, 1.0));
+        }
+    )";
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    meteorShader = registry.submit("Meteor", meteorVertexShaderSource, meteorFragmentShaderSource, [this](GLuint program) {
+        meteorUniforms.resolve(program);
+    });
 }
 
 void CelestialObjectManager::render(float starAlpha, float sunMoonPosition) {
     if (starAlpha <= 0.0f) return;
 
     // Ensure depth testing is enabled for stars
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
-    glDepthMask(GL_TRUE);
-
-    // Update star vertices with current brightness (distant celestials)
-    std::vector<float> starVertices;
-    for (const auto& star : stars) {
-        starVertices.push_back(star.position.x);
-        starVertices.push_back(star.position.y);
-        starVertices.push_back(star.brightness * starAlpha);
-        float size = (stars.size() > 50 && &star >= &stars[50]) ? 3.0f : 4.0f; // Distant stars are smaller
-        starVertices.push_back(size);
-        starVertices.push_back(1.0f); // Color (white)
-        starVertices.push_back(1.0f);
-        starVertices.push_back(1.0f);
-    }
-
-    for (const auto& planet : planets) {
-        starVertices.push_back(planet.position.x);
-        starVertices.push_back(planet.position.y);
-        starVertices.push_back(planet.brightness * starAlpha);
-        starVertices.push_back(planet.size);
-        starVertices.push_back(planet.color.r);
-        starVertices.push_back(planet.color.g);
-        starVertices.push_back(planet.color.b);
-    }
-
-    for (const auto& satellite : satellites) {
-        starVertices.push_back(satellite.position.x);
-        starVertices.push_back(satellite.position.y);
-        starVertices.push_back(satellite.brightness * starAlpha);
-        starVertices.push_back(satellite.size);
-        starVertices.push_back(satellite.isISS ? 1.0f : 0.5f); // Color (yellow for ISS, dim white for others)
-        starVertices.push_back(satellite.isISS ? 1.0f : 0.5f);
-        starVertices.push_back(satellite.isISS ? 0.0f : 0.5f);
-    }
-
-    for (const auto& train : starlinkTrains) {
-        for (size_t i = 0; i < train.positions.size(); ++i) {
-            starVertices.push_back(train.positions[i].x);
-            starVertices.push_back(train.positions[i].y);
-            starVertices.push_back(train.brightness * starAlpha);
-            starVertices.push_back(train.size);
-            starVertices.push_back(0.5f); // Dim white
-            starVertices.push_back(0.5f);
-            starVertices.push_back(0.5f);
+    GLStateCache::shared().enable(GL_DEPTH_TEST);
+    GLStateCache::shared().depthFunc(GL_LESS);
+    GLStateCache::shared().depthMask(GL_TRUE);
+
+    // Only the entity store is rebuilt each frame; the stars sit in the static buffer
+    dynamicStarVertices.clear();
+
+    // In the real sky the catalog stars replace the static pattern and turn with the Earth, so they are streamed too.
+    // The limiting magnitude rises as the field of view narrows, and only that prefix of the catalog is processed.
+    bool realSky = isRealSkyActive();
+    if (realSky) {
+        float limitingMagnitude = realSkyLimitingMagnitude + 5.0f * std::log10(60.0f / skyObserver.verticalFov);
+        projectedStars.clear();
+        SkyProjection projection(skyObserver, 0.3f, static_cast<float>(WINDOW_WIDTH) / WINDOW_HEIGHT);
+        starCatalog.project(skyObserver, projection, limitingMagnitude, projectedStars);
+        for (const ProjectedStar& star : projectedStars) {
+            // Brightest stars (around magnitude -1.5) at full brightness and size, fading towards the limit
+            float faintness = std::clamp((star.magnitude + 1.5f) / (limitingMagnitude + 1.5f), 0.0f, 1.0f);
+            dynamicStarVertices.push_back(star.position.x);
+            dynamicStarVertices.push_back(star.position.y);
+            dynamicStarVertices.push_back(1.0f - faintness * 0.75f);
+            dynamicStarVertices.push_back(5.0f - faintness * 3.0f);
+            dynamicStarVertices.push_back((star.color & 0xFF) / 255.0f);
+            dynamicStarVertices.push_back(((star.color >> 8) & 0xFF) / 255.0f);
+            dynamicStarVertices.push_back(((star.color >> 16) & 0xFF) / 255.0f);
         }
     }
 
-    for (const auto& shootingStar : shootingStars) {
-        starVertices.push_back(shootingStar.position.x);
-        starVertices.push_back(shootingStar.position.y);
-        starVertices.push_back(shootingStar.brightness * starAlpha);
-        starVertices.push_back(2.0f + (static_cast<float>(rand()) / RAND_MAX) * 0.5f);  // Set point size for rendering between 1.5 and 2.0
-        starVertices.push_back(1.0f); // White
-        starVertices.push_back(1.0f);
-        starVertices.push_back(1.0f);
+    // Real satellites were propagated in update; stations are the bright yellow ones, like the scripted ISS
+    for (const VisibleSatellite& satellite : visibleSatellites) {
+        bool station = satellitePropagator.isStation(satellite.index);
+        dynamicStarVertices.push_back(satellite.position.x);
+        dynamicStarVertices.push_back(satellite.position.y);
+        dynamicStarVertices.push_back(station ? 1.0f : 0.3f + 0.4f * satellite.altitude / 90.0f); // Brighter when closer overhead
+        dynamicStarVertices.push_back(station ? 4.0f : 2.5f);
+        dynamicStarVertices.push_back(station ? 1.0f : 0.5f);
+        dynamicStarVertices.push_back(station ? 1.0f : 0.5f);
+        dynamicStarVertices.push_back(station ? 0.0f : 0.5f);
     }
 
-    // Update VBO
-    glBindVertexArray(starVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, starVBO);
-    glBufferData(GL_ARRAY_BUFFER, starVertices.size() * sizeof(float), starVertices.data(), GL_STATIC_DRAW);
-    glBindVertexArray(0);
-
-    // Render distant celestials
-    glUseProgram(starShader);
-    float aspectRatio = static_cast<float>(WINDOW_WIDTH) / WINDOW_HEIGHT;
-    glUniform1f(glGetUniformLocation(starShader, "alpha"), starAlpha);
-    glUniform1f(glGetUniformLocation(starShader, "sunMoonPosition"), sunMoonPosition);
-    glUniform1f(glGetUniformLocation(starShader, "aspectRatio"), aspectRatio);
-
-    glBindVertexArray(starVAO);
-    glEnable(GL_PROGRAM_POINT_SIZE);
-    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(starVertices.size() / 7));
-    glDisable(GL_PROGRAM_POINT_SIZE);
-    glBindVertexArray(0);
-
-    // Render exhaust trails for satellites and Starlink trains in alien scene
-    if (scene == Scene::ALIEN) {
+    // The pattern's planets belong to the hand-placed sky and are left out of the real one
+    skyEntities.appendPointVertices(dynamicStarVertices, !realSky);
 
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        glBlendEquation(GL_FUNC_ADD);
+    GLsizei dynamicStarCount = static_cast<GLsizei>(dynamicStarVertices.size() / 7);
 
-        glUseProgram(smokeShader);
-        glBindVertexArray(smokeVAO);
-        glLineWidth(2.0f); // Set the line width for the exhaust trail
-
-        for (const auto& satellite : satellites) {
-            if (satellite.trail.empty()) continue;
-
-            std::vector<float> trailVertices;
-            for (const auto& segment : satellite.trail) {
-                trailVertices.push_back(segment.startPos.x);
-                trailVertices.push_back(segment.startPos.y);
-                trailVertices.push_back(segment.alpha);
-                trailVertices.push_back(0.0f); // Padding
-                trailVertices.push_back(segment.endPos.x);
-                trailVertices.push_back(segment.endPos.y);
-                trailVertices.push_back(segment.alpha);
-                trailVertices.push_back(0.0f); // Padding
-            }
+    GLintptr dynamicStarBase = 0;
+    if (dynamicStarCount > 0) {
+        dynamicStarBase = StreamBuffer::shared().upload(dynamicStarVertices.data(), dynamicStarVertices.size() * sizeof(float));
+    }
 
-            glBindBuffer(GL_ARRAY_BUFFER, smokeVBO);
-            glBufferSubData(GL_ARRAY_BUFFER, 0, trailVertices.size() * sizeof(float), trailVertices.data());
-            // Blend the spaceship's textColor with the base glow color
-            glm::vec3 baseColor(0.8f, 0.8f, 1.0f); // Light blue-purple glow
-            glm::vec3 blendedColor = glm::mix(baseColor, satellite.textColor, 0.3f); // 30% spaceship color
-            glUniform3f(glGetUniformLocation(smokeShader, "color"), blendedColor.r, blendedColor.g, blendedColor.b);
-            glDrawArrays(GL_LINE_STRIP, 0, static_cast<GLsizei>(trailVertices.size() / 4));
+    // Render distant celestials; without the star program only the stars are skipped
+    if (ShaderRegistry::shared().use(starShader)) {
+        float aspectRatio = static_cast<float>(WINDOW_WIDTH) / WINDOW_HEIGHT;
+        starUniforms.alpha.set(starAlpha);
+        starUniforms.sunMoonPosition.set(sunMoonPosition);
+        starUniforms.aspectRatio.set(aspectRatio);
+
+        GLStateCache::shared().enable(GL_PROGRAM_POINT_SIZE);
+        if (!realSky) {
+            GLStateCache::shared().bindVertexArray(starVAO);
+            glDrawArrays(GL_POINTS, 0, staticStarCount);
         }
-
-        // Render exhaust trails for satellites and Starlink trains in alien scene
-        for (const auto& train : starlinkTrains) {
-            for (size_t i = 0; i < train.trails.size(); ++i) {
-                const auto& trail = train.trails[i];
-                if (trail.empty()) continue;
-
-                // Prepare vertex data for satellite exhaust trails
-                std::vector<float> trailVertices;
-                for (const auto& segment : trail) {
-                    trailVertices.push_back(segment.startPos.x);  // Start X position
-                    trailVertices.push_back(segment.startPos.y);  // Start Y position
-                    trailVertices.push_back(segment.alpha);  // Alpha value for fading
-                    trailVertices.push_back(0.0f);  // Padding for alignment
-                    trailVertices.push_back(segment.endPos.x);  // End X position
-                    trailVertices.push_back(segment.endPos.y);  // End Y position
-                    trailVertices.push_back(segment.alpha);  // Alpha value for fading
-                    trailVertices.push_back(0.0f);  // Padding for alignment
-                }
-
-                // Render satellite exhaust trails
-                glBindBuffer(GL_ARRAY_BUFFER, smokeVBO);
-                glBufferSubData(GL_ARRAY_BUFFER, 0, trailVertices.size() * sizeof(float), trailVertices.data());
-                // Starlink trains use a yellow color (1.0f, 1.0f, 0.0f) in dynamicVertices
-                glm::vec3 baseColor(0.8f, 0.8f, 1.0f); // Light blue-purple glow
-                glm::vec3 shipColor(1.0f, 1.0f, 0.0f); // Yellow from dynamicVertices
-                glm::vec3 blendedColor = glm::mix(baseColor, shipColor, 0.3f); // 30% spaceship color
-                glUniform3f(glGetUniformLocation(smokeShader, "color"), blendedColor.r, blendedColor.g, blendedColor.b);
-                glDrawArrays(GL_LINE_STRIP, 0, static_cast<GLsizei>(trailVertices.size() / 4));
-
-            }
+        if (dynamicStarCount > 0) {
+            // The vertices sit somewhere else in the stream every frame, so the attributes follow them
+            GLStateCache::shared().bindVertexArray(dynamicStarVAO);
+            glBindBuffer(GL_ARRAY_BUFFER, StreamBuffer::shared().getBuffer());
+            setStarVertexAttributes(dynamicStarBase);
+            glDrawArrays(GL_POINTS, 0, dynamicStarCount);
         }
+        GLStateCache::shared().disable(GL_PROGRAM_POINT_SIZE);
+        GLStateCache::shared().bindVertexArray(0);
+    }
+
+    // Meteors add light to the sky and do not write depth
+    GLStateCache::shared().enable(GL_BLEND);
+    GLStateCache::shared().blendFunc(GL_SRC_ALPHA, GL_ONE);
+    GLStateCache::shared().depthMask(GL_FALSE);
+    meteorShower.render(meteorShader, meteorUniforms, totalTime, starAlpha);
+    GLStateCache::shared().depthMask(GL_TRUE);
+    GLStateCache::shared().blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // Exhaust trails of every ship in the alien scene, in one upload and one draw
+    if (scene == Scene::ALIEN && ShaderRegistry::shared().isReady(smokeShader)) {
+        GLStateCache::shared().enable(GL_BLEND);
+        GLStateCache::shared().blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        GLStateCache::shared().blendEquation(GL_FUNC_ADD);
+        glLineWidth(2.0f); // Set the line width for the exhaust trail
+        exhaustTrails.render(smokeShader, exhaustUniforms, totalTime);
     }
 }
 
 void CelestialObjectManager::renderText(Renderer* renderer, float starAlpha) {
     if (starAlpha <= 0.0f) return;
 
-    glDepthMask(GL_FALSE);
-    glDisable(GL_DEPTH_TEST);
+    // The pattern's constellations and planets are not drawn in the real sky
+    bool realSky = isRealSkyActive();
 
     // Render constellation names
-    if (showConstellationNames) {
+    if (showConstellationNames && !realSky) {
         for (const auto& constellation : constellations) {
             glm::vec2 center(0.0f);
             int count = 0;
@@ -1192,112 +1226,105 @@ void CelestialObjectManager::renderText(Renderer* renderer, float starAlpha) {
             if (count > 0) {
                 center /= static_cast<float>(count);
                 float x = center.x * WINDOW_WIDTH;
-                float y = center.y * WINDOW_HEIGHT + 20.0f;
-                renderer->renderText(constellation.name, x, y, CELESTIAL_TEXT_SCALE_CONSTELLATIONS, glm::vec3(0.5f, 0.5f, 0.5f), true);
+                float y = center.y * WINDOW_HEIGHT;
+                renderer->addLabel(constellation.name, x, y, 20.0f, CELESTIAL_TEXT_SCALE_CONSTELLATIONS, glm::vec3(0.5f, 0.5f, 0.5f),
+                    LabelPriority::CONSTELLATION);
             }
         }
     }
 
-    // Render planet names
-    if (showPlanetNames) {
-        for (const auto& planet : planets) {
-            float x = planet.position.x * WINDOW_WIDTH;
-            float y = planet.position.y * WINDOW_HEIGHT + 20.0f;
-            renderer->renderText(planet.name, x, y, CELESTIAL_TEXT_SCALE_PLANETS, glm::vec3(planet.color.r * 0.5f, planet.color.g * 0.5f, planet.color.b * 0.5f) * glm::vec3(0.8f), true);
+    // Render planet, satellite and Starlink names; only named entities are labelled, never the stress sky
+    SpacecraftCatalog& spacecraft = getSpacecraftCatalog();
+    for (uint32_t i = 0; i < skyEntities.size(); ++i) {
+        // Catalogued spacecraft are labelled with their catalog name, everything else by its label, if any
+        uint32_t reference = skyEntities.getReference(i);
+        bool catalogued = skyEntities.getKind(i) == SkyEntityKind::SATELLITE && reference != SkyEntityStore::NO_REFERENCE;
+        uint32_t label = skyEntities.getLabel(i);
+        if (!catalogued && label == SkyEntityStore::NO_LABEL) continue;
+        bool planet = skyEntities.getKind(i) == SkyEntityKind::PLANET;
+        if (planet ? (!showPlanetNames || realSky) : !showSatelliteNames) continue;
+        const std::string& name = catalogued ? spacecraft.getName(reference) : skyEntities.getLabelText(label);
+        // The ISS and the Bird-of-Prey outrank the planets, which outrank the other spacecraft
+        LabelPriority priority = planet ? LabelPriority::PLANET : LabelPriority::SPACECRAFT;
+        if (catalogued && spacecraft.isFlagship(reference)) {
+            priority = LabelPriority::FLAGSHIP;
         }
+        float x = skyEntities.getPosition(i).x * WINDOW_WIDTH;
+        float y = skyEntities.getPosition(i).y * WINDOW_HEIGHT;
+        renderer->addLabel(name, x, y, 20.0f, planet ? CELESTIAL_TEXT_SCALE_PLANETS : CELESTIAL_TEXT_SCALE_SATELLITES_AND_SPACESHIPS,
+            skyEntities.getLabelColor(i), priority);
     }
 
     // Render satellite names
     if (showSatelliteNames) {
-        for (const auto& sat : satellites) {
-            float x = sat.position.x * WINDOW_WIDTH;
-            float y = sat.position.y * WINDOW_HEIGHT + 20.0f;
-            renderer->renderText(sat.name, x, y, CELESTIAL_TEXT_SCALE_SATELLITES_AND_SPACESHIPS, sat.textColor * glm::vec3(0.5f), true);
-        }
-        for (const auto& train : starlinkTrains) {
-            if (!train.positions.empty()) {
-                float x = train.positions[0].x * WINDOW_WIDTH;
-                float y = train.positions[0].y * WINDOW_HEIGHT + 20.0f;
-                renderer->renderText(scene == Scene::ALIEN ? "KLINGON DEFENSE FORCE" : "STARLINK TRAIN", x, y, CELESTIAL_TEXT_SCALE_SATELLITES_AND_SPACESHIPS, glm::vec3(1.0f, 1.0f, 0.0f) * glm::vec3(0.5f) * glm::vec3(0.8f), true);
-            }
+        for (const VisibleSatellite& satellite : visibleSatellites) {
+            // Thousands of names would bury the sky, so only the stations are labelled
+            if (!satellitePropagator.isStation(satellite.index)) continue;
+            float x = satellite.position.x * WINDOW_WIDTH;
+            float y = satellite.position.y * WINDOW_HEIGHT;
+            renderer->addLabel(satellitePropagator.getName(satellite.index), x, y, 20.0f, CELESTIAL_TEXT_SCALE_SATELLITES_AND_SPACESHIPS,
+                glm::vec3(1.0f, 1.0f, 0.0f) * glm::vec3(0.5f), LabelPriority::FLAGSHIP);
         }
     }
 
     // Render close celestial names (planet)
     if (showPlanetNames) {
         for (const auto& celestial : closeCelestials) {
-            if (celestial.celestialType != "Planet") continue;
+            if (celestial.type != CloseCelestialType::PLANET) continue;
 
+            // The placer hides the label where it would sink into the terrain
             float x = celestial.position.x * WINDOW_WIDTH;
-            float y = celestial.position.y * WINDOW_HEIGHT + 30.0f;
-
-            bool isVisible = true;
-            int terrainX = static_cast<int>(celestial.position.x * (world->getDistantTerrain()->getWidth() - 1));
-            std::vector<float> heightmap = world->getDistantTerrain()->getHeightmap(world->getDistantTerrain()->getDepth() - 1);
-            if (terrainX >= 0 && terrainX < static_cast<int>(heightmap.size())) {
-                float terrainHeight = heightmap[terrainX];
-                if (terrainHeight != FLT_MAX) {
-                    float terrainScreenY = terrainHeight + world->getDistantParams().yOffset;
-                    if (y < terrainScreenY) {
-                        isVisible = false;
-                    }
-                }
-            }
-
-            if (isVisible) {
-                renderer->renderText(celestial.name, x, y, CELESTIAL_TEXT_SCALE_PLANETS, celestial.tintColor, true);
-            }
+            float y = celestial.position.y * WINDOW_HEIGHT;
+            renderer->addLabel(celestial.name, x, y, 30.0f, CELESTIAL_TEXT_SCALE_PLANETS, celestial.tintColor, LabelPriority::PLANET);
         }
     }
-    glEnable(GL_DEPTH_TEST);
-    glDepthMask(GL_TRUE);
 }
 
-void CelestialObjectManager::updateShootingStars(float dt, TimeOfDay currentTime) {
-    if (currentTime != TimeOfDay::NIGHT) {
-        shootingStars.clear();
-        return;
+void CelestialObjectManager::addPlanet(const Planet& planet) {
+    SkyEntityDesc desc;
+    desc.kind = SkyEntityKind::PLANET;
+    desc.position = planet.position;
+    desc.brightness = planet.brightness;
+    desc.size = planet.size;
+    desc.color = planet.color;
+    desc.label = skyEntities.internLabel(planet.name);
+    desc.labelColor = planet.color * 0.5f * 0.8f;
+    skyEntities.create(desc);
+}
+
+void CelestialObjectManager::destroySkyEntity(SkyEntityHandle handle) {
+    if (!skyEntities.isAlive(handle)) return;
+    uint32_t index = skyEntities.indexOf(handle);
+    if (skyEntities.getKind(index) == SkyEntityKind::SATELLITE && skyEntities.getReference(index) != SkyEntityStore::NO_REFERENCE) {
+        getSpacecraftCatalog().release(skyEntities.getReference(index));
     }
+    exhaustTrails.destroyTrail(skyEntities.getTrail(index));
+    skyEntities.destroy(handle);
+}
 
-    std::uniform_real_distribution<float> probDist(0.0f, 1.0f);
-    std::uniform_real_distribution<float> angleDist(30.0f, 60.0f);
-    std::uniform_real_distribution<float> brightnessDist(0.3f, 1.2f);
-    std::uniform_real_distribution<float> lifetimeVariation(-0.5f, 0.5f);
-    std::uniform_real_distribution<float> timerDist(5.0f, 15.0f);
-
-    shootingStarTimer -= dt;
-    if (shootingStarTimer <= 0.0f) {
-        ShootingStar star;
-        star.position = glm::vec2(probDist(rng), 1.0f);
-        float angle = glm::radians(angleDist(rng));
-        star.velocity = glm::vec2(-cos(angle), -sin(angle)) * 0.5f;
-
-        star.brightness = brightnessDist(rng);
-
-        float brightnessFactor = (star.brightness - 0.3f) / 0.9f;
-        star.lifetime = 0.5f + brightnessFactor * 1.5f;
-        star.lifetime += lifetimeVariation(rng) * 0.2f;
-        star.lifetime = glm::clamp(star.lifetime, 0.5f, 2.0f);
-
-        shootingStars.push_back(star);
-        shootingStarTimer = timerDist(rng);
+void CelestialObjectManager::clearSatellites() {
+    for (SkyEntityHandle satellite : satellites) {
+        destroySkyEntity(satellite);
     }
+    satellites.clear();
+}
 
-    for (auto it = shootingStars.begin(); it != shootingStars.end();) {
-        it->position += it->velocity * dt;
-        it->lifetime -= dt;
-        it->brightness = (it->brightness / it->lifetime) * (it->lifetime - dt);
-        if (it->lifetime <= 0.0f || it->position.x < 0.0f || it->position.y < 0.0f) {
-            it = shootingStars.erase(it);
-        } else {
-            ++it;
+void CelestialObjectManager::clearStarlinkTrains() {
+    if (!skyEntities.isAlive(starlinkLeader)) return;
+    // Backwards, so the entity swapped into a destroyed one's place has been looked at already
+    uint32_t leaderGroup = starlinkLeader.slot;
+    for (uint32_t i = static_cast<uint32_t>(skyEntities.size()); i-- > 0;) {
+        if (skyEntities.getGroup(i) == leaderGroup && skyEntities.handleAt(i).slot != leaderGroup) {
+            destroySkyEntity(skyEntities.handleAt(i));
         }
     }
+    destroySkyEntity(starlinkLeader);
+    starlinkLeader = SkyEntityHandle();
 }
 
 void CelestialObjectManager::updateSatellites(float dt, TimeOfDay currentTime) {
     if (currentTime != TimeOfDay::NIGHT) {
-        satellites.clear();
+        clearSatellites();
         return;
     }
 
@@ -1307,164 +1334,32 @@ void CelestialObjectManager::updateSatellites(float dt, TimeOfDay currentTime) {
     std::uniform_real_distribution<float> timerDist(60.0f, 120.0f);
 
     satelliteTimer -= dt;
-    if (satelliteTimer <= 0.0f && satellites.size() < 2) {
-        Satellite sat;
+    if (satelliteTimer <= 0.0f && satellites.size() < MAX_SATELLITES) {
+        SkyEntityDesc sat;
+        sat.kind = SkyEntityKind::SATELLITE;
         bool startLeft = binaryDist(rng) == 0;
         // Start one pixel inside the screen edge in normalized coordinates
         float onePixelNormalized = 1.0f / static_cast<float>(WINDOW_WIDTH);
         float startX = startLeft ? onePixelNormalized : 1.0f - onePixelNormalized;
         sat.position = glm::vec2(startX, posDist(rng));
 
-        const std::vector<std::tuple<std::string, float, float, glm::vec3, float, float>> satelliteData =
-            (scene == Scene::ALIEN) ?
-            std::vector<std::tuple<std::string, float, float, glm::vec3, float, float>> {
-                {"IKS D'GAVAH (BIRD-OF-PREY)", 0.012f, 45.0f, glm::vec3(1.0f, 0.0f, 0.0f), 3.0f, 1.2f},
-                { "IKS KORINAR (K'VORT-CLASS)", 0.010f, 40.0f, glm::vec3(0.7f, 0.2f, 0.2f), 2.5f, 0.9f },
-                { "IKS MAUK (VOR'CHA-CLASS)", 0.011f, 35.0f, glm::vec3(0.7f, 0.2f, 0.2f), 2.8f, 1.0f },
-                { "IKS TONG (D7-CLASS)", 0.009f, 50.0f, glm::vec3(0.7f, 0.2f, 0.2f), 2.0f, 0.8f },
-                { "IKS BURUK (B'REL-CLASS)", 0.010f, 42.0f, glm::vec3(0.7f, 0.2f, 0.2f), 2.2f, 0.9f },
-                { "IKS RAKTAR (NEGH'VAR-CLASS)", 0.012f, 38.0f, glm::vec3(0.7f, 0.2f, 0.2f), 3.0f, 1.1f },
-                { "IKS QEH'TAK (K'T'INGA-CLASS)", 0.011f, 47.0f, glm::vec3(0.7f, 0.2f, 0.2f), 2.7f, 1.0f },
-                { "IKS VOR'NAL (RAPTOR-CLASS)", 0.0095f, 41.0f, glm::vec3(0.7f, 0.2f, 0.2f), 2.3f, 0.9f },
-                { "IKS JIH'VEK (D5-CLASS)", 0.0105f, 39.0f, glm::vec3(0.7f, 0.2f, 0.2f), 2.4f, 0.9f },
-                { "IKS NUQ'TAR (KELDON-CLASS)", 0.011f, 43.0f, glm::vec3(0.7f, 0.2f, 0.2f), 2.6f, 1.0f },
-                { "IKS TAL'SHIAR (D'DERIDEX WARBIRD)", 0.012f, 44.0f, glm::vec3(0.2f, 0.8f, 0.2f), 3.0f, 1.1f },
-                { "IKS VREX'TAL (VALDORE-CLASS)", 0.011f, 40.0f, glm::vec3(0.3f, 0.6f, 0.3f), 2.8f, 1.0f },
-                { "IKS SOT'HAR (KERCHAN-CLASS)", 0.010f, 42.0f, glm::vec3(0.3f, 0.6f, 0.3f), 2.5f, 0.9f },
-                { "IKS DUK'TAL (SCORPION-CLASS)", 0.009f, 38.0f, glm::vec3(0.3f, 0.6f, 0.3f), 2.2f, 0.8f },
-                { "IKS REMAN'VEK (SHRIKE-CLASS)", 0.0105f, 41.0f, glm::vec3(0.3f, 0.6f, 0.3f), 2.4f, 0.9f },
-                { "IKS NEX'TOR (T'LISS WARBIRD)", 0.011f, 39.0f, glm::vec3(0.3f, 0.6f, 0.3f), 2.6f, 1.0f },
-                { "IKS VOR'CHA (NERADA-CLASS)", 0.012f, 43.0f, glm::vec3(0.3f, 0.6f, 0.3f), 3.0f, 1.1f },
-                { "IKS KEL'TAK (D7 WARBIRD)", 0.010f, 40.0f, glm::vec3(0.3f, 0.6f, 0.3f), 2.5f, 0.9f },
-                { "IKS TAL'VEK (HAWK-CLASS)", 0.0095f, 42.0f, glm::vec3(0.3f, 0.6f, 0.3f), 2.3f, 0.8f },
-                { "IKS SAREK'TAL (FALCON-CLASS)", 0.011f, 41.0f, glm::vec3(0.3f, 0.6f, 0.3f), 2.7f, 1.0f },
-                { "IKS TAJ'VEK (GALAXY-CLASS)", 0.012f, 45.0f, glm::vec3(0.8f, 0.8f, 1.0f), 3.0f, 1.1f },
-                { "IKS QONOS'TAR (CONSTITUTION-CLASS)", 0.011f, 40.0f, glm::vec3(0.5f, 0.5f, 0.8f), 2.8f, 1.0f },
-                { "IKS VOR'TAK (INTREPID-CLASS)", 0.010f, 42.0f, glm::vec3(0.5f, 0.5f, 0.8f), 2.5f, 0.9f },
-                { "IKS NEX'VEK (DEFIANT-CLASS)", 0.009f, 38.0f, glm::vec3(0.5f, 0.5f, 0.8f), 2.2f, 0.8f },
-                { "IKS KEL'CHA (SOVEREIGN-CLASS)", 0.011f, 41.0f, glm::vec3(0.5f, 0.5f, 0.8f), 2.7f, 1.0f },
-                { "IKS DUK'VEK (NEBULA-CLASS)", 0.0105f, 39.0f, glm::vec3(0.5f, 0.5f, 0.8f), 2.4f, 0.9f },
-                { "IKS SOT'VEK (EXCELSIOR-CLASS)", 0.012f, 43.0f, glm::vec3(0.5f, 0.5f, 0.8f), 3.0f, 1.1f },
-                { "IKS TAL'TAR (AKIRA-CLASS)", 0.010f, 40.0f, glm::vec3(0.5f, 0.5f, 0.8f), 2.5f, 0.9f },
-                { "IKS VREX'TOR (MIRANDA-CLASS)", 0.0095f, 42.0f, glm::vec3(0.5f, 0.5f, 0.8f), 2.3f, 0.8f },
-                { "IKS NEX'TAK (PROMETHEUS-CLASS)", 0.011f, 41.0f, glm::vec3(0.5f, 0.5f, 0.8f), 2.7f, 1.0f },
-                { "IKS ZOR'TAL (CYLON BASISTAR)", 0.012f, 44.0f, glm::vec3(0.5f, 0.5f, 0.5f), 3.0f, 1.1f },
-                { "IKS VEX'CHA (BORG CUBE)", 0.011f, 40.0f, glm::vec3(0.4f, 0.1f, 0.4f), 2.8f, 1.0f },
-                { "IKS DOR'TAK (IMPERIAL STAR DESTROYER)", 0.010f, 42.0f, glm::vec3(0.3f, 0.5f, 0.7f), 2.5f, 0.9f },
-                { "IKS KOR'VEK (MILLENNIUM FALCON)", 0.009f, 38.0f, glm::vec3(0.8f, 0.6f, 0.4f), 2.2f, 0.8f },
-                { "IKS TAL'CHA (FIREFLY-CLASS)", 0.0105f, 41.0f, glm::vec3(0.6f, 0.6f, 0.6f), 2.4f, 0.9f },
-                { "IKS SOT'TAR (SERENITY)", 0.011f, 39.0f, glm::vec3(0.6f, 0.6f, 0.6f), 2.6f, 1.0f },
-                { "IKS VOR'TAK (REAVER SHIP)", 0.012f, 43.0f, glm::vec3(0.6f, 0.6f, 0.6f), 3.0f, 1.1f },
-                { "IKS NEX'CHA (GALACTICA)", 0.010f, 40.0f, glm::vec3(0.6f, 0.6f, 0.6f), 2.5f, 0.9f },
-                { "IKS DUK'TOR (VIPER MK II)", 0.0095f, 42.0f, glm::vec3(0.6f, 0.6f, 0.6f), 2.3f, 0.8f },
-                { "IKS KEL'TAR (RAIDER)", 0.011f, 41.0f, glm::vec3(0.6f, 0.6f, 0.6f), 2.7f, 1.0f },
-                { "IKS ZOR'VEK (NORMANDY SR-2)", 0.012f, 44.0f, glm::vec3(0.6f, 0.6f, 0.6f), 3.0f, 1.1f },
-                { "IKS VEX'TAK (REAPER DESTROYER)", 0.011f, 40.0f, glm::vec3(0.6f, 0.6f, 0.6f), 2.8f, 1.0f },
-                { "IKS DOR'CHA (DESTINY)", 0.010f, 42.0f, glm::vec3(0.6f, 0.6f, 0.6f), 2.5f, 0.9f },
-                { "IKS KOR'VEK (ATLANTIS)", 0.009f, 38.0f, glm::vec3(0.6f, 0.6f, 0.6f), 2.2f, 0.8f },
-                { "IKS TAL'TOR (HIVE SHIP)", 0.0105f, 41.0f, glm::vec3(0.6f, 0.6f, 0.6f), 2.4f, 0.9f },
-                { "IKS SOT'CHA (WRAITH CRUISER)", 0.011f, 39.0f, glm::vec3(0.6f, 0.6f, 0.6f), 2.6f, 1.0f },
-                { "IKS VOR'TAK (DART)", 0.012f, 43.0f, glm::vec3(0.6f, 0.6f, 0.6f), 3.0f, 1.1f },
-                { "IKS NEX'TOR (ORION DESTROYER)", 0.010f, 40.0f, glm::vec3(0.6f, 0.6f, 0.6f), 2.5f, 0.9f },
-                { "IKS DUK'CHA (NAQUADAH MINER)", 0.0095f, 42.0f, glm::vec3(0.6f, 0.6f, 0.6f), 2.3f, 0.8f },
-                { "IKS KEL'TOR (TEL'TAK)", 0.011f, 41.0f, glm::vec3(0.6f, 0.6f, 0.6f), 2.7f, 1.0f }
-        } :
-        std::vector<std::tuple<std::string, float, float, glm::vec3, float, float>>{
-            {"INTERNATIONAL SPACE STATION", 0.01f, 51.6f, glm::vec3(1.0f, 1.0f, 0.0f), 2.0f, 1.0f},
-            {"HUBBLE SPACE TELESCOPE", 0.0098f, 28.5f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"SPUTNIK 1", 0.0096f, 65.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"LANDSAT 8", 0.0096f, 98.2f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"GOES-16", 0.0039f, 0.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"IRIDIUM 33", 0.0095f, 86.4f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"TIANGONG-1", 0.0101f, 42.8f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"NOAA-19", 0.0094f, 98.7f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"AQUA", 0.0096f, 98.2f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"TERRA", 0.0096f, 98.2f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"ENVISAT", 0.0095f, 98.4f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"JASON-3", 0.0092f, 66.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"CRYOSAT-2", 0.0096f, 92.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"SENTINEL-1A", 0.0097f, 98.18f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"METOP-A", 0.0094f, 98.7f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"KOSMOS 2251", 0.0095f, 74.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"GALILEO G1", 0.0048f, 56.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"GPS IIF-12", 0.0049f, 55.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"INMARSAT-4 F3", 0.0039f, 0.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"SIRIUS FM-6", 0.0039f, 0.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"CHANDRA X-RAY OBSERVATORY", 0.0035f, 28.5f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"KEPLER SPACE TELESCOPE", 0.0094f, 0.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"SPOT-7", 0.0097f, 98.2f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"SWIFT GAMMA-RAY BURST MISSION", 0.0098f, 20.6f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"FENGYUN-2D", 0.0039f, 0.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"RADARSAT-2", 0.0095f, 98.6f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"ALOS-2", 0.0098f, 97.9f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"WORLDVIEW-3", 0.0098f, 97.2f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"GCOM-W1", 0.0096f, 98.2f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"OFEQ-10", 0.0098f, 141.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"YAMAL-402", 0.0039f, 0.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"ASTROSAT", 0.0098f, 6.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"CARTOSAT-2", 0.0098f, 97.9f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"RESURS-P1", 0.0099f, 97.3f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"KOMPSAT-3", 0.0097f, 98.1f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"GONETS-M1", 0.0091f, 82.5f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"YAOGAN-30", 0.0098f, 35.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"BEIDOU G7", 0.0039f, 0.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"INSAT-4CR", 0.0039f, 0.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"EUTELSAT 8 WEST B", 0.0039f, 0.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"THAICOM 8", 0.0039f, 0.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"NUSANTARA SATU", 0.0039f, 0.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"GSAT-31", 0.0039f, 0.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"AMOS-17", 0.0039f, 0.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"INTELSAT 39", 0.0039f, 0.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"SES-12", 0.0039f, 0.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"TELSTAR 19V", 0.0039f, 0.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"ABS-3A", 0.0039f, 0.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"BRISAT", 0.0039f, 0.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"ECHOSTAR 23", 0.0039f, 0.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f},
-            {"SKYNET 5D", 0.0039f, 0.0f, glm::vec3(1.0f, 1.0f, 1.0f), 2.0f, 0.7f}
-        };
-
-        std::vector<std::string> activeSatellites;
-        for (std::vector<Satellite>::const_iterator s = satellites.begin(); s != satellites.end(); ++s) {
-            activeSatellites.push_back(s->name);
-        }
-
-        std::vector<int> availableIndices;
-        for (size_t i = 0; i < satelliteData.size(); ++i) {
-            const std::string& name = std::get<0>(satelliteData[i]);
-            if (std::find(activeSatellites.begin(), activeSatellites.end(), name) != activeSatellites.end()) {
-                continue;
-            }
-            std::map<std::string, float>::iterator it = satelliteDisplayHistory.find(name);
-            bool canDisplay = true;
-            if (it != satelliteDisplayHistory.end()) {
-                float lastTime = it->second;
-                float cooldown = (name == "IKS D'GAVAH (BIRD-OF-PREY)" || name == "INTERNATIONAL SPACE STATION") ? 240.0f : 60.0f;
-                if (totalTime - lastTime < cooldown) {
-                    canDisplay = false;
-                }
-            }
-            if (canDisplay) {
-                availableIndices.push_back(static_cast<int>(i));
-            }
-        }
-
-        if (availableIndices.empty()) {
+        // Spacecraft on screen or cooling down are not in the catalog's available set
+        SpacecraftCatalog& spacecraft = getSpacecraftCatalog();
+        uint32_t id = spacecraft.acquire(totalTime, rng);
+        if (id == SpacecraftCatalog::INVALID_ID) {
             satelliteTimer = 10.0f;
             return;
         }
 
-        std::uniform_int_distribution<int> nameDist(0, availableIndices.size() - 1);
-        int nameIndex = availableIndices[nameDist(rng)];
-        sat.name = std::get<0>(satelliteData[nameIndex]);
-        sat.speed = std::get<1>(satelliteData[nameIndex]);
-        float inclination = std::get<2>(satelliteData[nameIndex]);
-        sat.textColor = std::get<3>(satelliteData[nameIndex]);
-        sat.size = std::get<4>(satelliteData[nameIndex]);
-        sat.brightness = std::get<5>(satelliteData[nameIndex]);
-        sat.isISS = (sat.name == "IKS D'GAVAH (BIRD-OF-PREY)" || sat.name == "INTERNATIONAL SPACE STATION");
-        sat.lastDisplayedTime = totalTime;
-
-        satelliteDisplayHistory[sat.name] = totalTime;
+        sat.reference = id; // also picks the label, looked up in the catalog when the names are drawn
+        float speed = spacecraft.getSpeed(id);
+        float inclination = spacecraft.getInclination(id);
+        glm::vec3 textColor = spacecraft.getTextColor(id);
+        sat.labelColor = textColor * 0.5f;
+        sat.size = spacecraft.getSize(id);
+        sat.brightness = spacecraft.getBrightness(id);
+        // Yellow for the ISS, dim white for the others
+        sat.color = spacecraft.isFlagship(id) ? glm::vec3(1.0f, 1.0f, 0.0f) : glm::vec3(0.5f);
 
         float angle = glm::radians(90.0f - inclination);
         float direction = startLeft ? 1.0f : -1.0f;
@@ -1479,58 +1374,23 @@ void CelestialObjectManager::updateSatellites(float dt, TimeOfDay currentTime) {
             xComponent /= magnitude;
             yComponent /= magnitude;
         }
-        sat.heading = glm::vec2(xComponent, yComponent);
+        sat.velocity = glm::vec2(xComponent, yComponent) * speed;
 
-        satellites.push_back(sat);
-        satelliteTimer = timerDist(rng);
-    }
-
-    // Update satellites and their exhaust trails
-    for (std::vector<Satellite>::iterator it = satellites.begin(); it != satellites.end();) {
-        // Store the previous position before updating
-        glm::vec2 prevPos = it->position;
-
-        // Update satellite position
-        it->position += it->heading * it->speed * dt;
-
-        // Add exhaust trail in alien scene only
+        // Light blue-purple glow with 30% of the spaceship's color; larger ships leave longer trails
         if (scene == Scene::ALIEN) {
-            static float exhaustTimer = 0.0f;
-            exhaustTimer += dt;
-            if (exhaustTimer >= 0.05f) { // Add a new segment every 0.05 seconds
-                ExhaustSegment segment;
-                segment.startPos = prevPos;
-                segment.endPos = it->position;
-                segment.lifetime = 1.0f + (it->size - 2.0f) * 0.5f;
-                segment.alpha = 0.5f;
-                it->trail.push_back(segment);
-                exhaustTimer = 0.0f;
-            }
-
-            // Update exhaust segments
-            for (std::vector<ExhaustSegment>::iterator trailIt = it->trail.begin(); trailIt != it->trail.end();) {
-                trailIt->lifetime -= dt;
-                trailIt->alpha = (trailIt->lifetime / (1.0f + (it->size - 2.0f) * 0.5f)) * 0.5f;
-                if (trailIt->lifetime <= 0.0f || trailIt->alpha <= 0.0f) {
-                    trailIt = it->trail.erase(trailIt);
-                } else {
-                    ++trailIt;
-                }
-            }
+            glm::vec3 trailColor = glm::mix(glm::vec3(0.8f, 0.8f, 1.0f), textColor, 0.3f);
+            sat.trail = exhaustTrails.createTrail(sat.position, trailColor, 1.0f + (sat.size - 2.0f) * 0.5f, totalTime);
         }
 
-        // Remove satellite if off-screen
-        if (it->position.x > 1.0f || it->position.x < 0.0f || it->position.y > 1.0f || it->position.y < 0.0f) {
-            it = satellites.erase(it);
-        } else {
-            ++it;
-        }
+        // Moved, and removed once off screen, by updateSkyEntities
+        satellites.push_back(skyEntities.create(sat));
+        satelliteTimer = timerDist(rng);
     }
 }
 
 void CelestialObjectManager::updateStarlinkTrains(float dt, TimeOfDay currentTime) {
     if (currentTime != TimeOfDay::NIGHT) {
-        starlinkTrains.clear();
+        clearStarlinkTrains();
         return;
     }
 
@@ -1539,27 +1399,19 @@ void CelestialObjectManager::updateStarlinkTrains(float dt, TimeOfDay currentTim
     std::uniform_real_distribution<float> timerDist(60.0f, 300.0f);
 
     starlinkTimer -= dt;
-    if (starlinkTimer <= 0.0f && starlinkTrains.empty()) {
-        const std::string fleetName = (scene == Scene::ALIEN)
-            ? "KLINGON DEFENSE FORCE TACTICAL FLEET"
-            : "STARLINK TRAIN FORMATION";
-
-        auto it = satelliteDisplayHistory.find(fleetName);
-        if (it != satelliteDisplayHistory.end()) {
-            float lastTime = it->second;
-            float cooldown = 300.0f; 
-            if (totalTime - lastTime < cooldown) {
-                starlinkTimer = 60.0f; 
-                return;
-            }
+    if (starlinkTimer <= 0.0f && !skyEntities.isAlive(starlinkLeader)) {
+        if (totalTime < starlinkReadyTime) {
+            starlinkTimer = 60.0f;
+            return;
         }
 
-        StarlinkTrain train;
-        train.count = 7;
-        train.speed = 0.0096f;
-        train.brightness = 0.8f;
-        train.size = 2.0f;
-        train.lastDisplayedTime = totalTime;
+        const int count = 7;
+        const float speed = 0.0096f;
+        SkyEntityDesc ship;
+        ship.kind = SkyEntityKind::STARLINK;
+        ship.brightness = 0.8f;
+        ship.size = 2.0f;
+        ship.color = glm::vec3(0.5f); // Dim white
 
         bool startLeft = binaryDist(rng) == 0;
         float startY = posDist(rng);
@@ -1568,115 +1420,213 @@ void CelestialObjectManager::updateStarlinkTrains(float dt, TimeOfDay currentTim
         float inclination = 53.0f;
         float angle = glm::radians(90.0f - inclination);
         float direction = startLeft ? 1.0f : -1.0f;
-        train.heading = glm::vec2(direction * cos(angle), sin(angle));
+        glm::vec2 heading = glm::vec2(direction * cos(angle), sin(angle));
+        ship.velocity = heading * speed;
 
         float spacing = 0.02f;
         glm::vec2 leaderPos = glm::vec2(startX, startY);
-        train.positions.push_back(leaderPos);
+        std::vector<glm::vec2> positions;
+        positions.push_back(leaderPos);
 
         if (scene == Scene::ALIEN) {
             // Alien scene: V-shaped tactical formation
             constexpr float angleSpread = glm::radians(30.0f);
-            for (int i = 1; i < train.count; ++i) {
+            for (int i = 1; i < count; ++i) {
                 int side = (i % 2 == 0) ? 1 : -1;
                 int rank = (i + 1) / 2;
                 float offsetX = rank * spacing * cos(angle + side * angleSpread);
                 float offsetY = rank * spacing * sin(angle + side * angleSpread);
-                glm::vec2 pos = leaderPos - train.heading * (rank * spacing) + glm::vec2(offsetX, offsetY);
-                train.positions.push_back(pos);
+                glm::vec2 pos = leaderPos - heading * (rank * spacing) + glm::vec2(offsetX, offsetY);
+                positions.push_back(pos);
             }
         } else {
             // Earth scene: Single-file line formation
-            for (int i = 1; i < train.count; ++i) {
-                glm::vec2 pos = leaderPos - train.heading * (i * spacing);
-                train.positions.push_back(pos);
+            for (int i = 1; i < count; ++i) {
+                glm::vec2 pos = leaderPos - heading * (i * spacing);
+                positions.push_back(pos);
             }
         }
 
-        // Initialize a trail for each ship in the formation
-        train.trails.resize(train.count);
+        // The leader carries the label, and the train leaves the sky when its last ship does.
+        // In the alien scene every ship gets a trail, in the Starlink yellow blended into the glow.
+        glm::vec3 trailColor = glm::mix(glm::vec3(0.8f, 0.8f, 1.0f), glm::vec3(1.0f, 1.0f, 0.0f), 0.3f);
+        float trailLifetime = 1.0f + (ship.size * 1.5f - 2.0f) * 0.5f;
+        for (size_t i = 0; i < positions.size(); ++i) {
+            ship.position = positions[i];
+            ship.label = i == 0 ? (scene == Scene::ALIEN ? defenseForceLabel : starlinkTrainLabel) : SkyEntityStore::NO_LABEL;
+            ship.labelColor = glm::vec3(1.0f, 1.0f, 0.0f) * 0.5f * 0.8f;
+            ship.trail = scene == Scene::ALIEN ? exhaustTrails.createTrail(positions[i], trailColor, trailLifetime, totalTime) : ExhaustTrails::INVALID_TRAIL;
+            ship.group = starlinkLeader;
+            SkyEntityHandle handle = skyEntities.create(ship);
+            if (i == 0) starlinkLeader = handle;
+        }
 
-        starlinkTrains.push_back(train);
-        satelliteDisplayHistory[fleetName] = totalTime;
+        starlinkReadyTime = totalTime + 300.0f;
         starlinkTimer = timerDist(rng);
     }
+}
 
-    for (auto it = starlinkTrains.begin(); it != starlinkTrains.end();) {
-        bool offScreen = true;
-        std::vector<glm::vec2> prevPositions(it->positions.size());
-        for (size_t i = 0; i < it->positions.size(); ++i) {
-            prevPositions[i] = it->positions[i];
-            it->positions[i] += it->heading * it->speed * dt;
-            if (it->positions[i].x >= 0.0f && it->positions[i].x <= 1.0f &&
-                it->positions[i].y >= 0.0f && it->positions[i].y <= 1.0f) {
-                offScreen = false;
-            }
+void CelestialObjectManager::setStressShipCount(int count) {
+    stressShipCount = std::clamp(count, 0, MAX_STRESS_SHIPS);
+    respawnStressShips();
+}
 
-            // Add exhaust trail for each ship in the alien scene
-            if (scene == Scene::ALIEN) {
-                static float exhaustTimer = 0.0f;
-                exhaustTimer += dt;
-                if (exhaustTimer >= 0.05f) { // Add a new segment every 0.05 seconds
-                    ExhaustSegment segment;
-                    segment.startPos = prevPositions[i]; // Start at the previous position
-                    segment.endPos = it->positions[i]; // End at the current position
-                    float formationSize = it->size * 1.5f;
-                    segment.lifetime = 1.0f + (formationSize - 2.0f) * 0.5f; // Lifetime scales with size
-                    segment.alpha = 0.5f;  // Reduced initial alpha for less brightness
-                    it->trails[i].push_back(segment);
-                    exhaustTimer = 0.0f;
-                }
-            }
+void CelestialObjectManager::respawnStressShips() {
+    for (SkyEntityHandle ship : stressShips) {
+        destroySkyEntity(ship);
+    }
+    stressShips.clear();
+    if (scene != Scene::ALIEN) return;
+
+    SkyEntityDesc ship;
+    ship.kind = SkyEntityKind::SHIP;
+    ship.brightness = 0.9f;
+    ship.size = 2.5f;
+    ship.color = glm::vec3(1.0f, 0.3f, 0.3f); // Red, like the Bird-of-Prey
+    ship.stress = true;
+    stressShips.reserve(stressShipCount);
+    for (int i = 0; i < stressShipCount; ++i) {
+        SkyEntityHandle handle = skyEntities.create(ship);
+        spawnStressShip(skyEntities.indexOf(handle), true);
+        stressShips.push_back(handle);
+    }
+}
+
+void CelestialObjectManager::spawnStressShip(uint32_t index, bool anywhere) {
+    std::uniform_int_distribution<int> binaryDist(0, 1);
+    std::uniform_real_distribution<float> xDist(0.05f, 0.95f);
+    std::uniform_real_distribution<float> posDist(0.3f, 0.9f);
+    std::uniform_real_distribution<float> angleDist(-40.0f, 40.0f);
+    std::uniform_real_distribution<float> speedDist(0.02f, 0.06f);
+
+    bool startLeft = binaryDist(rng) == 0;
+    float angle = glm::radians(angleDist(rng));
+    glm::vec2 position(anywhere ? xDist(rng) : (startLeft ? 0.0f : 1.0f), posDist(rng));
+    skyEntities.setMotion(index, position, glm::vec2((startLeft ? 1.0f : -1.0f) * cos(angle), sin(angle)) * speedDist(rng));
+    // Bird-of-Prey red blended into the glow, like the scripted ships' trails
+    glm::vec3 trailColor = glm::mix(glm::vec3(0.8f, 0.8f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f), 0.3f);
+    skyEntities.setTrail(index, exhaustTrails.createTrail(position, trailColor, 1.5f, totalTime));
+}
+
+void CelestialObjectManager::setStressSkyCount(int count) {
+    stressSkyCount = std::clamp(count, 0, MAX_STRESS_SKY);
+    respawnStressSky();
+}
+
+void CelestialObjectManager::respawnStressSky() {
+    for (SkyEntityHandle entity : stressSkyEntities) {
+        destroySkyEntity(entity);
+    }
+    stressSkyEntities.clear();
+    stressSkyEntities.reserve(3 * stressSkyCount);
+
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_real_distribution<float> angleDist(-60.0f, 60.0f);
+    std::uniform_real_distribution<float> speedDist(0.01f, 0.04f);
+
+    // Unnamed, so they are never labelled; they wrap around instead of leaving, which keeps the counts fixed
+    SkyEntityDesc planet;
+    planet.kind = SkyEntityKind::PLANET;
+    planet.stress = true;
+    for (int i = 0; i < stressSkyCount; ++i) {
+        planet.position = glm::vec2(unit(rng), 0.3f + 0.7f * unit(rng));
+        planet.brightness = 0.6f + 0.4f * unit(rng);
+        planet.size = 3.0f + 3.0f * unit(rng);
+        planet.color = glm::vec3(1.0f, 0.7f + 0.3f * unit(rng), 0.6f + 0.4f * unit(rng));
+        stressSkyEntities.push_back(skyEntities.create(planet));
+    }
+
+    SkyEntityDesc satellite;
+    satellite.kind = SkyEntityKind::SATELLITE;
+    satellite.brightness = 0.6f;
+    satellite.color = glm::vec3(0.5f);
+    satellite.stress = true;
+    for (int i = 0; i < stressSkyCount; ++i) {
+        float angle = glm::radians(angleDist(rng) + (unit(rng) < 0.5f ? 0.0f : 180.0f)); // rightwards or leftwards
+        satellite.position = glm::vec2(unit(rng), unit(rng));
+        satellite.velocity = glm::vec2(cos(angle), sin(angle)) * speedDist(rng);
+        stressSkyEntities.push_back(skyEntities.create(satellite));
+    }
+
+    // Starlink ships in single-file trains of seven, each train grouped under its leader
+    SkyEntityDesc ship;
+    ship.kind = SkyEntityKind::STARLINK;
+    ship.brightness = 0.8f;
+    ship.color = glm::vec3(0.5f);
+    ship.stress = true;
+    for (int i = 0; i < stressSkyCount; ++i) {
+        if (i % 7 == 0) {
+            float angle = glm::radians(angleDist(rng) + (unit(rng) < 0.5f ? 0.0f : 180.0f)); // rightwards or leftwards
+            ship.position = glm::vec2(unit(rng), unit(rng));
+            ship.velocity = glm::vec2(cos(angle), sin(angle)) * speedDist(rng);
+            ship.group = SkyEntityHandle();
         }
+        SkyEntityHandle handle = skyEntities.create(ship);
+        if (i % 7 == 0) ship.group = handle;
+        ship.position -= glm::normalize(ship.velocity) * 0.02f;
+        stressSkyEntities.push_back(handle);
+    }
+}
 
-        // Update exhaust segments for each ship's trail
-        if (scene == Scene::ALIEN) {
-            for (size_t i = 0; i < it->trails.size(); ++i) {
-                for (auto trailIt = it->trails[i].begin(); trailIt != it->trails[i].end();) {
-                    trailIt->lifetime -= dt;
-                    // Fade alpha based on lifetime
-                    trailIt->alpha = (trailIt->lifetime / (1.0f + (it->size * 1.5f - 2.0f) * 0.5f)) * 0.5f;
-                    if (trailIt->lifetime <= 0.0f || trailIt->alpha <= 0.0f) {
-                        trailIt = it->trails[i].erase(trailIt);
-                    } else {
-                        ++trailIt;
-                    }
-                }
-            }
+void CelestialObjectManager::updateSkyEntities(float dt) {
+    skyEntities.update(dt, departedEntities);
+
+    for (uint32_t i = 0; i < skyEntities.size(); ++i) {
+        if (skyEntities.getTrail(i) != ExhaustTrails::INVALID_TRAIL) {
+            exhaustTrails.extend(skyEntities.getTrail(i), skyEntities.getPosition(i), totalTime);
         }
+    }
+
+    // Stress sky entities wrap to the other side by their leader's offset, before any leader has moved
+    wrapOffsets.clear();
+    for (SkyEntityHandle handle : departedEntities) {
+        const glm::vec2& leader = skyEntities.getGroupPosition(skyEntities.indexOf(handle));
+        wrapOffsets.push_back(glm::vec2(std::floor(leader.x), std::floor(leader.y)));
+    }
 
-        // Remove satellite if off-screen
-        if (offScreen) {
-            it = starlinkTrains.erase(it);
+    for (size_t i = 0; i < departedEntities.size(); ++i) {
+        SkyEntityHandle handle = departedEntities[i];
+        uint32_t index = skyEntities.indexOf(handle);
+        if (!skyEntities.isStress(index)) {
+            // Scripted satellites and trains are done once off screen
+            if (skyEntities.getKind(index) == SkyEntityKind::SATELLITE) {
+                satellites.erase(std::remove_if(satellites.begin(), satellites.end(),
+                    [&](SkyEntityHandle satellite) { return satellite.slot == handle.slot; }), satellites.end());
+            }
+            destroySkyEntity(handle);
+        } else if (skyEntities.getKind(index) == SkyEntityKind::SHIP) {
+            // A new pass starts a new trail, so no segment jumps across the screen
+            exhaustTrails.destroyTrail(skyEntities.getTrail(index));
+            spawnStressShip(index, false);
         } else {
-            ++it;
+            skyEntities.setMotion(index, skyEntities.getPosition(index) - wrapOffsets[i], skyEntities.getVelocity(index));
         }
     }
 }
 
 void CelestialObjectManager::update(float dt, TimeOfDay currentTime) {
     totalTime += dt;
-    updateShootingStars(dt, currentTime);
-    updateSatellites(dt, currentTime);
+    if (isRealSkyActive()) {
+        skyObserver.julianDate += dt * realSkyTimeScale / 86400.0;
+    }
+    meteorShower.update(dt, totalTime, currentTime == TimeOfDay::NIGHT);
+    visibleSatellites.clear();
+    if (isRealSatellitesActive()) {
+        clearSatellites();
+        if (currentTime == TimeOfDay::NIGHT) {
+            SkyProjection projection(skyObserver, 0.3f, static_cast<float>(WINDOW_WIDTH) / WINDOW_HEIGHT);
+            satellitePropagator.update(skyObserver, projection, visibleSatellites);
+        }
+    } else {
+        updateSatellites(dt, currentTime);
+    }
     updateStarlinkTrains(dt, currentTime);
+    updateSkyEntities(dt);
+    exhaustTrails.update(totalTime);
 
-    // Calculate timeFactor for position updates based on TimeOfDay
-    switch (currentTime) {
-        case TimeOfDay::DAWN:
-            timeFactor = 0.0f; // Left side of horizon: x = 0.2, y = 0.5
-            break;
-        case TimeOfDay::MID_DAY:
-            timeFactor = 0.5f; // Centered at the top: x = 0.5, y = 0.9
-            break;
-        case TimeOfDay::DUSK:
-            timeFactor = 1.0f; // Right side of horizon: x = 0.8, y = 0.5
-            break;
-        case TimeOfDay::NIGHT:
-            timeFactor = 0.5f; // Moon at Mid-Day position: x = 0.5, y = 0.9
-            break;
-        default:
-            timeFactor = 0.5f;
-    }
+    // Calculate timeFactor for position updates from the sun's progress across the day: 0 at the left of the
+    // horizon (x = 0.2, y = 0.5), 0.5 centered at the top (x = 0.5, y = 0.9), 1 at the right; the moon stays up top
+    timeFactor = (currentTime == TimeOfDay::NIGHT) ? 0.5f : world->getSunProgress();
 
     // Log timeFactor every 60 frames (approx. once per second at 60 FPS)
     static int frameCounter = 0;
@@ -1700,7 +1650,7 @@ void CelestialObjectManager::initializeCloseCelestials() {
     sun.tintColor = glm::vec3(1.0f, 0.9f, 0.7f); // Yellowish tint
     sun.rotation = 0.0f;
     sun.brightness = 1.0f;
-    sun.celestialType = "Sun";
+    sun.type = CloseCelestialType::SUN;
 #ifdef _WIN32
     sun.texturePath = "resources\\textures\\sun.png";
 #else
@@ -1716,7 +1666,7 @@ void CelestialObjectManager::initializeCloseCelestials() {
     moon.tintColor = (scene == Scene::ALIEN) ? glm::vec3(0.8f, 0.7f, 0.9f) : glm::vec3(1.0f, 1.0f, 1.0f);
     moon.rotation = (scene == Scene::ALIEN) ? glm::radians(90.0f) : 0.0f;
     moon.brightness = 1.0f;
-    moon.celestialType = "Moon";
+    moon.type = CloseCelestialType::MOON;
 #ifdef _WIN32
     moon.texturePath = "resources\\textures\\moon.png";
 #else
@@ -1733,7 +1683,7 @@ void CelestialObjectManager::initializeCloseCelestials() {
         planet.tintColor = glm::vec3(0.8f, 0.7f, 0.9f);
         planet.rotation = 0.0f;
         planet.brightness = 0.5f;
-        planet.celestialType = "Planet";
+        planet.type = CloseCelestialType::PLANET;
 #ifdef _WIN32
         planet.texturePath = "resources\\textures\\alien_planet.png";
 #else
@@ -1790,6 +1740,9 @@ void CelestialObjectManager::initializeCloseCelestials() {
             << celestial.name << " at " << celestial.texturePath << std::endl;
     }
 
+    // The quad and its program are the same in every scene, so they are only created by the first call
+    if (closeCelestialShaders.isInitialized()) return;
+
     // Define a quad for close celestials with explicit indices, reverting z to 0.0f
     float vertices[] = {
         // Positions (x, y, z)   // TexCoords
@@ -1808,7 +1761,7 @@ void CelestialObjectManager::initializeCloseCelestials() {
     glGenBuffers(1, &closeCelestialVBO);
     glGenBuffers(1, &closeCelestialEBO);
 
-    glBindVertexArray(closeCelestialVAO);
+    GLStateCache::shared().bindVertexArray(closeCelestialVAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, closeCelestialVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
@@ -1821,7 +1774,7 @@ void CelestialObjectManager::initializeCloseCelestials() {
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
 
-    glBindVertexArray(0);
+    GLStateCache::shared().bindVertexArray(0);
 
     // Create shader for close celestials
     const char* vertexShaderSource = R"(
@@ -1845,80 +1798,64 @@ void CelestialObjectManager::initializeCloseCelestials() {
         uniform sampler2D celestialTexture;
         uniform vec3 tintColor;  // Color tint
         uniform float opacity;   // Opacity multiplier
-        uniform int isGlowPass;  // Flag for glow pass (1 for glow, 0 for texture)
 
         void main() {
-            if (isGlowPass == 1) {
-                // Glow pass for sun
-                vec2 center = vec2(0.5);
-                vec2 normalizedTexCoord = TexCoord * 2.0 - 1.0; // Normalize to [-1, 1]
-                float dist = length(normalizedTexCoord);
-                // Power function for bright core with smooth fade
-                float intensity = pow(max(0.0, 1.0 - dist), 3.5);
-                // Scale alpha for gentle fade
-                float alpha = intensity * opacity * 17.0;  // adjust last value for sun glow brightness
-                if (alpha < 0.01) discard;
-                FragColor = vec4(tintColor * intensity, alpha);
-            } else {
-                // Texture pass
-                vec4 texColor = texture(celestialTexture, TexCoord);
-                if (texColor.a < 0.1) discard; // Adjusted threshold for transparency
-                // Apply color tint
-                texColor.rgb *= tintColor;
-                // Apply opacity
-                texColor.a *= opacity;
-                FragColor = texColor;
-            }
+        #ifdef GLOW
+            // Glow pass for sun
+            vec2 center = vec2(0.5);
+            vec2 normalizedTexCoord = TexCoord * 2.0 - 1.0; // Normalize to [-1, 1]
+            float dist = length(normalizedTexCoord);
+            // Power function for bright core with smooth fade
+            float intensity = pow(max(0.0, 1.0 - dist), 3.5);
+            // Scale alpha for gentle fade
+            float alpha = intensity * opacity * 17.0;  // adjust last value for sun glow brightness
+            if (alpha < 0.01) discard;
+            FragColor = vec4(tintColor * intensity, alpha);
+        #else
+            // Texture pass
+            vec4 texColor = texture(celestialTexture, TexCoord);
+            if (texColor.a < 0.1) discard; // Adjusted threshold for transparency
+            // Apply color tint
+            texColor.rgb *= tintColor;
+            // Apply opacity
+            texColor.a *= opacity;
+            FragColor = texColor;
+        #endif
         }
     )";
 
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
-    glCompileShader(vertexShader);
-    GLint success;
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
-        std::cerr << "Close celestial vertex shader compilation failed: " << infoLog << std::endl;
-        return;
-    }
-
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
-    glCompileShader(fragmentShader);
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
-        std::cerr << "Close celestial fragment shader compilation failed: " << infoLog << std::endl;
-        glDeleteShader(vertexShader);
-        return;
-    }
-
-    closeCelestialShader = glCreateProgram();
-    glAttachShader(closeCelestialShader, vertexShader);
-    glAttachShader(closeCelestialShader, fragmentShader);
-    glLinkProgram(closeCelestialShader);
-    glGetProgramiv(closeCelestialShader, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(closeCelestialShader, 512, nullptr, infoLog);
-        std::cerr << "Close celestial shader program linking failed: " << infoLog << std::endl;
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        closeCelestialShader = 0;
-        return;
-    }
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    // Deferred: the sun and moon may come in a few frames late rather than delay the first frame
+    closeCelestialShaders.initialize("Close celestial", vertexShaderSource, fragmentShaderSource,
+        [](uint32_t key) { return std::string(key == CLOSE_CELESTIAL_GLOW ? "#define GLOW\n" : ""); },
+        [](GLuint program, CloseCelestialUniforms& uniforms) {
+            ShaderRegistry& registry = ShaderRegistry::shared();
+            uniforms.model = registry.uniform<glm::mat4>(program, "model");
+            uniforms.tintColor = registry.uniform<glm::vec3>(program, "tintColor");
+            uniforms.opacity = registry.uniform<float>(program, "opacity");
+            // The whole window, which never changes size
+            registry.uniform<glm::mat4>(program, "projection").set(
+                glm::ortho(0.0f, static_cast<float>(WINDOW_WIDTH), 0.0f, static_cast<float>(WINDOW_HEIGHT), -1.0f, 1.0f));
+        });
+    closeCelestialShaders.prepare(CLOSE_CELESTIAL_TEXTURE, true);
+    closeCelestialShaders.prepare(CLOSE_CELESTIAL_GLOW, true);
 }
 
 void CelestialObjectManager::renderCloseCelestials(float starAlpha, float sunMoonPosition) {
-    glUseProgram(closeCelestialShader);
-    glm::mat4 orthoProjection = glm::ortho(0.0f, static_cast<float>(WINDOW_WIDTH), 0.0f, static_cast<float>(WINDOW_HEIGHT), -1.0f, 1.0f);
-    glUniformMatrix4fv(glGetUniformLocation(closeCelestialShader, "projection"), 1, GL_FALSE, &orthoProjection[0][0]);
+    // Skipped, rather than waited for, until the deferred program has compiled
+    if (!closeCelestialShaders.isReady(CLOSE_CELESTIAL_TEXTURE) || !closeCelestialShaders.isReady(CLOSE_CELESTIAL_GLOW)) return;
+    const auto* glowShader = closeCelestialShaders.use(CLOSE_CELESTIAL_GLOW);
+    const auto* textureShader = closeCelestialShaders.use(CLOSE_CELESTIAL_TEXTURE);
+    if (!glowShader || !textureShader) return;
+    ShaderRegistry& registry = ShaderRegistry::shared();
+
+    // Blended and depth tested without writing depth; the CLOSE_CELESTIALS stage state already is, so these are elided
+    GLStateCache& state = GLStateCache::shared();
+    state.enable(GL_BLEND);
+    state.enable(GL_DEPTH_TEST);
+    state.depthFunc(GL_LEQUAL);
+    state.depthMask(GL_FALSE);
+    // Every celestial is the same quad
+    state.bindVertexArray(closeCelestialVAO);
 
     // Log timeFactor to confirm its value during rendering
     static int timeFactorFrameCounter = 0;
@@ -1934,18 +1871,18 @@ void CelestialObjectManager::renderCloseCelestials(float starAlpha, float sunMoo
         // Calculate position based on timeFactor
         float calcX = 0.0f;
         float calcY = 0.0f;
-        if (celestial.celestialType == "Sun") {
+        if (celestial.type == CloseCelestialType::SUN) {
             calcX = 0.2f + timeFactor * 0.6f; // Moves from 0.2 to 0.8
             calcY = 0.5f + 0.4f * sin(glm::radians(timeFactor * 180.0f)); // Arc from 0.5 to 0.9 to 0.5
             celestial.position.x = calcX;
             celestial.position.y = calcY;
-        } else if (celestial.celestialType == "Moon") {
+        } else if (celestial.type == CloseCelestialType::MOON) {
             float moonTimeFactor = (world->getCurrentTimeOfDay() == TimeOfDay::NIGHT) ? 0.5f : timeFactor;
             calcX = 0.1f + moonTimeFactor * 0.2f; // Shift to left: starts at 0.1, at night x = 0.2
             calcY = 0.5f + 0.4f * sin(glm::radians(moonTimeFactor * 180.0f)); // At night y = 0.9
             celestial.position.x = calcX;
             celestial.position.y = calcY;
-        } else if (celestial.celestialType == "Planet") {
+        } else if (celestial.type == CloseCelestialType::PLANET) {
             calcX = 0.2f + timeFactor * 0.1f; // Slight movement
             calcY = 0.8f - timeFactor * 0.1f; // Slight vertical adjustment
             celestial.position.x = calcX;
@@ -1954,17 +1891,17 @@ void CelestialObjectManager::renderCloseCelestials(float starAlpha, float sunMoo
 
         // Determine if the celestial should be rendered based on time of day
         bool shouldRender = false;
-        if (celestial.celestialType == "Sun") {
+        if (celestial.type == CloseCelestialType::SUN) {
             if (world->getCurrentTimeOfDay() == TimeOfDay::DAWN ||
                 world->getCurrentTimeOfDay() == TimeOfDay::MID_DAY ||
                 world->getCurrentTimeOfDay() == TimeOfDay::DUSK) {
                 shouldRender = true;
             }
-        } else if (celestial.celestialType == "Moon") {
+        } else if (celestial.type == CloseCelestialType::MOON) {
             if (world->getCurrentTimeOfDay() == TimeOfDay::NIGHT) {
                 shouldRender = true;
             }
-        } else if (celestial.celestialType == "Planet" && scene == Scene::ALIEN) {
+        } else if (celestial.type == CloseCelestialType::PLANET && scene == Scene::ALIEN) {
             if (world->getCurrentTimeOfDay() == TimeOfDay::NIGHT) {
                 shouldRender = true;
             }
@@ -1976,10 +1913,10 @@ void CelestialObjectManager::renderCloseCelestials(float starAlpha, float sunMoo
 
         // Adjust opacity based on time of day transitions
         float opacity = 1.0f;
-        if (celestial.celestialType == "Sun") {
+        if (celestial.type == CloseCelestialType::SUN) {
             // Consistent opacity for sun across DAWN, MID_DAY, DUSK
             opacity = 0.04f; // Reduced for translucency
-        } else if (celestial.celestialType == "Moon" || celestial.celestialType == "Planet") {
+        } else if (celestial.type == CloseCelestialType::MOON || celestial.type == CloseCelestialType::PLANET) {
             if (world->getCurrentTimeOfDay() == TimeOfDay::NIGHT) {
                 opacity = starAlpha;
             } else if (world->getCurrentTimeOfDay() == TimeOfDay::DUSK) {
@@ -2005,72 +1942,58 @@ void CelestialObjectManager::renderCloseCelestials(float starAlpha, float sunMoo
             renderFrameCounter = 0;
         }
 
-        // Enable blending and depth testing
-        glEnable(GL_BLEND);
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LEQUAL);
-        glDepthMask(GL_FALSE); // Prevent affecting depth buffer
-
-        if (celestial.celestialType == "Sun") {
+        if (celestial.type == CloseCelestialType::SUN) {
             // Pass 1: Render glow
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE); // Additive blending for glow
-            glUniform1i(glGetUniformLocation(closeCelestialShader, "isGlowPass"), 1);
-            glUniform3fv(glGetUniformLocation(closeCelestialShader, "tintColor"), 1, &celestial.tintColor[0]);
-            glUniform1f(glGetUniformLocation(closeCelestialShader, "opacity"), opacity);
+            state.blendFunc(GL_SRC_ALPHA, GL_ONE); // Additive blending for glow
+            registry.use(glowShader->program);
+            glowShader->uniforms.tintColor.set(celestial.tintColor);
+            glowShader->uniforms.opacity.set(opacity);
 
             glm::mat4 glowModel = glm::mat4(1.0f);
             glowModel = glm::translate(glowModel, glm::vec3(celestial.position.x * WINDOW_WIDTH, celestial.position.y * WINDOW_HEIGHT, 0.0f));
             glowModel = glm::rotate(glowModel, celestial.rotation, glm::vec3(0.0f, 0.0f, 1.0f));
             float glowScale = celestial.size * 80.0f; // Larger scale for glow
             glowModel = glm::scale(glowModel, glm::vec3(glowScale));
-            glUniformMatrix4fv(glGetUniformLocation(closeCelestialShader, "model"), 1, GL_FALSE, &glowModel[0][0]);
+            glowShader->uniforms.model.set(glowModel);
 
-            glBindVertexArray(closeCelestialVAO);
             glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-            glBindVertexArray(0);
 
             // Pass 2: Render texture
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Standard blending for texture
-            glUniform1i(glGetUniformLocation(closeCelestialShader, "isGlowPass"), 0);
-            glUniform3fv(glGetUniformLocation(closeCelestialShader, "tintColor"), 1, &celestial.tintColor[0]);
-            glUniform1f(glGetUniformLocation(closeCelestialShader, "opacity"), opacity);
+            state.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Standard blending for texture
+            registry.use(textureShader->program);
+            textureShader->uniforms.tintColor.set(celestial.tintColor);
+            textureShader->uniforms.opacity.set(opacity);
 
             glm::mat4 model = glm::mat4(1.0f);
             model = glm::translate(model, glm::vec3(celestial.position.x * WINDOW_WIDTH, celestial.position.y * WINDOW_HEIGHT, 0.0f));
             model = glm::rotate(model, celestial.rotation, glm::vec3(0.0f, 0.0f, 1.0f));
             float scale = celestial.size;
             model = glm::scale(model, glm::vec3(scale));
-            glUniformMatrix4fv(glGetUniformLocation(closeCelestialShader, "model"), 1, GL_FALSE, &model[0][0]);
+            textureShader->uniforms.model.set(model);
 
-            glBindVertexArray(closeCelestialVAO);
             glBindTexture(GL_TEXTURE_2D, celestial.texture);
             glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-            glBindVertexArray(0);
         } else {
             // Moon or Planet (texture only)
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            glUniform1i(glGetUniformLocation(closeCelestialShader, "isGlowPass"), 0);
-            glUniform3fv(glGetUniformLocation(closeCelestialShader, "tintColor"), 1, &celestial.tintColor[0]);
-            glUniform1f(glGetUniformLocation(closeCelestialShader, "opacity"), opacity);
+            state.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            registry.use(textureShader->program);
+            textureShader->uniforms.tintColor.set(celestial.tintColor);
+            textureShader->uniforms.opacity.set(opacity);
 
             glm::mat4 model = glm::mat4(1.0f);
             model = glm::translate(model, glm::vec3(celestial.position.x * WINDOW_WIDTH, celestial.position.y * WINDOW_HEIGHT, 0.0f));
             model = glm::rotate(model, celestial.rotation, glm::vec3(0.0f, 0.0f, 1.0f));
-            float scale = celestial.celestialType == "Planet" ? celestial.size * 0.5f : celestial.size;
+            float scale = celestial.type == CloseCelestialType::PLANET ? celestial.size * 0.5f : celestial.size;
             model = glm::scale(model, glm::vec3(scale));
-            glUniformMatrix4fv(glGetUniformLocation(closeCelestialShader, "model"), 1, GL_FALSE, &model[0][0]);
+            textureShader->uniforms.model.set(model);
 
-            glBindVertexArray(closeCelestialVAO);
             glBindTexture(GL_TEXTURE_2D, celestial.texture);
             glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-            glBindVertexArray(0);
         }
 
-        // Restore depth state
-        glDepthMask(GL_TRUE);
-
         renderedCelestials++;
     }
+    state.bindVertexArray(0);
 
     // Log the number of celestials rendered
     DataManager::LogDebug(DebugCategory::RENDERING, "CelestialObjectManager", "renderCloseCelestials",
@@ -135,4 +135,36 @@ void DataManager::LogWarning(const std::string& className, const std::string& me
     }
     // Also output to stderr for immediate visibility
     std::cerr << timestamp.str() << " [WARNING] " << className << "::" << methodName << " - " << message << std::endl;
-}
\ No newline at end of file
+}
+
+bool DataManager::WriteFileAtomically(const std::string& path, const FileBlock& header, const std::vector<FileBlock>& payload) {
+    std::error_code error;
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent, error);
+
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary);
+        if (!file) {
+            LogWarning("DataManager", "WriteFileAtomically", "Failed to open " + temporaryPath);
+            return false;
+        }
+        file.write(static_cast<const char*>(header.data), static_cast<std::streamsize>(header.bytes));
+        for (const FileBlock& block : payload) {
+            file.write(static_cast<const char*>(block.data), static_cast<std::streamsize>(block.bytes));
+        }
+        if (!file) {
+            LogWarning("DataManager", "WriteFileAtomically", "Failed to write " + temporaryPath);
+            file.close();
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+    }
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        LogWarning("DataManager", "WriteFileAtomically", "Failed to rename " + temporaryPath + ": " + error.message());
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,148 @@
+#include "ExhaustTrails.hpp"
+#include "GLStateCache.hpp"
+#include "StreamBuffer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+ExhaustTrails::ExhaustTrails() : activeCount(0), vao(0) {
+}
+
+ExhaustTrails::~ExhaustTrails() {
+    if (vao) GLStateCache::shared().deleteVertexArrays(1, &vao);
+}
+
+uint32_t ExhaustTrails::createTrail(const glm::vec2& position, const glm::vec3& color, float lifetime, float time) {
+    uint32_t trail;
+    if (!freeTrails.empty()) {
+        trail = freeTrails.back();
+        freeTrails.pop_back();
+    } else {
+        // Grow the pool by one trail; the slots of released trails are reused first
+        trail = static_cast<uint32_t>(heads.size());
+        heads.push_back(0);
+        counts.push_back(0);
+        lifetimes.push_back(0.0f);
+        colors.push_back(0);
+        lastPoints.push_back(glm::vec2(0.0f));
+        lastSegmentTimes.push_back(0.0f);
+        active.push_back(0);
+        segmentStarts.resize(heads.size() * SEGMENTS_PER_TRAIL);
+        segmentEnds.resize(heads.size() * SEGMENTS_PER_TRAIL);
+        segmentBirthTimes.resize(heads.size() * SEGMENTS_PER_TRAIL);
+    }
+
+    glm::vec3 rgb = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+    heads[trail] = 0;
+    counts[trail] = 0;
+    lifetimes[trail] = lifetime;
+    colors[trail] = static_cast<uint32_t>(rgb.r) | (static_cast<uint32_t>(rgb.g) << 8) | (static_cast<uint32_t>(rgb.b) << 16) | 0xFF000000u;
+    lastPoints[trail] = position;
+    lastSegmentTimes[trail] = time;
+    active[trail] = 1;
+    ++activeCount;
+    return trail;
+}
+
+void ExhaustTrails::destroyTrail(uint32_t trail) {
+    if (trail >= active.size() || !active[trail]) return;
+    active[trail] = 0;
+    counts[trail] = 0;
+    freeTrails.push_back(trail);
+    --activeCount;
+}
+
+void ExhaustTrails::clear() {
+    freeTrails.clear();
+    for (uint32_t trail = 0; trail < active.size(); ++trail) {
+        active[trail] = 0;
+        counts[trail] = 0;
+        freeTrails.push_back(trail);
+    }
+    activeCount = 0;
+}
+
+void ExhaustTrails::extend(uint32_t trail, const glm::vec2& position, float time) {
+    if (trail >= active.size() || !active[trail] || time - lastSegmentTimes[trail] < SEGMENT_INTERVAL) return;
+
+    // Segments chain from the previous end point, so the line list draws an unbroken trail
+    size_t slot = static_cast<size_t>(trail) * SEGMENTS_PER_TRAIL + heads[trail];
+    segmentStarts[slot] = lastPoints[trail];
+    segmentEnds[slot] = position;
+    segmentBirthTimes[slot] = time;
+    heads[trail] = (heads[trail] + 1) % SEGMENTS_PER_TRAIL;
+    counts[trail] = std::min(counts[trail] + 1, SEGMENTS_PER_TRAIL);
+    lastPoints[trail] = position;
+    lastSegmentTimes[trail] = time;
+}
+
+void ExhaustTrails::update(float time) {
+    for (uint32_t trail = 0; trail < active.size(); ++trail) {
+        if (!active[trail]) continue;
+        // The oldest live segment sits count slots behind the head
+        const size_t base = static_cast<size_t>(trail) * SEGMENTS_PER_TRAIL;
+        while (counts[trail] > 0) {
+            int tail = (heads[trail] - counts[trail] + SEGMENTS_PER_TRAIL) % SEGMENTS_PER_TRAIL;
+            if (time - segmentBirthTimes[base + tail] < lifetimes[trail]) break;
+            --counts[trail];
+        }
+    }
+}
+
+void ExhaustTrailUniforms::resolve(GLuint shader) {
+    time = ShaderRegistry::shared().uniform<float>(shader, "time");
+}
+
+void ExhaustTrails::render(GLuint shader, const ExhaustTrailUniforms& uniforms, float time) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    stats.trails = activeCount;
+    stats.segments = 0;
+    stats.uploadBytes = 0;
+    stats.drawCalls = 0;
+
+    vertices.clear();
+    for (uint32_t trail = 0; trail < active.size(); ++trail) {
+        if (!active[trail] || counts[trail] == 0) continue;
+        const size_t base = static_cast<size_t>(trail) * SEGMENTS_PER_TRAIL;
+        const float lifetime = lifetimes[trail];
+        const uint32_t color = colors[trail];
+        int slot = (heads[trail] - counts[trail] + SEGMENTS_PER_TRAIL) % SEGMENTS_PER_TRAIL;
+        for (int i = 0; i < counts[trail]; ++i) {
+            vertices.push_back({ segmentStarts[base + slot], segmentBirthTimes[base + slot], lifetime, color });
+            vertices.push_back({ segmentEnds[base + slot], segmentBirthTimes[base + slot], lifetime, color });
+            slot = (slot + 1) % SEGMENTS_PER_TRAIL;
+        }
+    }
+    stats.segments = vertices.size() / 2;
+    if (vertices.empty()) {
+        stats.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+        return;
+    }
+
+    stats.uploadBytes = vertices.size() * sizeof(TrailVertex);
+    StreamBuffer& stream = StreamBuffer::shared();
+    GLintptr base = stream.upload(vertices.data(), stats.uploadBytes);
+
+    // The data moves through the frame's stream region, so the attributes are pointed at it for every draw
+    if (!vao) glGenVertexArrays(1, &vao);
+    GLStateCache::shared().bindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, stream.getBuffer());
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(TrailVertex), (void*)(base + offsetof(TrailVertex, position)));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(TrailVertex), (void*)(base + offsetof(TrailVertex, birthTime)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(TrailVertex), (void*)(base + offsetof(TrailVertex, lifetime)));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(TrailVertex), (void*)(base + offsetof(TrailVertex, color)));
+    glEnableVertexAttribArray(3);
+    stats.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+    if (!ShaderRegistry::shared().use(shader)) {
+        GLStateCache::shared().bindVertexArray(0);
+        return;
+    }
+    uniforms.time.set(time);
+    glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(vertices.size()));
+    stats.drawCalls = 1;
+    GLStateCache::shared().bindVertexArray(0);
+}
@@ -0,0 +1,96 @@
+#include "GLStateCache.hpp"
+
+GLStateCache& GLStateCache::shared() {
+    static GLStateCache cache;
+    return cache;
+}
+
+void GLStateCache::setCapability(GLenum capability, bool enabled) {
+    auto it = capabilities.find(capability);
+    if (it != capabilities.end() && it->second == enabled) {
+        ++frameStats.elided;
+        return;
+    }
+    capabilities[capability] = enabled;
+    ++frameStats.issued;
+    if (enabled) {
+        glEnable(capability);
+    } else {
+        glDisable(capability);
+    }
+}
+
+void GLStateCache::depthMask(GLboolean write) {
+    if (change(depthWrite, write)) glDepthMask(write);
+}
+
+void GLStateCache::depthFunc(GLenum func) {
+    if (change(depthFunction, func)) glDepthFunc(func);
+}
+
+void GLStateCache::depthRange(float nearValue, float farValue) {
+    if (change(currentDepthRange, DepthRange{ nearValue, farValue })) glDepthRange(nearValue, farValue);
+}
+
+void GLStateCache::blendFunc(GLenum source, GLenum destination) {
+    if (change(blendFunction, BlendFunction{ source, destination })) glBlendFunc(source, destination);
+}
+
+void GLStateCache::blendEquation(GLenum mode) {
+    if (change(blendMode, mode)) glBlendEquation(mode);
+}
+
+void GLStateCache::viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    if (change(currentViewport, Viewport{ x, y, width, height })) glViewport(x, y, width, height);
+}
+
+void GLStateCache::useProgram(GLuint program) {
+    if (change(currentProgram, program)) glUseProgram(program);
+}
+
+void GLStateCache::bindVertexArray(GLuint vertexArray) {
+    if (change(currentVertexArray, vertexArray)) glBindVertexArray(vertexArray);
+}
+
+void GLStateCache::deleteProgram(GLuint program) {
+    if (!program) return;
+    // The driver keeps a deleted program in use until another one is, so leave the binding as it is but make
+    // sure the next use of the name is issued
+    if (currentProgram.known && currentProgram.value == program) currentProgram.known = false;
+    glDeleteProgram(program);
+}
+
+void GLStateCache::deleteVertexArrays(GLsizei count, const GLuint* vertexArrays) {
+    // Deleting the bound vertex array binds 0 instead
+    for (GLsizei i = 0; i < count; ++i) {
+        if (currentVertexArray.known && vertexArrays[i] && currentVertexArray.value == vertexArrays[i]) currentVertexArray.value = 0;
+    }
+    glDeleteVertexArrays(count, vertexArrays);
+}
+
+void GLStateCache::apply(const RenderState& state) {
+    setCapability(GL_DEPTH_TEST, state.depthTest);
+    depthMask(state.depthWrite ? GL_TRUE : GL_FALSE);
+    depthFunc(state.depthFunc);
+    depthRange(state.depthNear, state.depthFar);
+    setCapability(GL_BLEND, state.blend);
+    blendFunc(state.blendSource, state.blendDestination);
+    setCapability(GL_CULL_FACE, state.cullFace);
+}
+
+void GLStateCache::invalidate() {
+    capabilities.clear();
+    depthWrite.known = false;
+    depthFunction.known = false;
+    currentDepthRange.known = false;
+    blendFunction.known = false;
+    blendMode.known = false;
+    currentViewport.known = false;
+    currentProgram.known = false;
+    currentVertexArray.known = false;
+}
+
+void GLStateCache::newFrame() {
+    stats = frameStats;
+    frameStats = GLStateCacheStats();
+}
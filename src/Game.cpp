@@ -1,5 +1,6 @@
 #include "Game.hpp"
 #include "DataManager.hpp"
+#include "GLStateCache.hpp"
 #include <Constants.hpp>
 
 Game::Game() : window(nullptr), context(nullptr), running(false), numPlayers(INITIAL_PLAYER_COUNT) {}
@@ -12,6 +13,8 @@ Game::~Game() {
 }
 
 bool Game::initialize() {
+    startTime = std::chrono::high_resolution_clock::now();
+
     if (!SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS)) {
         DataManager::LogError("Game", "initialize", "SDL_Init failed: " + std::string(SDL_GetError()));
         return false;
@@ -46,7 +49,7 @@ bool Game::initialize() {
         return false;
     }
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLStateCache::shared().viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 
     // Initialize systems
     dataManager = std::make_unique<DataManager>();
@@ -72,6 +75,7 @@ bool Game::initialize() {
 
 void Game::run() {
     Uint64 lastTime = SDL_GetTicks();
+    bool firstFrame = true;
     while (running) {
         SDL_Event event;
         while (SDL_PollEvent(&event)) {
@@ -96,12 +100,22 @@ void Game::run() {
         world->update(dt);
         renderer->render(dt);
 
-        // Render ImGui
+        // Render ImGui; the backend puts back the GL state it changes, so GLStateCache stays in step
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
         SDL_GL_SwapWindow(window);
 
+        if (firstFrame) {
+            firstFrame = false;
+            float milliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+            renderer->setTimeToFirstFrame(milliseconds);
+            DataManager::LogDebug(DebugCategory::GAME_LOOP, "Game", "run", "Time to first frame: " + std::to_string(milliseconds) + " ms, " +
+                (ShaderRegistry::shared().isDeferredCompilation() ? "deferred" : "serial") + " shader compilation");
+            // Whatever was put off to get here is compiled now, while the next frames are drawn
+            ShaderRegistry::shared().submitDeferred();
+        }
+
         // Cap the frame rate to ~60 FPS
         Uint64 frameTime = SDL_GetTicks() - currentTime;
         const Uint64 targetFrameTime = 1000 / 60; // 16.67 ms for 60 FPS
@@ -0,0 +1,53 @@
+#include "GpuTimer.hpp"
+
+GpuTimer::GpuTimer() : writeIndex(0), active(false), milliseconds(0.0f) {
+    for (int i = 0; i < QUERY_COUNT; ++i) {
+        queries[i] = 0;
+        pending[i] = false;
+    }
+}
+
+GpuTimer::~GpuTimer() {
+    if (queries[0]) glDeleteQueries(QUERY_COUNT, queries);
+}
+
+void GpuTimer::begin() {
+    if (!queries[0]) {
+        glGenQueries(QUERY_COUNT, queries);
+    }
+
+    collectResults();
+
+    // All queries still in flight: skip this measurement rather than wait on the GPU
+    if (pending[writeIndex]) return;
+
+    glBeginQuery(GL_TIME_ELAPSED, queries[writeIndex]);
+    active = true;
+}
+
+void GpuTimer::end() {
+    if (!active) return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    pending[writeIndex] = true;
+    writeIndex = (writeIndex + 1) % QUERY_COUNT;
+    active = false;
+}
+
+void GpuTimer::collectResults() {
+    for (int i = 0; i < QUERY_COUNT; ++i) {
+        if (!pending[i]) continue;
+
+        GLint available = 0;
+        glGetQueryObjectiv(queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) continue;
+
+        GLuint64 elapsedNs = 0;
+        glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &elapsedNs);
+        pending[i] = false;
+
+        float sample = static_cast<float>(elapsedNs) / 1000000.0f;
+        // Light exponential smoothing keeps the debug readout legible
+        milliseconds = (milliseconds == 0.0f) ? sample : milliseconds * 0.9f + sample * 0.1f;
+    }
+}
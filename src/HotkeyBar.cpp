@@ -0,0 +1,123 @@
+#include "HotkeyBar.hpp"
+#include "GLStateCache.hpp"
+#include <algorithm>
+#include <glm/gtc/matrix_transform.hpp>
+
+HotkeyBar::HotkeyBar() : layoutFont(-1), layoutWidth(0), layoutHeight(0), uploadedEnabled(0), colorsValid(false),
+    vao(0), geometryVbo(0), colorVbo(0), vertexCount(0) {
+}
+
+HotkeyBar::~HotkeyBar() {
+    if (vao) GLStateCache::shared().deleteVertexArrays(1, &vao);
+    if (geometryVbo) glDeleteBuffers(1, &geometryVbo);
+    if (colorVbo) glDeleteBuffers(1, &colorVbo);
+}
+
+void HotkeyBar::setItems(const std::vector<std::string>& newLabels) {
+    labels.assign(newLabels.begin(), newLabels.begin() + std::min(newLabels.size(), static_cast<size_t>(MAX_ITEMS)));
+    invalidate();
+}
+
+void HotkeyBar::layout(TextRenderer& text, int font, int viewportWidth, int viewportHeight) {
+    if (!vao) {
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &geometryVbo);
+        glGenBuffers(1, &colorVbo);
+        GLStateCache::shared().bindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, geometryVbo);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)(2 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glBindBuffer(GL_ARRAY_BUFFER, colorVbo);
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(uint32_t), (void*)0);
+        glEnableVertexAttribArray(2);
+    }
+
+    // Flow the labels into rows no wider than half the viewport, each row centered
+    const float maxWidth = viewportWidth * 0.5f;
+    std::vector<float> widths(labels.size());
+    for (size_t i = 0; i < labels.size(); ++i) {
+        widths[i] = std::max(text.measure(font, labels[i]) * SCALE, 10.0f);
+    }
+
+    geometryScratch.clear();
+    itemFirstVertex.assign(labels.size() + 1, 0);
+    size_t rowStart = 0;
+    int row = 0;
+    while (rowStart < labels.size()) {
+        size_t rowEnd = rowStart;
+        float rowWidth = 0.0f;
+        while (rowEnd < labels.size()) {
+            float entryWidth = widths[rowEnd] + (rowEnd == rowStart ? 0.0f : SPACING);
+            if (rowWidth + entryWidth > maxWidth && rowEnd > rowStart) break;
+            rowWidth += entryWidth;
+            ++rowEnd;
+        }
+
+        float xPos = (viewportWidth - rowWidth) / 2.0f;
+        float yPos = BASE_Y + row * ROW_HEIGHT;
+        for (size_t i = rowStart; i < rowEnd; ++i) {
+            itemFirstVertex[i] = static_cast<GLint>(geometryScratch.size());
+            text.layout(font, labels[i], xPos, yPos, SCALE, geometryScratch);
+            xPos += widths[i] + SPACING;
+        }
+        rowStart = rowEnd;
+        ++row;
+    }
+    itemFirstVertex[labels.size()] = static_cast<GLint>(geometryScratch.size());
+    vertexCount = static_cast<GLsizei>(geometryScratch.size());
+
+    glBindBuffer(GL_ARRAY_BUFFER, geometryVbo);
+    glBufferData(GL_ARRAY_BUFFER, geometryScratch.size() * sizeof(glm::vec4), geometryScratch.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, colorVbo);
+    glBufferData(GL_ARRAY_BUFFER, geometryScratch.size() * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    colorScratch.resize(geometryScratch.size());
+    colorsValid = false;
+
+    layoutFont = font;
+    layoutWidth = viewportWidth;
+    layoutHeight = viewportHeight;
+    stats.glyphs = geometryScratch.size() / 6;
+    ++stats.layouts;
+}
+
+void HotkeyBar::uploadColors(uint32_t enabled) {
+    // Green when on, white when off, written into every vertex of the item
+    const uint32_t enabledColor = 0xFF00FF00u;
+    const uint32_t disabledColor = 0xFFFFFFFFu;
+    for (size_t item = 0; item < labels.size(); ++item) {
+        uint32_t color = (enabled >> item) & 1u ? enabledColor : disabledColor;
+        std::fill(colorScratch.begin() + itemFirstVertex[item], colorScratch.begin() + itemFirstVertex[item + 1], color);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, colorVbo);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, colorScratch.size() * sizeof(uint32_t), colorScratch.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    uploadedEnabled = enabled;
+    colorsValid = true;
+    ++stats.colorUploads;
+}
+
+void HotkeyBar::render(GLuint shader, const TextUniforms& uniforms, TextRenderer& text, int font, uint32_t enabled, int viewportWidth, int viewportHeight) {
+    stats.drawCalls = 0;
+    if (font != layoutFont || viewportWidth != layoutWidth || viewportHeight != layoutHeight) {
+        layout(text, font, viewportWidth, viewportHeight);
+    }
+    if (vertexCount == 0) return;
+    if (!colorsValid || enabled != uploadedEnabled) {
+        uploadColors(enabled);
+    }
+
+    glm::mat4 orthoProjection = glm::ortho(0.0f, static_cast<float>(viewportWidth), 0.0f, static_cast<float>(viewportHeight));
+    if (!ShaderRegistry::shared().use(shader)) return;
+    uniforms.projection.set(orthoProjection);
+    uniforms.text.set(0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, text.getAtlasTexture());
+    GLStateCache::shared().bindVertexArray(vao);
+    glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+    stats.drawCalls = 1;
+    GLStateCache::shared().bindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
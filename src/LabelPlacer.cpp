@@ -0,0 +1,176 @@
+#include "LabelPlacer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+
+LabelPlacer::LabelPlacer() : candidateCount(0), frame(0), viewportWidth(0), viewportHeight(0), cellsY(0), wordsPerRow(0) {
+}
+
+void LabelPlacer::setViewport(int width, int height) {
+    if (width == viewportWidth && height == viewportHeight) return;
+    viewportWidth = width;
+    viewportHeight = height;
+    cellsY = (height + CELL_SIZE - 1) / CELL_SIZE + 1;
+    wordsPerRow = ((width + CELL_SIZE - 1) / CELL_SIZE + 1 + 63) / 64;
+    occupancy.assign(static_cast<size_t>(cellsY) * wordsPerRow, 0);
+}
+
+void LabelPlacer::setSkyline(const std::vector<float>& newSkyline) {
+    skyline.assign(newSkyline.begin(), newSkyline.end());
+}
+
+void LabelPlacer::add(const std::string& text, const glm::vec2& anchor, float gap, const glm::vec2& size, float scale,
+    const glm::vec3& color, LabelPriority priority) {
+    if (candidateCount == candidates.size()) {
+        candidates.emplace_back();
+    }
+    Candidate& candidate = candidates[candidateCount++];
+    candidate.text.assign(text);
+    candidate.key = std::hash<std::string>()(text) * 4 + static_cast<uint64_t>(priority);
+    candidate.anchor = anchor;
+    candidate.gap = gap;
+    candidate.size = size;
+    candidate.scale = scale;
+    candidate.color = color;
+    candidate.priority = priority;
+}
+
+glm::vec4 LabelPlacer::spotRect(const Candidate& candidate, int spot) const {
+    const glm::vec2& anchor = candidate.anchor;
+    const glm::vec2& size = candidate.size;
+    float halfWidth = size.x * 0.5f;
+    switch (spot) {
+        case 0: return glm::vec4(anchor.x - halfWidth, anchor.y + candidate.gap, anchor.x + halfWidth, anchor.y + candidate.gap + size.y);
+        case 1: return glm::vec4(anchor.x - halfWidth, anchor.y - candidate.gap - size.y, anchor.x + halfWidth, anchor.y - candidate.gap);
+        case 2: return glm::vec4(anchor.x + candidate.gap, anchor.y - size.y * 0.5f, anchor.x + candidate.gap + size.x, anchor.y + size.y * 0.5f);
+        default: return glm::vec4(anchor.x - candidate.gap - size.x, anchor.y - size.y * 0.5f, anchor.x - candidate.gap, anchor.y + size.y * 0.5f);
+    }
+}
+
+bool LabelPlacer::isFree(const glm::vec4& rect) const {
+    if (rect.x < 0.0f || rect.y < 0.0f || rect.z > viewportWidth || rect.w > viewportHeight) return false;
+
+    // The bottom edge has to clear the terrain at both ends and in the middle
+    if (skyline.size() > 1) {
+        const float columnScale = static_cast<float>(skyline.size() - 1) / viewportWidth;
+        const float xs[] = { rect.x, (rect.x + rect.z) * 0.5f, rect.z };
+        for (float x : xs) {
+            size_t column = std::min(static_cast<size_t>(x * columnScale), skyline.size() - 1);
+            if (rect.y < skyline[column]) return false;
+        }
+    }
+
+    // Any cell the rectangle touches counts, so labels keep up to a cell apart
+    const int minCellX = static_cast<int>(rect.x) / CELL_SIZE, maxCellX = static_cast<int>(rect.z) / CELL_SIZE;
+    const int minCellY = static_cast<int>(rect.y) / CELL_SIZE, maxCellY = static_cast<int>(rect.w) / CELL_SIZE;
+    for (int cellY = minCellY; cellY <= maxCellY; ++cellY) {
+        const uint64_t* row = &occupancy[static_cast<size_t>(cellY) * wordsPerRow];
+        for (int word = minCellX / 64; word <= maxCellX / 64; ++word) {
+            if (row[word] & spanMask(word, minCellX, maxCellX)) return false;
+        }
+    }
+    return true;
+}
+
+void LabelPlacer::insert(const glm::vec4& rect) {
+    const int minCellX = static_cast<int>(rect.x) / CELL_SIZE, maxCellX = static_cast<int>(rect.z) / CELL_SIZE;
+    const int minCellY = static_cast<int>(rect.y) / CELL_SIZE, maxCellY = static_cast<int>(rect.w) / CELL_SIZE;
+    for (int cellY = minCellY; cellY <= maxCellY; ++cellY) {
+        uint64_t* row = &occupancy[static_cast<size_t>(cellY) * wordsPerRow];
+        for (int word = minCellX / 64; word <= maxCellX / 64; ++word) {
+            row[word] |= spanMask(word, minCellX, maxCellX);
+        }
+    }
+}
+
+uint64_t LabelPlacer::spanMask(int word, int minCell, int maxCell) {
+    // Bits minCell to maxCell of the row, as far as they fall into this word
+    int first = std::max(minCell - word * 64, 0);
+    int last = std::min(maxCell - word * 64, 63);
+    uint64_t upTo = last == 63 ? ~0ull : (1ull << (last + 1)) - 1;
+    return upTo & ~((1ull << first) - 1);
+}
+
+const std::vector<PlacedLabel>& LabelPlacer::place() {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    ++frame;
+    placed.clear();
+    std::fill(occupancy.begin(), occupancy.end(), 0);
+    stats = LabelPlacerStats();
+    stats.candidates = candidateCount;
+
+    // One history lookup per candidate; references into the map survive later insertions
+    states.resize(candidateCount);
+    buckets.resize(candidateCount);
+    for (size_t i = 0; i < candidateCount; ++i) {
+        History& state = history.emplace(candidates[i].key, History{ frame, 0, 0, false }).first->second;
+        if (state.lastFrame + 1 < frame) {
+            // Not seen last frame, so it starts over
+            state.visible = false;
+            state.freeFrames = 0;
+        }
+        state.lastFrame = frame;
+        states[i] = &state;
+        buckets[i] = static_cast<uint8_t>((static_cast<uint32_t>(LabelPriority::COUNT) - 1 - static_cast<uint32_t>(candidates[i].priority)) * 2 +
+            (state.visible ? 0 : 1));
+    }
+
+    // Counting sort into buckets by priority, and within one by whether the label was shown last frame
+    const uint32_t bucketCount = static_cast<uint32_t>(LabelPriority::COUNT) * 2;
+    bucketStarts.assign(bucketCount + 1, 0);
+    for (size_t i = 0; i < candidateCount; ++i) {
+        ++bucketStarts[buckets[i] + 1];
+    }
+    for (uint32_t bucket = 0; bucket < bucketCount; ++bucket) {
+        bucketStarts[bucket + 1] += bucketStarts[bucket];
+    }
+    order.resize(candidateCount);
+    for (size_t i = 0; i < candidateCount; ++i) {
+        order[bucketStarts[buckets[i]]++] = static_cast<uint32_t>(i);
+    }
+
+    for (uint32_t index : order) {
+        const Candidate& candidate = candidates[index];
+        History& state = *states[index];
+
+        // The last spot first, so a label does not hop between equally good spots
+        int found = -1;
+        glm::vec4 rect;
+        for (int attempt = 0; attempt <= SPOT_COUNT && found < 0; ++attempt) {
+            int spot = attempt == 0 ? state.spot : attempt - 1;
+            if (attempt > 0 && spot == state.spot) continue;
+            rect = spotRect(candidate, spot);
+            if (isFree(rect)) found = spot;
+        }
+
+        if (found < 0) {
+            state.visible = false;
+            state.freeFrames = 0;
+            ++stats.hidden;
+            continue;
+        }
+        state.spot = static_cast<uint8_t>(found);
+        insert(rect);
+        if (!state.visible) {
+            state.freeFrames = static_cast<uint8_t>(std::min<int>(state.freeFrames + 1, SHOW_DELAY_FRAMES));
+            state.visible = state.freeFrames >= SHOW_DELAY_FRAMES;
+        }
+        if (state.visible) {
+            placed.push_back({ &candidate.text, glm::vec2((rect.x + rect.z) * 0.5f, rect.y), candidate.scale, candidate.color });
+        } else {
+            ++stats.pending;
+        }
+    }
+    stats.placed = placed.size();
+
+    // Forget labels that have been gone a while, a little at a time
+    if (frame % FORGET_FRAMES == 0) {
+        for (auto it = history.begin(); it != history.end();) {
+            it = frame - it->second.lastFrame > FORGET_FRAMES ? history.erase(it) : std::next(it);
+        }
+    }
+
+    candidateCount = 0;
+    stats.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+    return placed;
+}
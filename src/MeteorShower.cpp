@@ -0,0 +1,218 @@
+#include "MeteorShower.hpp"
+#include "Constants.hpp"
+#include "ThreadPool.hpp"
+#include "GLStateCache.hpp"
+#include "StreamBuffer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+MeteorShower::MeteorShower()
+    : motions(CAPACITY), timings(CAPACITY), head(0), tail(0), uploadedHead(0),
+    showerEnabled(false), showerMeteors(20000), radiant(0.75f, 0.85f), spawnDebt(0.0f), sporadicTimer(0.0f),
+    vao(0), cornerVbo(0), instanceVbo(0) {
+    std::random_device device;
+    std::seed_seq seeds{ device(), device(), device(), device() };
+    std::vector<uint32_t> streamSeeds((CAPACITY + SPAWN_CHUNK - 1) / SPAWN_CHUNK);
+    seeds.generate(streamSeeds.begin(), streamSeeds.end());
+    for (uint32_t seed : streamSeeds) {
+        streams.emplace_back(seed);
+    }
+}
+
+MeteorShower::~MeteorShower() {
+    if (vao) GLStateCache::shared().deleteVertexArrays(1, &vao);
+    if (cornerVbo) glDeleteBuffers(1, &cornerVbo);
+    if (instanceVbo) glDeleteBuffers(1, &instanceVbo);
+}
+
+void MeteorShower::setShowerMeteors(int count) {
+    showerMeteors = std::clamp(count, MIN_SHOWER_METEORS, MAX_SHOWER_METEORS);
+}
+
+void MeteorShower::clear() {
+    head = 0;
+    tail = 0;
+    uploadedHead = 0;
+    spawnDebt = 0.0f;
+}
+
+void MeteorShower::update(float dt, float time, bool night) {
+    stats.spawned = 0;
+    if (!night) {
+        clear();
+        stats.ringSlots = 0;
+        return;
+    }
+
+    // Meteors are in spawn order, so the tail moves past every one whose lifetime has ended.
+    // Shorter-lived meteors behind a longer-lived one wait for it; the shader already hides them.
+    while (tail < head) {
+        const glm::vec4& timing = timings[tail % CAPACITY];
+        if (time - timing.x < timing.y) break;
+        ++tail;
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    sporadicTimer -= dt;
+    if (sporadicTimer <= 0.0f && head - tail < CAPACITY) {
+        spawnSporadic(time);
+        sporadicTimer = std::uniform_real_distribution<float>(5.0f, 15.0f)(streams[0]);
+    }
+
+    if (showerEnabled) {
+        // Spawning at count / mean lifetime per second keeps about count meteors in the sky
+        spawnDebt += showerMeteors / MEAN_SHOWER_LIFETIME * dt;
+        // Should the ring ever be full, what does not fit waits for the next update instead of being dropped
+        size_t count = std::min(static_cast<size_t>(spawnDebt), CAPACITY - (head - tail));
+        spawnDebt = std::min(spawnDebt - static_cast<float>(count), static_cast<float>(CAPACITY));
+        if (count > 0) spawnShower(count, time);
+    }
+    stats.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+    stats.ringSlots = head - tail;
+}
+
+void MeteorShower::spawnSporadic(float time) {
+    // Same look as the single shooting stars before: from the top edge, down and to the left
+    std::mt19937& random = streams[0];
+    std::uniform_real_distribution<float> probDist(0.0f, 1.0f);
+    std::uniform_real_distribution<float> angleDist(30.0f, 60.0f);
+    std::uniform_real_distribution<float> brightnessDist(0.3f, 1.2f);
+    std::uniform_real_distribution<float> lifetimeVariation(-0.5f, 0.5f);
+
+    float angle = glm::radians(angleDist(random));
+    glm::vec2 velocity = glm::vec2(-std::cos(angle), -std::sin(angle)) * 0.5f;
+    float brightness = brightnessDist(random);
+    float brightnessFactor = (brightness - 0.3f) / 0.9f;
+    float lifetime = glm::clamp(0.5f + brightnessFactor * 1.5f + lifetimeVariation(random) * 0.2f, 0.5f, MAX_LIFETIME);
+
+    size_t slot = head % CAPACITY;
+    motions[slot] = glm::vec4(probDist(random), 1.0f, velocity.x, velocity.y);
+    timings[slot] = glm::vec4(time, lifetime, brightness, 0.06f);
+    ++head;
+    ++stats.spawned;
+}
+
+void MeteorShower::spawnShower(size_t count, float time) {
+    const float aspectRatio = static_cast<float>(WINDOW_WIDTH) / WINDOW_HEIGHT;
+    const size_t first = head;
+    const glm::vec2 showerRadiant = radiant;
+
+    // Every chunk draws from its own stream, so the chunks can run on any thread in any order
+    ThreadPool::shared().parallelFor(static_cast<int>(count), SPAWN_CHUNK, [&](int begin, int end, int chunk) {
+        std::mt19937& random = streams[chunk];
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        for (int i = begin; i < end; ++i) {
+            // Uniform over the sky above the horizon, streaking straight away from the radiant.
+            // Meteors close to the radiant are seen head-on, so they are slower and shorter.
+            glm::vec2 start(unit(random), 0.25f + 0.75f * unit(random));
+            glm::vec2 offset = (start - showerRadiant) * glm::vec2(aspectRatio, 1.0f);
+            float distance = std::max(glm::length(offset), 1e-3f);
+            glm::vec2 direction = offset / distance;
+            float foreshortening = std::min(distance, 1.0f);
+            float speed = (0.15f + 0.6f * foreshortening) * (0.8f + 0.4f * unit(random)); // screen heights per second
+            float lifetime = 0.4f + 1.2f * unit(random);
+            float faint = unit(random);
+            float brightness = 0.2f + 1.0f * faint * faint * faint; // mostly faint, a few bright ones
+            float streak = foreshortening * (0.03f + 0.09f * unit(random));
+
+            size_t slot = (first + i) % CAPACITY;
+            motions[slot] = glm::vec4(start.x, start.y, direction.x * speed / aspectRatio, direction.y * speed);
+            timings[slot] = glm::vec4(time, lifetime, brightness, streak);
+        }
+    });
+    head += count;
+    stats.spawned += count;
+}
+
+void MeteorShower::upload(size_t first, size_t count) {
+    // The slots overwritten here were drawn from a few frames ago, maybe by frames the GPU has not finished, so
+    // the new meteors go through the stream buffer and are copied into the ring on the GPU, in order with those
+    // draws, instead of being written with glBufferSubData, which may wait for them.
+    // Split at the end of the ring; each piece updates the same slots of both attribute blocks.
+    StreamBuffer& stream = StreamBuffer::shared();
+    while (count > 0) {
+        size_t slot = first % CAPACITY;
+        size_t piece = std::min(count, CAPACITY - slot);
+        GLsizeiptr bytes = static_cast<GLsizeiptr>(piece * sizeof(glm::vec4));
+        GLintptr motionOffset = stream.upload(&motions[slot], bytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, stream.getBuffer());
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_ARRAY_BUFFER, motionOffset, slot * sizeof(glm::vec4), bytes);
+        // A second upload may move to a larger stream buffer, so the source is bound again
+        GLintptr timingOffset = stream.upload(&timings[slot], bytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, stream.getBuffer());
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_ARRAY_BUFFER, timingOffset, (CAPACITY + slot) * sizeof(glm::vec4), bytes);
+        stats.uploadBytes += 2 * piece * sizeof(glm::vec4);
+        first += piece;
+        count -= piece;
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+}
+
+void MeteorShower::bindInstances(size_t firstSlot) {
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)(firstSlot * sizeof(glm::vec4)));
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)((CAPACITY + firstSlot) * sizeof(glm::vec4)));
+}
+
+void MeteorShowerUniforms::resolve(GLuint shader) {
+    ShaderRegistry& registry = ShaderRegistry::shared();
+    time = registry.uniform<float>(shader, "time");
+    alpha = registry.uniform<float>(shader, "alpha");
+    viewportSize = registry.uniform<glm::vec2>(shader, "viewportSize");
+}
+
+void MeteorShower::render(GLuint shader, const MeteorShowerUniforms& uniforms, float time, float alpha) {
+    stats.uploadBytes = 0;
+    stats.drawCalls = 0;
+    if (head == tail) return;
+
+    if (!vao) {
+        // One quad per meteor, as a strip: x runs from the tail (0) to the head (1), y across the streak
+        const float corners[] = { 0.0f, -1.0f, 1.0f, -1.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &cornerVbo);
+        glGenBuffers(1, &instanceVbo);
+        GLStateCache::shared().bindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, cornerVbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+        glBufferData(GL_ARRAY_BUFFER, 2 * CAPACITY * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+        glEnableVertexAttribArray(1);
+        glVertexAttribDivisor(1, 1);
+        glEnableVertexAttribArray(2);
+        glVertexAttribDivisor(2, 1);
+    } else {
+        GLStateCache::shared().bindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+    }
+
+    // Only meteors spawned since the last frame are uploaded
+    uploadedHead = std::max(uploadedHead, tail);
+    upload(uploadedHead, head - uploadedHead);
+    uploadedHead = head;
+
+    if (!ShaderRegistry::shared().use(shader)) {
+        GLStateCache::shared().bindVertexArray(0);
+        return;
+    }
+    uniforms.time.set(time);
+    uniforms.alpha.set(alpha);
+    uniforms.viewportSize.set(glm::vec2(static_cast<float>(WINDOW_WIDTH), static_cast<float>(WINDOW_HEIGHT)));
+
+    // The live range is one draw, or two where it wraps around the end of the ring
+    size_t firstSlot = tail % CAPACITY;
+    size_t count = head - tail;
+    size_t piece = std::min(count, CAPACITY - firstSlot);
+    bindInstances(firstSlot);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(piece));
+    stats.drawCalls = 1;
+    if (count > piece) {
+        bindInstances(0);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(count - piece));
+        stats.drawCalls = 2;
+    }
+    GLStateCache::shared().bindVertexArray(0);
+}
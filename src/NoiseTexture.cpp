@@ -0,0 +1,123 @@
+#include "NoiseTexture.hpp"
+#include "DataManager.hpp"
+#include "ThreadPool.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+NoiseTexture::NoiseTexture() : texture(0) {
+}
+
+NoiseTexture::~NoiseTexture() {
+    if (texture) glDeleteTextures(1, &texture);
+}
+
+// Lattice value in [0, 1) for a cell of one channel, from an integer hash so every platform bakes the same tile
+static float latticeValue(uint32_t seed, uint32_t channel, uint32_t x, uint32_t y) {
+    uint32_t h = seed ^ (channel * 0x9E3779B9u) ^ (x * 0x85EBCA6Bu) ^ (y * 0xC2B2AE35u);
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    return static_cast<float>(h >> 8) / 16777216.0f;
+}
+
+std::vector<uint8_t> NoiseTexture::bake(const NoiseTextureParameters& params) {
+    const int size = params.size;
+    std::vector<uint8_t> texels(static_cast<size_t>(size) * size * 4);
+    ThreadPool::shared().parallelFor(size, 16, [&](int begin, int end, int) {
+        for (int y = begin; y < end; ++y) {
+            uint8_t* row = &texels[static_cast<size_t>(y) * size * 4];
+            for (int channel = 0; channel < 4; ++channel) {
+                // Lattice coordinates wrap at the channel's cell count, which makes the tile seamless
+                const uint32_t cells = static_cast<uint32_t>(params.period) << channel;
+                const float cellsPerTexel = static_cast<float>(cells) / size;
+                float cy = (y + 0.5f) * cellsPerTexel;
+                uint32_t y0 = static_cast<uint32_t>(cy) % cells;
+                uint32_t y1 = (y0 + 1) % cells;
+                float fy = cy - std::floor(cy);
+                float uy = fy * fy * (3.0f - 2.0f * fy);
+                for (int x = 0; x < size; ++x) {
+                    float cx = (x + 0.5f) * cellsPerTexel;
+                    uint32_t x0 = static_cast<uint32_t>(cx) % cells;
+                    uint32_t x1 = (x0 + 1) % cells;
+                    float fx = cx - std::floor(cx);
+                    float ux = fx * fx * (3.0f - 2.0f * fx);
+                    float bottom = latticeValue(params.seed, channel, x0, y0) * (1.0f - ux) + latticeValue(params.seed, channel, x1, y0) * ux;
+                    float top = latticeValue(params.seed, channel, x0, y1) * (1.0f - ux) + latticeValue(params.seed, channel, x1, y1) * ux;
+                    float value = bottom * (1.0f - uy) + top * uy;
+                    row[x * 4 + channel] = static_cast<uint8_t>(value * 255.0f + 0.5f);
+                }
+            }
+        }
+    });
+    return texels;
+}
+
+std::string NoiseTexture::cachePath(const NoiseTextureParameters& params, const std::string& cacheDirectory) {
+    std::string name = "noise_" + std::to_string(params.seed) + "_" + std::to_string(params.size) + "_" + std::to_string(params.period) +
+        "_v" + std::to_string(FILE_VERSION) + ".bin";
+    return (std::filesystem::path(cacheDirectory) / name).string();
+}
+
+bool NoiseTexture::load(const std::string& path, const NoiseTextureParameters& params, std::vector<uint8_t>& texels) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    FileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.magic, "CNOI", 4) != 0 ||
+        header.version != FILE_VERSION || header.seed != params.seed || header.size != static_cast<uint32_t>(params.size) ||
+        header.period != static_cast<uint32_t>(params.period)) {
+        DataManager::LogWarning("NoiseTexture", "load", path + " does not match the requested noise; baking it again");
+        return false;
+    }
+    texels.resize(static_cast<size_t>(params.size) * params.size * 4);
+    if (!file.read(reinterpret_cast<char*>(texels.data()), texels.size())) {
+        DataManager::LogWarning("NoiseTexture", "load", path + " is truncated; baking it again");
+        return false;
+    }
+    return true;
+}
+
+bool NoiseTexture::save(const std::string& path, const NoiseTextureParameters& params, const std::vector<uint8_t>& texels) {
+    FileHeader header = { { 'C', 'N', 'O', 'I' }, FILE_VERSION, params.seed, static_cast<uint32_t>(params.size),
+        static_cast<uint32_t>(params.period), 0 };
+    return DataManager::WriteFileAtomically(path, { &header, sizeof(header) }, { { texels.data(), texels.size() } });
+}
+
+bool NoiseTexture::create(const NoiseTextureParameters& params, const std::string& cacheDirectory) {
+    if (params.size <= 0 || (params.size & (params.size - 1)) != 0 || params.period <= 0 || params.size % (params.period * 8) != 0) {
+        DataManager::LogError("NoiseTexture", "create", "Noise size must be a power of two and a multiple of eight times the period");
+        return false;
+    }
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    std::string path = cachePath(params, cacheDirectory);
+    std::vector<uint8_t> texels;
+    stats = NoiseTextureStats();
+    stats.size = params.size;
+    stats.fromCache = load(path, params, texels);
+    if (!stats.fromCache) {
+        texels = bake(params);
+        stats.threads = ThreadPool::shared().getThreadCount() + 1;
+        save(path, params, texels);
+    }
+
+    if (!texture) glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, params.size, params.size, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    parameters = params;
+
+    stats.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+    DataManager::LogDebug(DebugCategory::RENDERING, "NoiseTexture", "create",
+        std::string(stats.fromCache ? "Loaded " : "Baked ") + path + " in " + std::to_string(stats.milliseconds) + " ms");
+    return true;
+}
@@ -0,0 +1,177 @@
+#include "PoissonDiskSampler.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Cells left empty hold this, far enough from any point that the distance test rejects them without a branch
+static const float EMPTY_CELL = -1.0e18f;
+
+struct PoissonGrid {
+    float width;
+    float height;
+    float radius;
+    float cellSize;
+    float inverseCellSize;
+    int gridWidth;
+    int gridHeight;
+    int stride;   // of the cell rows, which carry a border of BORDER empty cells on every side
+    int tileCells;
+    int attempts;
+    std::vector<glm::vec2> cells; // EMPTY_CELL in x marks an empty cell
+
+    // With cells of radius / sqrt(2), any conflicting point lies within two cells, so the border spares the
+    // lookups any bounds checks
+    static const int BORDER = 2;
+
+    glm::vec2& cell(int x, int y) { return cells[(y + BORDER) * stride + x + BORDER]; }
+
+    bool fits(const glm::vec2& p) const {
+        int cx = static_cast<int>(p.x * inverseCellSize);
+        int cy = static_cast<int>(p.y * inverseCellSize);
+        const glm::vec2* center = &cells[(cy + BORDER) * stride + cx + BORDER];
+        // An occupied own cell always conflicts (the cell diagonal is radius) and is the most common rejection
+        if (center->x >= 0.0f) return false;
+        float radiusSquared = radius * radius;
+        // The whole 5x5 block without early outs: the compiler unrolls it, and mispredicted branches cost more
+        // than the few extra distances. Its four corner cells are always at least radius away and are skipped.
+        bool conflict = false;
+        for (int y = -2; y <= 2; ++y) {
+            const glm::vec2* row = center + y * stride;
+            int reach = (y == -2 || y == 2) ? 1 : 2;
+            for (int x = -reach; x <= reach; ++x) {
+                float dx = row[x].x - p.x;
+                float dy = row[x].y - p.y;
+                conflict |= dx * dx + dy * dy < radiusSquared;
+            }
+        }
+        return !conflict;
+    }
+
+    void insert(const glm::vec2& p) {
+        cell(static_cast<int>(p.x * inverseCellSize), static_cast<int>(p.y * inverseCellSize)) = p;
+    }
+};
+
+// Small xorshift generator; one per tile, so no state is shared between threads
+struct TileRandom {
+    uint32_t state;
+    explicit TileRandom(uint32_t seed) : state(seed ? seed : 0x9E3779B9u) {}
+    float next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (state >> 8) * (1.0f / 16777216.0f);
+    }
+};
+
+static void fillTile(PoissonGrid& grid, int tileX, int tileY, uint32_t seed, const PoissonDiskSampler::KeepFunction& keep,
+    std::vector<glm::vec2>& output) {
+    // Candidates must land in the tile's own cells so concurrent tiles never write the same cell
+    float minX = tileX * grid.tileCells * grid.cellSize;
+    float minY = tileY * grid.tileCells * grid.cellSize;
+    float maxX = std::min(minX + grid.tileCells * grid.cellSize, grid.width);
+    float maxY = std::min(minY + grid.tileCells * grid.cellSize, grid.height);
+    int cellMaxX = std::min((tileX + 1) * grid.tileCells, grid.gridWidth) - 1;
+    int cellMaxY = std::min((tileY + 1) * grid.tileCells, grid.gridHeight) - 1;
+
+    TileRandom random(seed);
+    // Thinned points stay in the grid, so the kept ones are still at least radius apart and gaps do not refill
+    auto accept = [&](const glm::vec2& p) {
+        grid.insert(p);
+        if (!keep || random.next() < keep(p)) output.push_back(p);
+    };
+    auto inTile = [&](const glm::vec2& p) {
+        if (p.x < minX || p.y < minY || p.x >= maxX || p.y >= maxY) return false;
+        return static_cast<int>(p.x * grid.inverseCellSize) <= cellMaxX && static_cast<int>(p.y * grid.inverseCellSize) <= cellMaxY;
+    };
+
+    // Candidates walk around the origin in even angle steps from a random start, just beyond radius
+    // (Roberts' variant of Bridson): fewer rejected attempts and a denser fill than random annulus samples
+    const float step = 6.28318531f / grid.attempts;
+    const float stepCos = std::cos(step);
+    const float stepSin = std::sin(step);
+
+    std::vector<glm::vec2> active;
+    // Seed points keep coming until a run of attempts finds no room, so regions cut off by earlier tiles still fill
+    for (int seedTry = 0; seedTry < grid.attempts; ++seedTry) {
+        glm::vec2 start(minX + random.next() * (maxX - minX), minY + random.next() * (maxY - minY));
+        if (!inTile(start) || !grid.fits(start)) continue;
+        accept(start);
+        active.push_back(start);
+        seedTry = 0;
+
+        while (!active.empty()) {
+            size_t index = std::min(static_cast<size_t>(random.next() * active.size()), active.size() - 1);
+            glm::vec2 origin = active[index];
+            float angle = random.next() * 6.28318531f;
+            float distance = grid.radius * (1.0001f + 0.05f * random.next());
+            float dirX = std::cos(angle) * distance;
+            float dirY = std::sin(angle) * distance;
+            bool placed = false;
+            for (int attempt = 0; attempt < grid.attempts; ++attempt) {
+                glm::vec2 candidate(origin.x + dirX, origin.y + dirY);
+                float rotatedX = dirX * stepCos - dirY * stepSin;
+                dirY = dirX * stepSin + dirY * stepCos;
+                dirX = rotatedX;
+                if (!inTile(candidate) || !grid.fits(candidate)) continue;
+                accept(candidate);
+                active.push_back(candidate);
+                placed = true;
+                break;
+            }
+            if (!placed) {
+                // Swap-remove: order in the active list does not matter
+                active[index] = active.back();
+                active.pop_back();
+            }
+        }
+    }
+}
+
+std::vector<glm::vec2> PoissonDiskSampler::sample(float width, float height, float radius, uint32_t seed, float tileSize, int attempts,
+    const KeepFunction& keep) {
+    std::vector<glm::vec2> points;
+    if (width <= 0.0f || height <= 0.0f || radius <= 0.0f) return points;
+
+    PoissonGrid grid;
+    grid.width = width;
+    grid.height = height;
+    grid.radius = radius;
+    grid.cellSize = radius / std::sqrt(2.0f);
+    grid.inverseCellSize = 1.0f / grid.cellSize;
+    grid.gridWidth = static_cast<int>(std::ceil(width / grid.cellSize));
+    grid.gridHeight = static_cast<int>(std::ceil(height / grid.cellSize));
+    // Three cells per tile keeps same-pass tiles further apart than radius and out of each other's two-cell lookups
+    grid.tileCells = std::max(3, static_cast<int>(std::ceil(tileSize / grid.cellSize)));
+    grid.attempts = std::max(1, attempts);
+    grid.stride = grid.gridWidth + 2 * PoissonGrid::BORDER;
+    grid.cells.assign(static_cast<size_t>(grid.stride) * (grid.gridHeight + 2 * PoissonGrid::BORDER), glm::vec2(EMPTY_CELL, EMPTY_CELL));
+
+    const int tilesX = (grid.gridWidth + grid.tileCells - 1) / grid.tileCells;
+    const int tilesY = (grid.gridHeight + grid.tileCells - 1) / grid.tileCells;
+    std::vector<std::vector<glm::vec2>> tilePoints(static_cast<size_t>(tilesX) * tilesY);
+
+    ThreadPool& pool = ThreadPool::shared();
+    for (int pass = 0; pass < 4; ++pass) {
+        int offsetX = pass & 1;
+        int offsetY = pass >> 1;
+        int passTilesX = (tilesX - offsetX + 1) / 2;
+        int passTilesY = (tilesY - offsetY + 1) / 2;
+        pool.parallelFor(passTilesX * passTilesY, 1, [&](int begin, int end, int) {
+            for (int i = begin; i < end; ++i) {
+                int tileX = offsetX + (i % passTilesX) * 2;
+                int tileY = offsetY + (i / passTilesX) * 2;
+                int tile = tileY * tilesX + tileX;
+                // Seeding by tile keeps the result independent of which thread runs it
+                fillTile(grid, tileX, tileY, seed * 2654435761u + static_cast<uint32_t>(tile) * 40503u + 1u, keep,
+                    tilePoints[tile]);
+            }
+        });
+    }
+
+    size_t total = 0;
+    for (const auto& tile : tilePoints) total += tile.size();
+    points.reserve(total);
+    for (const auto& tile : tilePoints) points.insert(points.end(), tile.begin(), tile.end());
+    return points;
+}
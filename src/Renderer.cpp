@@ -1,15 +1,25 @@
 #include "Renderer.hpp"
 #include "World.hpp"
 #include "DataManager.hpp"
+#include "GLStateCache.hpp"
+#include "StreamBuffer.hpp"
 #include <SDL3_image/SDL_image.h>
+#include <algorithm>
+#include <cfloat>
 #include <numeric>
+#include <random>
 #include <string>
 #include <Constants.hpp>
 
+// Point light over the middle of the scene that shades the terrain and vegetation
+static const glm::vec3 LIGHT_POSITION(WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f + 800.0f, 800.0f);
+
 Renderer::Renderer() : world(nullptr), font(nullptr), klingonFont(nullptr), useKlingonFont(false), useKlingonNames(true),
-textShader(0), textVAO(0), textVBO(0), terrainShader(0), smokeShader(0), smokeVAO(0), smokeVBO(0),
-smokeEBO(0), smokeTexture(0), cameraZoom(1713.225f), cameraYaw(0.0f), cameraPitch(11.690f),
-terrainHardness(0.5f), currentTimeOfDayIndex(1), sceneNamesIndex(0), regenerationTriggered(false), regenerateDistantTriggered(false) {
+textShader(0), textFont(-1), klingonTextFont(-1), backgroundLayerShader(0), vegetationShader(0), backgroundLayersEnabled(true),
+vegetationEnabled(true), vegetationDensity(1.0f), smokeShader(0), smokeVAO(0), smokeVBO(0),
+smokeEBO(0), smokeTexture(0), cameraZoom(DEFAULT_CAMERA_ZOOM), cameraYaw(0.0f), cameraPitch(DEFAULT_CAMERA_PITCH),
+terrainHardness(0.5f), distantMaxPixelError(0.5f), randomStarCount(CelestialObjectManager::MIN_RANDOM_STARS), occlusionCullingEnabled(true), timeToFirstFrame(-1.0f), currentTimeOfDayIndex(1), sceneNamesIndex(0),
+regenerationTriggered(false), regenerateDistantTriggered(false) {
     sceneNames = { "Summer", "Fall", "Winter", "Spring", "Alien" };
 }
 
@@ -17,6 +27,9 @@ Renderer::~Renderer() {
     cleanupOpenGLResources();
     cleanupSmokeResources();
     cleanupSkyResources();
+    // Last, as the sky and the celestial objects' programs are also the registry's
+    ShaderRegistry::shared().cleanup();
+    StreamBuffer::shared().cleanup();
     if (font) TTF_CloseFont(font);
     if (klingonFont) TTF_CloseFont(klingonFont);
     TTF_Quit();
@@ -25,191 +38,86 @@ Renderer::~Renderer() {
 bool Renderer::initializeTextRendering() {
     const char* vertexShaderSource = R"(
         #version 330 core
-        layout(location = 0) in vec4 vertex;
+        layout(location = 0) in vec2 aPos;
+        layout(location = 1) in vec2 aTexCoords;
+        layout(location = 2) in vec4 aColor;
         out vec2 TexCoords;
+        out vec3 TextColor;
         uniform mat4 projection;
         void main() {
-            gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);
-            TexCoords = vertex.zw;
+            gl_Position = projection * vec4(aPos, 0.0, 1.0);
+            TexCoords = aTexCoords;
+            TextColor = aColor.rgb;
         }
     )";
     const char* fragmentShaderSource = R"(
         #version 330 core
         in vec2 TexCoords;
+        in vec3 TextColor;
         out vec4 color;
         uniform sampler2D text;
-        uniform vec3 textColor;
         void main() {
-            vec4 sampled = texture(text, TexCoords);
-            if (sampled.a < 0.1) discard;  // Discard pixels with low alpha to ensure transparency
-            color = vec4(textColor, sampled.a);  // Use the sampled alpha for anti-aliased edges
+            float coverage = texture(text, TexCoords).r; // single-channel glyph atlas
+            if (coverage < 0.1) discard;  // Discard pixels with low coverage to ensure transparency
+            color = vec4(TextColor, coverage);  // Use the filtered coverage for anti-aliased edges
         }
     )";
 
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
-    glCompileShader(vertexShader);
-    GLint success;
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
-        DataManager::LogError("Renderer", "initializeTextRendering", "Text vertex shader compilation failed: " + std::string(infoLog));
-        return false;
-    }
-
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
-    glCompileShader(fragmentShader);
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
-        DataManager::LogError("Renderer", "initializeTextRendering", "Text fragment shader compilation failed: " + std::string(infoLog));
-        glDeleteShader(vertexShader);
-        return false;
-    }
-
-    textShader = glCreateProgram();
-    glAttachShader(textShader, vertexShader);
-    glAttachShader(textShader, fragmentShader);
-    glLinkProgram(textShader);
-    glGetProgramiv(textShader, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(textShader, 512, nullptr, infoLog);
-        DataManager::LogError("Renderer", "initializeTextRendering", "Text shader program linking failed: " + std::string(infoLog));
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        return false;
-    }
+    // Validated once linked, which is only waited for when the first text is drawn
+    textShader = ShaderRegistry::shared().submit("Text", vertexShaderSource, fragmentShaderSource, [this](GLuint program) {
+        textUniforms.resolve(program);
+        glValidateProgram(program);
+        GLint success;
+        glGetProgramiv(program, GL_VALIDATE_STATUS, &success);
+        if (!success) {
+            char infoLog[512];
+            glGetProgramInfoLog(program, 512, nullptr, infoLog);
+            DataManager::LogError("Renderer", "initializeTextRendering", "Text shader program validation failed: " + std::string(infoLog));
+        }
+    });
 
-    glValidateProgram(textShader);
-    glGetProgramiv(textShader, GL_VALIDATE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(textShader, 512, nullptr, infoLog);
-        DataManager::LogError("Renderer", "initializeTextRendering", "Text shader program validation failed: " + std::string(infoLog));
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
+    // Both fonts share one atlas, so text in either goes out in the same draw
+    textFont = textRenderer.addFont(font);
+    klingonTextFont = textRenderer.addFont(klingonFont);
+    if (textFont < 0 || klingonTextFont < 0) {
+        DataManager::LogError("Renderer", "initializeTextRendering", "Failed to build the glyph atlas");
         return false;
     }
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    glGenVertexArrays(1, &textVAO);
-    glGenBuffers(1, &textVBO);
-    glBindVertexArray(textVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, textVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, nullptr, GL_DYNAMIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    hotkeyBar.setItems({
+        "D: REGENERATE DISTANT TERRAIN",
+        "B: REGENERATE BOTTOM TERRAIN",
+        "F1: CONSTELLATIONS",
+        "F2: PLANETS",
+        "F3: SATELLITES",
+        "F4: DAWN",
+        "F5: MID DAY",
+        "F6: DUSK",
+        "F7: NIGHT",
+        "F8: FALL",
+        "F9: SPRING",
+        "F10: SUMMER",
+        "F11: WINTER",
+        "F12: TOGGLE KLINGON / ENGLISH NAMES",
+        "A: ALIEN PLANET"
+    });
 
     return true;
 }
 
 void Renderer::renderText(const std::string& text, float x, float y, float scale, glm::vec3 color, bool celestial) {
-    TTF_Font* activeFont = (celestial && useKlingonFont && useKlingonNames) ? klingonFont : font;
-
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    SDL_Color sdlColor = { 255, 255, 255, 255 };
-    SDL_Surface* surface = TTF_RenderText_Solid(activeFont, text.c_str(), static_cast<int>(text.length()), sdlColor);
-    if (!surface) {
-        DataManager::LogError("Renderer", "renderText", "Failed to render text: " + std::string(SDL_GetError()));
-        return;
-    }
-
-    SDL_Surface* rgbaSurface = SDL_ConvertSurface(surface, SDL_PIXELFORMAT_RGBA32);
-    if (!rgbaSurface) {
-        DataManager::LogError("Renderer", "renderText", "Failed to convert surface to RGBA: " + std::string(SDL_GetError()));
-        SDL_DestroySurface(surface);
-        return;
-    }
-
-    if (SDL_MUSTLOCK(rgbaSurface)) {
-        if (!SDL_LockSurface(rgbaSurface)) {
-            std::string errorMsg = SDL_GetError();
-            DataManager::LogError("Renderer", "renderText",
-                "Failed to lock surface for directly accessing the pixels. " + (errorMsg.length() > 0 ? errorMsg : ""));
-            SDL_DestroySurface(surface);
-            SDL_DestroySurface(rgbaSurface);
-            return;
-        }
-    }
-
-    Uint32* pixels = (Uint32*)rgbaSurface->pixels;
-    int pitch = rgbaSurface->pitch / sizeof(Uint32);
-    for (int py = 0; py < rgbaSurface->h; ++py) {
-        for (int px = 0; px < rgbaSurface->w; ++px) {
-            Uint32 pixel = pixels[py * pitch + px];
-            Uint8 alpha = (pixel >> 24) & 0xFF;
-            if (alpha == 0) {
-                pixels[py * pitch + px] = 0x00000000;
-            } else {
-                pixels[py * pitch + px] = (pixel & 0x00FFFFFF) | (255 << 24);
-            }
-        }
-    }
-
-    if (SDL_MUSTLOCK(rgbaSurface)) SDL_UnlockSurface(rgbaSurface);
-
-    SDL_SetSurfaceBlendMode(rgbaSurface, SDL_BLENDMODE_NONE);
-    SDL_SetSurfaceAlphaMod(rgbaSurface, 255);
-
-    GLuint texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, rgbaSurface->w, rgbaSurface->h, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgbaSurface->pixels);
+    int activeFont = (celestial && useKlingonFont && useKlingonNames) ? klingonTextFont : textFont;
+    textRenderer.add(activeFont, text, x, y, scale, color, celestial);
+}
 
-    glUseProgram(textShader);
-    glUniform3fv(glGetUniformLocation(textShader, "textColor"), 1, &color[0]);
-    glUniform1i(glGetUniformLocation(textShader, "text"), 0);
+void Renderer::addLabel(const std::string& text, float x, float y, float gap, float scale, glm::vec3 color, LabelPriority priority) {
+    int activeFont = (useKlingonFont && useKlingonNames) ? klingonTextFont : textFont;
+    glm::vec2 size(textRenderer.measure(activeFont, text) * scale, textRenderer.getLineHeight(activeFont) * scale);
+    labelPlacer.add(text, glm::vec2(x, y), gap, size, scale, color, priority);
+}
 
+void Renderer::flushText() {
     glm::mat4 orthoProjection = glm::ortho(0.0f, static_cast<float>(WINDOW_WIDTH), 0.0f, static_cast<float>(WINDOW_HEIGHT));
-    glUniformMatrix4fv(glGetUniformLocation(textShader, "projection"), 1, GL_FALSE, &orthoProjection[0][0]);
-
-    float width = rgbaSurface->w * scale;
-    float height = rgbaSurface->h * scale;
-
-    float xPos = celestial ? x - (width / 2.0f) : x;
-    float yPos = y;
-
-    float vertices[] = {
-        xPos,         yPos + height, 0.0f, 0.0f,
-        xPos,         yPos,          0.0f, 1.0f,
-        xPos + width, yPos,          1.0f, 1.0f,
-
-        xPos,         yPos + height, 0.0f, 0.0f,
-        xPos + width, yPos,          1.0f, 1.0f,
-        xPos + width, yPos + height, 1.0f, 0.0f
-    };
-
-    glBindVertexArray(textVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, textVBO);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    glDeleteTextures(1, &texture);
-    SDL_DestroySurface(surface);
-    SDL_DestroySurface(rgbaSurface);
+    textRenderer.render(textShader, textUniforms, orthoProjection);
 }
 
 void Renderer::setScene(Scene newScene) {
@@ -348,6 +256,60 @@ void Renderer::displayTest_GUI() {
             ImGui::SetTooltip("Reset all distant terrain parameters to their default values.");
         }
 
+        ImGui::Text("Background Layers:");
+        ImGui::Checkbox("Show Background Layers", &backgroundLayersEnabled);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Draw receding mountain ranges behind the distant terrain.\nAll layers share one ridge texture and one instanced draw.");
+        }
+        BackgroundLayerParameters& backgroundParams = world->getBackgroundParams();
+        ImGui::SliderInt("Layer Count", &backgroundParams.layerCount, 1, BackgroundLayers::MAX_LAYERS);
+        if (ImGui::IsItemDeactivatedAfterEdit()) world->regenerateBackgroundLayers();
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Number of mountain ranges behind the distant terrain (1 to %d).", BackgroundLayers::MAX_LAYERS);
+        }
+        ImGui::SliderFloat("Layer Spacing", &backgroundParams.spacing, 100.0f, 1500.0f);
+        if (ImGui::IsItemDeactivatedAfterEdit()) world->regenerateBackgroundLayers();
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Distance between consecutive ranges (100 to 1500).\nLarger values spread the ranges further towards the horizon.");
+        }
+        ImGui::SliderFloat("Layer Haze", &backgroundParams.haze, 0.0f, 1.0f);
+        if (ImGui::IsItemDeactivatedAfterEdit()) world->regenerateBackgroundLayers();
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("How far the farthest range fades towards the haze color (0.0 to 1.0).");
+        }
+        ImGui::Text("Layers: %d in 1 draw, GPU Time: %.3f ms", world->getBackgroundLayers()->getLayerCount(), backgroundLayerTimer.getMilliseconds());
+
+        ImGui::Text("Distant Terrain Mesh:");
+        ImGui::Checkbox("Occlusion Culling", &occlusionCullingEnabled);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Skip distant terrain chunks that are off screen or entirely below the projected silhouette of the bottom terrain.");
+        }
+        ImGui::Text("Chunks: %d total, %d occluded, %d off screen", occlusionStats.totalChunks, occlusionStats.occludedChunks, occlusionStats.outsideChunks);
+        ImGui::Text("Triangles Skipped: %zu (culling %.3f ms CPU)", occlusionStats.savedTriangles, occlusionStats.cpuMilliseconds);
+        bool simplifyDistant = world->isDistantSimplificationEnabled();
+        if (ImGui::Checkbox("Simplified Mesh", &simplifyDistant)) {
+            world->setDistantSimplification(simplifyDistant, distantMaxPixelError);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Draw an RTIN-simplified distant terrain built on worker threads after each generation.\nOff: draw the full-resolution grid.");
+        }
+        // Kept in a member so the value survives until the slider is released
+        ImGui::SliderFloat("Max Screen Error (px)", &distantMaxPixelError, 0.1f, 4.0f);
+        if (ImGui::IsItemDeactivatedAfterEdit()) {
+            world->setDistantSimplification(simplifyDistant, distantMaxPixelError);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Largest allowed height error of the simplified mesh in pixels at the default camera (0.1 to 4.0).\nHigher values remove more triangles.");
+        }
+        const TerrainSimplificationStats& simplificationStats = world->getDistantSimplificationStats();
+        if (world->isDistantSimplificationPending()) {
+            ImGui::Text("Simplifying...");
+        } else if (simplificationStats.sourceTriangles > 0) {
+            float reduction = 100.0f * (1.0f - static_cast<float>(simplificationStats.simplifiedTriangles) / simplificationStats.sourceTriangles);
+            ImGui::Text("Triangles: %zu -> %zu (%.1f%% fewer)", simplificationStats.sourceTriangles, simplificationStats.simplifiedTriangles, reduction);
+            ImGui::Text("Build Time: %.2f ms on %u threads", simplificationStats.buildMilliseconds, simplificationStats.threadCount);
+        }
+
         ImGui::Text("Bottom Terrain Noise Parameters:");
         NoiseParameters& noiseParamsBottom = world->getBottomNoiseParams();
         ImGui::SliderFloat("Bottom Base Height", &noiseParamsBottom.baseHeight, -WINDOW_HEIGHT, WINDOW_HEIGHT);
@@ -395,6 +357,208 @@ void Renderer::displayTest_GUI() {
             ImGui::SetTooltip("Reset all bottom terrain parameters to their default values.");
         }
 
+        ImGui::Text("Bottom Terrain Mesh:");
+        Terrain* bottomTerrain = world->getBottomTerrain();
+        bool detailNormalMapping = bottomTerrain->isDetailNormalMapping();
+        int meshStride = bottomTerrain->getMeshStride();
+        if (ImGui::Checkbox("Coarse Mesh + Detail Normals", &detailNormalMapping)) {
+            bottomTerrain->setDetailNormalMapping(detailNormalMapping, meshStride);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("A/B switch for the bottom terrain mesh.\nOn: draw a reduced-density mesh and recover full-resolution normals and colors from a baked texture.\nOff: draw the full-resolution mesh.");
+        }
+        if (ImGui::SliderInt("Coarse Mesh Stride", &meshStride, 2, 8)) {
+            bottomTerrain->setDetailNormalMapping(detailNormalMapping, meshStride);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Keep every Nth vertex in X and Z for the coarse mesh (2 to 8).\nA stride of 4 draws roughly 16x fewer vertices.");
+        }
+        ImGui::Text("Vertices: %zu  Triangles: %zu", bottomTerrain->getRenderedVertexCount(), bottomTerrain->getRenderedTriangleCount());
+        ImGui::Text("GPU Time: Full %.3f ms | Coarse + Detail %.3f ms",
+            bottomTerrainTimers[0].getMilliseconds(), bottomTerrainTimers[1].getMilliseconds());
+
+        ImGui::Text("Vegetation:");
+        Vegetation* vegetation = world->getVegetation();
+        ImGui::Checkbox("Show Vegetation", &vegetationEnabled);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Draw instanced trees, grass and rocks on the bottom terrain.\nColors and density follow the current scene.");
+        }
+        ImGui::SliderFloat("Vegetation Density", &vegetationDensity, 0.0f, 2.0f);
+        if (ImGui::IsItemDeactivatedAfterEdit()) {
+            world->setVegetationDensity(vegetationDensity);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Scale the chance that each candidate position grows a plant (0.0 to 2.0).");
+        }
+        if (ImGui::Button("Deform Test Crater")) {
+            std::uniform_real_distribution<float> craterX(0.0f, WINDOW_WIDTH * 2.0f);
+            float x = craterX(CelestialObjectManager::getRng());
+            world->deformBottomTerrain(x, 40.0f, 60.0f, false);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Dig a crater into the bottom terrain at a random position.\nOnly the vegetation chunks it touches are re-placed.");
+        }
+        const VegetationStats& vegetationStats = vegetation->getStats();
+        ImGui::Text("Instances: %zu (trees %zu, grass %zu, rocks %zu)", vegetation->getInstanceCount(),
+            vegetationStats.instanceCount[static_cast<int>(VegetationType::TREE)],
+            vegetationStats.instanceCount[static_cast<int>(VegetationType::GRASS)],
+            vegetationStats.instanceCount[static_cast<int>(VegetationType::ROCK)]);
+        ImGui::Text("Drawn: %zu mesh, %zu billboard in %d draws (%d of %d chunks)", vegetationStats.meshInstancesDrawn,
+            vegetationStats.billboardInstancesDrawn, vegetationStats.drawCalls, vegetationStats.visibleChunks, vegetationStats.totalChunks);
+        ImGui::Text("Placement: %d chunks in %.2f ms, sampling %.2f ms, GPU Time: %.3f ms", vegetationStats.updatedChunks,
+            vegetationStats.placementMilliseconds, vegetationStats.samplingMilliseconds, vegetationTimer.getMilliseconds());
+
+        ImGui::Text("Clouds:");
+        const char* cloudQualities[static_cast<int>(CloudQuality::COUNT)];
+        for (int quality = 0; quality < static_cast<int>(CloudQuality::COUNT); ++quality) {
+            cloudQualities[quality] = Sky::getCloudQualityName(static_cast<CloudQuality>(quality));
+        }
+        int cloudQuality = static_cast<int>(sky->getCloudQuality());
+        if (ImGui::Combo("Cloud Quality", &cloudQuality, cloudQualities, static_cast<int>(CloudQuality::COUNT))) {
+            sky->setCloudQuality(static_cast<CloudQuality>(cloudQuality));
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Full evaluates the cloud noise for every window pixel every frame.\n"
+                "Half and Quarter evaluate it at that fraction of the resolution and upsample, keeping cloud edges sharp.\n"
+                "Checkerboard evaluates half of those pixels per frame and carries the rest over from the previous frame.");
+        }
+        ImGui::Text("GPU Time: Full %.3f, Half %.3f, Quarter %.3f, Half CB %.3f, Quarter CB %.3f ms",
+            sky->getCloudMilliseconds(CloudQuality::FULL), sky->getCloudMilliseconds(CloudQuality::HALF),
+            sky->getCloudMilliseconds(CloudQuality::QUARTER), sky->getCloudMilliseconds(CloudQuality::HALF_CHECKERBOARD),
+            sky->getCloudMilliseconds(CloudQuality::QUARTER_CHECKERBOARD));
+        const NoiseTextureStats& noiseStats = sky->getCloudNoiseStats();
+        if (noiseStats.fromCache) {
+            ImGui::Text("Noise: %dx%d tile loaded from cache in %.1f ms", noiseStats.size, noiseStats.size, noiseStats.milliseconds);
+        } else {
+            ImGui::Text("Noise: %dx%d tile baked on %u threads in %.1f ms", noiseStats.size, noiseStats.size, noiseStats.threads, noiseStats.milliseconds);
+        }
+
+        ImGui::Text("Stars:");
+        ImGui::SliderInt("Random Stars", &randomStarCount, CelestialObjectManager::MIN_RANDOM_STARS,
+            CelestialObjectManager::MAX_RANDOM_STARS, "%d", ImGuiSliderFlags_Logarithmic);
+        if (ImGui::IsItemDeactivatedAfterEdit()) {
+            celestialObjectManager->setRandomStarCount(randomStarCount);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Number of Poisson-disk stars behind the constellations (50 to 1,000,000).\nThey thin out towards the horizon; the starfield is regenerated on release,\nwhich takes about two seconds at a million stars on a single core.");
+        }
+        ImGui::Text("Stars: %zu, generated in %.2f ms", celestialObjectManager->getStarCount(),
+            celestialObjectManager->getStarGenerationMilliseconds());
+
+        ImGui::Text("Real Sky:");
+        bool realSkyEnabled = celestialObjectManager->isRealSkyEnabled();
+        if (ImGui::Checkbox("Real Sky (Earth scenes)", &realSkyEnabled)) {
+            celestialObjectManager->setRealSkyEnabled(realSkyEnabled);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Replace the hand-placed Earth patterns with catalog stars seen from the observer below.\nNeeds resources/stars/stars.bin, or hygdata_v41.csv to convert it from.\nSatellite passes come from resources/satellites/active.tle if present.");
+        }
+        SkyObserver& skyObserver = celestialObjectManager->getSkyObserver();
+        ImGui::SliderFloat("Latitude", &skyObserver.latitude, -90.0f, 90.0f, "%.1f");
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Observer latitude in degrees, north positive (-90 to 90).");
+        }
+        ImGui::SliderFloat("Longitude", &skyObserver.longitude, -180.0f, 180.0f, "%.1f");
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Observer longitude in degrees, east positive (-180 to 180).");
+        }
+        int realSkyDay = celestialObjectManager->getRealSkyDayOfYear();
+        float realSkyHour = celestialObjectManager->getRealSkyHourUtc();
+        bool realSkyTimeChanged = ImGui::SliderInt("Day of Year", &realSkyDay, 1,
+            celestialObjectManager->getRealSkyDaysInYear());
+        realSkyTimeChanged |= ImGui::SliderFloat("Hour (UTC)", &realSkyHour, 0.0f, 23.99f, "%.2f");
+        if (realSkyTimeChanged) {
+            celestialObjectManager->setRealSkyTime(realSkyDay, realSkyHour);
+        }
+        float realSkyTimeScale = celestialObjectManager->getRealSkyTimeScale();
+        if (ImGui::SliderFloat("Sky Time Scale", &realSkyTimeScale, 0.0f, 3600.0f, "%.0f", ImGuiSliderFlags_Logarithmic)) {
+            celestialObjectManager->setRealSkyTimeScale(realSkyTimeScale);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Sky seconds per second (0 to 3600). The stars turn about the celestial pole as time passes.");
+        }
+        ImGui::SliderFloat("Field of View", &skyObserver.verticalFov, 15.0f, 90.0f, "%.0f deg");
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Degrees of altitude shown above the horizon (15 to 90).\nNarrower views reach fainter stars.");
+        }
+        float limitingMagnitude = celestialObjectManager->getRealSkyLimitingMagnitude();
+        if (ImGui::SliderFloat("Limiting Magnitude", &limitingMagnitude, 1.0f, 12.0f, "%.1f")) {
+            celestialObjectManager->setRealSkyLimitingMagnitude(limitingMagnitude);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Faintest magnitude drawn at a 60 degree field of view (1.0 to 12.0).\nThe catalog is sorted by magnitude, so fainter stars are never touched.");
+        }
+        const StarCatalogStats& catalogStats = celestialObjectManager->getStarCatalogStats();
+        ImGui::Text("Catalog: %zu stars, processed %zu (mag <= %.1f), drawn %zu in %.3f ms", celestialObjectManager->getStarCatalogCount(),
+            catalogStats.processed, catalogStats.limitingMagnitude, catalogStats.visible, catalogStats.milliseconds);
+        if (celestialObjectManager->isRealSatellitesActive()) {
+            const SatellitePropagatorStats& satelliteStats = celestialObjectManager->getSatellitePropagatorStats();
+            ImGui::Text("Satellites: %zu (%zu deep-space skipped), propagated %zu, up %zu, visible %zu in %.3f ms", satelliteStats.loaded,
+                satelliteStats.deepSpaceSkipped, satelliteStats.propagated, satelliteStats.aboveHorizon, satelliteStats.visible, satelliteStats.milliseconds);
+        }
+
+        ImGui::Text("Sky Entities:");
+        int stressSkyCount = celestialObjectManager->getStressSkyCount();
+        if (ImGui::SliderInt("Stress Sky", &stressSkyCount, 0, CelestialObjectManager::MAX_STRESS_SKY, "%d", ImGuiSliderFlags_Logarithmic)) {
+            celestialObjectManager->setStressSkyCount(stressSkyCount);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Extra planets, satellites and Starlink ships, this many of each (0 to 10000).\nUse it to profile update and render cost against the entity count.");
+        }
+        const SkyEntityStats& entityStats = celestialObjectManager->getSkyEntityStats();
+        ImGui::Text("Entities: %zu (planets %zu, satellites %zu, Starlink %zu, ships %zu), update %.3f ms, vertices %.3f ms", entityStats.entities,
+            entityStats.kinds[static_cast<size_t>(SkyEntityKind::PLANET)], entityStats.kinds[static_cast<size_t>(SkyEntityKind::SATELLITE)],
+            entityStats.kinds[static_cast<size_t>(SkyEntityKind::STARLINK)], entityStats.kinds[static_cast<size_t>(SkyEntityKind::SHIP)],
+            entityStats.updateMilliseconds, entityStats.vertexMilliseconds);
+        const TextRendererStats& textStats = textRenderer.getStats();
+        ImGui::Text("Text: %zu strings, %zu glyphs in %d draws, %zu KB, %d atlas uploads (%zu glyphs cached), %.3f ms", textStats.strings,
+            textStats.glyphs, textStats.drawCalls, textStats.uploadBytes / 1024, textStats.textureUploads, textStats.atlasGlyphs, textStats.milliseconds);
+        const LabelPlacerStats& labelStats = labelPlacer.getStats();
+        ImGui::Text("Labels: %zu candidates, %zu placed, %zu fading in, %zu hidden, %.3f ms", labelStats.candidates, labelStats.placed,
+            labelStats.pending, labelStats.hidden, labelStats.milliseconds);
+        const HotkeyBarStats& hotkeyStats = hotkeyBar.getStats();
+        ImGui::Text("Hotkeys: %zu glyphs in %d draw, %d layouts, %d color uploads", hotkeyStats.glyphs, hotkeyStats.drawCalls,
+            hotkeyStats.layouts, hotkeyStats.colorUploads);
+
+        ImGui::Text("Exhaust Trails:");
+        int stressShipCount = celestialObjectManager->getStressShipCount();
+        if (ImGui::SliderInt("Stress Ships", &stressShipCount, 0, CelestialObjectManager::MAX_STRESS_SHIPS)) {
+            celestialObjectManager->setStressShipCount(stressShipCount);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Extra ships with exhaust trails crossing the alien sky (0 to 2000).\nAll trails are drawn with one upload and one draw call.");
+        }
+        const ExhaustTrailStats& trailStats = celestialObjectManager->getExhaustTrailStats();
+        ImGui::Text("Trails: %zu, segments %zu, %zu KB in %d draw, built in %.3f ms", trailStats.trails, trailStats.segments,
+            trailStats.uploadBytes / 1024, trailStats.drawCalls, trailStats.milliseconds);
+
+        ImGui::Text("Meteor Shower:");
+        MeteorShower& meteorShower = celestialObjectManager->getMeteorShower();
+        bool showerEnabled = meteorShower.isShowerEnabled();
+        if (ImGui::Checkbox("Meteor Shower", &showerEnabled)) {
+            meteorShower.setShowerEnabled(showerEnabled);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Fill the night sky with meteors streaking away from a radiant point.\nSporadic meteors keep falling either way.");
+        }
+        int showerMeteors = meteorShower.getShowerMeteors();
+        if (ImGui::SliderInt("Meteors", &showerMeteors, MeteorShower::MIN_SHOWER_METEORS, MeteorShower::MAX_SHOWER_METEORS, "%d", ImGuiSliderFlags_Logarithmic)) {
+            meteorShower.setShowerMeteors(showerMeteors);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Meteors in the sky at once during the shower (1000 to 50000).");
+        }
+        glm::vec2 radiant = meteorShower.getRadiant();
+        if (ImGui::SliderFloat2("Radiant", &radiant.x, 0.0f, 1.0f)) {
+            meteorShower.setRadiant(radiant);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Screen position the shower streaks away from, 0 to 1 left to right and bottom to top.");
+        }
+        const MeteorShowerStats& meteorStats = meteorShower.getStats();
+        ImGui::Text("Meteors: %zu ring slots, %zu spawned in %.3f ms, %zu KB in %d draw(s)",
+            meteorStats.ringSlots, meteorStats.spawned, meteorStats.milliseconds, meteorStats.uploadBytes / 1024, meteorStats.drawCalls);
+
         ImGui::Text("Time of Day and Projectile Settings:");
         const char* timeOfDayModes[] = { "Dawn", "Mid-Day", "Dusk", "Night" };
         if (ImGui::Combo("Time of Day", &currentTimeOfDayIndex, timeOfDayModes, IM_ARRAYSIZE(timeOfDayModes))) {
@@ -403,6 +567,52 @@ void Renderer::displayTest_GUI() {
         if (ImGui::IsItemHovered()) {
             ImGui::SetTooltip("Select the time of day to transition the sky appearance.\nHotkeys: F4 (Dawn), F5 (Mid-Day), F6 (Dusk), F7 (Night)");
         }
+        bool dayCycle = world->isDayCycleEnabled();
+        if (ImGui::Checkbox("Day Cycle", &dayCycle)) {
+            world->setDayCycleEnabled(dayCycle);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Run the clock continuously; the Time of Day follows the sun.\nSelecting a Time of Day moves the clock there and it carries on.");
+        }
+        float dayLength = world->getDayLength();
+        if (ImGui::SliderFloat("Day Length (s)", &dayLength, 10.0f, 1200.0f, "%.0f")) {
+            world->setDayLength(dayLength);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Real seconds per full day while the day cycle runs.");
+        }
+        float hour = world->getDayTime() * 24.0f;
+        if (ImGui::SliderFloat("Hour", &hour, 0.0f, 24.0f, "%.2f")) {
+            world->setDayTime(hour / 24.0f);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Time of day on the clock: 6 is sunrise, 12 noon and 18 sunset.\nThe sky and terrain light follow it continuously.");
+        }
+        // The cycle moves the band on by itself; keep the Time of Day selection showing it
+        if (world->isDayCycleEnabled()) currentTimeOfDayIndex = static_cast<int>(world->getCurrentTimeOfDay());
+        const AtmosphereStats& atmosphereStats = world->getAtmosphere().getStats();
+        if (atmosphereStats.fromCache) {
+            ImGui::Text("Atmosphere: sun %.1f deg, tables loaded from cache in %.1f ms", glm::degrees(world->getSunElevation()),
+                atmosphereStats.milliseconds);
+        } else {
+            ImGui::Text("Atmosphere: sun %.1f deg, tables integrated on %u threads in %.1f ms", glm::degrees(world->getSunElevation()),
+                atmosphereStats.threads, atmosphereStats.milliseconds);
+        }
+        const ShaderRegistryStats& shaderStats = ShaderRegistry::shared().getStats();
+        ImGui::Text("Shaders: %d programs, %d compiled and %d from the binary cache in %.1f ms", shaderStats.programs,
+            shaderStats.compiled, shaderStats.loaded, shaderStats.milliseconds);
+        ImGui::Text("    %d uniforms resolved at link, Frame block %zu bytes", shaderStats.uniforms, shaderStats.frameUniformBytes);
+        ImGui::Text("    time to first frame %.0f ms, %s%s compilation, %d pending, %d failed", timeToFirstFrame,
+            ShaderRegistry::shared().isDeferredCompilation() ? "deferred" : "serial", shaderStats.parallel ? " parallel" : "",
+            shaderStats.pending, shaderStats.failed);
+        const GLStateCacheStats& stateStats = GLStateCache::shared().getStats();
+        ImGui::Text("GL state changes: %d issued, %d elided per frame", stateStats.issued, stateStats.elided);
+        const StreamBufferStats& streamStats = StreamBuffer::shared().getStats();
+        ImGui::Text("Streamed: %.1f KB in %d uploads per frame, %d x %zu KB regions %s", streamStats.bytes / 1024.0f,
+            streamStats.allocations, StreamBuffer::FRAMES, streamStats.regionBytes / 1024,
+            streamStats.persistent ? "persistently mapped" : "mapped per upload");
+        ImGui::Text("    %d waits for the GPU (%.1f ms), %d orphaned, %d resized", streamStats.waits, streamStats.waitMilliseconds,
+            streamStats.orphans, streamStats.resizes);
 
         static int numPlayers = 1;
         if (ImGui::SliderInt("Number of Players", &numPlayers, 1, 10)) {
@@ -450,9 +660,9 @@ void Renderer::displayTest_GUI() {
 }
 
 void Renderer::resetCameraControls() {
-    cameraZoom = 1713.225f;
+    cameraZoom = DEFAULT_CAMERA_ZOOM;
     cameraYaw = 0.0f;
-    cameraPitch = 11.690f;
+    cameraPitch = DEFAULT_CAMERA_PITCH;
     cameraPos = glm::vec3(WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f + 800.0f, 800.0f);
     cameraTarget = glm::vec3(WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f, 0.0f);
     cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
@@ -472,111 +682,232 @@ void Renderer::resetCameraControls() {
         ", Pitch=" + std::to_string(cameraPitch));
 }
 
-bool Renderer::initializeTerrainShader() {
-    const char* vertexShaderSource = R"(
-        #version 330 core
+void Renderer::initializeTerrainShader() {
+    // View, projection and light come from the Frame block
+    const std::string vertexShaderSource = std::string("#version 330 core\n") + ShaderRegistry::FRAME_UNIFORM_BLOCK + R"(
         layout(location = 0) in vec3 aPos;
         layout(location = 1) in vec3 aNormal;
         layout(location = 2) in vec3 aColor;
         uniform mat4 model;
-        uniform mat4 view;
-        uniform mat4 projection;
+        uniform mat3 normalMatrix;
+        uniform vec2 detailScale;
+        uniform vec2 detailOffset;
         out vec3 Normal;
         out vec3 FragPos;
         out vec3 Color;
         out float ZCoord;
+        out vec2 DetailCoord;
         void main() {
             gl_Position = projection * view * model * vec4(aPos, 1.0);
             FragPos = vec3(model * vec4(aPos, 1.0));
-            Normal = mat3(transpose(inverse(model))) * aNormal;
+            Normal = normalMatrix * aNormal;
             Color = aColor;
             ZCoord = aPos.z;
+            DetailCoord = aPos.xz * detailScale + detailOffset;
         }
     )";
-    const char* fragmentShaderSource = R"(
-        #version 330 core
+    const std::string fragmentShaderSource = std::string("#version 330 core\n") + ShaderRegistry::FRAME_UNIFORM_BLOCK + R"(
         out vec4 FragColor;
         in vec3 Normal;
         in vec3 FragPos;
         in vec3 Color;
         in float ZCoord;
-        uniform vec3 lightPos;
-        uniform vec3 viewPos;
-        uniform vec3 lightColor;
+        in vec2 DetailCoord;
+    #ifdef DISTANT
         uniform float depthFade;
         uniform float terrainDepth;
+    #endif
+        uniform mat3 normalMatrix;
+        uniform bool useDetailMap;
+        uniform sampler2D detailMap;
+        uniform vec3 lowColor;
+        uniform vec3 highColor;
         void main() {
+            vec3 baseColor = Color;
+            vec3 norm = normalize(Normal);
+            if (useDetailMap) {
+                // Coarse mesh: take normal and height from the full-resolution bake instead of the interpolated vertices
+                vec4 detail = texture(detailMap, DetailCoord);
+                norm = normalize(normalMatrix * (detail.xyz * 2.0 - 1.0));
+                baseColor = mix(lowColor, highColor, detail.a);
+            }
+
             float ambientStrength = 0.5;
-            vec3 ambient = ambientStrength * lightColor * Color;
+            vec3 ambient = ambientStrength * lightColor * baseColor;
 
-            vec3 norm = normalize(Normal);
             vec3 lightDir = normalize(lightPos - FragPos);
             float diff = max(dot(norm, lightDir), 0.0);
-            vec3 diffuse = diff * lightColor * Color;
+            vec3 diffuse = diff * lightColor * baseColor;
 
-            vec3 result = (ambient + diffuse) * Color;
+            vec3 result = (ambient + diffuse) * baseColor;
 
-            if (depthFade > 0.0) {
-                float zNormalized = (ZCoord + terrainDepth / 2.0) / terrainDepth;
-                float fadeFactor = mix(1.0, 1.0 - zNormalized, depthFade);
-                result *= fadeFactor;
-            }
+        #ifdef DISTANT
+            float zNormalized = (ZCoord + terrainDepth / 2.0) / terrainDepth;
+            float fadeFactor = mix(1.0, 1.0 - zNormalized, depthFade);
+            result *= fadeFactor;
+        #endif
 
             FragColor = vec4(result, 1.0);
         }
     )";
 
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
-    glCompileShader(vertexShader);
-    GLint success;
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
-        DataManager::LogError("Renderer", "initializeTerrainShader", "Vertex shader compilation failed: " + std::string(infoLog));
-        return false;
-    }
+    // Both variants are drawn in the first frame
+    terrainShaders.initialize("Terrain", vertexShaderSource, fragmentShaderSource,
+        [](uint32_t key) { return std::string(key == TERRAIN_DISTANT ? "#define DISTANT\n" : ""); },
+        [](GLuint program, TerrainPassUniforms& uniforms) {
+            ShaderRegistry& registry = ShaderRegistry::shared();
+            uniforms.model = registry.uniform<glm::mat4>(program, "model");
+            uniforms.normalMatrix = registry.uniform<glm::mat3>(program, "normalMatrix");
+            uniforms.depthFade = registry.uniform<float>(program, "depthFade");
+            uniforms.terrainDepth = registry.uniform<float>(program, "terrainDepth");
+            uniforms.terrain.resolve(program);
+        });
+    terrainShaders.prepare(TERRAIN_BOTTOM);
+    terrainShaders.prepare(TERRAIN_DISTANT);
+}
 
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
-    glCompileShader(fragmentShader);
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
-        DataManager::LogError("Renderer", "initializeTerrainShader", "Fragment shader compilation failed: " + std::string(infoLog));
-        return false;
-    }
+void Renderer::initializeBackgroundLayerShader() {
+    const std::string vertexShaderSource = std::string("#version 330 core\n") + ShaderRegistry::FRAME_UNIFORM_BLOCK + R"(
+        layout(location = 0) in vec2 aStrip;      // profile sample index, 0 = bottom edge / 1 = ridge
+        layout(location = 1) in vec4 aPlacement;  // xStart, yBase, z, width
+        layout(location = 2) in vec4 aAppearance; // color, fade
+        uniform sampler2D profiles;
+        uniform int layerCount;
+        uniform float sampleCount;
+        out vec3 LayerColor;
+        out float Fade;
+        out float Ridge;
+        void main() {
+            float ridgeHeight = texelFetch(profiles, ivec2(int(aStrip.x), gl_InstanceID), 0).r;
+            vec3 worldPos = vec3(aPlacement.x + aStrip.x / (sampleCount - 1.0) * aPlacement.w,
+                                 aPlacement.y + aStrip.y * ridgeHeight,
+                                 aPlacement.z);
+            gl_Position = projection * view * vec4(worldPos, 1.0);
+            // Far layers lie beyond the far plane; order layers by index within the depth range instead
+            float layerDepth = (float(gl_InstanceID) + 1.0) / (float(layerCount) + 1.0);
+            gl_Position.z = (layerDepth * 2.0 - 1.0) * gl_Position.w;
+            LayerColor = aAppearance.rgb;
+            Fade = aAppearance.a;
+            Ridge = aStrip.y;
+        }
+    )";
+    const std::string fragmentShaderSource = std::string("#version 330 core\n") + ShaderRegistry::FRAME_UNIFORM_BLOCK + R"(
+        out vec4 FragColor;
+        in vec3 LayerColor;
+        in float Fade;
+        in float Ridge;
+        uniform vec3 hazeColor;
+        void main() {
+            // Slightly lighter towards the ridge line, then fade towards the haze with distance
+            vec3 color = LayerColor * mix(0.7, 1.0, Ridge);
+            FragColor = vec4(mix(color, hazeColor, Fade) * lightColor, 1.0);
+        }
+    )";
 
-    terrainShader = glCreateProgram();
-    glAttachShader(terrainShader, vertexShader);
-    glAttachShader(terrainShader, fragmentShader);
-    glLinkProgram(terrainShader);
-    glGetProgramiv(terrainShader, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(terrainShader, 512, nullptr, infoLog);
-        DataManager::LogError("Renderer", "initializeTerrainShader", "Shader program linking failed: " + std::string(infoLog));
-        return false;
-    }
+    backgroundLayerShader = ShaderRegistry::shared().submit("BackgroundLayer", vertexShaderSource, fragmentShaderSource,
+        [this](GLuint program) {
+            backgroundLayerUniforms.hazeColor = ShaderRegistry::shared().uniform<glm::vec3>(program, "hazeColor");
+            backgroundLayerUniforms.layers.resolve(program);
+        });
+}
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+void Renderer::initializeVegetationShader() {
+    const std::string vertexShaderSource = std::string("#version 330 core\n") + ShaderRegistry::FRAME_UNIFORM_BLOCK + R"(
+        layout(location = 0) in vec3 aPos;
+        layout(location = 1) in vec3 aNormal;
+        layout(location = 2) in float aTint;
+        layout(location = 3) in vec4 aPositionScale; // terrain-local base position, scale
+        layout(location = 4) in vec4 aParams;        // rotation, brightness
+        uniform mat4 model;
+        uniform bool billboard;
+        uniform vec3 cameraRight;
+        out vec3 Normal;
+        out vec3 FragPos;
+        out float Tint;
+        out float Brightness;
+        out vec2 QuadCoord;
+        void main() {
+            // Only the base point goes through the terrain model, so plants keep their proportions
+            vec3 base = vec3(model * vec4(aPositionScale.xyz, 1.0));
+            float scale = aPositionScale.w;
+            vec3 offset;
+            if (billboard) {
+                offset = (cameraRight * aPos.x + vec3(0.0, aPos.y, 0.0)) * scale;
+                Normal = normalize(vec3(0.0, 0.6, 0.8));
+            } else {
+                float c = cos(aParams.x);
+                float s = sin(aParams.x);
+                vec3 p = aPos * scale;
+                offset = vec3(c * p.x + s * p.z, p.y, -s * p.x + c * p.z);
+                Normal = vec3(c * aNormal.x + s * aNormal.z, aNormal.y, -s * aNormal.x + c * aNormal.z);
+            }
+            FragPos = base + offset;
+            gl_Position = projection * view * vec4(FragPos, 1.0);
+            Tint = aTint;
+            Brightness = aParams.y;
+            QuadCoord = aPos.xy;
+        }
+    )";
+    const std::string fragmentShaderSource = std::string("#version 330 core\n") + ShaderRegistry::FRAME_UNIFORM_BLOCK + R"(
+        out vec4 FragColor;
+        in vec3 Normal;
+        in vec3 FragPos;
+        in float Tint;
+        in float Brightness;
+        in vec2 QuadCoord;
+        uniform vec3 primaryColor;
+        uniform vec3 secondaryColor;
+        uniform bool billboard;
+        uniform int shape; // 0 tree, 1 grass, 2 rock
+        void main() {
+            float tint = Tint;
+            if (billboard) {
+                // Cut the quad to the silhouette of the far mesh
+                vec2 q = QuadCoord;
+                if (shape == 0) {
+                    if (q.y < 0.25) {
+                        if (abs(q.x) > 0.05) discard;
+                        tint = 0.0;
+                    } else if (abs(q.x) > (1.0 - q.y) * 0.45) {
+                        discard;
+                    }
+                } else if (shape == 1) {
+                    if (abs(q.x) > (1.0 - q.y) * 0.3) discard;
+                    tint = q.y;
+                } else {
+                    if (length(vec2(q.x / 0.5, q.y / 0.6)) > 1.0) discard;
+                    tint = q.y / 0.6;
+                }
+            }
 
-    return true;
+            vec3 baseColor = mix(secondaryColor, primaryColor, tint) * Brightness;
+            vec3 norm = normalize(Normal);
+            vec3 lightDir = normalize(lightPos - FragPos);
+            float diff = max(dot(norm, lightDir), 0.0);
+            vec3 result = (0.55 + 0.6 * diff) * lightColor * baseColor;
+            FragColor = vec4(result, 1.0);
+        }
+    )";
+
+    vegetationShader = ShaderRegistry::shared().submit("Vegetation", vertexShaderSource, fragmentShaderSource, [this](GLuint program) {
+        ShaderRegistry& registry = ShaderRegistry::shared();
+        vegetationUniforms.model = registry.uniform<glm::mat4>(program, "model");
+        vegetationUniforms.cameraRight = registry.uniform<glm::vec3>(program, "cameraRight");
+        vegetationUniforms.vegetation.resolve(program);
+    });
 }
 
 void Renderer::cleanupOpenGLResources() {
-    if (terrainShader) glDeleteProgram(terrainShader);
-    if (textShader) glDeleteProgram(textShader);
-    if (textVAO) glDeleteVertexArrays(1, &textVAO);
-    if (textVBO) glDeleteBuffers(1, &textVBO);
+    ShaderRegistry& registry = ShaderRegistry::shared();
+    terrainShaders.destroy();
+    registry.destroy(backgroundLayerShader);
+    registry.destroy(vegetationShader);
+    registry.destroy(textShader);
 }
 
 void Renderer::cleanupSmokeResources() {
-    if (smokeShader) glDeleteProgram(smokeShader);
-    if (smokeVAO) glDeleteVertexArrays(1, &smokeVAO);
+    if (smokeShader) GLStateCache::shared().deleteProgram(smokeShader);
+    if (smokeVAO) GLStateCache::shared().deleteVertexArrays(1, &smokeVAO);
     if (smokeVBO) glDeleteBuffers(1, &smokeVBO);
     if (smokeEBO) glDeleteBuffers(1, &smokeEBO);
     if (smokeTexture) glDeleteTextures(1, &smokeTexture);
@@ -621,13 +952,26 @@ bool Renderer::initialize(World* w) {
         TTF_CloseFont(klingonFont);
         return false;
     }
-    if (!initializeTerrainShader()) {
+    initializeTerrainShader();
+    initializeBackgroundLayerShader();
+    initializeVegetationShader();
+
+    // Submitting never fails, so the programs every frame needs are waited for here, after the last of the
+    // start-up programs has gone to the driver; a broken one then fails start-up instead of every frame
+    ShaderRegistry& registry = ShaderRegistry::shared();
+    bool shadersLinked = registry.use(textShader) && terrainShaders.use(TERRAIN_BOTTOM) && terrainShaders.use(TERRAIN_DISTANT) &&
+        registry.use(backgroundLayerShader) && registry.use(vegetationShader);
+    GLStateCache::shared().useProgram(0);
+    if (!shadersLinked) {
+        DataManager::LogError("Renderer", "initialize", "A shader program the renderer needs failed to compile or link");
         TTF_CloseFont(font);
         TTF_CloseFont(klingonFont);
         return false;
     }
 
-    projection = glm::perspective(glm::radians(45.0f), static_cast<float>(WINDOW_WIDTH) / WINDOW_HEIGHT, 0.1f, 2000.0f);
+    distantMaxPixelError = world->getDistantMaxPixelError();
+    randomStarCount = celestialObjectManager->getRandomStarCount();
+    projection = glm::perspective(glm::radians(CAMERA_FOV_DEGREES), static_cast<float>(WINDOW_WIDTH) / WINDOW_HEIGHT, 0.1f, 2000.0f);
     resetCameraControls();
 
     return true;
@@ -638,13 +982,14 @@ void Renderer::reinitializeCelestialResources() {
 }
 
 void Renderer::render(float dt) {
+    GLStateCache& state = GLStateCache::shared();
+    state.newFrame();
+    // Everything streamed this frame goes into the next region of the stream buffer, fenced once drawn
+    StreamBuffer::shared().beginFrame();
+    // The depth buffer is only cleared where depth writes are on
+    state.depthMask(GL_TRUE);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
-    glDepthMask(GL_TRUE);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    textRenderer.newFrame();
 
     float yawRad = glm::radians(cameraYaw);
     float pitchRad = glm::radians(cameraPitch);
@@ -654,10 +999,21 @@ void Renderer::render(float dt) {
     cameraPos = glm::vec3(camX, camY, camZ);
     view = glm::lookAt(cameraPos, cameraTarget, cameraUp);
 
+    // Everything the world-space shaders share goes up once, into the Frame block
+    FrameUniforms frame = {};
+    frame.view = view;
+    frame.projection = projection;
+    frame.cameraPos = cameraPos;
+    frame.lightPos = LIGHT_POSITION;
+    frame.lightColor = world->getLightColor();
+    ShaderRegistry::shared().updateFrameUniforms(frame);
+
     for (int stage = static_cast<int>(RenderStage::SKY); stage < static_cast<int>(RenderStage::COUNT); ++stage) {
+        state.apply(getStageState(static_cast<RenderStage>(stage)));
         switch (static_cast<RenderStage>(stage)) {
             case RenderStage::SKY:
-                sky->render(world->getCurrentTimeOfDay(), world->getTransitionProgress());
+                sky->render(world->getCurrentTimeOfDay(), world->getAtmosphere(), world->getSunElevation(),
+                    world->getSunProgress());
                 break;
             case RenderStage::DISTANT_CELESTIALS:
                 renderDistantCelestials();
@@ -666,7 +1022,10 @@ void Renderer::render(float dt) {
                 renderCelestialText();
                 break;
             case RenderStage::CLOUDS:
-                sky->renderClouds(world->getCurrentTimeOfDay(), world->getTransitionProgress(), world->getTotalTime());
+                sky->renderClouds(world->getCurrentTimeOfDay(), world->getTotalTime());
+                break;
+            case RenderStage::BACKGROUND_LAYERS:
+                if (backgroundLayersEnabled) renderBackgroundLayers();
                 break;
             case RenderStage::DISTANT_TERRAIN:
                 renderDistantTerrain();
@@ -674,6 +1033,9 @@ void Renderer::render(float dt) {
             case RenderStage::BOTTOM_TERRAIN:
                 renderBottomTerrain();
                 break;
+            case RenderStage::VEGETATION:
+                if (vegetationEnabled) renderVegetation();
+                break;
             case RenderStage::CLOSE_CELESTIALS:
                 renderCloseCelestials();
                 break;
@@ -687,106 +1049,76 @@ void Renderer::render(float dt) {
                 break;
         }
     }
+    StreamBuffer::shared().endFrame();
 }
 
-void Renderer::renderHotKeys() {
-    glDisable(GL_DEPTH_TEST);
-
-    glm::vec3 enabledColor(0.0f, 1.0f, 0.0f);
-    glm::vec3 disabledColor(1.0f, 1.0f, 1.0f);
-
-    float baseYPos = 30.0f;
-    float scale = 0.5f;
-    float spacing = 20.0f;
-    float rowHeight = 20.0f;
-    float maxWidth = WINDOW_WIDTH * 0.5f;
-
-    struct HotkeyEntry {
-        std::string text;
-        bool enabled;
-        float width;
-    };
-    std::vector<HotkeyEntry> hotkeys = {
-        {"D: REGENERATE DISTANT TERRAIN", regenerateDistantTriggered, 0.0f},
-        {"B: REGENERATE BOTTOM TERRAIN", regenerationTriggered, 0.0f},
-        {"F1: CONSTELLATIONS", celestialObjectManager->getShowConstellationNames(), 0.0f},
-        {"F2: PLANETS", celestialObjectManager->getShowPlanetNames(), 0.0f},
-        {"F3: SATELLITES", celestialObjectManager->getShowSatelliteNames(), 0.0f},
-        {"F4: DAWN", world->getCurrentTimeOfDay() == TimeOfDay::DAWN, 0.0f},
-        {"F5: MID DAY", world->getCurrentTimeOfDay() == TimeOfDay::MID_DAY, 0.0f},
-        {"F6: DUSK", world->getCurrentTimeOfDay() == TimeOfDay::DUSK, 0.0f},
-        {"F7: NIGHT", world->getCurrentTimeOfDay() == TimeOfDay::NIGHT, 0.0f},
-        {"F8: FALL", world->getScene() == Scene::FALL, 0.0f},
-        {"F9: SPRING", world->getScene() == Scene::SPRING, 0.0f},
-        {"F10: SUMMER", world->getScene() == Scene::SUMMER, 0.0f},
-        {"F11: WINTER", world->getScene() == Scene::WINTER, 0.0f},
-        {"F12: TOGGLE KLINGON / ENGLISH NAMES", useKlingonNames, 0.0f},
-        {"A: ALIEN PLANET", world->getScene() == Scene::ALIEN, 0.0f}
-    };
-
-    for (auto& hotkey : hotkeys) {
-        TTF_Font* activeFont = useKlingonNames ? klingonFont : font;
-        int w;
-        size_t measured_length;
-        if (TTF_MeasureString(activeFont, hotkey.text.c_str(), hotkey.text.length(), 0, &w, &measured_length) == true) {
-            hotkey.width = static_cast<float>(w) * scale;
-        } else {
-            hotkey.width = 0.0f;
-            DataManager::LogError("Renderer", "renderHotKeys", "Failed to calculate text width for: " + hotkey.text + " - SDL Error:" + SDL_GetError());
-        }
-        hotkey.width = std::max(hotkey.width, 10.0f);
-    }
-
-    std::vector<std::vector<HotkeyEntry>> rows;
-    std::vector<HotkeyEntry> currentRow;
-    float currentRowWidth = 0.0f;
-
-    for (const auto& hotkey : hotkeys) {
-        float entryWidth = hotkey.width + (currentRow.empty() ? 0.0f : spacing);
-        if (currentRowWidth + entryWidth > maxWidth && !currentRow.empty()) {
-            rows.push_back(currentRow);
-            currentRow.clear();
-            currentRowWidth = 0.0f;
-        }
-        currentRow.push_back(hotkey);
-        currentRowWidth += entryWidth;
+RenderState Renderer::getStageState(RenderStage stage) {
+    // Everything not set below is the default: depth tested and written with GL_LESS over the whole depth range,
+    // alpha blended, no face culling
+    RenderState state;
+    switch (stage) {
+        case RenderStage::SKY:
+        case RenderStage::CLOUDS:
+        case RenderStage::CELESTIAL_TEXT: // drawn over the sky only, so clouds and terrain still cover the labels
+        case RenderStage::HOTKEYS_TEXT:
+            state.depthTest = false;
+            state.depthWrite = false;
+            break;
+        case RenderStage::DISTANT_CELESTIALS:
+            state.depthNear = 0.9f;
+            break;
+        case RenderStage::CLOSE_CELESTIALS:
+            state.depthFunc = GL_LEQUAL;
+            state.depthWrite = false;
+            break;
+        case RenderStage::BACKGROUND_LAYERS:
+            // Behind the distant terrain, in front of the cleared depth
+            state.depthNear = 0.75f;
+            break;
+        case RenderStage::DISTANT_TERRAIN:
+            state.depthNear = 0.5f;
+            state.depthFar = 0.75f;
+            break;
+        case RenderStage::BOTTOM_TERRAIN:
+        case RenderStage::VEGETATION:
+            // Plants share the bottom terrain's range so the hills in front of them hide them
+            state.depthFar = 0.25f;
+            break;
+        default:
+            break;
     }
-    if (!currentRow.empty()) {
-        rows.push_back(currentRow);
-    }
-
-    for (size_t rowIdx = 0; rowIdx < rows.size(); ++rowIdx) {
-        const auto& row = rows[rowIdx];
-        float rowWidth = 0.0f;
-        for (size_t i = 0; i < row.size(); ++i) {
-            rowWidth += row[i].width + spacing;
-        }
-        if (!row.empty()) {
-            rowWidth -= spacing;
-        }
-        float xPos = (WINDOW_WIDTH - rowWidth) / 2.0f;
-        float yPos = baseYPos + static_cast<float>(rowIdx) * rowHeight;
+    return state;
+}
 
-        for (const auto& hotkey : row) {
-            renderText(hotkey.text, xPos, yPos, scale,
-                hotkey.enabled ? enabledColor : disabledColor);
-            xPos += hotkey.width + spacing;
-        }
+void Renderer::renderHotKeys() {
+    // One bit per label, in the order given to hotkeyBar.setItems in initializeTextRendering
+    const bool enabled[] = {
+        regenerateDistantTriggered,
+        regenerationTriggered,
+        celestialObjectManager->getShowConstellationNames(),
+        celestialObjectManager->getShowPlanetNames(),
+        celestialObjectManager->getShowSatelliteNames(),
+        world->getCurrentTimeOfDay() == TimeOfDay::DAWN,
+        world->getCurrentTimeOfDay() == TimeOfDay::MID_DAY,
+        world->getCurrentTimeOfDay() == TimeOfDay::DUSK,
+        world->getCurrentTimeOfDay() == TimeOfDay::NIGHT,
+        world->getScene() == Scene::FALL,
+        world->getScene() == Scene::SPRING,
+        world->getScene() == Scene::SUMMER,
+        world->getScene() == Scene::WINTER,
+        useKlingonNames,
+        world->getScene() == Scene::ALIEN
+    };
+    uint32_t enabledBits = 0;
+    for (size_t i = 0; i < sizeof(enabled) / sizeof(enabled[0]); ++i) {
+        if (enabled[i]) enabledBits |= 1u << i;
     }
-
-    glEnable(GL_DEPTH_TEST);
+    hotkeyBar.render(textShader, textUniforms, textRenderer, textFont, enabledBits, WINDOW_WIDTH, WINDOW_HEIGHT);
 }
 
 void Renderer::renderCloseCelestials() {
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
-
+    GLStateCache::shared().viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
     celestialObjectManager->renderCloseCelestials(world->getTransitionProgress(), sky->getSunMoonPosition());
-
-    glEnable(GL_DEPTH_TEST);
 }
 
 void Renderer::renderDistantCelestials() {
@@ -798,13 +1130,11 @@ void Renderer::renderDistantCelestials() {
         starAlpha = std::max(starAlpha, 0.5f);
     }
     if (starAlpha > 0.0f) {
-        glDepthRange(0.9f, 1.0f);
         if (distantFrameCounter % 60 == 0) {
             DataManager::LogDebug(DebugCategory::RENDERING, "Renderer", "render",
                 "Rendering distant celestial objects with starAlpha=" + std::to_string(starAlpha));
         }
         celestialObjectManager->render(starAlpha, sky->getSunMoonPosition());
-        glDepthRange(0.0f, 1.0f);
     } else {
         if (distantFrameCounter % 60 == 0) {
             DataManager::LogDebug(DebugCategory::RENDERING, "Renderer", "render",
@@ -817,49 +1147,221 @@ void Renderer::renderDistantCelestials() {
 }
 
 void Renderer::renderBottomTerrain() {
-    glDepthFunc(GL_LESS);
-    glUseProgram(terrainShader);
-    glUniformMatrix4fv(glGetUniformLocation(terrainShader, "view"), 1, GL_FALSE, &view[0][0]);
-    glUniformMatrix4fv(glGetUniformLocation(terrainShader, "projection"), 1, GL_FALSE, &projection[0][0]);
-    glUniform3fv(glGetUniformLocation(terrainShader, "lightPos"), 1, &glm::vec3(WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f + 800.0f, 800.0f)[0]);
-    glUniform3fv(glGetUniformLocation(terrainShader, "viewPos"), 1, &cameraPos[0]);
-    glUniform3fv(glGetUniformLocation(terrainShader, "lightColor"), 1, &world->getLightColor()[0]);
-
-    glDepthRange(0.0f, 0.25f);
+    const auto* terrainShader = terrainShaders.use(TERRAIN_BOTTOM);
+    if (!terrainShader) return;
+
+    glm::mat4 model = getBottomTerrainModel();
+    terrainShader->uniforms.model.set(model);
+    terrainShader->uniforms.normalMatrix.set(glm::transpose(glm::inverse(glm::mat3(model))));
+
+    // Time each mesh mode separately so the debug panel can compare them side by side
+    Terrain* bottomTerrain = world->getBottomTerrain();
+    GpuTimer& timer = bottomTerrainTimers[bottomTerrain->isDetailNormalMapping() ? 1 : 0];
+    timer.begin();
+    bottomTerrain->render(terrainShader->program, terrainShader->uniforms.terrain);
+    timer.end();
+}
+
+void Renderer::renderDistantTerrain() {
+    const auto& params = world->getDistantParams();
+    // Without fading the distant terrain shades like the bottom one
+    const auto* terrainShader = terrainShaders.use(params.depthFade > 0.0f ? TERRAIN_DISTANT : TERRAIN_BOTTOM);
+    if (!terrainShader) return;
+
+    glm::mat4 distantModel = getDistantTerrainModel();
+    terrainShader->uniforms.model.set(distantModel);
+    terrainShader->uniforms.normalMatrix.set(glm::transpose(glm::inverse(glm::mat3(distantModel))));
+    terrainShader->uniforms.depthFade.set(params.depthFade);
+    terrainShader->uniforms.terrainDepth.set(static_cast<float>(world->getDistantTerrain()->getDepth() * 5.0f));
+
+    Terrain* distantTerrain = world->getDistantTerrain();
+    if (occlusionCullingEnabled) {
+        cullDistantTerrainChunks(distantModel);
+        distantTerrain->renderChunks(terrainShader->program, terrainShader->uniforms.terrain, distantChunkVisibility);
+    } else {
+        occlusionStats = OcclusionCullingStats();
+        distantTerrain->render(terrainShader->program, terrainShader->uniforms.terrain);
+    }
+}
+
+void Renderer::renderVegetation() {
+    if (!ShaderRegistry::shared().use(vegetationShader)) return;
+    vegetationUniforms.cameraRight.set(glm::vec3(view[0][0], view[1][0], view[2][0]));
+
+    glm::mat4 model = getBottomTerrainModel();
+    vegetationUniforms.model.set(model);
+    vegetationTimer.begin();
+    world->getVegetation()->render(vegetationShader, vegetationUniforms.vegetation, model, projection * view, cameraPos);
+    vegetationTimer.end();
+}
+
+void Renderer::renderBackgroundLayers() {
+    if (!ShaderRegistry::shared().use(backgroundLayerShader)) return;
+    backgroundLayerUniforms.hazeColor.set(glm::vec3(0.55f, 0.65f, 0.8f));
+
+    backgroundLayerTimer.begin();
+    world->getBackgroundLayers()->render(backgroundLayerShader, backgroundLayerUniforms.layers);
+    backgroundLayerTimer.end();
+}
+
+glm::mat4 Renderer::getBottomTerrainModel() const {
     float extraWidth = 400.0f;
     float scaleX = (WINDOW_WIDTH + extraWidth) / WINDOW_WIDTH;
     glm::mat4 model = glm::mat4(1.0f);
     model = glm::translate(model, glm::vec3(-WINDOW_WIDTH / 2.0f - extraWidth / 2.0f, 0.0f, -200.0f));
     model = glm::scale(model, glm::vec3(scaleX, 1.0f, 1.0f));
-    glUniformMatrix4fv(glGetUniformLocation(terrainShader, "model"), 1, GL_FALSE, &model[0][0]);
-    glUniform1f(glGetUniformLocation(terrainShader, "depthFade"), 0.0f);
-    glUniform1f(glGetUniformLocation(terrainShader, "terrainDepth"), 1.0f);
-    glUniform1f(glGetUniformLocation(terrainShader, "colorFade"), 0.0f);
-    world->getBottomTerrain()->render(terrainShader);
-    glDepthRange(0.0f, 1.0f);
+    return model;
 }
 
-void Renderer::renderDistantTerrain() {
-    glDepthFunc(GL_LESS);
-
-    glUseProgram(terrainShader);
-    glUniformMatrix4fv(glGetUniformLocation(terrainShader, "view"), 1, GL_FALSE, &view[0][0]);
-    glUniformMatrix4fv(glGetUniformLocation(terrainShader, "projection"), 1, GL_FALSE, &projection[0][0]);
-    glUniform3fv(glGetUniformLocation(terrainShader, "lightPos"), 1, &glm::vec3(WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f + 800.0f, 800.0f)[0]);
-    glUniform3fv(glGetUniformLocation(terrainShader, "viewPos"), 1, &cameraPos[0]);
-    glUniform3fv(glGetUniformLocation(terrainShader, "lightColor"), 1, &world->getLightColor()[0]);
-
+glm::mat4 Renderer::getDistantTerrainModel() const {
     const auto& params = world->getDistantParams();
-
-    glDepthRange(0.5f, 0.75f);
     glm::mat4 distantModel = glm::translate(glm::mat4(1.0f), glm::vec3(-WINDOW_WIDTH / 2.0f, params.yOffset, params.zPosition));
     distantModel = glm::scale(distantModel, glm::vec3(2.0f, 1.0f, 1.0f));
-    glUniformMatrix4fv(glGetUniformLocation(terrainShader, "model"), 1, GL_FALSE, &distantModel[0][0]);
-    glUniform1f(glGetUniformLocation(terrainShader, "depthFade"), params.depthFade);
-    glUniform1f(glGetUniformLocation(terrainShader, "terrainDepth"), static_cast<float>(world->getDistantTerrain()->getDepth() * 5.0f));
-    glUniform1f(glGetUniformLocation(terrainShader, "colorFade"), params.colorFade);
+    return distantModel;
+}
+
+bool Renderer::buildOcclusionHorizon() {
+    // For every screen bin, the highest pixel row known to be covered by the bottom terrain. The bottom terrain is drawn
+    // in a nearer depth range than the distant terrain, so screen coverage alone decides occlusion.
+    const int binCount = WINDOW_WIDTH / OCCLUSION_BIN_PIXELS;
+    occlusionHorizon.assign(binCount, -FLT_MAX);
+
+    // The argument below assumes the terrain's side edges recede outward on screen, which holds for an unrotated camera
+    if (cameraYaw != 0.0f) return false;
+
+    Terrain* bottomTerrain = world->getBottomTerrain();
+    const int width = bottomTerrain->getWidth();
+    const int depth = bottomTerrain->getDepth();
+    const std::vector<float>& heights = bottomTerrain->getHeights();
+    glm::mat4 modelViewProjection = projection * view * getBottomTerrainModel();
 
-    world->getDistantTerrain()->render(terrainShader);
+    auto toScreen = [](const glm::vec4& clip) {
+        return glm::vec2((clip.x / clip.w * 0.5f + 0.5f) * WINDOW_WIDTH, (clip.y / clip.w * 0.5f + 0.5f) * WINDOW_HEIGHT);
+    };
+
+    // Everything between a terrain row and the front edge is covered only if that front edge is off the bottom of the
+    // screen or behind the camera; check it at its highest point
+    const float* frontRow = &heights[static_cast<size_t>(depth - 1) * width];
+    float frontMax = *std::max_element(frontRow, frontRow + width);
+    glm::vec4 frontLeft = modelViewProjection * glm::vec4(0.0f, frontMax, (depth - 1) * 5.0f, 1.0f);
+    glm::vec4 frontRight = modelViewProjection * glm::vec4((width - 1) * 2.0f, frontMax, (depth - 1) * 5.0f, 1.0f);
+    bool frontBehindCamera = frontLeft.w <= 0.0f && frontRight.w <= 0.0f;
+    bool frontInFront = frontLeft.w > 0.0f && frontRight.w > 0.0f;
+    if (!frontBehindCamera && !(frontInFront && toScreen(frontLeft).y < 0.0f && toScreen(frontRight).y < 0.0f)) {
+        return false;
+    }
+
+    const int step = bottomTerrain->getOccluderStep();
+    const int spanCount = bottomTerrain->getOccluderSpanCount();
+    const std::vector<float>& profile = bottomTerrain->getOccluderHeights();
+    const int rowCount = spanCount > 0 ? static_cast<int>(profile.size()) / spanCount : 0;
+
+    for (int row = 0; row < rowCount; ++row) {
+        float z = row * step * 5.0f;
+        occlusionRowHorizon.assign(binCount, FLT_MAX);
+        float rowLeft = FLT_MAX;
+        float rowRight = -FLT_MAX;
+        bool rowInFront = true;
+
+        for (int span = 0; span < spanCount && rowInFront; ++span) {
+            float minHeight = profile[row * spanCount + span];
+            float x0 = span * step * 2.0f;
+            float x1 = std::min((span + 1) * step, width - 1) * 2.0f;
+            glm::vec4 clip0 = modelViewProjection * glm::vec4(x0, minHeight, z, 1.0f);
+            glm::vec4 clip1 = modelViewProjection * glm::vec4(x1, minHeight, z, 1.0f);
+            if (clip0.w <= 0.1f || clip1.w <= 0.1f) {
+                rowInFront = false;
+                break;
+            }
+
+            // The real row lies on or above the span minimum, and a flat segment projects between its end points
+            glm::vec2 a = toScreen(clip0);
+            glm::vec2 b = toScreen(clip1);
+            float left = std::min(a.x, b.x);
+            float right = std::max(a.x, b.x);
+            float coveredY = std::min(a.y, b.y);
+            rowLeft = std::min(rowLeft, left);
+            rowRight = std::max(rowRight, right);
+
+            int firstBin = std::max(0, static_cast<int>(std::floor(left / OCCLUSION_BIN_PIXELS)));
+            int lastBin = std::min(binCount - 1, static_cast<int>(std::floor(right / OCCLUSION_BIN_PIXELS)));
+            for (int bin = firstBin; bin <= lastBin; ++bin) {
+                occlusionRowHorizon[bin] = std::min(occlusionRowHorizon[bin], coveredY);
+            }
+        }
+        if (!rowInFront) continue;
+
+        // Only bins lying completely inside the row's screen extent are known to be covered
+        for (int bin = 0; bin < binCount; ++bin) {
+            if (bin * OCCLUSION_BIN_PIXELS >= rowLeft && (bin + 1) * OCCLUSION_BIN_PIXELS <= rowRight) {
+                occlusionHorizon[bin] = std::max(occlusionHorizon[bin], occlusionRowHorizon[bin]);
+            }
+        }
+    }
+    return true;
+}
+
+void Renderer::cullDistantTerrainChunks(const glm::mat4& distantModel) {
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    Terrain* distantTerrain = world->getDistantTerrain();
+    const std::vector<TerrainChunk>& chunks = distantTerrain->getChunks();
+    distantChunkVisibility.assign(chunks.size(), 1);
+    occlusionStats = OcclusionCullingStats();
+    occlusionStats.totalChunks = static_cast<int>(chunks.size());
+
+    bool horizonValid = buildOcclusionHorizon();
+    const int binCount = static_cast<int>(occlusionHorizon.size());
+    glm::mat4 modelViewProjection = projection * view * distantModel;
+
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        const TerrainChunk& chunk = chunks[i];
+
+        // Screen rectangle of the chunk's bounding box; a corner behind the camera keeps the chunk
+        float left = FLT_MAX, right = -FLT_MAX, bottom = FLT_MAX, top = -FLT_MAX;
+        bool behindCamera = false;
+        for (int corner = 0; corner < 8 && !behindCamera; ++corner) {
+            glm::vec4 point((corner & 1) ? chunk.boundsMax.x : chunk.boundsMin.x,
+                (corner & 2) ? chunk.boundsMax.y : chunk.boundsMin.y,
+                (corner & 4) ? chunk.boundsMax.z : chunk.boundsMin.z, 1.0f);
+            glm::vec4 clip = modelViewProjection * point;
+            if (clip.w <= 0.1f) {
+                behindCamera = true;
+                break;
+            }
+            float sx = (clip.x / clip.w * 0.5f + 0.5f) * WINDOW_WIDTH;
+            float sy = (clip.y / clip.w * 0.5f + 0.5f) * WINDOW_HEIGHT;
+            left = std::min(left, sx);
+            right = std::max(right, sx);
+            bottom = std::min(bottom, sy);
+            top = std::max(top, sy);
+        }
+        if (behindCamera) continue;
+
+        bool culled = false;
+        if (right < 0.0f || left > WINDOW_WIDTH || top < 0.0f || bottom > WINDOW_HEIGHT) {
+            ++occlusionStats.outsideChunks;
+            culled = true;
+        } else if (horizonValid) {
+            int firstBin = std::max(0, static_cast<int>(std::floor(left / OCCLUSION_BIN_PIXELS)));
+            int lastBin = std::min(binCount - 1, static_cast<int>(std::floor(right / OCCLUSION_BIN_PIXELS)));
+            float lowestHorizon = FLT_MAX;
+            for (int bin = firstBin; bin <= lastBin; ++bin) {
+                lowestHorizon = std::min(lowestHorizon, occlusionHorizon[bin]);
+            }
+            if (top < lowestHorizon) {
+                ++occlusionStats.occludedChunks;
+                culled = true;
+            }
+        }
+
+        if (culled) {
+            distantChunkVisibility[i] = 0;
+            occlusionStats.savedTriangles += static_cast<size_t>(chunk.indexCount) / 3;
+        }
+    }
+
+    occlusionStats.cpuMilliseconds = static_cast<float>(SDL_GetPerformanceCounter() - start) * 1000.0f / static_cast<float>(SDL_GetPerformanceFrequency());
 }
 
 void Renderer::renderCelestialText() {
@@ -876,6 +1378,24 @@ void Renderer::renderCelestialText() {
                 "Rendering celestial text with starAlpha=" + std::to_string(starAlpha));
         }
         celestialObjectManager->renderText(this, starAlpha);
+
+        // Labels may not start below the distant terrain's ridge line, taken per column across the window
+        Terrain* distantTerrain = world->getDistantTerrain();
+        if (distantTerrain) {
+            labelSkyline = distantTerrain->getHeightmap(LABEL_SKYLINE_COLUMNS);
+            float yOffset = world->getDistantParams().yOffset;
+            for (float& height : labelSkyline) {
+                height = height == FLT_MAX ? 0.0f : height + yOffset;
+            }
+        } else {
+            labelSkyline.clear();
+        }
+        labelPlacer.setViewport(WINDOW_WIDTH, WINDOW_HEIGHT);
+        labelPlacer.setSkyline(labelSkyline);
+        for (const PlacedLabel& label : labelPlacer.place()) {
+            renderText(*label.text, label.position.x, label.position.y, label.scale, label.color, true);
+        }
+        flushText();
     }
     if (textFrameCounter % 60 == 0) {
         textFrameCounter = 0;
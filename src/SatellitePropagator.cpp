@@ -0,0 +1,367 @@
+#include "SatellitePropagator.hpp"
+#include "DataManager.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+
+// WGS-72 constants, which the TLE mean elements are fitted with
+static const double EARTH_RADIUS = 6378.135;  // km
+static const double XKE = 0.0743669161331734; // sqrt(mu / radius^3) in earth radii per minute
+static const double J2 = 0.001082616;
+static const double J3OJ2 = -0.00000253881 / 0.001082616;
+static const double J4 = -0.00000165597;
+static const double FLATTENING = 1.0 / 298.26;
+static const double TWO_PI = 6.283185307179586;
+static const double MINUTES_PER_DAY = 1440.0;
+
+static double parseField(const std::string& line, size_t start, size_t length) {
+    if (line.size() < start + length) return 0.0;
+    return std::atof(line.substr(start, length).c_str());
+}
+
+// TLE exponent notation with an implied leading decimal point, like " 28098-4" for 0.28098e-4
+static double parseExponentField(const std::string& line, size_t start) {
+    if (line.size() < start + 8) return 0.0;
+    double mantissa = std::atof(("0." + line.substr(start + 1, 5)).c_str());
+    if (line[start] == '-') mantissa = -mantissa;
+    int exponent = std::atoi(line.substr(start + 6, 2).c_str());
+    return mantissa * std::pow(10.0, exponent);
+}
+
+static double julianDateOfYearStart(int year) {
+    // Julian date of January 1, 00:00 UTC
+    return 367.0 * year - std::floor(7.0 * year * 0.25) + 30.0 + 1.0 + 1721013.5;
+}
+
+bool SatellitePropagator::loadTle(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        // The TLE file is optional; without it the scripted satellites keep flying
+        DataManager::LogDebug(DebugCategory::RENDERING, "SatellitePropagator", "loadTle", "No TLE file at " + path);
+        return false;
+    }
+
+    elements = Elements();
+    names.clear();
+    stations.clear();
+    stats = SatellitePropagatorStats();
+
+    std::string line, name, line1;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.size() >= 69 && line[0] == '1' && line[1] == ' ') {
+            line1 = line;
+        } else if (line.size() >= 69 && line[0] == '2' && line[1] == ' ' && !line1.empty()) {
+            if (!addSatellite(name.empty() ? line1.substr(2, 5) : name, line1, line)) ++stats.deepSpaceSkipped;
+            line1.clear();
+            name.clear();
+        } else if (!line.empty()) {
+            // Name lines may carry the "0 " prefix of the three-line format and trailing padding
+            name = line.compare(0, 2, "0 ") == 0 ? line.substr(2) : line;
+            name.erase(name.find_last_not_of(' ') + 1);
+        }
+    }
+
+    stats.loaded = names.size();
+    nextUpdate.assign(names.size(), 0.0);
+    east.assign(names.size(), 0.0f);
+    north.assign(names.size(), 0.0f);
+    up.assign(names.size(), -1.0f);
+    sunlit.assign(names.size(), 0);
+    dueIndices.reserve(names.size());
+
+    DataManager::LogDebug(DebugCategory::RENDERING, "SatellitePropagator", "loadTle",
+        "Loaded " + std::to_string(names.size()) + " satellites from " + path + ", skipped " +
+        std::to_string(stats.deepSpaceSkipped) + " deep-space orbits");
+    if (names.empty()) {
+        DataManager::LogWarning("SatellitePropagator", "loadTle", "No near-Earth satellites in " + path);
+        return false;
+    }
+    return true;
+}
+
+bool SatellitePropagator::addSatellite(const std::string& name, const std::string& line1, const std::string& line2) {
+    int year = static_cast<int>(parseField(line1, 18, 2));
+    year += year < 57 ? 2000 : 1900;
+    double epoch = julianDateOfYearStart(year) - 1.0 + parseField(line1, 20, 12);
+    double bstar = parseExponentField(line1, 53);
+    double inclo = parseField(line2, 8, 8) * TWO_PI / 360.0;
+    double nodeo = parseField(line2, 17, 8) * TWO_PI / 360.0;
+    double ecco = parseField(line2, 26, 7) * 1e-7;
+    double argpo = parseField(line2, 34, 8) * TWO_PI / 360.0;
+    double mo = parseField(line2, 43, 8) * TWO_PI / 360.0;
+    double noKozai = parseField(line2, 52, 11) * TWO_PI / MINUTES_PER_DAY; // radians per minute
+
+    // SGP4 initialization (Spacetrack Report #3, as revised by Vallado et al. 2006), near-Earth branch only
+    double cosio = std::cos(inclo), sinio = std::sin(inclo);
+    double cosio2 = cosio * cosio;
+    double eccsq = ecco * ecco;
+    double omeosq = 1.0 - eccsq;
+    double rteosq = std::sqrt(omeosq);
+    double ak = std::pow(XKE / noKozai, 2.0 / 3.0);
+    double d1 = 0.75 * J2 * (3.0 * cosio2 - 1.0) / (rteosq * omeosq);
+    double del = d1 / (ak * ak);
+    double adel = ak * (1.0 - del * del - del * (1.0 / 3.0 + 134.0 * del * del / 81.0));
+    del = d1 / (adel * adel);
+    double no = noKozai / (1.0 + del);
+    if (TWO_PI / no >= 225.0) return false;
+
+    double ao = std::pow(XKE / no, 2.0 / 3.0);
+    double po = ao * omeosq;
+    double con42 = 1.0 - 5.0 * cosio2;
+    double con41 = -con42 - cosio2 - cosio2;
+    double posq = po * po;
+    double rp = ao * (1.0 - ecco);
+    bool simple = rp < 220.0 / EARTH_RADIUS + 1.0;
+
+    double sfour = 78.0 / EARTH_RADIUS + 1.0;
+    double qzms24 = std::pow((120.0 - 78.0) / EARTH_RADIUS, 4.0);
+    double perigee = (rp - 1.0) * EARTH_RADIUS;
+    if (perigee < 156.0) {
+        sfour = perigee < 98.0 ? 20.0 : perigee - 78.0;
+        qzms24 = std::pow((120.0 - sfour) / EARTH_RADIUS, 4.0);
+        sfour = sfour / EARTH_RADIUS + 1.0;
+    }
+    double pinvsq = 1.0 / posq;
+    double tsi = 1.0 / (ao - sfour);
+    double eta = ao * ecco * tsi;
+    double etasq = eta * eta;
+    double eeta = ecco * eta;
+    double psisq = std::fabs(1.0 - etasq);
+    double coef = qzms24 * std::pow(tsi, 4.0);
+    double coef1 = coef / std::pow(psisq, 3.5);
+    double cc2 = coef1 * no * (ao * (1.0 + 1.5 * etasq + eeta * (4.0 + etasq)) +
+        0.375 * J2 * tsi / psisq * con41 * (8.0 + 3.0 * etasq * (8.0 + etasq)));
+    double cc1 = bstar * cc2;
+    double cc3 = ecco > 1.0e-4 ? -2.0 * coef * tsi * J3OJ2 * no * sinio / ecco : 0.0;
+    double x1mth2 = 1.0 - cosio2;
+    double cc4 = 2.0 * no * coef1 * ao * omeosq * (eta * (2.0 + 0.5 * etasq) + ecco * (0.5 + 2.0 * etasq) -
+        J2 * tsi / (ao * psisq) * (-3.0 * con41 * (1.0 - 2.0 * eeta + etasq * (1.5 - 0.5 * eeta)) +
+        0.75 * x1mth2 * (2.0 * etasq - eeta * (1.0 + etasq)) * std::cos(2.0 * argpo)));
+    double cc5 = 2.0 * coef1 * ao * omeosq * (1.0 + 2.75 * (etasq + eeta) + eeta * etasq);
+    double cosio4 = cosio2 * cosio2;
+    double temp1 = 1.5 * J2 * pinvsq * no;
+    double temp2 = 0.5 * temp1 * J2 * pinvsq;
+    double temp3 = -0.46875 * J4 * pinvsq * pinvsq * no;
+    double mdot = no + 0.5 * temp1 * rteosq * con41 + 0.0625 * temp2 * rteosq * (13.0 - 78.0 * cosio2 + 137.0 * cosio4);
+    double argpdot = -0.5 * temp1 * con42 + 0.0625 * temp2 * (7.0 - 114.0 * cosio2 + 395.0 * cosio4) +
+        temp3 * (3.0 - 36.0 * cosio2 + 49.0 * cosio4);
+    double xhdot1 = -temp1 * cosio;
+    double nodedot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * cosio2) + 2.0 * temp3 * (3.0 - 7.0 * cosio2)) * cosio;
+
+    Elements& e = elements;
+    e.epoch.push_back(epoch);
+    e.meanMotion.push_back(no);
+    e.eccentricity.push_back(ecco);
+    e.inclination.push_back(inclo);
+    e.node.push_back(nodeo);
+    e.argPerigee.push_back(argpo);
+    e.meanAnomaly.push_back(mo);
+    e.bstar.push_back(bstar);
+    e.mdot.push_back(mdot);
+    e.argpdot.push_back(argpdot);
+    e.nodedot.push_back(nodedot);
+    e.nodecf.push_back(3.5 * omeosq * xhdot1 * cc1);
+    e.cc1.push_back(cc1);
+    e.cc4.push_back(cc4);
+    e.eta.push_back(eta);
+    e.delmo.push_back(std::pow(1.0 + eta * std::cos(mo), 3.0));
+    e.sinmao.push_back(std::sin(mo));
+    e.t2cof.push_back(1.5 * cc1);
+    e.aycof.push_back(-0.5 * J3OJ2 * sinio);
+    double xlcofDivisor = std::fabs(cosio + 1.0) > 1.5e-12 ? 1.0 + cosio : 1.5e-12;
+    e.xlcof.push_back(-0.25 * J3OJ2 * sinio * (3.0 + 5.0 * cosio) / xlcofDivisor);
+    e.con41.push_back(con41);
+    e.x1mth2.push_back(x1mth2);
+    e.x7thm1.push_back(7.0 * cosio2 - 1.0);
+    e.cosio.push_back(cosio);
+    e.sinio.push_back(sinio);
+
+    // Low perigees use the simplified drag model; zeroing its extra terms lets one code path handle both
+    if (simple) {
+        e.cc5.push_back(0.0);
+        e.omgcof.push_back(0.0);
+        e.xmcof.push_back(0.0);
+        e.d2.push_back(0.0);
+        e.d3.push_back(0.0);
+        e.d4.push_back(0.0);
+        e.t3cof.push_back(0.0);
+        e.t4cof.push_back(0.0);
+        e.t5cof.push_back(0.0);
+    } else {
+        double cc1sq = cc1 * cc1;
+        double d2 = 4.0 * ao * tsi * cc1sq;
+        double temp = d2 * tsi * cc1 / 3.0;
+        double d3 = (17.0 * ao + sfour) * temp;
+        double d4 = 0.5 * temp * ao * tsi * (221.0 * ao + 31.0 * sfour) * cc1;
+        e.cc5.push_back(cc5);
+        e.omgcof.push_back(bstar * cc3 * std::cos(argpo));
+        e.xmcof.push_back(ecco > 1.0e-4 ? -2.0 / 3.0 * coef * bstar / eeta : 0.0);
+        e.d2.push_back(d2);
+        e.d3.push_back(d3);
+        e.d4.push_back(d4);
+        e.t3cof.push_back(d2 + 2.0 * cc1sq);
+        e.t4cof.push_back(0.25 * (3.0 * d3 + cc1 * (12.0 * d2 + 10.0 * cc1sq)));
+        e.t5cof.push_back(0.2 * (3.0 * d4 + 12.0 * cc1 * d3 + 6.0 * d2 * d2 + 15.0 * cc1sq * (2.0 * d2 + cc1sq)));
+    }
+
+    names.push_back(name);
+    int catalogNumber = static_cast<int>(parseField(line1, 2, 5));
+    stations.push_back(catalogNumber == 25544 || catalogNumber == 48274 ? 1 : 0);
+    return true;
+}
+
+void SatellitePropagator::invalidateSchedule() {
+    std::fill(nextUpdate.begin(), nextUpdate.end(), 0.0);
+}
+
+void SatellitePropagator::update(const SkyObserver& observer, const SkyProjection& projection, std::vector<VisibleSatellite>& visible) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    visible.clear();
+    const size_t count = names.size();
+    if (count == 0) return;
+
+    const double julianDate = observer.julianDate;
+    // Going back in time, a big jump or moving the observer makes the schedule meaningless
+    if (julianDate < lastJulianDate || julianDate - lastJulianDate > 1.0 ||
+        observer.latitude != lastLatitude || observer.longitude != lastLongitude) {
+        invalidateSchedule();
+    }
+    lastJulianDate = julianDate;
+    lastLatitude = observer.latitude;
+    lastLongitude = observer.longitude;
+
+    // Observer on the WGS-72 ellipsoid in the TEME frame, which is Earth-fixed rotated by sidereal time
+    double latitude = observer.latitude * TWO_PI / 360.0;
+    double theta = SkyProjection::greenwichSiderealTime(julianDate) + observer.longitude * TWO_PI / 360.0;
+    double sinLat = std::sin(latitude), cosLat = std::cos(latitude);
+    double sinTheta = std::sin(theta), cosTheta = std::cos(theta);
+    double e2 = FLATTENING * (2.0 - FLATTENING);
+    double primeVertical = EARTH_RADIUS / std::sqrt(1.0 - e2 * sinLat * sinLat);
+    double observerX = primeVertical * cosLat * cosTheta;
+    double observerY = primeVertical * cosLat * sinTheta;
+    double observerZ = primeVertical * (1.0 - e2) * sinLat;
+
+    // Low-precision Sun direction (Astronomical Almanac), good to about 0.01 degrees
+    double daysSinceJ2000 = julianDate - 2451545.0;
+    double meanLongitude = (280.460 + 0.9856474 * daysSinceJ2000) * TWO_PI / 360.0;
+    double meanAnomaly = (357.528 + 0.9856003 * daysSinceJ2000) * TWO_PI / 360.0;
+    double eclipticLongitude = meanLongitude + (1.915 * std::sin(meanAnomaly) + 0.020 * std::sin(2.0 * meanAnomaly)) * TWO_PI / 360.0;
+    double obliquity = (23.439 - 0.0000004 * daysSinceJ2000) * TWO_PI / 360.0;
+    double sunX = std::cos(eclipticLongitude);
+    double sunY = std::cos(obliquity) * std::sin(eclipticLongitude);
+    double sunZ = std::sin(obliquity) * std::sin(eclipticLongitude);
+
+    dueIndices.clear();
+    for (uint32_t i = 0; i < count; ++i) {
+        if (nextUpdate[i] <= julianDate) dueIndices.push_back(i);
+    }
+
+    const Elements& e = elements;
+    ThreadPool::shared().parallelFor(static_cast<int>(dueIndices.size()), 256, [&](int begin, int end, int) {
+        for (int k = begin; k < end; ++k) {
+            uint32_t i = dueIndices[k];
+            double t = (julianDate - e.epoch[i]) * MINUTES_PER_DAY;
+
+            // Secular gravity and atmospheric drag
+            double xmdf = e.meanAnomaly[i] + e.mdot[i] * t;
+            double argpdf = e.argPerigee[i] + e.argpdot[i] * t;
+            double nodedf = e.node[i] + e.nodedot[i] * t;
+            double t2 = t * t, t3 = t2 * t, t4 = t3 * t;
+            double nodem = nodedf + e.nodecf[i] * t2;
+            double delm = e.xmcof[i] * (std::pow(1.0 + e.eta[i] * std::cos(xmdf), 3.0) - e.delmo[i]);
+            double temp = e.omgcof[i] * t + delm;
+            double mm = xmdf + temp;
+            double argpm = argpdf - temp;
+            double tempa = 1.0 - e.cc1[i] * t - e.d2[i] * t2 - e.d3[i] * t3 - e.d4[i] * t4;
+            double tempe = e.bstar[i] * e.cc4[i] * t + e.bstar[i] * e.cc5[i] * (std::sin(mm) - e.sinmao[i]);
+            double templ = e.t2cof[i] * t2 + e.t3cof[i] * t3 + t4 * (e.t4cof[i] + t * e.t5cof[i]);
+
+            double am = std::pow(XKE / e.meanMotion[i], 2.0 / 3.0) * tempa * tempa;
+            double em = std::max(e.eccentricity[i] - tempe, 1.0e-6);
+            mm += e.meanMotion[i] * templ;
+
+            // Long-period periodics
+            double axnl = em * std::cos(argpm);
+            double invSemiLatus = 1.0 / (am * (1.0 - em * em));
+            double aynl = em * std::sin(argpm) + invSemiLatus * e.aycof[i];
+            double xl = mm + argpm + nodem + invSemiLatus * e.xlcof[i] * axnl;
+
+            // Kepler's equation with a fixed number of damped Newton steps, so every satellite takes the same path
+            double u = std::fmod(xl - nodem, TWO_PI);
+            double eo1 = u, sineo1 = 0.0, coseo1 = 1.0;
+            for (int iteration = 0; iteration < 10; ++iteration) {
+                sineo1 = std::sin(eo1);
+                coseo1 = std::cos(eo1);
+                double step = (u - aynl * coseo1 + axnl * sineo1 - eo1) / (1.0 - coseo1 * axnl - sineo1 * aynl);
+                eo1 += std::clamp(step, -0.95, 0.95);
+            }
+
+            // Short-period periodics
+            double ecose = axnl * coseo1 + aynl * sineo1;
+            double esine = axnl * sineo1 - aynl * coseo1;
+            double el2 = axnl * axnl + aynl * aynl;
+            double pl = am * (1.0 - el2);
+            double rl = am * (1.0 - ecose);
+            double betal = std::sqrt(std::max(1.0 - el2, 0.0));
+            double esineOverBeta = esine / (1.0 + betal);
+            double sinu = am / rl * (sineo1 - aynl - axnl * esineOverBeta);
+            double cosu = am / rl * (coseo1 - axnl + aynl * esineOverBeta);
+            double su = std::atan2(sinu, cosu);
+            double sin2u = (cosu + cosu) * sinu;
+            double cos2u = 1.0 - 2.0 * sinu * sinu;
+            double temp1 = 0.5 * J2 / pl;
+            double temp2 = temp1 / pl;
+            double mrt = rl * (1.0 - 1.5 * temp2 * betal * e.con41[i]) + 0.5 * temp1 * e.x1mth2[i] * cos2u;
+            su -= 0.25 * temp2 * e.x7thm1[i] * sin2u;
+            double xnode = nodem + 1.5 * temp2 * e.cosio[i] * sin2u;
+            double xinc = e.inclination[i] + 1.5 * temp2 * e.cosio[i] * e.sinio[i] * cos2u;
+
+            // Orientation vectors to the TEME position in km
+            double sinsu = std::sin(su), cossu = std::cos(su);
+            double snod = std::sin(xnode), cnod = std::cos(xnode);
+            double sini = std::sin(xinc), cosi = std::cos(xinc);
+            double radius = mrt * EARTH_RADIUS;
+            double x = radius * (-snod * cosi * sinsu + cnod * cossu);
+            double y = radius * (cnod * cosi * sinsu + snod * cossu);
+            double z = radius * (sini * sinsu);
+            // Decayed or invalid elements never become visible
+            bool valid = em < 1.0 && pl > 0.0 && mrt >= 1.0;
+
+            // Topocentric east, north and up
+            double dx = x - observerX, dy = y - observerY, dz = z - observerZ;
+            double range = std::sqrt(dx * dx + dy * dy + dz * dz);
+            double topEast = -sinTheta * dx + cosTheta * dy;
+            double topNorth = -sinLat * cosTheta * dx - sinLat * sinTheta * dy + cosLat * dz;
+            double topUp = cosLat * cosTheta * dx + cosLat * sinTheta * dy + sinLat * dz;
+            east[i] = static_cast<float>(topEast / range);
+            north[i] = static_cast<float>(topNorth / range);
+            up[i] = valid ? static_cast<float>(topUp / range) : -1.0f;
+
+            // Cylindrical Earth shadow: lit on the day side, or far enough off the Sun-Earth axis on the night side
+            double alongSun = x * sunX + y * sunY + z * sunZ;
+            double offAxisSquared = radius * radius - alongSun * alongSun;
+            sunlit[i] = (alongSun > 0.0 || offAxisSquared > EARTH_RADIUS * EARTH_RADIUS) ? 1 : 0;
+
+            double altitude = std::asin(std::clamp(static_cast<double>(up[i]), -1.0, 1.0)) * 360.0 / TWO_PI;
+            double secondsAway = std::min((NEAR_HORIZON - altitude) / MAX_ALTITUDE_RATE, MAX_SCHEDULE_STEP);
+            nextUpdate[i] = secondsAway > 0.0 ? julianDate + secondsAway / 86400.0 : julianDate;
+        }
+    });
+
+    stats.propagated = dueIndices.size();
+    stats.aboveHorizon = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (up[i] <= 0.0f) continue;
+        ++stats.aboveHorizon;
+        VisibleSatellite satellite;
+        if (!sunlit[i] || !projection.horizonToScreen(east[i], north[i], up[i], satellite.position)) continue;
+        satellite.altitude = std::asin(std::min(up[i], 1.0f)) * 57.2957795f;
+        satellite.index = i;
+        visible.push_back(satellite);
+    }
+    stats.visible = visible.size();
+    stats.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+}
@@ -0,0 +1,372 @@
+#include "ShaderRegistry.hpp"
+#include "DataManager.hpp"
+#include "GLStateCache.hpp"
+#include "StreamBuffer.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+static const char* const PROGRAM_CACHE_DIRECTORY = "resources\\cache\\programs";
+#else
+static const char* const PROGRAM_CACHE_DIRECTORY = "./resources/cache/programs";
+#endif
+
+// FNV-1a, 64-bit
+static uint64_t hashString(const std::string& text, uint64_t hash = 14695981039346656037ull) {
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static_assert(sizeof(FrameUniforms) == 176, "FrameUniforms must match the std140 layout of the Frame block");
+
+const char* const ShaderRegistry::FRAME_UNIFORM_BLOCK = R"(
+    layout(std140) uniform Frame {
+        mat4 view;
+        mat4 projection;
+        vec3 cameraPos;
+        vec3 lightPos;
+        vec3 lightColor;
+    };
+)";
+
+ShaderRegistry::ShaderRegistry()
+    : uniformBufferAlignment(256), driverQueried(false), binarySupport(false), driverHash(0), deferredCompilation(true),
+      deferredSubmitted(false) {
+}
+
+ShaderRegistry& ShaderRegistry::shared() {
+    static ShaderRegistry registry;
+    return registry;
+}
+
+// What the driver offers, asked once on the first submit() as it needs a current context
+void ShaderRegistry::queryDriver() {
+    if (driverQueried) return;
+    driverQueried = true;
+
+    GLint formats = 0;
+    if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary) glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    binarySupport = formats > 0;
+    // A binary is only good for the driver that produced it
+    std::string driver;
+    for (GLenum property : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+        const GLubyte* value = glGetString(property);
+        if (value) driver += reinterpret_cast<const char*>(value);
+        driver += '\n';
+    }
+    driverHash = hashString(driver);
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformBufferAlignment);
+
+    // Let the driver use as many compiler threads as it likes
+    if (GLEW_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+        stats.parallel = true;
+    } else if (GLEW_ARB_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+        stats.parallel = true;
+    }
+
+    DataManager::LogDebug(DebugCategory::RENDERING, "ShaderRegistry", "queryDriver",
+        std::string(binarySupport ? "Program binaries cached in " + std::string(PROGRAM_CACHE_DIRECTORY) : "No program binary formats") +
+        (stats.parallel ? ", parallel compilation" : ", serial compilation"));
+}
+
+GLuint ShaderRegistry::add(const std::string& name, const std::string& vertexSource, const std::string& fragmentSource,
+    LinkedCallback onLinked) {
+    queryDriver();
+    GLuint program = glCreateProgram();
+    ProgramInfo& info = programs[program];
+    info.name = name;
+    info.vertexSource = vertexSource;
+    info.fragmentSource = fragmentSource;
+    info.onLinked = std::move(onLinked);
+    info.sourceHash = hashString(fragmentSource, hashString(vertexSource + '\0'));
+    if (binarySupport) {
+        // One file per source, so a driver update replaces the stale binaries instead of piling up new ones
+        char fileName[32];
+        std::snprintf(fileName, sizeof(fileName), "program_%016llx.bin", static_cast<unsigned long long>(info.sourceHash));
+        info.cachePath = (std::filesystem::path(PROGRAM_CACHE_DIRECTORY) / fileName).string();
+    }
+    stats.programs = static_cast<int>(programs.size());
+    ++stats.pending;
+    return program;
+}
+
+GLuint ShaderRegistry::submit(const std::string& name, const std::string& vertexSource, const std::string& fragmentSource,
+    LinkedCallback onLinked) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    GLuint program = add(name, vertexSource, fragmentSource, std::move(onLinked));
+    ProgramInfo& info = programs[program];
+    beginLink(program, info);
+    stats.milliseconds += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+    if (!deferredCompilation) use(program);
+    return program;
+}
+
+GLuint ShaderRegistry::defer(const std::string& name, const std::string& vertexSource, const std::string& fragmentSource,
+    LinkedCallback onLinked) {
+    if (!deferredCompilation || deferredSubmitted) return submit(name, vertexSource, fragmentSource, std::move(onLinked));
+    return add(name, vertexSource, fragmentSource, std::move(onLinked));
+}
+
+void ShaderRegistry::submitDeferred() {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    deferredSubmitted = true;
+    for (auto& entry : programs) {
+        if (entry.second.state == ProgramState::DEFERRED) beginLink(entry.first, entry.second);
+    }
+    stats.milliseconds += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+GLuint ShaderRegistry::create(const std::string& name, const std::string& vertexSource, const std::string& fragmentSource,
+    LinkedCallback onLinked) {
+    GLuint program = submit(name, vertexSource, fragmentSource, std::move(onLinked));
+    if (use(program)) return program;
+    destroy(program);
+    return 0;
+}
+
+std::string ShaderRegistry::withDefines(const std::string& source, const std::string& defines) {
+    if (defines.empty()) return source;
+    size_t version = source.find("#version");
+    if (version == std::string::npos) return defines + source;
+    size_t lineEnd = source.find('\n', version);
+    if (lineEnd == std::string::npos) return source + "\n" + defines;
+    return source.substr(0, lineEnd + 1) + defines + source.substr(lineEnd + 1);
+}
+
+// The cached binary if there is a usable one, otherwise the sources; nothing here waits for the driver
+void ShaderRegistry::beginLink(GLuint program, ProgramInfo& info) {
+    info.fromCache = !info.cachePath.empty() && loadBinary(program, info);
+    if (!info.fromCache) compileAndLink(program, info);
+    info.state = ProgramState::LINKING;
+}
+
+void ShaderRegistry::compileAndLink(GLuint program, ProgramInfo& info) {
+    const char* vertexText = info.vertexSource.c_str();
+    info.vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(info.vertexShader, 1, &vertexText, nullptr);
+    glCompileShader(info.vertexShader);
+    const char* fragmentText = info.fragmentSource.c_str();
+    info.fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(info.fragmentShader, 1, &fragmentText, nullptr);
+    glCompileShader(info.fragmentShader);
+
+    if (binarySupport) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(program, info.vertexShader);
+    glAttachShader(program, info.fragmentShader);
+    glLinkProgram(program);
+}
+
+// Waits for the link, the first status query on the program, and sets it up for drawing
+bool ShaderRegistry::finish(GLuint program, ProgramInfo& info) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success && info.fromCache) {
+        // Drivers may refuse their own binaries after an update that kept the version string
+        DataManager::LogWarning("ShaderRegistry", "finish", info.cachePath + " was rejected by the driver; compiling it again");
+        info.fromCache = false;
+        compileAndLink(program, info);
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+    }
+    if (!success) logFailure(program, info);
+    if (info.vertexShader) {
+        glDetachShader(program, info.vertexShader);
+        glDeleteShader(info.vertexShader);
+    }
+    if (info.fragmentShader) {
+        glDetachShader(program, info.fragmentShader);
+        glDeleteShader(info.fragmentShader);
+    }
+    info.vertexShader = 0;
+    info.fragmentShader = 0;
+    --stats.pending;
+
+    if (!success) {
+        info.state = ProgramState::FAILED;
+        info.vertexSource.clear();
+        info.fragmentSource.clear();
+        info.onLinked = nullptr;
+        ++stats.failed;
+        return false;
+    }
+
+    if (!info.fromCache && !info.cachePath.empty()) saveBinary(program, info);
+    info.vertexSource.clear();
+    info.fragmentSource.clear();
+
+    // Block bindings and uniform values are not part of the binary, so they are set up the same either way
+    GLuint frameBlock = glGetUniformBlockIndex(program, "Frame");
+    if (frameBlock != GL_INVALID_INDEX) glUniformBlockBinding(program, frameBlock, FRAME_UNIFORM_BINDING);
+    resolveUniforms(program, info);
+    info.state = ProgramState::LINKED;
+    stats.uniforms += static_cast<int>(info.locations.size());
+    if (info.fromCache) {
+        ++stats.loaded;
+    } else {
+        ++stats.compiled;
+    }
+
+    GLStateCache::shared().useProgram(program);
+    if (info.onLinked) info.onLinked(program);
+    info.onLinked = nullptr;
+
+    float milliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+    stats.milliseconds += milliseconds;
+    DataManager::LogDebug(DebugCategory::RENDERING, "ShaderRegistry", "finish",
+        info.name + (info.fromCache ? " loaded: " : " compiled: ") + std::to_string(info.locations.size()) + " uniforms, waited " +
+        std::to_string(milliseconds) + " ms");
+    return true;
+}
+
+void ShaderRegistry::logFailure(GLuint program, const ProgramInfo& info) {
+    char infoLog[512];
+    GLint success;
+    GLuint shaders[2] = { info.vertexShader, info.fragmentShader };
+    for (GLuint shader : shaders) {
+        if (!shader) continue;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (success) continue;
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        DataManager::LogError("ShaderRegistry", "compile", info.name + (shader == info.vertexShader ? " vertex" : " fragment") +
+            " shader compilation failed: " + std::string(infoLog));
+        return;
+    }
+    glGetProgramInfoLog(program, 512, nullptr, infoLog);
+    DataManager::LogError("ShaderRegistry", "link", info.name + " shader program linking failed: " + std::string(infoLog));
+}
+
+bool ShaderRegistry::use(GLuint program) {
+    auto it = programs.find(program);
+    if (it != programs.end() && it->second.state != ProgramState::LINKED) {
+        ProgramInfo& info = it->second;
+        if (info.state == ProgramState::DEFERRED) beginLink(program, info);
+        if (info.state == ProgramState::LINKING) finish(program, info);
+        if (info.state == ProgramState::FAILED) {
+            GLStateCache::shared().useProgram(0);
+            return false;
+        }
+    }
+    GLStateCache::shared().useProgram(program);
+    return true;
+}
+
+bool ShaderRegistry::isReady(GLuint program) {
+    auto it = programs.find(program);
+    if (it == programs.end()) return program != 0;
+    switch (it->second.state) {
+        case ProgramState::LINKED: return true;
+        case ProgramState::FAILED:
+        case ProgramState::DEFERRED: return false;
+        case ProgramState::LINKING: break;
+    }
+    // Without parallel compilation there is no asking; the first use() waits
+    if (!stats.parallel) return true;
+    GLint done = GL_FALSE;
+    glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &done);
+    return done == GL_TRUE;
+}
+
+bool ShaderRegistry::loadBinary(GLuint program, const ProgramInfo& info) {
+    const std::string& path = info.cachePath;
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    BinaryHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.magic, "CPRG", 4) != 0 ||
+        header.version != BINARY_FILE_VERSION || header.sourceHash != info.sourceHash) {
+        DataManager::LogWarning("ShaderRegistry", "loadBinary", path + " does not match the " + info.name + " source; compiling it again");
+        return false;
+    }
+    if (header.driverHash != driverHash) {
+        DataManager::LogDebug(DebugCategory::RENDERING, "ShaderRegistry", "loadBinary", path + " was built by another driver; compiling it again");
+        return false;
+    }
+    std::vector<char> binary(header.length);
+    if (!file.read(binary.data(), binary.size())) {
+        DataManager::LogWarning("ShaderRegistry", "loadBinary", path + " is truncated; compiling it again");
+        return false;
+    }
+    // Whether the driver accepts it is only asked in finish()
+    glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+    return true;
+}
+
+void ShaderRegistry::saveBinary(GLuint program, const ProgramInfo& info) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    BinaryHeader header = { { 'C', 'P', 'R', 'G' }, BINARY_FILE_VERSION, info.sourceHash, driverHash, format,
+        static_cast<uint32_t>(length) };
+    DataManager::WriteFileAtomically(info.cachePath, { &header, sizeof(header) }, { { binary.data(), static_cast<size_t>(length) } });
+}
+
+// Every active uniform outside a block, by its name and, for arrays, also by the name without "[0]"
+void ShaderRegistry::resolveUniforms(GLuint program, ProgramInfo& info) {
+    GLint count = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        char name[256];
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, static_cast<GLuint>(i), sizeof(name), &length, &size, &type, name);
+        GLint location = glGetUniformLocation(program, name);
+        if (location < 0) continue;
+        std::string uniformName(name, length);
+        info.locations[uniformName] = location;
+        if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0) {
+            info.locations[uniformName.substr(0, uniformName.size() - 3)] = location;
+        }
+    }
+}
+
+GLint ShaderRegistry::findLocation(GLuint program, const std::string& name) const {
+    auto programIt = programs.find(program);
+    if (programIt == programs.end()) return -1;
+    auto it = programIt->second.locations.find(name);
+    if (it == programIt->second.locations.end()) {
+        // Usually optimized out by the compiler rather than misspelled, so not an error
+        DataManager::LogDebug(DebugCategory::RENDERING, "ShaderRegistry", "uniform",
+            programIt->second.name + " has no active uniform " + name);
+        return -1;
+    }
+    return it->second;
+}
+
+void ShaderRegistry::destroy(GLuint program) {
+    auto it = programs.find(program);
+    if (it == programs.end()) return;
+    ProgramInfo& info = it->second;
+    if (info.vertexShader) glDeleteShader(info.vertexShader);
+    if (info.fragmentShader) glDeleteShader(info.fragmentShader);
+    if (info.state == ProgramState::DEFERRED || info.state == ProgramState::LINKING) --stats.pending;
+    stats.uniforms -= static_cast<int>(info.locations.size());
+    programs.erase(it);
+    stats.programs = static_cast<int>(programs.size());
+    GLStateCache::shared().deleteProgram(program);
+}
+
+void ShaderRegistry::updateFrameUniforms(const FrameUniforms& frame) {
+    // A fresh copy in the frame's stream region each time, so last frame's draws can still read theirs
+    queryDriver();
+    StreamBuffer& stream = StreamBuffer::shared();
+    GLintptr offset = stream.upload(&frame, sizeof(FrameUniforms), static_cast<size_t>(uniformBufferAlignment));
+    glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, stream.getBuffer(), offset, sizeof(FrameUniforms));
+    stats.frameUniformBytes = sizeof(FrameUniforms);
+}
+
+void ShaderRegistry::cleanup() {
+    while (!programs.empty()) destroy(programs.begin()->first);
+}
@@ -1,18 +1,127 @@
 #include "Sky.hpp"
 #include "Constants.hpp"
 #include "DataManager.hpp"
+#include "ShaderRegistry.hpp"
+#include "GLStateCache.hpp"
+#include <string>
+
+static const char* const CLOUD_VERTEX_SOURCE = R"(
+    #version 330 core
+    layout(location = 0) in vec3 aPos;
+    out vec2 TexCoord;
+    void main() {
+        gl_Position = vec4(aPos, 1.0);
+        TexCoord = (aPos.xy + 1.0) / 2.0; // Map to [0, 1]
+    }
+)";
+
+// Cloud cover at a point of the screen, before the time of day is applied, from the baked noise of NoiseTexture. Both layers drift at the same
+// 0.0075 / aspectRatio of the screen width per second, which the checkerboard reprojection relies on.
+static const char* const CLOUD_NOISE_SOURCE = R"(
+    uniform float time;
+    uniform float aspectRatio;
+
+    uniform sampler2D noiseTexture;
+    uniform float noisePeriod;
+
+    // Six octaves from the baked tile, which holds one octave per channel: the first four in one fetch,
+    // the last two from a fetch sixteen times finer. Octaves double in frequency so the tile can repeat.
+    float fbm(vec2 st) {
+        vec2 uv = st / noisePeriod;
+        vec4 coarse = texture(noiseTexture, uv);
+        vec2 fine = texture(noiseTexture, uv * 16.0).rg;
+        return dot(coarse, vec4(0.5, 0.25, 0.125, 0.0625)) + dot(fine, vec2(0.03125, 0.015625));
+    }
+
+    float cloudCover(vec2 uv) {
+        // Slight reduction in cloud density at the top
+        float topFade = 1.0 - smoothstep(0.8, 1.0, uv.y); // Fade out slightly at the very top
+
+        // Layer 1: Base layer of clouds (slower, larger)
+        vec2 cloudPos1 = uv * 4.0; // Increased scale for smaller, more distinct clouds
+        cloudPos1.x *= aspectRatio;
+        float cloudNoise1 = fbm(cloudPos1 + vec2(time * 0.03, 0.0)); // Slower movement
+        float cloudAmount1 = smoothstep(0.5, 0.8, cloudNoise1) * 0.4; // Adjusted thresholds to make sparser, reduced opacity
+
+        // Layer 2: Detail layer of clouds (faster, smaller)
+        vec2 cloudPos2 = uv * 8.0; // Increased scale for smaller, more detailed clouds
+        cloudPos2.x *= aspectRatio;
+        float cloudNoise2 = fbm(cloudPos2 + vec2(time * 0.06, 0.0)); // Faster movement
+        float cloudAmount2 = smoothstep(0.6, 0.9, cloudNoise2) * 0.25; // Adjusted thresholds to make sparser, reduced opacity
+
+        // Combine layers
+        return max(cloudAmount1, cloudAmount2) * topFade;
+    }
+)";
+
+// Cloud colour for the times of day involved in the current one or the transition towards the next; compiled
+// into one variant per combination, see cloudShadingKey
+static const char* const CLOUD_SHADING_SOURCE = R"(
+    vec4 shadeClouds(float cloudAmount) {
+    #if defined(DUSK)
+        vec3 cloudColor = vec3(0.9, 0.6, 0.5);
+    #elif defined(DAWN)
+        vec3 cloudColor = vec3(0.9, 0.7, 0.6);
+    #else
+        vec3 cloudColor = vec3(0.8, 0.8, 0.9); // Default cloud color
+    #endif
+    #ifdef NIGHT
+        cloudAmount *= 0.2;
+    #endif
+
+        // Output the cloud color with transparency
+        return vec4(cloudColor, cloudAmount);
+    }
+)";
+
+// Variant keys of the cloud shading: a bit per time of day that changes it. Dusk takes precedence over dawn,
+// so the two together are the dusk variant and there are six in all.
+static const uint32_t CLOUD_SHADING_DAWN = 1;
+static const uint32_t CLOUD_SHADING_DUSK = 2;
+static const uint32_t CLOUD_SHADING_NIGHT = 4;
+static const uint32_t CLOUD_SHADING_KEYS[] = {
+    0, CLOUD_SHADING_DAWN, CLOUD_SHADING_DUSK, CLOUD_SHADING_NIGHT,
+    CLOUD_SHADING_DAWN | CLOUD_SHADING_NIGHT, CLOUD_SHADING_DUSK | CLOUD_SHADING_NIGHT
+};
+
+static uint32_t cloudShadingKey(TimeOfDay source, TimeOfDay target) {
+    auto involves = [&](TimeOfDay timeOfDay) { return source == timeOfDay || target == timeOfDay; };
+    uint32_t key = 0;
+    if (involves(TimeOfDay::DUSK)) {
+        key |= CLOUD_SHADING_DUSK;
+    } else if (involves(TimeOfDay::DAWN)) {
+        key |= CLOUD_SHADING_DAWN;
+    }
+    if (involves(TimeOfDay::NIGHT)) key |= CLOUD_SHADING_NIGHT;
+    return key;
+}
+
+static std::string cloudShadingDefines(uint32_t key) {
+    std::string defines;
+    if (key & CLOUD_SHADING_DAWN) defines += "#define DAWN\n";
+    if (key & CLOUD_SHADING_DUSK) defines += "#define DUSK\n";
+    if (key & CLOUD_SHADING_NIGHT) defines += "#define NIGHT\n";
+    return defines;
+}
+
+// Vertical field of view the sky covers from the horizon at the bottom of the screen, in radians (75 degrees)
+static const float SKY_FIELD_OF_VIEW = 1.3089969f;
+
+// Screen widths per second the cloud layers move left by; see cloudCover
+static const float CLOUD_DRIFT_PER_SECOND = 0.0075f;
 
-Sky::Sky() : skyShader(0), skyVAO(0), skyVBO(0), skyEBO(0),
-cloudShader(0), cloudVAO(0), cloudVBO(0), cloudEBO(0),
+Sky::Sky() : skyShader(0), skyVAO(0), skyVBO(0), skyEBO(0), rayleighTexture(0), mieTexture(0),
+cloudVAO(0), cloudVBO(0), cloudEBO(0),
+cloudQuality(CloudQuality::HALF_CHECKERBOARD), cloudDensityShader(0), cloudResolveShader(0),
+cloudFramebuffers{0, 0}, cloudTextures{0, 0}, cloudFreshFramebuffer(0), cloudFreshTexture(0), cloudTargetWidth(0), cloudTargetHeight(0),
+cloudCurrent(0), cloudHistoryValid(false), cloudHistoryTime(0.0f), cloudFrame(0),
 immediateFadeFromNight(false) {
-    skyColorTop = glm::vec3(0.2f, 0.4f, 0.8f);
-    skyColorBottom = glm::vec3(0.5f, 0.7f, 1.0f);
     skyTransitionTime = 0.0f;
     skyTransitionDuration = 1.0f;
     skyTransitioning = false;
     currentTimeOfDay = TimeOfDay::MID_DAY;
+    targetTimeOfDay = TimeOfDay::MID_DAY;
     sunMoonPosition = 0.5f;
-    transitionProgress = 0.0f;
     aspectRatio = static_cast<float>(WINDOW_WIDTH) / WINDOW_HEIGHT;
 }
 
@@ -44,7 +153,7 @@ bool Sky::initializeSky() {
     glGenBuffers(1, &skyVBO);
     glGenBuffers(1, &skyEBO);
 
-    glBindVertexArray(skyVAO);
+    GLStateCache::shared().bindVertexArray(skyVAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, skyVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(skyVertices), skyVertices, GL_STATIC_DRAW);
@@ -55,7 +164,7 @@ bool Sky::initializeSky() {
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
 
-    glBindVertexArray(0);
+    GLStateCache::shared().bindVertexArray(0);
 
     const char* vertexShaderSource = R"(
         #version 330 core
@@ -67,31 +176,55 @@ bool Sky::initializeSky() {
         }
     )";
 
+    // Each pixel looks along elevation and azimuth from the screen position; the scattering tables give the light
+    // scattered towards it without the phase functions, which depend on the angle to the sun and are applied here
     const char* fragmentShaderSource = R"(
         #version 330 core
         out vec4 FragColor;
         in vec2 TexCoord;
-        uniform vec3 topColor;
-        uniform vec3 bottomColor;
-        uniform float sunMoonPosition;
-        uniform int sourceTimeOfDay;
-        uniform int targetTimeOfDay;
-        uniform float transitionProgress;
+        uniform sampler3D rayleighTable;
+        uniform sampler3D mieTable;
+        uniform vec3 tableSize;
+        uniform float minSunElevation;
+        uniform float mieAsymmetry;
+        uniform float sunElevation;
+        uniform float sunAzimuth;
+        uniform float fieldOfView;
+        uniform float nightAmount;
         uniform float aspectRatio;
 
+        const float PI = 3.14159265;
+        const float HALF_PI = 1.57079633;
+        const float SUN_INTENSITY = 70.0;
+
         float random(vec2 st) {
             return fract(sin(dot(st, vec2(12.9898, 78.233))) * 43758.5453123);
         }
 
         void main() {
+            float elevation = TexCoord.y * fieldOfView;
+            float azimuth = (TexCoord.x - 0.5) * fieldOfView * aspectRatio;
+            vec3 view = vec3(cos(elevation) * sin(azimuth), sin(elevation), cos(elevation) * cos(azimuth));
+            vec3 sun = vec3(cos(sunElevation) * sin(sunAzimuth), sin(sunElevation), cos(sunElevation) * cos(sunAzimuth));
+            float mu = dot(view, sun);
+
+            // Table coordinates as laid out by Atmosphere, remapped onto texel centres
+            vec3 coord = vec3(sqrt(elevation / HALF_PI),
+                clamp((sunElevation - minSunElevation) / (HALF_PI - minSunElevation), 0.0, 1.0),
+                min(abs(azimuth - sunAzimuth), PI) / PI);
+            coord = (coord * (tableSize - 1.0) + 0.5) / tableSize;
+
+            float g = mieAsymmetry;
+            float rayleighPhase = 3.0 / (16.0 * PI) * (1.0 + mu * mu);
+            float miePhase = 3.0 / (8.0 * PI) * ((1.0 - g * g) * (1.0 + mu * mu)) / ((2.0 + g * g) * pow(1.0 + g * g - 2.0 * g * mu, 1.5));
+            vec3 radiance = texture(rayleighTable, coord).rgb * rayleighPhase + texture(mieTable, coord).rgb * miePhase;
+            vec3 skyColor = 1.0 - exp(-radiance * SUN_INTENSITY);
+
             float t = pow(TexCoord.y, 2.2);
-            vec3 skyColor = mix(bottomColor, topColor, t);
+            skyColor += mix(vec3(0.0, 0.0, 0.2), vec3(0.0, 0.0, 0.1), t) * nightAmount;
 
             float noise = random(TexCoord * 1000.0);
-            float ditherAmount = 0.015;
-            if (sourceTimeOfDay == 3 || targetTimeOfDay == 3) {
-                ditherAmount = 0.005;
-            }
+            float ditherAmount = mix(0.015, 0.005, nightAmount);
             skyColor += (noise - 0.5) * ditherAmount;
 
             skyColor = clamp(skyColor, 0.0, 1.0);
@@ -99,47 +232,26 @@ bool Sky::initializeSky() {
         }
     )";
 
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
-    glCompileShader(vertexShader);
-    GLint success;
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
-        DataManager::LogError("Sky", "initializeSky", "Sky vertex shader compilation failed: " + std::string(infoLog));
-        return false;
-    }
-
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
-    glCompileShader(fragmentShader);
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
-        DataManager::LogError("Sky", "initializeSky", "Sky fragment shader compilation failed: " + std::string(infoLog));
-        return false;
-    }
-
-    skyShader = glCreateProgram();
-    glAttachShader(skyShader, vertexShader);
-    glAttachShader(skyShader, fragmentShader);
-    glLinkProgram(skyShader);
-    glGetProgramiv(skyShader, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(skyShader, 512, nullptr, infoLog);
-        DataManager::LogError("Sky", "initializeSky", "Sky shader program linking failed: " + std::string(infoLog));
-        return false;
-    }
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    skyShader = ShaderRegistry::shared().submit("Sky", vertexShaderSource, fragmentShaderSource, [this](GLuint program) {
+        ShaderRegistry& registry = ShaderRegistry::shared();
+        skyUniforms.sunElevation = registry.uniform<float>(program, "sunElevation");
+        skyUniforms.sunAzimuth = registry.uniform<float>(program, "sunAzimuth");
+        skyUniforms.nightAmount = registry.uniform<float>(program, "nightAmount");
+        skyUniforms.aspectRatio = registry.uniform<float>(program, "aspectRatio");
+
+        // The table layout and the sampler units never change, so they are set once here
+        registry.uniform<int>(program, "rayleighTable").set(0);
+        registry.uniform<int>(program, "mieTable").set(1);
+        registry.uniform<glm::vec3>(program, "tableSize").set(glm::vec3(static_cast<float>(Atmosphere::SCATTERING_VIEW),
+            static_cast<float>(Atmosphere::SCATTERING_SUN), static_cast<float>(Atmosphere::SCATTERING_AZIMUTH)));
+        registry.uniform<float>(program, "minSunElevation").set(Atmosphere::MIN_SUN_ELEVATION);
+        registry.uniform<float>(program, "mieAsymmetry").set(Atmosphere::MIE_ASYMMETRY);
+        registry.uniform<float>(program, "fieldOfView").set(SKY_FIELD_OF_VIEW);
+    });
     return true;
 }
 
-void Sky::renderClouds(TimeOfDay timeOfDay, float transitionProgress, float totalTime) {
+void Sky::renderClouds(TimeOfDay timeOfDay, float totalTime) {
     float density;
     glm::vec3 cloudColor;
     switch (timeOfDay) {
@@ -165,19 +277,130 @@ void Sky::renderClouds(TimeOfDay timeOfDay, float transitionProgress, float tota
             break;
     }
 
-    glDepthMask(GL_FALSE);
-    glUseProgram(cloudShader);
-    glUniform1f(glGetUniformLocation(cloudShader, "time"), totalTime);
-    glUniform1i(glGetUniformLocation(cloudShader, "sourceTimeOfDay"), static_cast<int>(timeOfDay));
-    glUniform1i(glGetUniformLocation(cloudShader, "targetTimeOfDay"), static_cast<int>(targetTimeOfDay));
-    glUniform1f(glGetUniformLocation(cloudShader, "transitionProgress"), transitionProgress);
-    glUniform1f(glGetUniformLocation(cloudShader, "aspectRatio"), aspectRatio);
-    glBindVertexArray(cloudVAO);
-    glDisable(GL_DEPTH_TEST);
+    GpuTimer& timer = cloudTimers[static_cast<int>(cloudQuality)];
+    timer.begin();
+    if (cloudQuality != CloudQuality::FULL) {
+        renderReducedClouds(timeOfDay, totalTime);
+        timer.end();
+        return;
+    }
+
+    const auto* cloudShader = cloudShaders.use(cloudShadingKey(timeOfDay, targetTimeOfDay));
+    if (!cloudShader) {
+        timer.end();
+        return;
+    }
+    GLStateCache::shared().depthMask(GL_FALSE);
+    cloudShader->uniforms.time.set(totalTime);
+    cloudShader->uniforms.aspectRatio.set(aspectRatio);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, cloudNoise.getTexture());
+    glActiveTexture(GL_TEXTURE0);
+    GLStateCache::shared().bindVertexArray(cloudVAO);
+    GLStateCache::shared().disable(GL_DEPTH_TEST);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glEnable(GL_DEPTH_TEST);
-    glBindVertexArray(0);
-    glDepthMask(GL_TRUE);
+    GLStateCache::shared().bindVertexArray(0);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    timer.end();
+}
+
+void Sky::renderReducedClouds(TimeOfDay timeOfDay, float totalTime) {
+    bool quarter = cloudQuality == CloudQuality::QUARTER || cloudQuality == CloudQuality::QUARTER_CHECKERBOARD;
+    bool checkerboard = cloudQuality == CloudQuality::HALF_CHECKERBOARD || cloudQuality == CloudQuality::QUARTER_CHECKERBOARD;
+    int divisor = quarter ? 4 : 2;
+    int width = (WINDOW_WIDTH + divisor - 1) / divisor;
+    int height = (WINDOW_HEIGHT + divisor - 1) / divisor;
+    if (width != cloudTargetWidth || height != cloudTargetHeight) {
+        if (!createCloudTargets(width, height)) {
+            cloudQuality = CloudQuality::FULL;
+            return;
+        }
+    }
+
+    // History is only good for the frame straight after: not across a pause, a time jump or a mode switch
+    float elapsed = totalTime - cloudHistoryTime;
+    bool historyValid = checkerboard && cloudHistoryValid && elapsed >= 0.0f && elapsed < 0.25f;
+    int parity = static_cast<int>(cloudFrame & 1u);
+    int next = 1 - cloudCurrent;
+
+    // Either pass failing to link falls back to full resolution, as failing to create the targets does;
+    // the resolve pass is waited for first so the density pass is left bound
+    ShaderRegistry& registry = ShaderRegistry::shared();
+    if ((checkerboard && !registry.use(cloudResolveShader)) || !registry.use(cloudDensityShader)) {
+        cloudQuality = CloudQuality::FULL;
+        return;
+    }
+
+    GLStateCache::shared().depthMask(GL_FALSE);
+    GLStateCache::shared().disable(GL_DEPTH_TEST);
+    GLStateCache::shared().disable(GL_BLEND);
+    GLStateCache::shared().bindVertexArray(cloudVAO);
+
+    cloudDensityUniforms.time.set(totalTime);
+    cloudDensityUniforms.aspectRatio.set(aspectRatio);
+    cloudDensityUniforms.targetSize.set(glm::vec2(static_cast<float>(width), static_cast<float>(height)));
+    cloudDensityUniforms.checkerboard.set(checkerboard);
+    cloudDensityUniforms.parity.set(parity);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, cloudNoise.getTexture());
+    glActiveTexture(GL_TEXTURE0);
+    if (checkerboard) {
+        glBindFramebuffer(GL_FRAMEBUFFER, cloudFreshFramebuffer);
+        GLStateCache::shared().viewport(0, 0, (width + 1) / 2, height);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, cloudFramebuffers[next]);
+        GLStateCache::shared().viewport(0, 0, width, height);
+        registry.use(cloudResolveShader);
+        cloudResolveUniforms.targetSize.set(glm::vec2(static_cast<float>(width), static_cast<float>(height)));
+        cloudResolveUniforms.parity.set(parity);
+        cloudResolveUniforms.drift.set(glm::vec2(CLOUD_DRIFT_PER_SECOND / aspectRatio * elapsed, 0.0f));
+        cloudResolveUniforms.historyValid.set(historyValid);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, cloudTextures[cloudCurrent]);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, cloudFreshTexture);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    } else {
+        glBindFramebuffer(GL_FRAMEBUFFER, cloudFramebuffers[next]);
+        GLStateCache::shared().viewport(0, 0, width, height);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
+    cloudCurrent = next;
+    cloudHistoryValid = true;
+    cloudHistoryTime = totalTime;
+    ++cloudFrame;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLStateCache::shared().viewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    GLStateCache::shared().enable(GL_BLEND);
+    GLStateCache::shared().blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    if (cloudCompositeShaders.use(cloudShadingKey(timeOfDay, targetTimeOfDay))) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, cloudTextures[cloudCurrent]);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    GLStateCache::shared().bindVertexArray(0);
+}
+
+const char* Sky::getCloudQualityName(CloudQuality quality) {
+    switch (quality) {
+        case CloudQuality::FULL: return "Full";
+        case CloudQuality::HALF: return "Half";
+        case CloudQuality::QUARTER: return "Quarter";
+        case CloudQuality::HALF_CHECKERBOARD: return "Half Checkerboard";
+        case CloudQuality::QUARTER_CHECKERBOARD: return "Quarter Checkerboard";
+        default: return "Unknown";
+    }
 }
 
 bool Sky::initializeClouds() {
@@ -199,7 +422,7 @@ bool Sky::initializeClouds() {
     glGenBuffers(1, &cloudVBO);
     glGenBuffers(1, &cloudEBO);
 
-    glBindVertexArray(cloudVAO);
+    GLStateCache::shared().bindVertexArray(cloudVAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, cloudVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(cloudVertices), cloudVertices, GL_STATIC_DRAW);
@@ -210,125 +433,212 @@ bool Sky::initializeClouds() {
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
 
-    glBindVertexArray(0);
+    GLStateCache::shared().bindVertexArray(0);
 
-    const char* vertexShaderSource = R"(
-        #version 330 core
-        layout(location = 0) in vec3 aPos;
-        out vec2 TexCoord;
-        void main() {
-            gl_Position = vec4(aPos, 1.0);
-            TexCoord = (aPos.xy + 1.0) / 2.0; // Map to [0, 1]
-        }
-    )";
+    if (!cloudNoise.getTexture()) {
+        NoiseTextureParameters noiseParams;
+#ifdef _WIN32
+        const std::string cacheDirectory = "resources\\cache";
+#else
+        const std::string cacheDirectory = "./resources/cache";
+#endif
+        if (!cloudNoise.create(noiseParams, cacheDirectory)) return false;
+    }
 
-    const char* fragmentShaderSource = R"(
-        #version 330 core
+    // The shading variant of the current time of day is needed for the first frame, the others only from its
+    // first transition on
+    cloudShaders.initialize("Cloud", CLOUD_VERTEX_SOURCE, std::string("#version 330 core\n") + CLOUD_NOISE_SOURCE + CLOUD_SHADING_SOURCE + R"(
         out vec4 FragColor;
         in vec2 TexCoord;
-        uniform float time;
-        uniform int sourceTimeOfDay;
-        uniform int targetTimeOfDay;
-        uniform float transitionProgress;
-        uniform float aspectRatio;
 
-        float random(vec2 st) {
-            return fract(sin(dot(st, vec2(12.9898, 78.233))) * 43758.5453123);
+        void main() {
+            FragColor = shadeClouds(cloudCover(TexCoord));
         }
+    )", cloudShadingDefines, [this](GLuint program, CloudUniforms& uniforms) {
+        ShaderRegistry& registry = ShaderRegistry::shared();
+        uniforms.time = registry.uniform<float>(program, "time");
+        uniforms.aspectRatio = registry.uniform<float>(program, "aspectRatio");
+        // Sampler units and the noise period are fixed for the lifetime of the programs
+        registry.uniform<int>(program, "noiseTexture").set(2);
+        registry.uniform<float>(program, "noisePeriod").set(static_cast<float>(cloudNoise.getParameters().period));
+    });
+
+    // Evaluates the cover into the cloud target. Checkerboarded, the target is packed two pixels per texel:
+    // texel x of row y is target pixel 2x + ((y + parity) & 1), so the half due this frame is one dense pass
+    cloudDensityShader = linkCloudProgram(std::string("#version 330 core\n") + CLOUD_NOISE_SOURCE + R"(
+        out float Cover;
+        uniform vec2 targetSize;
+        uniform int checkerboard;
+        uniform int parity;
 
-        float noise(vec2 st) {
-            vec2 i = floor(st);
-            vec2 f = fract(st);
-            vec2 u = f * f * (3.0 - 2.0 * f);
-            return mix(mix(random(i + vec2(0.0, 0.0)), random(i + vec2(1.0, 0.0)), u.x),
-                       mix(random(i + vec2(0.0, 1.0)), random(i + vec2(1.0, 1.0)), u.x), u.y);
+        void main() {
+            vec2 pixel = gl_FragCoord.xy;
+            if (checkerboard == 1) {
+                pixel.x = floor(pixel.x) * 2.0 + float((int(pixel.y) + parity) & 1) + 0.5;
+            }
+            Cover = cloudCover(pixel / targetSize);
         }
+    )", "Cloud density", [this](GLuint program) {
+        ShaderRegistry& registry = ShaderRegistry::shared();
+        cloudDensityUniforms.time = registry.uniform<float>(program, "time");
+        cloudDensityUniforms.aspectRatio = registry.uniform<float>(program, "aspectRatio");
+        cloudDensityUniforms.targetSize = registry.uniform<glm::vec2>(program, "targetSize");
+        cloudDensityUniforms.checkerboard = registry.uniform<bool>(program, "checkerboard");
+        cloudDensityUniforms.parity = registry.uniform<int>(program, "parity");
+        registry.uniform<int>(program, "noiseTexture").set(2);
+        registry.uniform<float>(program, "noisePeriod").set(static_cast<float>(cloudNoise.getParameters().period));
+    });
+
+    // Unpacks the fresh half and fills the other half from last frame's cover at where the clouds were then.
+    // Without usable history (first frame, a mode switch, clouds drifting in at the edge) the fresh neighbours
+    // on either side are averaged instead.
+    cloudResolveShader = linkCloudProgram(R"(
+        #version 330 core
+        out float Cover;
+        uniform sampler2D freshCover;
+        uniform sampler2D historyCover;
+        uniform vec2 targetSize;
+        uniform int parity;
+        uniform vec2 drift;
+        uniform int historyValid;
 
-        float fbm(vec2 st) {
-            float value = 0.0;
-            float amplitude = 0.5;
-            float frequency = 1.0;
-            const int octaves = 6; // Reduced octaves for smoother clouds
-            for (int i = 0; i < octaves; i++) {
-                value += amplitude * noise(st * frequency);
-                st *= 1.8; // Reduced lacunarity for smoother transitions
-                amplitude *= 0.5;
+        void main() {
+            ivec2 pixel = ivec2(gl_FragCoord.xy);
+            if (((pixel.x + pixel.y + parity) & 1) == 0) {
+                Cover = texelFetch(freshCover, ivec2(pixel.x / 2, pixel.y), 0).r;
+                return;
+            }
+            vec2 source = (vec2(pixel) + 0.5) / targetSize + drift;
+            if (historyValid == 1 && source.x >= 0.0 && source.x <= 1.0 - 0.5 / targetSize.x) {
+                Cover = texture(historyCover, source).r;
+                return;
             }
-            return value;
+            int lastPacked = textureSize(freshCover, 0).x - 1;
+            float left = texelFetch(freshCover, ivec2(clamp((pixel.x - 1) / 2, 0, lastPacked), pixel.y), 0).r;
+            float right = texelFetch(freshCover, ivec2(clamp((pixel.x + 1) / 2, 0, lastPacked), pixel.y), 0).r;
+            Cover = 0.5 * (left + right);
         }
+    )", "Cloud resolve", [this](GLuint program) {
+        ShaderRegistry& registry = ShaderRegistry::shared();
+        cloudResolveUniforms.targetSize = registry.uniform<glm::vec2>(program, "targetSize");
+        cloudResolveUniforms.parity = registry.uniform<int>(program, "parity");
+        cloudResolveUniforms.drift = registry.uniform<glm::vec2>(program, "drift");
+        cloudResolveUniforms.historyValid = registry.uniform<bool>(program, "historyValid");
+        registry.uniform<int>(program, "freshCover").set(0);
+        registry.uniform<int>(program, "historyCover").set(1);
+    });
+
+    // Bilateral upsample of the cover: the four surrounding texels weighted bilinearly and by how close their
+    // cover is to the texel under the pixel, so a cloud edge stays an edge instead of a half-texel smear.
+    // The terrain is drawn over the clouds afterwards, so there is no depth edge to respect here.
+    cloudCompositeShaders.initialize("Cloud composite", CLOUD_VERTEX_SOURCE, std::string("#version 330 core\n") + CLOUD_SHADING_SOURCE + R"(
+        out vec4 FragColor;
+        in vec2 TexCoord;
+        uniform sampler2D cloudCoverTexture;
 
         void main() {
-            // Slight reduction in cloud density at the top
-            float topFade = 1.0 - smoothstep(0.8, 1.0, TexCoord.y); // Fade out slightly at the very top
-
-            // Layer 1: Base layer of clouds (slower, larger)
-            vec2 cloudPos1 = TexCoord * 4.0; // Increased scale for smaller, more distinct clouds
-            cloudPos1.x *= aspectRatio;
-            float cloudNoise1 = fbm(cloudPos1 + vec2(time * 0.03, 0.0)); // Slower movement
-            float cloudAmount1 = smoothstep(0.5, 0.8, cloudNoise1) * 0.4; // Adjusted thresholds to make sparser, reduced opacity
-
-            // Layer 2: Detail layer of clouds (faster, smaller)
-            vec2 cloudPos2 = TexCoord * 8.0; // Increased scale for smaller, more detailed clouds
-            cloudPos2.x *= aspectRatio;
-            float cloudNoise2 = fbm(cloudPos2 + vec2(time * 0.06, 0.0)); // Faster movement
-            float cloudAmount2 = smoothstep(0.6, 0.9, cloudNoise2) * 0.25; // Adjusted thresholds to make sparser, reduced opacity
-
-            // Combine layers
-            float cloudAmount = max(cloudAmount1, cloudAmount2) * topFade;
-
-            // Adjust cloud visibility and color based on time of day
-            vec3 cloudColor = vec3(0.8, 0.8, 0.9); // Default cloud color
-            if (sourceTimeOfDay == 0 || targetTimeOfDay == 0) cloudColor = vec3(0.9, 0.7, 0.6); // Dawn
-            if (sourceTimeOfDay == 2 || targetTimeOfDay == 2) cloudColor = vec3(0.9, 0.6, 0.5); // Dusk
-            if (sourceTimeOfDay == 3 || targetTimeOfDay == 3) cloudAmount *= 0.2; // Night
-
-            // Output the cloud color with transparency
-            FragColor = vec4(cloudColor, cloudAmount);
+            ivec2 size = textureSize(cloudCoverTexture, 0);
+            ivec2 lastTexel = size - 1;
+            vec2 position = TexCoord * vec2(size) - 0.5;
+            ivec2 base = ivec2(floor(position));
+            vec2 f = position - floor(position);
+
+            vec4 cover = vec4(
+                texelFetch(cloudCoverTexture, clamp(base, ivec2(0), lastTexel), 0).r,
+                texelFetch(cloudCoverTexture, clamp(base + ivec2(1, 0), ivec2(0), lastTexel), 0).r,
+                texelFetch(cloudCoverTexture, clamp(base + ivec2(0, 1), ivec2(0), lastTexel), 0).r,
+                texelFetch(cloudCoverTexture, clamp(base + ivec2(1, 1), ivec2(0), lastTexel), 0).r);
+            float center = texelFetch(cloudCoverTexture, clamp(ivec2(TexCoord * vec2(size)), ivec2(0), lastTexel), 0).r;
+
+            vec4 weights = vec4((1.0 - f.x) * (1.0 - f.y), f.x * (1.0 - f.y), (1.0 - f.x) * f.y, f.x * f.y);
+            weights *= exp(-abs(cover - center) * 20.0);
+            FragColor = shadeClouds(dot(weights, cover) / max(dot(weights, vec4(1.0)), 1e-4));
         }
-    )";
-
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
-    glCompileShader(vertexShader);
-    GLint success;
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
-        DataManager::LogError("Sky", "initializeClouds", "Cloud vertex shader compilation failed: " + std::string(infoLog));
-        return false;
+    )", cloudShadingDefines, [](GLuint program, CloudCompositeUniforms&) {
+        ShaderRegistry::shared().uniform<int>(program, "cloudCoverTexture").set(0);
+    });
+
+    uint32_t currentKey = cloudShadingKey(currentTimeOfDay, targetTimeOfDay);
+    for (uint32_t key : CLOUD_SHADING_KEYS) {
+        cloudShaders.prepare(key, key != currentKey);
+        cloudCompositeShaders.prepare(key, key != currentKey);
     }
+    return cloudDensityShader && cloudResolveShader;
+}
 
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
-    glCompileShader(fragmentShader);
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
-        DataManager::LogError("Sky", "initializeClouds", "Cloud fragment shader compilation failed: " + std::string(infoLog));
-        return false;
-    }
+GLuint Sky::linkCloudProgram(const std::string& fragmentSource, const std::string& name, ShaderRegistry::LinkedCallback onLinked) {
+    return ShaderRegistry::shared().submit(name, CLOUD_VERTEX_SOURCE, fragmentSource, std::move(onLinked));
+}
 
-    cloudShader = glCreateProgram();
-    glAttachShader(cloudShader, vertexShader);
-    glAttachShader(cloudShader, fragmentShader);
-    glLinkProgram(cloudShader);
-    glGetProgramiv(cloudShader, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(cloudShader, 512, nullptr, infoLog);
-        DataManager::LogError("Sky", "initializeClouds", "Cloud shader program linking failed: " + std::string(infoLog));
+bool Sky::createCloudTargets(int width, int height) {
+    destroyCloudTargets();
+
+    auto createTarget = [](int targetWidth, int targetHeight, GLuint& framebuffer, GLuint& texture) {
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R16F, targetWidth, targetHeight, 0, GL_RED, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+        return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    };
+    bool complete = createTarget(width, height, cloudFramebuffers[0], cloudTextures[0]) &&
+        createTarget(width, height, cloudFramebuffers[1], cloudTextures[1]) &&
+        createTarget((width + 1) / 2, height, cloudFreshFramebuffer, cloudFreshTexture);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    if (!complete) {
+        DataManager::LogError("Sky", "createCloudTargets", "Cloud framebuffer is incomplete at " + std::to_string(width) + "x" + std::to_string(height));
+        destroyCloudTargets();
         return false;
     }
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
+    cloudTargetWidth = width;
+    cloudTargetHeight = height;
+    cloudHistoryValid = false;
+    DataManager::LogDebug(DebugCategory::RENDERING, "Sky", "createCloudTargets",
+        "Cloud targets created at " + std::to_string(width) + "x" + std::to_string(height));
     return true;
 }
 
-void Sky::render(TimeOfDay timeOfDay, float transitionProgress) {
+void Sky::destroyCloudTargets() {
+    for (int i = 0; i < 2; ++i) {
+        if (cloudFramebuffers[i]) glDeleteFramebuffers(1, &cloudFramebuffers[i]);
+        if (cloudTextures[i]) glDeleteTextures(1, &cloudTextures[i]);
+        cloudFramebuffers[i] = 0;
+        cloudTextures[i] = 0;
+    }
+    if (cloudFreshFramebuffer) glDeleteFramebuffers(1, &cloudFreshFramebuffer);
+    if (cloudFreshTexture) glDeleteTextures(1, &cloudFreshTexture);
+    cloudFreshFramebuffer = 0;
+    cloudFreshTexture = 0;
+    cloudTargetWidth = 0;
+    cloudTargetHeight = 0;
+    cloudHistoryValid = false;
+}
+
+void Sky::uploadAtmosphere(const Atmosphere& atmosphere) {
+    GLuint* textures[2] = { &rayleighTexture, &mieTexture };
+    const std::vector<glm::vec3>* tables[2] = { &atmosphere.getRayleighScattering(), &atmosphere.getMieScattering() };
+    for (int i = 0; i < 2; ++i) {
+        glGenTextures(1, textures[i]);
+        glBindTexture(GL_TEXTURE_3D, *textures[i]);
+        glTexImage3D(GL_TEXTURE_3D, 0, GL_RGB16F, Atmosphere::SCATTERING_VIEW, Atmosphere::SCATTERING_SUN, Atmosphere::SCATTERING_AZIMUTH,
+            0, GL_RGB, GL_FLOAT, tables[i]->data());
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_3D, 0);
+}
+
+void Sky::render(TimeOfDay timeOfDay, const Atmosphere& atmosphere, float sunElevation, float sunProgress) {
     if (timeOfDay != currentTimeOfDay) {
         skyTransitioning = true;
         skyTransitionTime = 0.0f;
@@ -336,33 +646,19 @@ void Sky::render(TimeOfDay timeOfDay, float transitionProgress) {
 
         if (currentTimeOfDay == TimeOfDay::NIGHT && timeOfDay != TimeOfDay::NIGHT) {
             immediateFadeFromNight = true;
-            transitionProgress = 0.0f;
         } else if (timeOfDay == TimeOfDay::NIGHT) {
             immediateFadeFromNight = false;
-            transitionProgress = 0.0f;
         } else {
             immediateFadeFromNight = false;
         }
 
         switch (timeOfDay) {
             case TimeOfDay::DAWN:
-                targetSkyColorTop = glm::vec3(0.8f, 0.5f, 0.4f);
-                targetSkyColorBottom = glm::vec3(1.0f, 0.8f, 0.7f);
-                targetSunMoonPosition = 0.1f;
-                break;
-            case TimeOfDay::MID_DAY:
-                targetSkyColorTop = glm::vec3(0.2f, 0.4f, 0.8f);
-                targetSkyColorBottom = glm::vec3(0.5f, 0.7f, 1.0f);
-                targetSunMoonPosition = 0.5f;
-                break;
             case TimeOfDay::DUSK:
-                targetSkyColorTop = glm::vec3(0.7f, 0.4f, 0.3f);
-                targetSkyColorBottom = glm::vec3(0.9f, 0.6f, 0.5f);
                 targetSunMoonPosition = 0.1f;
                 break;
+            case TimeOfDay::MID_DAY:
             case TimeOfDay::NIGHT:
-                targetSkyColorTop = glm::vec3(0.0f, 0.0f, 0.1f);
-                targetSkyColorBottom = glm::vec3(0.0f, 0.0f, 0.2f);
                 targetSunMoonPosition = 0.5f;
                 break;
         }
@@ -371,43 +667,60 @@ void Sky::render(TimeOfDay timeOfDay, float transitionProgress) {
     if (skyTransitioning) {
         skyTransitionTime += 0.016f;
         float t = std::min(skyTransitionTime / skyTransitionDuration, 1.0f);
-        skyColorTop = glm::mix(skyColorTop, targetSkyColorTop, t);
-        skyColorBottom = glm::mix(skyColorBottom, targetSkyColorBottom, t);
         sunMoonPosition = glm::mix(sunMoonPosition, targetSunMoonPosition, t);
-        transitionProgress = t;
 
         if (t >= 1.0f) {
             skyTransitioning = false;
             skyTransitionTime = 0.0f;
             currentTimeOfDay = targetTimeOfDay;
-            transitionProgress = 1.0f;
         }
     }
 
-    glDepthMask(GL_FALSE);
-    glUseProgram(skyShader);
-    glUniform3fv(glGetUniformLocation(skyShader, "topColor"), 1, &skyColorTop[0]);
-    glUniform3fv(glGetUniformLocation(skyShader, "bottomColor"), 1, &skyColorBottom[0]);
-    glUniform1f(glGetUniformLocation(skyShader, "sunMoonPosition"), sunMoonPosition);
-    glUniform1i(glGetUniformLocation(skyShader, "sourceTimeOfDay"), static_cast<int>(currentTimeOfDay));
-    glUniform1i(glGetUniformLocation(skyShader, "targetTimeOfDay"), static_cast<int>(targetTimeOfDay));
-    glUniform1f(glGetUniformLocation(skyShader, "transitionProgress"), transitionProgress);
-    glUniform1f(glGetUniformLocation(skyShader, "aspectRatio"), aspectRatio);
-    glBindVertexArray(skyVAO);
-    glDisable(GL_DEPTH_TEST);
+    if (!rayleighTexture && atmosphere.isReady()) uploadAtmosphere(atmosphere);
+
+    // The sun sits where the close celestials draw it, between 0.2 and 0.8 of the screen width
+    float sunAzimuth = (0.2f + sunProgress * 0.6f - 0.5f) * SKY_FIELD_OF_VIEW * aspectRatio;
+    float nightAmount = glm::smoothstep(0.0f, 0.1f, -sunElevation);
+
+    if (!ShaderRegistry::shared().use(skyShader)) return;
+    GLStateCache::shared().depthMask(GL_FALSE);
+    skyUniforms.sunElevation.set(sunElevation);
+    skyUniforms.sunAzimuth.set(sunAzimuth);
+    skyUniforms.nightAmount.set(nightAmount);
+    skyUniforms.aspectRatio.set(aspectRatio);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_3D, mieTexture);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_3D, rayleighTexture);
+    GLStateCache::shared().bindVertexArray(skyVAO);
+    GLStateCache::shared().disable(GL_DEPTH_TEST);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glEnable(GL_DEPTH_TEST);
-    glBindVertexArray(0);
-    glDepthMask(GL_TRUE);
+    GLStateCache::shared().bindVertexArray(0);
+    glBindTexture(GL_TEXTURE_3D, 0);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_3D, 0);
+    glActiveTexture(GL_TEXTURE0);
 }
 
 void Sky::cleanup() {
-    if (skyShader) glDeleteProgram(skyShader);
-    if (skyVAO) glDeleteVertexArrays(1, &skyVAO);
+    ShaderRegistry& registry = ShaderRegistry::shared();
+    registry.destroy(skyShader);
+    skyShader = 0;
+    if (rayleighTexture) glDeleteTextures(1, &rayleighTexture);
+    if (mieTexture) glDeleteTextures(1, &mieTexture);
+    rayleighTexture = 0;
+    mieTexture = 0;
+    if (skyVAO) GLStateCache::shared().deleteVertexArrays(1, &skyVAO);
     if (skyVBO) glDeleteBuffers(1, &skyVBO);
     if (skyEBO) glDeleteBuffers(1, &skyEBO);
-    if (cloudShader) glDeleteProgram(cloudShader);
-    if (cloudVAO) glDeleteVertexArrays(1, &cloudVAO);
+    cloudShaders.destroy();
+    if (cloudVAO) GLStateCache::shared().deleteVertexArrays(1, &cloudVAO);
     if (cloudVBO) glDeleteBuffers(1, &cloudVBO);
     if (cloudEBO) glDeleteBuffers(1, &cloudEBO);
+    registry.destroy(cloudDensityShader);
+    registry.destroy(cloudResolveShader);
+    cloudCompositeShaders.destroy();
+    cloudDensityShader = 0;
+    cloudResolveShader = 0;
+    destroyCloudTargets();
 }
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include "SkyEntityStore.hpp"
+#include <chrono>
+
+uint32_t SkyEntityStore::internLabel(const std::string& text) {
+    auto it = labelIds.find(text);
+    if (it != labelIds.end()) return it->second;
+    uint32_t label = static_cast<uint32_t>(labelTexts.size());
+    labelTexts.push_back(text);
+    labelIds.emplace(text, label);
+    return label;
+}
+
+SkyEntityHandle SkyEntityStore::create(const SkyEntityDesc& desc) {
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(slotIndices.size());
+        slotIndices.push_back(0);
+        slotGenerations.push_back(0);
+    }
+    uint32_t index = static_cast<uint32_t>(positions.size());
+    slotIndices[slot] = index;
+    indexSlots.push_back(slot);
+
+    positions.push_back(desc.position);
+    velocities.push_back(desc.velocity);
+    brightnesses.push_back(desc.brightness);
+    sizes.push_back(desc.size);
+    colors.push_back(desc.color);
+    kinds.push_back(desc.kind);
+    groups.push_back(isAlive(desc.group) ? desc.group.slot : slot);
+    labels.push_back(desc.label);
+    labelColors.push_back(desc.labelColor);
+    references.push_back(desc.reference);
+    trails.push_back(desc.trail);
+    stress.push_back(desc.stress ? 1 : 0);
+
+    ++stats.kinds[static_cast<size_t>(desc.kind)];
+    stats.entities = positions.size();
+    return { slot, slotGenerations[slot] };
+}
+
+void SkyEntityStore::destroy(SkyEntityHandle handle) {
+    if (!isAlive(handle)) return;
+    uint32_t index = slotIndices[handle.slot];
+    uint32_t last = static_cast<uint32_t>(positions.size() - 1);
+    --stats.kinds[static_cast<size_t>(kinds[index])];
+
+    // Move the last entity into the hole, then drop the last element of every field
+    if (index != last) {
+        positions[index] = positions[last];
+        velocities[index] = velocities[last];
+        brightnesses[index] = brightnesses[last];
+        sizes[index] = sizes[last];
+        colors[index] = colors[last];
+        kinds[index] = kinds[last];
+        groups[index] = groups[last];
+        labels[index] = labels[last];
+        labelColors[index] = labelColors[last];
+        references[index] = references[last];
+        trails[index] = trails[last];
+        stress[index] = stress[last];
+        indexSlots[index] = indexSlots[last];
+        slotIndices[indexSlots[index]] = index;
+    }
+    positions.pop_back();
+    velocities.pop_back();
+    brightnesses.pop_back();
+    sizes.pop_back();
+    colors.pop_back();
+    kinds.pop_back();
+    groups.pop_back();
+    labels.pop_back();
+    labelColors.pop_back();
+    references.pop_back();
+    trails.pop_back();
+    stress.pop_back();
+    indexSlots.pop_back();
+
+    ++slotGenerations[handle.slot];
+    freeSlots.push_back(handle.slot);
+    stats.entities = positions.size();
+}
+
+bool SkyEntityStore::isAlive(SkyEntityHandle handle) const {
+    // Freeing a slot moves its generation on, so only the live entity's handle matches
+    return handle.slot < slotGenerations.size() && slotGenerations[handle.slot] == handle.generation;
+}
+
+void SkyEntityStore::clear() {
+    // Every live handle goes stale; the slots are kept for reuse
+    for (uint32_t slot : indexSlots) {
+        ++slotGenerations[slot];
+        freeSlots.push_back(slot);
+    }
+    positions.clear();
+    velocities.clear();
+    brightnesses.clear();
+    sizes.clear();
+    colors.clear();
+    kinds.clear();
+    groups.clear();
+    labels.clear();
+    labelColors.clear();
+    references.clear();
+    trails.clear();
+    stress.clear();
+    indexSlots.clear();
+    stats = SkyEntityStats();
+}
+
+void SkyEntityStore::setMotion(uint32_t index, const glm::vec2& position, const glm::vec2& velocity) {
+    positions[index] = position;
+    velocities[index] = velocity;
+}
+
+void SkyEntityStore::update(float dt, std::vector<SkyEntityHandle>& departed) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    departed.clear();
+    const size_t count = positions.size();
+
+    // Planets have no velocity, so one branch-free loop moves everything
+    for (size_t i = 0; i < count; ++i) {
+        positions[i] += velocities[i] * dt;
+    }
+
+    // A group stays while any member is on screen, so a train leaves as a whole
+    groupOnScreen.assign(slotIndices.size(), 0);
+    for (size_t i = 0; i < count; ++i) {
+        const glm::vec2& position = positions[i];
+        if (position.x >= 0.0f && position.x <= 1.0f && position.y >= 0.0f && position.y <= 1.0f) {
+            groupOnScreen[groups[i]] = 1;
+        }
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (!groupOnScreen[groups[i]] && kinds[i] != SkyEntityKind::PLANET) {
+            departed.push_back(handleAt(static_cast<uint32_t>(i)));
+        }
+    }
+
+    stats.departed = departed.size();
+    stats.updateMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+void SkyEntityStore::appendPointVertices(std::vector<float>& vertices, bool withPlanets) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    const size_t count = positions.size();
+    vertices.reserve(vertices.size() + count * 7);
+    for (size_t i = 0; i < count; ++i) {
+        if (!withPlanets && kinds[i] == SkyEntityKind::PLANET) continue;
+        vertices.push_back(positions[i].x);
+        vertices.push_back(positions[i].y);
+        vertices.push_back(brightnesses[i]);
+        vertices.push_back(sizes[i]);
+        vertices.push_back(colors[i].r);
+        vertices.push_back(colors[i].g);
+        vertices.push_back(colors[i].b);
+    }
+    stats.vertexMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+}
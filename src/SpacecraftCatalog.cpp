@@ -0,0 +1,138 @@
+#include "SpacecraftCatalog.hpp"
+#include "DataManager.hpp"
+#include <algorithm>
+#include <fstream>
+#include <json.hpp>
+
+// json::value() and get() throw when a field is present with the wrong type, so the catalog, being user data,
+// is read through these, which fall back to the default instead
+static float numberOr(const nlohmann::json& entry, const char* key, float fallback) {
+    auto it = entry.find(key);
+    return it != entry.end() && it->is_number() ? it->get<float>() : fallback;
+}
+
+static bool boolOr(const nlohmann::json& entry, const char* key, bool fallback) {
+    auto it = entry.find(key);
+    return it != entry.end() && it->is_boolean() ? it->get<bool>() : fallback;
+}
+
+static std::string stringOr(const nlohmann::json& entry, const char* key, const std::string& fallback) {
+    auto it = entry.find(key);
+    return it != entry.end() && it->is_string() ? it->get<std::string>() : fallback;
+}
+
+bool SpacecraftCatalog::load(const std::string& path, const std::string& group) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        DataManager::LogError("SpacecraftCatalog", "load", "Failed to open " + path);
+        return false;
+    }
+
+    nlohmann::json document = nlohmann::json::parse(file, nullptr, false);
+    if (document.is_discarded() || !document.contains(group) || !document[group].is_array()) {
+        DataManager::LogError("SpacecraftCatalog", "load", "No \"" + group + "\" spacecraft array in " + path);
+        return false;
+    }
+
+    const nlohmann::json& entries = document[group];
+    names.clear();
+    speeds.clear();
+    inclinations.clear();
+    textColors.clear();
+    sizes.clear();
+    brightnesses.clear();
+    cooldowns.clear();
+    flagships.clear();
+    ids.clear();
+    names.reserve(entries.size());
+    ids.reserve(entries.size());
+
+    for (const nlohmann::json& entry : entries) {
+        if (!entry.is_object()) {
+            DataManager::LogWarning("SpacecraftCatalog", "load", "Skipping a spacecraft entry that is not an object");
+            continue;
+        }
+        std::string name = stringOr(entry, "name", "");
+        if (name.empty() || ids.count(name)) {
+            DataManager::LogWarning("SpacecraftCatalog", "load", "Skipping unnamed or duplicate spacecraft \"" + name + "\"");
+            continue;
+        }
+        glm::vec3 textColor(1.0f);
+        auto color = entry.find("textColor");
+        if (color != entry.end() && color->is_array() && color->size() == 3 &&
+            std::all_of(color->begin(), color->end(), [](const nlohmann::json& channel) { return channel.is_number(); })) {
+            textColor = glm::vec3((*color)[0].get<float>(), (*color)[1].get<float>(), (*color)[2].get<float>());
+        }
+
+        ids.emplace(name, static_cast<uint32_t>(names.size()));
+        names.push_back(name);
+        speeds.push_back(numberOr(entry, "speed", 0.01f));
+        inclinations.push_back(numberOr(entry, "inclination", 45.0f));
+        textColors.push_back(textColor);
+        sizes.push_back(numberOr(entry, "size", 2.0f));
+        brightnesses.push_back(numberOr(entry, "brightness", 0.7f));
+        cooldowns.push_back(numberOr(entry, "cooldown", 60.0f));
+        flagships.push_back(boolOr(entry, "flagship", false) ? 1 : 0);
+    }
+
+    readyTimes.assign(names.size(), 0.0f);
+    available.reserve(names.size());
+    availableSlots.assign(names.size(), COOLING);
+    cooling.reserve(names.size());
+    reset();
+
+    DataManager::LogDebug(DebugCategory::RENDERING, "SpacecraftCatalog", "load",
+        "Loaded " + std::to_string(names.size()) + " " + group + " spacecraft from " + path);
+    return !names.empty();
+}
+
+uint32_t SpacecraftCatalog::findId(const std::string& name) const {
+    auto it = ids.find(name);
+    return it != ids.end() ? it->second : INVALID_ID;
+}
+
+void SpacecraftCatalog::reset() {
+    std::fill(readyTimes.begin(), readyTimes.end(), 0.0f);
+    cooling.clear();
+    available.clear();
+    for (uint32_t id = 0; id < names.size(); ++id) {
+        makeAvailable(id);
+    }
+}
+
+void SpacecraftCatalog::makeAvailable(uint32_t id) {
+    availableSlots[id] = static_cast<uint32_t>(available.size());
+    available.push_back(id);
+}
+
+uint32_t SpacecraftCatalog::acquire(float now, std::mt19937& rng) {
+    // Released spacecraft whose cooldown has passed rejoin the available set
+    while (!cooling.empty() && cooling.front().readyTime <= now) {
+        uint32_t id = cooling.front().id;
+        std::pop_heap(cooling.begin(), cooling.end());
+        cooling.pop_back();
+        makeAvailable(id);
+    }
+    if (available.empty()) return INVALID_ID;
+
+    std::uniform_int_distribution<size_t> pick(0, available.size() - 1);
+    size_t slot = pick(rng);
+    uint32_t id = available[slot];
+
+    // Swap-remove from the available set
+    uint32_t last = available.back();
+    available[slot] = last;
+    availableSlots[last] = static_cast<uint32_t>(slot);
+    available.pop_back();
+    availableSlots[id] = ON_SCREEN;
+
+    readyTimes[id] = now + cooldowns[id];
+    return id;
+}
+
+void SpacecraftCatalog::release(uint32_t id) {
+    if (id >= names.size() || availableSlots[id] != ON_SCREEN) return;
+    availableSlots[id] = COOLING;
+    cooling.push_back({ readyTimes[id], id });
+    std::push_heap(cooling.begin(), cooling.end());
+}
@@ -0,0 +1,315 @@
+#include "StarCatalog.hpp"
+#include "DataManager.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+StarCatalog::StarCatalog() : mapping(nullptr), mappingSize(0),
+#ifdef _WIN32
+    fileHandle(nullptr), mappingHandle(nullptr),
+#else
+    fileDescriptor(-1),
+#endif
+    count(0), x(nullptr), y(nullptr), z(nullptr), magnitudes(nullptr), colors(nullptr) {
+}
+
+StarCatalog::~StarCatalog() {
+    unload();
+}
+
+bool StarCatalog::load(const std::string& binaryPath, const std::string& csvPath) {
+    unload();
+
+    if (!std::filesystem::exists(binaryPath)) {
+        if (!std::filesystem::exists(csvPath)) {
+            DataManager::LogError("StarCatalog", "load", "Neither " + binaryPath + " nor " + csvPath + " exists");
+            return false;
+        }
+        if (!convertHygCsv(csvPath, binaryPath)) return false;
+    }
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(binaryPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        DataManager::LogError("StarCatalog", "load", "Failed to open " + binaryPath);
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        DataManager::LogError("StarCatalog", "load", "Failed to stat " + binaryPath);
+        return false;
+    }
+    HANDLE fileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = fileMapping ? MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (fileMapping) CloseHandle(fileMapping);
+        CloseHandle(file);
+        DataManager::LogError("StarCatalog", "load", "Failed to map " + binaryPath);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = fileMapping;
+    mapping = view;
+    mappingSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int descriptor = open(binaryPath.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        DataManager::LogError("StarCatalog", "load", "Failed to open " + binaryPath);
+        return false;
+    }
+    struct stat fileStat;
+    if (fstat(descriptor, &fileStat) != 0) {
+        close(descriptor);
+        DataManager::LogError("StarCatalog", "load", "Failed to stat " + binaryPath);
+        return false;
+    }
+    void* view = fileStat.st_size > 0 ? mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0) : MAP_FAILED;
+    if (view == MAP_FAILED) {
+        close(descriptor);
+        DataManager::LogError("StarCatalog", "load", "Failed to map " + binaryPath);
+        return false;
+    }
+    fileDescriptor = descriptor;
+    mapping = view;
+    mappingSize = static_cast<size_t>(fileStat.st_size);
+#endif
+
+    const FileHeader* header = static_cast<const FileHeader*>(mapping);
+    if (mappingSize < sizeof(FileHeader) || std::memcmp(header->magic, "CSTR", 4) != 0 || header->version != FILE_VERSION ||
+        mappingSize < sizeof(FileHeader) + static_cast<size_t>(header->count) * 5 * sizeof(float)) {
+        DataManager::LogError("StarCatalog", "load", binaryPath + " is not a valid star catalog (version " + std::to_string(FILE_VERSION) + ")");
+        unload();
+        return false;
+    }
+
+    count = header->count;
+    const float* arrays = reinterpret_cast<const float*>(static_cast<const char*>(mapping) + sizeof(FileHeader));
+    x = arrays;
+    y = arrays + count;
+    z = arrays + count * 2;
+    magnitudes = arrays + count * 3;
+    colors = reinterpret_cast<const uint32_t*>(arrays + count * 4);
+
+    DataManager::LogDebug(DebugCategory::RENDERING, "StarCatalog", "load",
+        "Mapped " + std::to_string(count) + " stars from " + binaryPath);
+    return true;
+}
+
+void StarCatalog::unload() {
+#ifdef _WIN32
+    if (mapping) UnmapViewOfFile(mapping);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+    fileHandle = mappingHandle = nullptr;
+#else
+    if (mapping) munmap(mapping, mappingSize);
+    if (fileDescriptor >= 0) close(fileDescriptor);
+    fileDescriptor = -1;
+#endif
+    mapping = nullptr;
+    mappingSize = 0;
+    count = 0;
+    x = y = z = magnitudes = nullptr;
+    colors = nullptr;
+}
+
+SkyProjection::SkyProjection(const SkyObserver& observer, float horizonY, float aspectRatio) : horizonY(horizonY) {
+    verticalFov = glm::radians(observer.verticalFov);
+    horizontalFov = verticalFov / (1.0f - horizonY) * aspectRatio;
+    cosHalfHorizontal = std::cos(std::min(horizontalFov * 0.5f, 3.14159265f));
+    float azimuth = glm::radians(observer.viewAzimuth);
+    sinAzimuth = std::sin(azimuth);
+    cosAzimuth = std::cos(azimuth);
+}
+
+bool SkyProjection::viewToScreen(float forward, float right, float up, glm::vec2& position) const {
+    if (up <= 0.0f) return false;
+    float horizontal = std::sqrt(forward * forward + right * right);
+    if (forward < cosHalfHorizontal * horizontal) return false;
+    float altitude = std::atan2(up, horizontal);
+    if (altitude > verticalFov) return false;
+    position = glm::vec2(0.5f + std::atan2(right, forward) / horizontalFov, horizonY + altitude / verticalFov * (1.0f - horizonY));
+    return true;
+}
+
+double SkyProjection::greenwichSiderealTime(double julianDate) {
+    double degrees = std::fmod(280.46061837 + 360.98564736629 * (julianDate - 2451545.0), 360.0);
+    return degrees * 3.14159265358979323846 / 180.0;
+}
+
+void StarCatalog::project(const SkyObserver& observer, const SkyProjection& projection, float limitingMagnitude,
+    std::vector<ProjectedStar>& output) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    stats = StarCatalogStats();
+    stats.limitingMagnitude = limitingMagnitude;
+    if (!mapping) return;
+
+    // Sorted brightest first, so everything past the limiting magnitude is skipped without being touched
+    size_t limit = std::upper_bound(magnitudes, magnitudes + count, limitingMagnitude) - magnitudes;
+
+    float localSiderealTime = static_cast<float>(SkyProjection::greenwichSiderealTime(observer.julianDate) + glm::radians(static_cast<double>(observer.longitude)));
+    float latitude = glm::radians(observer.latitude);
+    float sinLat = std::sin(latitude), cosLat = std::cos(latitude);
+    float sinLst = std::sin(localSiderealTime), cosLst = std::cos(localSiderealTime);
+    float sinAz = projection.sinAzimuth, cosAz = projection.cosAzimuth;
+
+    // Rows of the equatorial to horizon rotation (up, north, east), with the view azimuth folded into
+    // forward (towards the screen center) and right
+    float upX = cosLat * cosLst, upY = cosLat * sinLst, upZ = sinLat;
+    float northX = -sinLat * cosLst, northY = -sinLat * sinLst, northZ = cosLat;
+    float eastX = -sinLst, eastY = cosLst;
+    float forwardX = northX * cosAz + eastX * sinAz, forwardY = northY * cosAz + eastY * sinAz, forwardZ = northZ * cosAz;
+    float rightX = eastX * cosAz - northX * sinAz, rightY = eastY * cosAz - northY * sinAz, rightZ = -northZ * sinAz;
+
+    float up[BLOCK_SIZE], forward[BLOCK_SIZE], right[BLOCK_SIZE];
+    for (size_t blockStart = 0; blockStart < limit; blockStart += BLOCK_SIZE) {
+        int n = static_cast<int>(std::min(static_cast<size_t>(BLOCK_SIZE), limit - blockStart));
+        const float* blockX = x + blockStart;
+        const float* blockY = y + blockStart;
+        const float* blockZ = z + blockStart;
+
+        // Branch-free multiply-adds over the structure-of-arrays block; compilers turn this into SIMD code
+        for (int i = 0; i < n; ++i) {
+            up[i] = upX * blockX[i] + upY * blockY[i] + upZ * blockZ[i];
+            forward[i] = forwardX * blockX[i] + forwardY * blockY[i] + forwardZ * blockZ[i];
+            right[i] = rightX * blockX[i] + rightY * blockY[i] + rightZ * blockZ[i];
+        }
+
+        // Only stars above the horizon get the field of view test and the trigonometry
+        for (int i = 0; i < n; ++i) {
+            if (up[i] <= 0.0f) continue;
+            ProjectedStar star;
+            if (!projection.viewToScreen(forward[i], right[i], up[i], star.position)) continue;
+            star.magnitude = magnitudes[blockStart + i];
+            star.color = colors[blockStart + i];
+            output.push_back(star);
+            ++stats.visible;
+        }
+    }
+
+    stats.processed = limit;
+    stats.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+// Approximate star color from the B-V color index, through its temperature (Ballesteros) and a fit of the
+// blackbody color, blended halfway towards white since stars look mostly white to the eye
+static uint32_t colorFromColorIndex(float colorIndex) {
+    colorIndex = std::clamp(colorIndex, -0.4f, 2.0f);
+    float temperature = 4600.0f * (1.0f / (0.92f * colorIndex + 1.7f) + 1.0f / (0.92f * colorIndex + 0.62f));
+    float t = temperature / 100.0f;
+    float r = t <= 66.0f ? 255.0f : 329.698727f * std::pow(t - 60.0f, -0.1332048f);
+    float g = t <= 66.0f ? 99.4708026f * std::log(t) - 161.1195682f : 288.1221695f * std::pow(t - 60.0f, -0.0755148f);
+    float b = t >= 66.0f ? 255.0f : (t <= 19.0f ? 0.0f : 138.5177312f * std::log(t - 10.0f) - 305.0447927f);
+    auto channel = [](float value) {
+        value = std::clamp(value, 0.0f, 255.0f);
+        return static_cast<uint32_t>(value * 0.5f + 127.5f);
+    };
+    return channel(r) | (channel(g) << 8) | (channel(b) << 16) | (255u << 24);
+}
+
+// Splits one CSV line; fields may be quoted
+static void splitCsvLine(const std::string& line, std::vector<std::string>& fields) {
+    fields.clear();
+    std::string field;
+    bool quoted = false;
+    for (char c : line) {
+        if (c == '"') {
+            quoted = !quoted;
+        } else if (c == ',' && !quoted) {
+            fields.push_back(field);
+            field.clear();
+        } else if (c != '\r') {
+            field.push_back(c);
+        }
+    }
+    fields.push_back(field);
+}
+
+bool StarCatalog::convertHygCsv(const std::string& csvPath, const std::string& binaryPath) {
+    std::ifstream csv(csvPath);
+    if (!csv.is_open()) {
+        DataManager::LogError("StarCatalog", "convertHygCsv", "Failed to open " + csvPath);
+        return false;
+    }
+
+    std::string line;
+    std::vector<std::string> fields;
+    std::getline(csv, line);
+    splitCsvLine(line, fields);
+    auto column = [&](const char* name) {
+        auto it = std::find(fields.begin(), fields.end(), name);
+        return it == fields.end() ? -1 : static_cast<int>(it - fields.begin());
+    };
+    int raColumn = column("ra"), decColumn = column("dec"), magColumn = column("mag");
+    int colorColumn = column("ci"), distanceColumn = column("dist");
+    if (raColumn < 0 || decColumn < 0 || magColumn < 0) {
+        DataManager::LogError("StarCatalog", "convertHygCsv", csvPath + " has no ra, dec and mag columns");
+        return false;
+    }
+    int lastColumn = std::max({ raColumn, decColumn, magColumn, colorColumn, distanceColumn });
+
+    std::vector<float> starX, starY, starZ, starMagnitudes;
+    std::vector<uint32_t> starColors;
+    while (std::getline(csv, line)) {
+        splitCsvLine(line, fields);
+        if (static_cast<int>(fields.size()) <= lastColumn || fields[magColumn].empty()) continue;
+        // The Sun is row zero of the HYG database, at distance zero
+        if (distanceColumn >= 0 && !fields[distanceColumn].empty() && std::atof(fields[distanceColumn].c_str()) <= 0.0) continue;
+
+        double rightAscension = std::atof(fields[raColumn].c_str()) * 15.0 * 3.14159265358979323846 / 180.0; // hours
+        double declination = std::atof(fields[decColumn].c_str()) * 3.14159265358979323846 / 180.0;
+        float colorIndex = (colorColumn >= 0 && !fields[colorColumn].empty()) ? static_cast<float>(std::atof(fields[colorColumn].c_str())) : 0.6f;
+        starX.push_back(static_cast<float>(std::cos(declination) * std::cos(rightAscension)));
+        starY.push_back(static_cast<float>(std::cos(declination) * std::sin(rightAscension)));
+        starZ.push_back(static_cast<float>(std::sin(declination)));
+        starMagnitudes.push_back(static_cast<float>(std::atof(fields[magColumn].c_str())));
+        starColors.push_back(colorFromColorIndex(colorIndex));
+    }
+
+    std::vector<uint32_t> order(starMagnitudes.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return starMagnitudes[a] < starMagnitudes[b]; });
+
+    std::filesystem::path parent = std::filesystem::path(binaryPath).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent);
+    std::ofstream binary(binaryPath, std::ios::binary);
+    if (!binary.is_open()) {
+        DataManager::LogError("StarCatalog", "convertHygCsv", "Failed to create " + binaryPath);
+        return false;
+    }
+
+    FileHeader header = { { 'C', 'S', 'T', 'R' }, FILE_VERSION, static_cast<uint32_t>(order.size()), 0 };
+    binary.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const std::vector<float>* source : { &starX, &starY, &starZ, &starMagnitudes }) {
+        for (uint32_t index : order) binary.write(reinterpret_cast<const char*>(&(*source)[index]), sizeof(float));
+    }
+    for (uint32_t index : order) binary.write(reinterpret_cast<const char*>(&starColors[index]), sizeof(uint32_t));
+    if (!binary) {
+        DataManager::LogError("StarCatalog", "convertHygCsv", "Failed to write " + binaryPath);
+        return false;
+    }
+
+    DataManager::LogDebug(DebugCategory::RENDERING, "StarCatalog", "convertHygCsv",
+        "Converted " + std::to_string(order.size()) + " stars from " + csvPath + " to " + binaryPath);
+    return true;
+}
@@ -0,0 +1,181 @@
+#include "StreamBuffer.hpp"
+#include "DataManager.hpp"
+#include <chrono>
+#include <cstring>
+#include <string>
+
+// How long one glClientWaitSync may block before it is asked again, in nanoseconds
+static const GLuint64 FENCE_WAIT_TIMEOUT = 100000000;
+
+StreamBuffer::StreamBuffer() : buffer(0), mapped(nullptr), regionBytes(0), region(0), regionUsed(0), fences{} {
+}
+
+StreamBuffer& StreamBuffer::shared() {
+    static StreamBuffer streamBuffer;
+    return streamBuffer;
+}
+
+void StreamBuffer::create(size_t bytesPerRegion) {
+    GLsizeiptr totalBytes = static_cast<GLsizeiptr>(bytesPerRegion * FRAMES);
+    glGenBuffers(1, &buffer);
+    // The copy target, so that creating and writing the buffer disturbs no binding the drawing code relies on
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    if (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, totalBytes, nullptr, flags);
+        mapped = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, totalBytes, flags));
+        if (!mapped) {
+            // Immutable storage cannot be respecified, so start over with a buffer of the ordinary kind
+            DataManager::LogWarning("StreamBuffer", "create", "Persistent mapping failed; mapping per upload instead");
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            glDeleteBuffers(1, &buffer);
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        }
+    }
+    if (!mapped) glBufferData(GL_COPY_WRITE_BUFFER, totalBytes, nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    regionBytes = bytesPerRegion;
+    regionUsed = 0;
+    stats.regionBytes = regionBytes;
+    stats.persistent = mapped != nullptr;
+    DataManager::LogDebug(DebugCategory::RENDERING, "StreamBuffer", "create",
+        std::to_string(FRAMES) + " regions of " + std::to_string(regionBytes / 1024) + " KB, " +
+        (mapped ? "persistently mapped" : "mapped per upload"));
+}
+
+void StreamBuffer::destroy() {
+    deleteFences();
+    deleteRetired(true);
+    if (!buffer) return;
+    unmap();
+    // Draws already issued keep the storage alive until the GPU is done with them
+    glDeleteBuffers(1, &buffer);
+    buffer = 0;
+}
+
+void StreamBuffer::unmap() {
+    if (!mapped) return;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    mapped = nullptr;
+}
+
+// Deleting a buffer unbinds it from every binding point, among them the Frame block already bound into it
+// this frame, so the buffer is only given up once the frame that replaced it has been drawn
+void StreamBuffer::retire() {
+    deleteFences();
+    unmap();
+    retired.push_back({ buffer, nullptr });
+    buffer = 0;
+}
+
+void StreamBuffer::deleteFences() {
+    for (GLsync& fence : fences) {
+        if (fence) glDeleteSync(fence);
+        fence = nullptr;
+    }
+}
+
+void StreamBuffer::deleteRetired(bool all) {
+    size_t kept = 0;
+    for (RetiredBuffer& old : retired) {
+        if (!all && (!old.fence || glClientWaitSync(old.fence, 0, 0) == GL_TIMEOUT_EXPIRED)) {
+            retired[kept++] = old;
+            continue;
+        }
+        if (old.fence) glDeleteSync(old.fence);
+        glDeleteBuffers(1, &old.buffer);
+    }
+    retired.resize(kept);
+}
+
+void StreamBuffer::beginFrame() {
+    if (!buffer) create(INITIAL_REGION_BYTES);
+    if (!retired.empty()) deleteRetired(false);
+    stats.bytes = frameStats.bytes;
+    stats.allocations = frameStats.allocations;
+    frameStats = StreamBufferStats();
+
+    region = (region + 1) % FRAMES;
+    regionUsed = 0;
+    GLsync fence = fences[region];
+    if (!fence) return;
+    fences[region] = nullptr;
+
+    // Normally signalled long ago, FRAMES - 1 frames having been issued since
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        if (mapped) {
+            auto startTime = std::chrono::high_resolution_clock::now();
+            do {
+                status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_TIMEOUT);
+            } while (status == GL_TIMEOUT_EXPIRED);
+            ++stats.waits;
+            stats.waitMilliseconds += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+        } else {
+            // Fresh storage for every region; the driver frees the old one once the GPU is done with it
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(regionBytes * FRAMES), nullptr, GL_STREAM_DRAW);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            deleteFences();
+            ++stats.orphans;
+        }
+    }
+    glDeleteSync(fence);
+}
+
+void StreamBuffer::endFrame() {
+    if (!buffer) return;
+    if (fences[region]) glDeleteSync(fences[region]);
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    for (RetiredBuffer& old : retired) {
+        if (!old.fence) old.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+GLintptr StreamBuffer::upload(const void* data, size_t bytes, size_t alignment) {
+    if (!buffer) create(INITIAL_REGION_BYTES);
+    size_t regionStart = static_cast<size_t>(region) * regionBytes;
+    size_t position = (regionStart + regionUsed + alignment - 1) / alignment * alignment;
+    if (position + bytes > regionStart + regionBytes) {
+        // Outgrown: move to a buffer with regions twice the size or more. What this frame already put in the old
+        // one stays there, along with the bindings into it, until retire() lets it go, so nothing needs copying;
+        // uploads from here on bind the new buffer themselves.
+        size_t newRegionBytes = regionBytes * 2;
+        while (newRegionBytes < bytes + alignment) newRegionBytes *= 2;
+        DataManager::LogDebug(DebugCategory::RENDERING, "StreamBuffer", "upload",
+            "Region of " + std::to_string(regionBytes / 1024) + " KB outgrown by an upload of " + std::to_string(bytes) + " bytes");
+        retire();
+        create(newRegionBytes);
+        ++stats.resizes;
+        regionStart = static_cast<size_t>(region) * regionBytes;
+        position = (regionStart + alignment - 1) / alignment * alignment;
+    }
+
+    if (mapped) {
+        std::memcpy(mapped + position, data, bytes);
+    } else {
+        // The fences guarantee the GPU is not reading this range, so there is nothing to synchronize with
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        void* target = glMapBufferRange(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(position), static_cast<GLsizeiptr>(bytes),
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (target) {
+            std::memcpy(target, data, bytes);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        } else {
+            glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(position), static_cast<GLsizeiptr>(bytes), data);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    regionUsed = position + bytes - regionStart;
+    frameStats.bytes += bytes;
+    ++frameStats.allocations;
+    return static_cast<GLintptr>(position);
+}
+
+void StreamBuffer::cleanup() {
+    destroy();
+}
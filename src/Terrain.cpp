@@ -1,5 +1,7 @@
 #include "Terrain.hpp"
+#include "GLStateCache.hpp"
 #include <GL/glew.h>
+#include <cfloat>
 #include <cmath>
 #include <algorithm>
 #include <iostream>
@@ -7,7 +9,11 @@
 
 Terrain::Terrain(int width, int depth, const glm::vec4& color)
     : width(width), depth(depth), color(color), vao(0), vbo(0), ebo(0),
-    lowColor(0.0f), highColor(0.0f) { // Initialize new members
+    lowColor(0.0f), highColor(0.0f), colorMinHeight(0.0f), colorHeightRange(1.0f),
+    useDetailNormalMapping(false), meshStride(4), coarseVao(0), coarseVbo(0), coarseEbo(0),
+    coarseIndexCount(0), coarseVertexCount(0), detailTexture(0), useSimplifiedMesh(true),
+    simplifiedVao(0), simplifiedVbo(0), simplifiedEbo(0), simplifiedIndexCount(0), simplifiedVertexCount(0),
+    occluderStep(8), occluderSpanCount(0) { // Initialize new members
     heights.resize(width * depth, 0.0f);
 }
 
@@ -18,6 +24,8 @@ Terrain::~Terrain() {
 void Terrain::generate(noise::module::Perlin& perlin, float baseHeight, float minHeight, float maxHeight, const glm::vec3& lowColor, const glm::vec3& highColor, const std::vector<float>* heightmap) {
     this->lowColor = lowColor;
     this->highColor = highColor;
+    colorMinHeight = baseHeight + minHeight;
+    colorHeightRange = maxHeight - minHeight;
 
     // Generate heights with finer noise sampling
     for (int z = 0; z < depth; ++z) {
@@ -56,33 +64,206 @@ void Terrain::generate(noise::module::Perlin& perlin, float baseHeight, float mi
         }
     }
 
-    // Generate indices for a triangle mesh
-    for (int z = 0; z < depth - 1; ++z) {
-        for (int x = 0; x < width - 1; ++x) {
-            int topLeft = x + z * width;
-            int topRight = (x + 1) + z * width;
-            int bottomLeft = x + (z + 1) * width;
-            int bottomRight = (x + 1) + (z + 1) * width;
-
-            indices.push_back(topLeft);
-            indices.push_back(bottomLeft);
-            indices.push_back(topRight);
-
-            indices.push_back(topRight);
-            indices.push_back(bottomLeft);
-            indices.push_back(bottomRight);
+    // Generate indices for a triangle mesh, one chunk at a time so every chunk can be drawn on its own
+    chunks.clear();
+    for (int chunkZ = 0; chunkZ < depth - 1; chunkZ += CHUNK_SIZE) {
+        for (int chunkX = 0; chunkX < width - 1; chunkX += CHUNK_SIZE) {
+            TerrainChunk chunk{};
+            chunk.indexOffset = static_cast<GLsizei>(indices.size());
+            for (int z = chunkZ; z < std::min(chunkZ + CHUNK_SIZE, depth - 1); ++z) {
+                for (int x = chunkX; x < std::min(chunkX + CHUNK_SIZE, width - 1); ++x) {
+                    int topLeft = x + z * width;
+                    int topRight = (x + 1) + z * width;
+                    int bottomLeft = x + (z + 1) * width;
+                    int bottomRight = (x + 1) + (z + 1) * width;
+
+                    indices.push_back(topLeft);
+                    indices.push_back(bottomLeft);
+                    indices.push_back(topRight);
+
+                    indices.push_back(topRight);
+                    indices.push_back(bottomLeft);
+                    indices.push_back(bottomRight);
+                }
+            }
+            chunk.indexCount = static_cast<GLsizei>(indices.size()) - chunk.indexOffset;
+            chunks.push_back(chunk);
         }
     }
+    computeChunkBounds(chunks);
 
     computeNormals();
     setupMesh();
+    cleanupSimplifiedMesh();
+
+    if (useDetailNormalMapping) {
+        setupCoarseMesh();
+        setupDetailTexture();
+    }
+    buildOccluderProfile();
+}
+
+void TerrainUniforms::resolve(GLuint shader) {
+    ShaderRegistry& registry = ShaderRegistry::shared();
+    useDetailMap = registry.uniform<bool>(shader, "useDetailMap");
+    detailScale = registry.uniform<glm::vec2>(shader, "detailScale");
+    detailOffset = registry.uniform<glm::vec2>(shader, "detailOffset");
+    lowColor = registry.uniform<glm::vec3>(shader, "lowColor");
+    highColor = registry.uniform<glm::vec3>(shader, "highColor");
+    detailMap = registry.uniform<int>(shader, "detailMap");
 }
 
-void Terrain::render(GLuint shader) {
-    glUseProgram(shader);
-    glBindVertexArray(vao);
+void Terrain::render(GLuint shader, const TerrainUniforms& uniforms) {
+    if (!ShaderRegistry::shared().use(shader)) return;
+    uniforms.useDetailMap.set(useDetailNormalMapping);
+
+    if (useDetailNormalMapping && coarseVao) {
+        // Texel centers line up with the full-resolution grid (2 units apart in X, 5 units in Z)
+        uniforms.detailScale.set(glm::vec2(1.0f / (2.0f * width), 1.0f / (5.0f * depth)));
+        uniforms.detailOffset.set(glm::vec2(0.5f / width, 0.5f / depth));
+        uniforms.lowColor.set(lowColor);
+        uniforms.highColor.set(highColor);
+        uniforms.detailMap.set(0);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, detailTexture);
+        GLStateCache::shared().bindVertexArray(coarseVao);
+        glDrawElements(GL_TRIANGLES, coarseIndexCount, GL_UNSIGNED_INT, 0);
+        GLStateCache::shared().bindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return;
+    }
+
+    if (isUsingSimplifiedMesh()) {
+        GLStateCache::shared().bindVertexArray(simplifiedVao);
+        glDrawElements(GL_TRIANGLES, simplifiedIndexCount, GL_UNSIGNED_INT, 0);
+        GLStateCache::shared().bindVertexArray(0);
+        return;
+    }
+
+    GLStateCache::shared().bindVertexArray(vao);
     glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    GLStateCache::shared().bindVertexArray(0);
+}
+
+void Terrain::setDetailNormalMapping(bool enabled, int stride) {
+    stride = std::max(1, std::min(stride, 16));
+    bool changed = (enabled != useDetailNormalMapping) || (stride != meshStride);
+    useDetailNormalMapping = enabled;
+    meshStride = stride;
+
+    if (!changed || vertices.empty()) return;
+
+    if (useDetailNormalMapping) {
+        setupCoarseMesh();
+        if (!detailTexture) setupDetailTexture();
+    } else {
+        cleanupDetailResources();
+    }
+    buildOccluderProfile();
+}
+
+void Terrain::renderChunks(GLuint shader, const TerrainUniforms& uniforms, const std::vector<char>& visibleChunks) {
+    const std::vector<TerrainChunk>& drawnChunks = getChunks();
+    if (drawnChunks.empty() || visibleChunks.size() != drawnChunks.size()) {
+        render(shader, uniforms);
+        return;
+    }
+
+    if (!ShaderRegistry::shared().use(shader)) return;
+    uniforms.useDetailMap.set(false);
+    GLStateCache::shared().bindVertexArray(isUsingSimplifiedMesh() ? simplifiedVao : vao);
+
+    // Chunks are stored back to back, so consecutive visible chunks collapse into a single draw
+    size_t i = 0;
+    while (i < drawnChunks.size()) {
+        if (!visibleChunks[i]) {
+            ++i;
+            continue;
+        }
+        GLsizei first = drawnChunks[i].indexOffset;
+        GLsizei count = 0;
+        while (i < drawnChunks.size() && visibleChunks[i]) {
+            count += drawnChunks[i].indexCount;
+            ++i;
+        }
+        glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, (void*)(static_cast<size_t>(first) * sizeof(unsigned int)));
+    }
+
+    GLStateCache::shared().bindVertexArray(0);
+}
+
+const std::vector<TerrainChunk>& Terrain::getChunks() const {
+    static const std::vector<TerrainChunk> noChunks;
+    if (useDetailNormalMapping && coarseVao) return noChunks;
+    if (isUsingSimplifiedMesh()) return simplifiedChunks;
+    return chunks;
+}
+
+size_t Terrain::getRenderedVertexCount() const {
+    if (useDetailNormalMapping && coarseVao) return coarseVertexCount;
+    if (isUsingSimplifiedMesh()) return simplifiedVertexCount;
+    return vertices.size() / 3;
+}
+
+size_t Terrain::getRenderedTriangleCount() const {
+    if (useDetailNormalMapping && coarseVao) return static_cast<size_t>(coarseIndexCount) / 3;
+    if (isUsingSimplifiedMesh()) return static_cast<size_t>(simplifiedIndexCount) / 3;
+    return indices.size() / 3;
+}
+
+void Terrain::setSimplifiedMesh(const SimplifiedTerrainMesh& mesh) {
+    cleanupSimplifiedMesh();
+    if (mesh.indices.empty() || vertices.empty()) return;
+
+    // Simplified vertices are a subset of the grid, so they reuse the full-resolution normals and colors
+    simplifiedVertexCount = mesh.gridIndices.size();
+    std::vector<float> attributes(simplifiedVertexCount * 9);
+    float* positionOut = attributes.data();
+    float* normalOut = positionOut + simplifiedVertexCount * 3;
+    float* colorOut = normalOut + simplifiedVertexCount * 3;
+    for (size_t i = 0; i < simplifiedVertexCount; ++i) {
+        size_t source = static_cast<size_t>(mesh.gridIndices[i]) * 3;
+        for (int c = 0; c < 3; ++c) {
+            positionOut[i * 3 + c] = vertices[source + c];
+            normalOut[i * 3 + c] = normals[source + c];
+            colorOut[i * 3 + c] = colors[source + c];
+        }
+    }
+    simplifiedIndexCount = static_cast<GLsizei>(mesh.indices.size());
+
+    // Simplifier tiles cover the same cells as the full mesh chunks, in the same order
+    if (mesh.tileIndexOffsets.size() == chunks.size() + 1) {
+        simplifiedChunks.resize(chunks.size());
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            simplifiedChunks[i].indexOffset = static_cast<GLsizei>(mesh.tileIndexOffsets[i]);
+            simplifiedChunks[i].indexCount = static_cast<GLsizei>(mesh.tileIndexOffsets[i + 1] - mesh.tileIndexOffsets[i]);
+        }
+        computeChunkBounds(simplifiedChunks);
+    }
+
+    size_t attributeBytes = simplifiedVertexCount * 3 * sizeof(float);
+
+    glGenVertexArrays(1, &simplifiedVao);
+    glGenBuffers(1, &simplifiedVbo);
+    glGenBuffers(1, &simplifiedEbo);
+
+    GLStateCache::shared().bindVertexArray(simplifiedVao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, simplifiedVbo);
+    glBufferData(GL_ARRAY_BUFFER, attributes.size() * sizeof(float), attributes.data(), GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, simplifiedEbo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(unsigned int), mesh.indices.data(), GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)attributeBytes);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)(attributeBytes * 2));
+    glEnableVertexAttribArray(2);
+
+    GLStateCache::shared().bindVertexArray(0);
 }
 
 std::vector<float> Terrain::getHeightmap(int resolution) const {
@@ -149,13 +330,22 @@ void Terrain::deform(float x, float radius, float intensity, bool addTerrain) {
     computeNormals();
 
     // Update VBO
-    glBindVertexArray(vao);
+    GLStateCache::shared().bindVertexArray(vao);
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
     glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(float), vertices.data());
     glBufferSubData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), normals.size() * sizeof(float), normals.data());
     glBufferSubData(GL_ARRAY_BUFFER, (vertices.size() + normals.size()) * sizeof(float), colors.size() * sizeof(float), colors.data());
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLStateCache::shared().bindVertexArray(0);
+
+    cleanupSimplifiedMesh();
+    computeChunkBounds(chunks);
+
+    if (useDetailNormalMapping) {
+        setupCoarseMesh();
+        setupDetailTexture();
+    }
+    buildOccluderProfile();
 }
 
 void Terrain::computeNormals() {
@@ -195,7 +385,7 @@ void Terrain::computeNormals() {
 }
 
 void Terrain::setupMesh() {
-    if (vao) glDeleteVertexArrays(1, &vao);
+    if (vao) GLStateCache::shared().deleteVertexArrays(1, &vao);
     if (vbo) glDeleteBuffers(1, &vbo);
     if (ebo) glDeleteBuffers(1, &ebo);
 
@@ -203,7 +393,7 @@ void Terrain::setupMesh() {
     glGenBuffers(1, &vbo);
     glGenBuffers(1, &ebo);
 
-    glBindVertexArray(vao);
+    GLStateCache::shared().bindVertexArray(vao);
 
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
     glBufferData(GL_ARRAY_BUFFER,
@@ -228,12 +418,204 @@ void Terrain::setupMesh() {
     glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)(vertices.size() * sizeof(float) + normals.size() * sizeof(float)));
     glEnableVertexAttribArray(2);
 
-    glBindVertexArray(0);
+    GLStateCache::shared().bindVertexArray(0);
+}
+
+void Terrain::setupCoarseMesh() {
+    if (coarseVao) GLStateCache::shared().deleteVertexArrays(1, &coarseVao);
+    if (coarseVbo) glDeleteBuffers(1, &coarseVbo);
+    if (coarseEbo) glDeleteBuffers(1, &coarseEbo);
+
+    // Keep every meshStride-th row and column, plus the last ones so the coarse mesh covers the full extent
+    std::vector<int> columns;
+    for (int x = 0; x < width; x += meshStride) columns.push_back(x);
+    if (columns.back() != width - 1) columns.push_back(width - 1);
+    std::vector<int> rows;
+    for (int z = 0; z < depth; z += meshStride) rows.push_back(z);
+    if (rows.back() != depth - 1) rows.push_back(depth - 1);
+
+    const int coarseWidth = static_cast<int>(columns.size());
+    const int coarseDepth = static_cast<int>(rows.size());
+    coarseVertexCount = static_cast<size_t>(coarseWidth) * coarseDepth;
+
+    std::vector<float> coarseVertices;
+    std::vector<float> coarseNormals;
+    std::vector<float> coarseColors;
+    coarseVertices.reserve(coarseVertexCount * 3);
+    coarseNormals.reserve(coarseVertexCount * 3);
+    coarseColors.reserve(coarseVertexCount * 3);
+    for (int z : rows) {
+        for (int x : columns) {
+            size_t source = (static_cast<size_t>(x) + static_cast<size_t>(z) * width) * 3;
+            coarseVertices.insert(coarseVertices.end(), vertices.begin() + source, vertices.begin() + source + 3);
+            coarseNormals.insert(coarseNormals.end(), normals.begin() + source, normals.begin() + source + 3);
+            coarseColors.insert(coarseColors.end(), colors.begin() + source, colors.begin() + source + 3);
+        }
+    }
+
+    std::vector<unsigned int> coarseIndices;
+    coarseIndices.reserve(static_cast<size_t>(coarseWidth - 1) * (coarseDepth - 1) * 6);
+    for (int z = 0; z < coarseDepth - 1; ++z) {
+        for (int x = 0; x < coarseWidth - 1; ++x) {
+            unsigned int topLeft = x + z * coarseWidth;
+            unsigned int topRight = (x + 1) + z * coarseWidth;
+            unsigned int bottomLeft = x + (z + 1) * coarseWidth;
+            unsigned int bottomRight = (x + 1) + (z + 1) * coarseWidth;
+
+            coarseIndices.push_back(topLeft);
+            coarseIndices.push_back(bottomLeft);
+            coarseIndices.push_back(topRight);
+
+            coarseIndices.push_back(topRight);
+            coarseIndices.push_back(bottomLeft);
+            coarseIndices.push_back(bottomRight);
+        }
+    }
+    coarseIndexCount = static_cast<GLsizei>(coarseIndices.size());
+
+    size_t attributeBytes = coarseVertices.size() * sizeof(float);
+
+    glGenVertexArrays(1, &coarseVao);
+    glGenBuffers(1, &coarseVbo);
+    glGenBuffers(1, &coarseEbo);
+
+    GLStateCache::shared().bindVertexArray(coarseVao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, coarseVbo);
+    glBufferData(GL_ARRAY_BUFFER, attributeBytes * 3, nullptr, GL_STATIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, attributeBytes, coarseVertices.data());
+    glBufferSubData(GL_ARRAY_BUFFER, attributeBytes, attributeBytes, coarseNormals.data());
+    glBufferSubData(GL_ARRAY_BUFFER, attributeBytes * 2, attributeBytes, coarseColors.data());
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, coarseEbo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, coarseIndices.size() * sizeof(unsigned int), coarseIndices.data(), GL_STATIC_DRAW);
+
+    // Same attribute layout as the full-resolution mesh so both paths share the terrain shader
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)attributeBytes);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)(attributeBytes * 2));
+    glEnableVertexAttribArray(2);
+
+    GLStateCache::shared().bindVertexArray(0);
+
+    DataManager::LogDebug(DebugCategory::RENDERING, "Terrain", "setupCoarseMesh",
+        "Coarse mesh built: stride=" + std::to_string(meshStride) +
+        ", vertices=" + std::to_string(coarseVertexCount) + " (full " + std::to_string(vertices.size() / 3) + ")" +
+        ", triangles=" + std::to_string(coarseIndexCount / 3) + " (full " + std::to_string(indices.size() / 3) + ")");
+}
+
+void Terrain::setupDetailTexture() {
+    // One texel per full-resolution vertex: RGB holds the packed normal, A the normalized height used for coloring
+    std::vector<unsigned char> texels(static_cast<size_t>(width) * depth * 4);
+    float inverseRange = colorHeightRange != 0.0f ? 1.0f / colorHeightRange : 0.0f;
+    for (size_t i = 0; i < static_cast<size_t>(width) * depth; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            float packed = normals[i * 3 + c] * 0.5f + 0.5f;
+            texels[i * 4 + c] = static_cast<unsigned char>(std::clamp(packed, 0.0f, 1.0f) * 255.0f + 0.5f);
+        }
+        float normalizedHeight = (heights[i] - colorMinHeight) * inverseRange;
+        texels[i * 4 + 3] = static_cast<unsigned char>(std::clamp(normalizedHeight, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+
+    if (!detailTexture) {
+        glGenTextures(1, &detailTexture);
+    }
+    glBindTexture(GL_TEXTURE_2D, detailTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, depth, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Terrain::cleanupDetailResources() {
+    if (coarseVao) {
+        GLStateCache::shared().deleteVertexArrays(1, &coarseVao);
+        coarseVao = 0;
+    }
+    if (coarseVbo) {
+        glDeleteBuffers(1, &coarseVbo);
+        coarseVbo = 0;
+    }
+    if (coarseEbo) {
+        glDeleteBuffers(1, &coarseEbo);
+        coarseEbo = 0;
+    }
+    if (detailTexture) {
+        glDeleteTextures(1, &detailTexture);
+        detailTexture = 0;
+    }
+    coarseIndexCount = 0;
+    coarseVertexCount = 0;
+}
+
+void Terrain::computeChunkBounds(std::vector<TerrainChunk>& target) const {
+    const int chunksX = (width - 1 + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    for (size_t i = 0; i < target.size(); ++i) {
+        int x0 = static_cast<int>(i % chunksX) * CHUNK_SIZE;
+        int z0 = static_cast<int>(i / chunksX) * CHUNK_SIZE;
+        int x1 = std::min(x0 + CHUNK_SIZE, width - 1);
+        int z1 = std::min(z0 + CHUNK_SIZE, depth - 1);
+
+        float minHeight = FLT_MAX;
+        float maxHeight = -FLT_MAX;
+        for (int z = z0; z <= z1; ++z) {
+            for (int x = x0; x <= x1; ++x) {
+                float h = heights[x + z * width];
+                minHeight = std::min(minHeight, h);
+                maxHeight = std::max(maxHeight, h);
+            }
+        }
+        target[i].boundsMin = glm::vec3(x0 * 2.0f, minHeight, z0 * 5.0f);
+        target[i].boundsMax = glm::vec3(x1 * 2.0f, maxHeight, z1 * 5.0f);
+    }
+}
+
+void Terrain::buildOccluderProfile() {
+    // Rows and span ends must be vertices of the mesh that is drawn, so each profile row follows real mesh edges and
+    // the interpolated surface between two profile samples never dips below the span minimum
+    int stride = (useDetailNormalMapping && coarseVao) ? meshStride : 1;
+    occluderStep = stride * std::max(1, (8 + stride - 1) / stride);
+    occluderSpanCount = (width - 1 + occluderStep - 1) / occluderStep;
+    int rowCount = (depth - 1) / occluderStep + 1;
+
+    occluderHeights.assign(static_cast<size_t>(rowCount) * occluderSpanCount, FLT_MAX);
+    for (int row = 0; row < rowCount; ++row) {
+        const float* rowHeights = &heights[static_cast<size_t>(row * occluderStep) * width];
+        for (int span = 0; span < occluderSpanCount; ++span) {
+            int x0 = span * occluderStep;
+            int x1 = std::min(x0 + occluderStep, width - 1);
+            occluderHeights[row * occluderSpanCount + span] = *std::min_element(rowHeights + x0, rowHeights + x1 + 1);
+        }
+    }
+}
+
+void Terrain::cleanupSimplifiedMesh() {
+    if (simplifiedVao) {
+        GLStateCache::shared().deleteVertexArrays(1, &simplifiedVao);
+        simplifiedVao = 0;
+    }
+    if (simplifiedVbo) {
+        glDeleteBuffers(1, &simplifiedVbo);
+        simplifiedVbo = 0;
+    }
+    if (simplifiedEbo) {
+        glDeleteBuffers(1, &simplifiedEbo);
+        simplifiedEbo = 0;
+    }
+    simplifiedIndexCount = 0;
+    simplifiedVertexCount = 0;
+    simplifiedChunks.clear();
 }
 
 void Terrain::cleanup() {
+    cleanupDetailResources();
+    cleanupSimplifiedMesh();
     if (vao) {
-        glDeleteVertexArrays(1, &vao);
+        GLStateCache::shared().deleteVertexArrays(1, &vao);
         vao = 0;
     }
     if (vbo) {
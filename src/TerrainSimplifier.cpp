@@ -0,0 +1,210 @@
+#include "TerrainSimplifier.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+struct SimplifierTile {
+    int originX;
+    int originZ;
+    std::vector<float> errors; // (tileSize + 1)^2, indexed z * gridSize + x in tile space
+    std::vector<unsigned int> triangles;
+};
+
+struct SimplifierGrid {
+    const std::vector<float>& heights;
+    const std::vector<float>& rowErrorScale;
+    int width;
+    int depth;
+    int tileSize;
+    int gridSize;
+    float maxError;
+
+    // Tiles overhanging the terrain edge sample the clamped border, which collapses their extra area onto the edge
+    int clampX(int x) const { return std::min(x, width - 1); }
+    int clampZ(int z) const { return std::min(z, depth - 1); }
+    float height(const SimplifierTile& tile, int x, int z) const {
+        return heights[clampZ(tile.originZ + z) * width + clampX(tile.originX + x)];
+    }
+    float errorScale(const SimplifierTile& tile, int z) const {
+        return rowErrorScale.empty() ? 1.0f : rowErrorScale[clampZ(tile.originZ + z)];
+    }
+    unsigned int gridIndex(const SimplifierTile& tile, int x, int z) const {
+        return static_cast<unsigned int>(clampZ(tile.originZ + z) * width + clampX(tile.originX + x));
+    }
+};
+
+// Visits triangles from the finest level up so each midpoint error includes all of its descendants
+static void accumulateErrors(const SimplifierGrid& grid, const std::vector<int>& coords, int parentTriangleCount, SimplifierTile& tile) {
+    const int gridSize = grid.gridSize;
+    const int triangleCount = static_cast<int>(coords.size() / 4);
+    for (int i = triangleCount - 1; i >= 0; --i) {
+        int ax = coords[i * 4], ay = coords[i * 4 + 1];
+        int bx = coords[i * 4 + 2], by = coords[i * 4 + 3];
+        int mx = (ax + bx) >> 1;
+        int my = (ay + by) >> 1;
+        int cx = mx + my - ay;
+        int cy = my + ax - mx;
+
+        float interpolated = (grid.height(tile, ax, ay) + grid.height(tile, bx, by)) * 0.5f;
+        float middleError = std::fabs(interpolated - grid.height(tile, mx, my)) * grid.errorScale(tile, my);
+        int middleIndex = my * gridSize + mx;
+        float& error = tile.errors[middleIndex];
+        error = std::max(error, middleError);
+
+        if (i < parentTriangleCount) {
+            int leftChild = ((ay + cy) >> 1) * gridSize + ((ax + cx) >> 1);
+            int rightChild = ((by + cy) >> 1) * gridSize + ((bx + cx) >> 1);
+            error = std::max(error, std::max(tile.errors[leftChild], tile.errors[rightChild]));
+        }
+    }
+}
+
+// Gives every vertex on an edge shared by two tiles the larger of its two errors; returns whether any changed
+static bool reconcileTileEdges(std::vector<SimplifierTile>& tiles, int tilesX, int tilesZ, int tileSize, int gridSize) {
+    bool changed = false;
+    auto share = [&changed](float& first, float& second) {
+        if (first == second) return;
+        first = second = std::max(first, second);
+        changed = true;
+    };
+    for (int tz = 0; tz < tilesZ; ++tz) {
+        for (int tx = 0; tx < tilesX; ++tx) {
+            SimplifierTile& tile = tiles[tz * tilesX + tx];
+            if (tx + 1 < tilesX) {
+                SimplifierTile& right = tiles[tz * tilesX + tx + 1];
+                for (int z = 0; z < gridSize; ++z) share(tile.errors[z * gridSize + tileSize], right.errors[z * gridSize]);
+            }
+            if (tz + 1 < tilesZ) {
+                SimplifierTile& below = tiles[(tz + 1) * tilesX + tx];
+                for (int x = 0; x < gridSize; ++x) share(tile.errors[tileSize * gridSize + x], below.errors[x]);
+            }
+        }
+    }
+    return changed;
+}
+
+static void extractTriangle(const SimplifierGrid& grid, SimplifierTile& tile, int ax, int ay, int bx, int by, int cx, int cy) {
+    int mx = (ax + bx) >> 1;
+    int my = (ay + by) >> 1;
+    if (std::abs(ax - cx) + std::abs(ay - cy) > 1 && tile.errors[my * grid.gridSize + mx] > grid.maxError) {
+        extractTriangle(grid, tile, cx, cy, ax, ay, mx, my);
+        extractTriangle(grid, tile, bx, by, cx, cy, mx, my);
+        return;
+    }
+
+    // Triangles in the overhang collapse onto the clamped border; drop the ones left with no area
+    int clampedAx = grid.clampX(tile.originX + ax), clampedAz = grid.clampZ(tile.originZ + ay);
+    int clampedBx = grid.clampX(tile.originX + bx), clampedBz = grid.clampZ(tile.originZ + by);
+    int clampedCx = grid.clampX(tile.originX + cx), clampedCz = grid.clampZ(tile.originZ + cy);
+    int doubleArea = (clampedBx - clampedAx) * (clampedCz - clampedAz) - (clampedCx - clampedAx) * (clampedBz - clampedAz);
+    if (doubleArea == 0) return;
+
+    tile.triangles.push_back(grid.gridIndex(tile, ax, ay));
+    tile.triangles.push_back(grid.gridIndex(tile, bx, by));
+    tile.triangles.push_back(grid.gridIndex(tile, cx, cy));
+}
+
+SimplifiedTerrainMesh TerrainSimplifier::simplify(const std::vector<float>& heights, int width, int depth,
+    const std::vector<float>& rowErrorScale, float maxError, int tileSize) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    SimplifiedTerrainMesh mesh;
+    if (width < 2 || depth < 2 || heights.size() < static_cast<size_t>(width) * depth) return mesh;
+
+    // RTIN needs a power-of-two number of cells per tile
+    int powerOfTwo = 2;
+    while (powerOfTwo < tileSize) powerOfTwo <<= 1;
+    tileSize = powerOfTwo;
+
+    SimplifierGrid grid{ heights, rowErrorScale, width, depth, tileSize, tileSize + 1, maxError };
+    const int gridSize = grid.gridSize;
+    const int tilesX = (width - 1 + tileSize - 1) / tileSize;
+    const int tilesZ = (depth - 1 + tileSize - 1) / tileSize;
+    const int tileCount = tilesX * tilesZ;
+
+    // Vertex coordinates (a, b) of every triangle in the implicit binary hierarchy, shared by all tiles
+    const int triangleCount = tileSize * tileSize * 2 - 2;
+    const int parentTriangleCount = triangleCount - tileSize * tileSize;
+    std::vector<int> coords(static_cast<size_t>(triangleCount) * 4);
+    for (int i = 0; i < triangleCount; ++i) {
+        int id = i + 2;
+        int ax = 0, ay = 0, bx = 0, by = 0, cx = 0, cy = 0;
+        if (id & 1) {
+            bx = by = cx = tileSize; // bottom-left half of the tile
+        } else {
+            ax = ay = cy = tileSize; // top-right half of the tile
+        }
+        while ((id >>= 1) > 1) {
+            int mx = (ax + bx) >> 1;
+            int my = (ay + by) >> 1;
+            if (id & 1) { // left child
+                bx = ax; by = ay;
+                ax = cx; ay = cy;
+            } else { // right child
+                ax = bx; ay = by;
+                bx = cx; by = cy;
+            }
+            cx = mx; cy = my;
+        }
+        coords[i * 4] = ax;
+        coords[i * 4 + 1] = ay;
+        coords[i * 4 + 2] = bx;
+        coords[i * 4 + 3] = by;
+    }
+
+    std::vector<SimplifierTile> tiles(tileCount);
+    for (int tz = 0; tz < tilesZ; ++tz) {
+        for (int tx = 0; tx < tilesX; ++tx) {
+            SimplifierTile& tile = tiles[tz * tilesX + tx];
+            tile.originX = tx * tileSize;
+            tile.originZ = tz * tileSize;
+            tile.errors.assign(static_cast<size_t>(gridSize) * gridSize, 0.0f);
+        }
+    }
+
+    ThreadPool& pool = ThreadPool::shared();
+    pool.parallelFor(tileCount, 1, [&](int begin, int end, int) {
+        for (int t = begin; t < end; ++t) accumulateErrors(grid, coords, parentTriangleCount, tiles[t]);
+    });
+
+    // Neighbouring tiles must split a shared edge the same way or the mesh cracks, so each shared edge vertex
+    // takes the larger of its two errors. Re-propagating then raises interior ancestors, and through them larger
+    // edge vertices whose errors the neighbour has not seen, so both steps repeat until the edges stop changing.
+    // Errors only ever grow and take values from a finite set, so this ends, normally after two or three passes.
+    while (reconcileTileEdges(tiles, tilesX, tilesZ, tileSize, gridSize)) {
+        pool.parallelFor(tileCount, 1, [&](int begin, int end, int) {
+            for (int t = begin; t < end; ++t) accumulateErrors(grid, coords, parentTriangleCount, tiles[t]);
+        });
+    }
+
+    pool.parallelFor(tileCount, 1, [&](int begin, int end, int) {
+        for (int t = begin; t < end; ++t) {
+            extractTriangle(grid, tiles[t], 0, 0, tileSize, tileSize, tileSize, 0);
+            extractTriangle(grid, tiles[t], tileSize, tileSize, 0, 0, 0, tileSize);
+        }
+    });
+
+    // Compact the referenced grid vertices into a dense vertex list
+    std::vector<int> remap(static_cast<size_t>(width) * depth, -1);
+    for (const SimplifierTile& tile : tiles) {
+        mesh.tileIndexOffsets.push_back(static_cast<unsigned int>(mesh.indices.size()));
+        for (unsigned int gridVertex : tile.triangles) {
+            int& vertex = remap[gridVertex];
+            if (vertex < 0) {
+                vertex = static_cast<int>(mesh.gridIndices.size());
+                mesh.gridIndices.push_back(gridVertex);
+            }
+            mesh.indices.push_back(static_cast<unsigned int>(vertex));
+        }
+    }
+
+    mesh.tileIndexOffsets.push_back(static_cast<unsigned int>(mesh.indices.size()));
+
+    mesh.stats.sourceTriangles = static_cast<size_t>(width - 1) * (depth - 1) * 2;
+    mesh.stats.simplifiedTriangles = mesh.indices.size() / 3;
+    mesh.stats.simplifiedVertices = mesh.gridIndices.size();
+    mesh.stats.threadCount = pool.getThreadCount() + 1;
+    mesh.stats.buildMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    return mesh;
+}
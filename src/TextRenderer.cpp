@@ -0,0 +1,244 @@
+#include "TextRenderer.hpp"
+#include "DataManager.hpp"
+#include "GLStateCache.hpp"
+#include "StreamBuffer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+
+TextRenderer::TextRenderer() : shelfX(1), shelfY(1), shelfHeight(0), atlasTexture(0), vao(0) {
+}
+
+TextRenderer::~TextRenderer() {
+    if (atlasTexture) glDeleteTextures(1, &atlasTexture);
+    if (vao) GLStateCache::shared().deleteVertexArrays(1, &vao);
+}
+
+int TextRenderer::addFont(TTF_Font* font) {
+    if (!font) return -1;
+    if (!atlasTexture) {
+        // Glyph coverage only, so one channel; the empty atlas is filled in as glyphs are rasterized
+        std::vector<uint8_t> empty(static_cast<size_t>(ATLAS_SIZE) * ATLAS_SIZE, 0);
+        glGenTextures(1, &atlasTexture);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, ATLAS_SIZE, ATLAS_SIZE, 0, GL_RED, GL_UNSIGNED_BYTE, empty.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    int index = static_cast<int>(fonts.size());
+    fonts.push_back(font);
+    asciiGlyphs.emplace_back(127 - 32);
+    for (uint32_t codepoint = 32; codepoint < 127; ++codepoint) {
+        asciiGlyphs[index][codepoint - 32] = rasterize(index, codepoint);
+    }
+    DataManager::LogDebug(DebugCategory::RENDERING, "TextRenderer", "addFont",
+        "Font " + std::to_string(index) + " packed, atlas now at row " + std::to_string(shelfY) + " of " + std::to_string(ATLAS_SIZE));
+    return index;
+}
+
+TextRenderer::Glyph TextRenderer::rasterize(int font, uint32_t codepoint) {
+    Glyph glyph = {};
+    int minX, maxX, minY, maxY, advance;
+    if (!TTF_GetGlyphMetrics(fonts[font], codepoint, &minX, &maxX, &minY, &maxY, &advance)) {
+        return glyph;
+    }
+    glyph.advance = static_cast<float>(advance);
+    glyph.valid = true;
+    if (codepoint == ' ') return glyph;
+
+    // The whole-line cell, so every glyph of a font shares the baseline and lines up as TTF_RenderText_Solid did
+    SDL_Color white = { 255, 255, 255, 255 };
+    SDL_Surface* surface = TTF_RenderGlyph_Solid(fonts[font], codepoint, white);
+    if (!surface) {
+        DataManager::LogWarning("TextRenderer", "rasterize", "Failed to render glyph " + std::to_string(codepoint) + ": " + std::string(SDL_GetError()));
+        return glyph;
+    }
+    SDL_Surface* rgbaSurface = SDL_ConvertSurface(surface, SDL_PIXELFORMAT_RGBA32);
+    SDL_DestroySurface(surface);
+    if (!rgbaSurface) {
+        DataManager::LogWarning("TextRenderer", "rasterize", "Failed to convert glyph " + std::to_string(codepoint) + ": " + std::string(SDL_GetError()));
+        return glyph;
+    }
+
+    int width = rgbaSurface->w;
+    int height = rgbaSurface->h;
+    if (shelfX + width + 1 > ATLAS_SIZE) {
+        shelfX = 1;
+        shelfY += shelfHeight + 1;
+        shelfHeight = 0;
+    }
+    if (shelfY + height + 1 > ATLAS_SIZE) {
+        DataManager::LogWarning("TextRenderer", "rasterize", "Glyph atlas is full; skipping glyph " + std::to_string(codepoint));
+        SDL_DestroySurface(rgbaSurface);
+        return glyph;
+    }
+
+    // Solid glyphs are fully covered or empty, so any alpha counts as full coverage
+    if (SDL_MUSTLOCK(rgbaSurface)) SDL_LockSurface(rgbaSurface);
+    rasterScratch.resize(static_cast<size_t>(width) * height);
+    const Uint32* pixels = static_cast<const Uint32*>(rgbaSurface->pixels);
+    int pitch = rgbaSurface->pitch / sizeof(Uint32);
+    for (int py = 0; py < height; ++py) {
+        for (int px = 0; px < width; ++px) {
+            rasterScratch[static_cast<size_t>(py) * width + px] = ((pixels[py * pitch + px] >> 24) & 0xFF) ? 255 : 0;
+        }
+    }
+    if (SDL_MUSTLOCK(rgbaSurface)) SDL_UnlockSurface(rgbaSurface);
+    SDL_DestroySurface(rgbaSurface);
+
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, shelfX, shelfY, width, height, GL_RED, GL_UNSIGNED_BYTE, rasterScratch.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glyph.uvMin = glm::vec2(static_cast<float>(shelfX) / ATLAS_SIZE, static_cast<float>(shelfY) / ATLAS_SIZE);
+    glyph.uvMax = glm::vec2(static_cast<float>(shelfX + width) / ATLAS_SIZE, static_cast<float>(shelfY + height) / ATLAS_SIZE);
+    glyph.width = static_cast<float>(width);
+    glyph.height = static_cast<float>(height);
+    shelfX += width + 1;
+    shelfHeight = std::max(shelfHeight, height);
+    ++stats.textureUploads;
+    ++stats.atlasGlyphs;
+    return glyph;
+}
+
+const TextRenderer::Glyph& TextRenderer::getGlyph(int font, uint32_t codepoint) {
+    if (codepoint >= 32 && codepoint < 127) {
+        return asciiGlyphs[font][codepoint - 32];
+    }
+    uint64_t key = (static_cast<uint64_t>(font) << 32) | codepoint;
+    auto it = otherGlyphs.find(key);
+    if (it == otherGlyphs.end()) {
+        it = otherGlyphs.emplace(key, rasterize(font, codepoint)).first;
+    }
+    return it->second;
+}
+
+float TextRenderer::measure(int font, const std::string& text) {
+    if (font < 0 || font >= static_cast<int>(fonts.size())) return 0.0f;
+    float width = 0.0f;
+    const char* cursor = text.c_str();
+    size_t remaining = text.length();
+    Uint32 previous = 0;
+    int kerning = 0;
+    while (remaining > 0) {
+        Uint32 codepoint = SDL_StepUTF8(&cursor, &remaining);
+        if (previous != 0 && TTF_GetGlyphKerning(fonts[font], previous, codepoint, &kerning)) {
+            width += static_cast<float>(kerning);
+        }
+        width += getGlyph(font, codepoint).advance;
+        previous = codepoint;
+    }
+    return width;
+}
+
+float TextRenderer::getLineHeight(int font) const {
+    if (font < 0 || font >= static_cast<int>(fonts.size())) return 0.0f;
+    return static_cast<float>(TTF_GetFontHeight(fonts[font]));
+}
+
+void TextRenderer::layout(int font, const std::string& text, float x, float y, float scale, std::vector<glm::vec4>& out) {
+    if (font < 0 || font >= static_cast<int>(fonts.size())) return;
+    float penX = x;
+    const char* cursor = text.c_str();
+    size_t remaining = text.length();
+    Uint32 previous = 0;
+    int kerning = 0;
+    while (remaining > 0) {
+        Uint32 codepoint = SDL_StepUTF8(&cursor, &remaining);
+        // Pairs are kerned here because glyphs are rasterized one at a time
+        if (previous != 0 && TTF_GetGlyphKerning(fonts[font], previous, codepoint, &kerning)) {
+            penX += static_cast<float>(kerning) * scale;
+        }
+        previous = codepoint;
+        const Glyph& glyph = getGlyph(font, codepoint);
+        if (glyph.width > 0.0f) {
+            // The top of the cell is the first atlas row
+            float x0 = penX, x1 = penX + glyph.width * scale;
+            float y0 = y, y1 = y + glyph.height * scale;
+            glm::vec4 topLeft(x0, y1, glyph.uvMin.x, glyph.uvMin.y);
+            glm::vec4 bottomLeft(x0, y0, glyph.uvMin.x, glyph.uvMax.y);
+            glm::vec4 bottomRight(x1, y0, glyph.uvMax.x, glyph.uvMax.y);
+            glm::vec4 topRight(x1, y1, glyph.uvMax.x, glyph.uvMin.y);
+            out.push_back(topLeft);
+            out.push_back(bottomLeft);
+            out.push_back(bottomRight);
+            out.push_back(topLeft);
+            out.push_back(bottomRight);
+            out.push_back(topRight);
+        }
+        penX += glyph.advance * scale;
+    }
+}
+
+void TextRenderer::add(int font, const std::string& text, float x, float y, float scale, const glm::vec3& color, bool centered) {
+    if (font < 0 || font >= static_cast<int>(fonts.size()) || text.empty()) return;
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    glm::vec3 rgb = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+    uint32_t packed = static_cast<uint32_t>(rgb.r) | (static_cast<uint32_t>(rgb.g) << 8) | (static_cast<uint32_t>(rgb.b) << 16) | 0xFF000000u;
+
+    quadScratch.clear();
+    layout(font, text, centered ? x - measure(font, text) * scale * 0.5f : x, y, scale, quadScratch);
+    for (const glm::vec4& corner : quadScratch) {
+        vertices.push_back({ glm::vec2(corner.x, corner.y), glm::vec2(corner.z, corner.w), packed });
+    }
+    ++stats.strings;
+    stats.milliseconds += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+void TextUniforms::resolve(GLuint shader) {
+    ShaderRegistry& registry = ShaderRegistry::shared();
+    projection = registry.uniform<glm::mat4>(shader, "projection");
+    text = registry.uniform<int>(shader, "text");
+}
+
+void TextRenderer::render(GLuint shader, const TextUniforms& uniforms, const glm::mat4& projection) {
+    if (vertices.empty()) return;
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    size_t bytes = vertices.size() * sizeof(TextVertex);
+    StreamBuffer& stream = StreamBuffer::shared();
+    GLintptr base = stream.upload(vertices.data(), bytes);
+    stats.uploadBytes += bytes;
+
+    // Each flush lands somewhere else in the frame's stream region, so the attributes are pointed at it anew
+    if (!vao) glGenVertexArrays(1, &vao);
+    GLStateCache::shared().bindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, stream.getBuffer());
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void*)(base + offsetof(TextVertex, position)));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void*)(base + offsetof(TextVertex, texCoords)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(TextVertex), (void*)(base + offsetof(TextVertex, color)));
+    glEnableVertexAttribArray(2);
+    stats.glyphs += vertices.size() / 6;
+
+    // The queued text is dropped either way, so a failed program does not pile it up frame after frame
+    if (ShaderRegistry::shared().use(shader)) {
+        uniforms.projection.set(projection);
+        uniforms.text.set(0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+        glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertices.size()));
+        ++stats.drawCalls;
+    }
+
+    GLStateCache::shared().bindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    vertices.clear();
+    stats.milliseconds += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+void TextRenderer::newFrame() {
+    size_t atlasGlyphs = stats.atlasGlyphs;
+    stats = TextRendererStats();
+    stats.atlasGlyphs = atlasGlyphs;
+}
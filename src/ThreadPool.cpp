@@ -0,0 +1,91 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+
+ThreadPool::ThreadPool(unsigned int threadCount) : stopping(false) {
+    for (unsigned int i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    // Leave one core for the main (render) thread; hardware_concurrency() may report 0
+    static ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push(std::move(task));
+    }
+    condition.notify_one();
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(int count, int chunkSize, const std::function<void(int, int, int)>& body) {
+    if (count <= 0) return;
+    chunkSize = std::max(1, chunkSize);
+    const int chunkCount = (count + chunkSize - 1) / chunkSize;
+
+    if (chunkCount == 1 || workers.empty()) {
+        for (int chunk = 0; chunk < chunkCount; ++chunk) {
+            body(chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize), chunk);
+        }
+        return;
+    }
+
+    struct Progress {
+        std::atomic<int> nextChunk{ 0 };
+        std::atomic<int> finishedChunks{ 0 };
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    auto progress = std::make_shared<Progress>();
+
+    // Helpers that start after all chunks are claimed return without touching body,
+    // so body only has to outlive this call
+    auto runChunks = [progress, chunkCount, chunkSize, count, &body]() {
+        int chunk;
+        while ((chunk = progress->nextChunk.fetch_add(1)) < chunkCount) {
+            body(chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize), chunk);
+            if (progress->finishedChunks.fetch_add(1) + 1 == chunkCount) {
+                std::lock_guard<std::mutex> lock(progress->mutex);
+                progress->done.notify_all();
+            }
+        }
+    };
+
+    int helperCount = std::min(static_cast<int>(workers.size()), chunkCount - 1);
+    for (int i = 0; i < helperCount; ++i) {
+        enqueue(runChunks);
+    }
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(progress->mutex);
+    progress->done.wait(lock, [&progress, chunkCount]() { return progress->finishedChunks.load() == chunkCount; });
+}
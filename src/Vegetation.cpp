@@ -0,0 +1,513 @@
+#include "Vegetation.hpp"
+#include "PoissonDiskSampler.hpp"
+#include "ThreadPool.hpp"
+#include "GLStateCache.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+
+struct VegetationTypeSettings {
+    float spacing;      // Poisson-disk radius in terrain-local units
+    float minScale;
+    float maxScale;
+    float sink;         // fraction of the scale pushed below the surface
+    float meshDistance; // full mesh closer than this
+    float maxDistance;  // billboard closer than this, hidden beyond
+    float minNormalY;   // steepest slope the type grows on
+};
+
+static const VegetationTypeSettings typeSettings[] = {
+    { 22.0f, 28.0f, 46.0f, 0.03f, 900.0f, 2600.0f, 0.75f }, // TREE
+    { 7.0f, 5.0f, 9.0f, 0.05f, 500.0f, 1100.0f, 0.65f },    // GRASS
+    { 26.0f, 5.0f, 12.0f, 0.15f, 800.0f, 2000.0f, 0.0f },   // ROCK
+};
+
+struct VegetationStyle {
+    glm::vec3 primaryColor;   // canopy, blade tips, rock tops
+    glm::vec3 secondaryColor; // trunk, blade roots, rock undersides
+    float density;
+};
+
+static VegetationStyle getStyle(Scene scene, VegetationType type) {
+    switch (type) {
+        case VegetationType::TREE:
+            switch (scene) {
+                case Scene::SUMMER: return { glm::vec3(0.13f, 0.38f, 0.12f), glm::vec3(0.35f, 0.24f, 0.14f), 0.9f };
+                case Scene::FALL:   return { glm::vec3(0.75f, 0.38f, 0.10f), glm::vec3(0.33f, 0.22f, 0.13f), 0.8f };
+                case Scene::WINTER: return { glm::vec3(0.82f, 0.86f, 0.90f), glm::vec3(0.28f, 0.22f, 0.18f), 0.6f };
+                case Scene::SPRING: return { glm::vec3(0.85f, 0.60f, 0.70f), glm::vec3(0.36f, 0.26f, 0.16f), 0.8f };
+                case Scene::ALIEN:  return { glm::vec3(0.60f, 0.20f, 0.70f), glm::vec3(0.15f, 0.45f, 0.45f), 0.7f };
+            }
+            break;
+        case VegetationType::GRASS:
+            switch (scene) {
+                case Scene::SUMMER: return { glm::vec3(0.30f, 0.55f, 0.20f), glm::vec3(0.18f, 0.35f, 0.12f), 1.0f };
+                case Scene::FALL:   return { glm::vec3(0.62f, 0.52f, 0.26f), glm::vec3(0.40f, 0.33f, 0.18f), 0.8f };
+                case Scene::WINTER: return { glm::vec3(0.78f, 0.78f, 0.72f), glm::vec3(0.45f, 0.45f, 0.40f), 0.25f };
+                case Scene::SPRING: return { glm::vec3(0.42f, 0.68f, 0.26f), glm::vec3(0.22f, 0.40f, 0.14f), 1.0f };
+                case Scene::ALIEN:  return { glm::vec3(0.20f, 0.70f, 0.65f), glm::vec3(0.35f, 0.10f, 0.40f), 0.9f };
+            }
+            break;
+        default:
+            switch (scene) {
+                case Scene::WINTER: return { glm::vec3(0.80f, 0.82f, 0.86f), glm::vec3(0.40f, 0.40f, 0.42f), 0.8f };
+                case Scene::ALIEN:  return { glm::vec3(0.40f, 0.28f, 0.45f), glm::vec3(0.22f, 0.15f, 0.25f), 0.8f };
+                default:            return { glm::vec3(0.50f, 0.48f, 0.45f), glm::vec3(0.32f, 0.30f, 0.28f), 0.8f };
+            }
+    }
+    return { glm::vec3(1.0f), glm::vec3(1.0f), 1.0f };
+}
+
+// Stable per-position random numbers, so re-placing a chunk keeps the plants that are still allowed to grow
+static uint32_t hashPosition(const glm::vec2& position, int type, uint32_t seed) {
+    uint32_t h = static_cast<uint32_t>(static_cast<int>(position.x * 16.0f)) * 73856093u;
+    h ^= static_cast<uint32_t>(static_cast<int>(position.y * 16.0f)) * 19349663u;
+    h ^= static_cast<uint32_t>(type + 1) * 83492791u;
+    h ^= seed * 2654435761u;
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+static float nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (state >> 8) * (1.0f / 16777216.0f);
+}
+
+// Interleaved position (3), normal (3), tint (1) for one unit-sized plant standing on the origin
+static void addTriangle(std::vector<float>& mesh, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c,
+    float tintA, float tintB, float tintC, const glm::vec3& outward) {
+    glm::vec3 normal = glm::normalize(glm::cross(b - a, c - a));
+    if (glm::dot(normal, outward) < 0.0f) normal = -normal;
+    const glm::vec3* corners[3] = { &a, &b, &c };
+    float tints[3] = { tintA, tintB, tintC };
+    for (int i = 0; i < 3; ++i) {
+        mesh.insert(mesh.end(), { corners[i]->x, corners[i]->y, corners[i]->z, normal.x, normal.y, normal.z, tints[i] });
+    }
+}
+
+static void addCone(std::vector<float>& mesh, float baseY, float radius, float apexY, int segments, float tint) {
+    glm::vec3 apex(0.0f, apexY, 0.0f);
+    for (int i = 0; i < segments; ++i) {
+        float a0 = 6.28318531f * i / segments;
+        float a1 = 6.28318531f * (i + 1) / segments;
+        glm::vec3 p0(std::cos(a0) * radius, baseY, std::sin(a0) * radius);
+        glm::vec3 p1(std::cos(a1) * radius, baseY, std::sin(a1) * radius);
+        addTriangle(mesh, p0, p1, apex, tint, tint, tint, (p0 + p1) * 0.5f - glm::vec3(0.0f, baseY, 0.0f));
+    }
+}
+
+static std::vector<float> buildMesh(VegetationType type) {
+    std::vector<float> mesh;
+    switch (type) {
+        case VegetationType::TREE: {
+            // Hexagonal trunk and two stacked cones for the canopy
+            const int sides = 6;
+            for (int i = 0; i < sides; ++i) {
+                float a0 = 6.28318531f * i / sides;
+                float a1 = 6.28318531f * (i + 1) / sides;
+                glm::vec3 b0(std::cos(a0) * 0.05f, 0.0f, std::sin(a0) * 0.05f);
+                glm::vec3 b1(std::cos(a1) * 0.05f, 0.0f, std::sin(a1) * 0.05f);
+                glm::vec3 t0 = b0 + glm::vec3(0.0f, 0.3f, 0.0f);
+                glm::vec3 t1 = b1 + glm::vec3(0.0f, 0.3f, 0.0f);
+                glm::vec3 outward = (b0 + b1) * 0.5f;
+                addTriangle(mesh, b0, b1, t1, 0.0f, 0.0f, 0.0f, outward);
+                addTriangle(mesh, b0, t1, t0, 0.0f, 0.0f, 0.0f, outward);
+            }
+            addCone(mesh, 0.2f, 0.32f, 0.75f, 8, 1.0f);
+            addCone(mesh, 0.5f, 0.24f, 1.0f, 8, 1.0f);
+            break;
+        }
+        case VegetationType::GRASS: {
+            // Three crossed blades, darker at the root
+            for (int i = 0; i < 3; ++i) {
+                float angle = 3.14159265f * i / 3.0f;
+                glm::vec3 side(std::cos(angle) * 0.08f, 0.0f, std::sin(angle) * 0.08f);
+                glm::vec3 lean(std::sin(angle) * 0.15f, 1.0f, -std::cos(angle) * 0.15f);
+                addTriangle(mesh, -side, side, lean, 0.0f, 0.0f, 1.0f, glm::vec3(0.0f, 1.0f, 0.0f));
+            }
+            break;
+        }
+        default: {
+            // Irregular ring of six points under a low off-centre peak
+            const float ringScale[6] = { 1.0f, 0.8f, 0.95f, 0.75f, 1.0f, 0.85f };
+            glm::vec3 top(0.05f, 0.6f, 0.02f);
+            glm::vec3 bottom(0.0f, -0.1f, 0.0f);
+            for (int i = 0; i < 6; ++i) {
+                float a0 = 6.28318531f * i / 6.0f;
+                float a1 = 6.28318531f * (i + 1) / 6.0f;
+                glm::vec3 p0(std::cos(a0) * 0.5f * ringScale[i], 0.25f, std::sin(a0) * 0.5f * ringScale[i]);
+                glm::vec3 p1(std::cos(a1) * 0.5f * ringScale[(i + 1) % 6], 0.25f, std::sin(a1) * 0.5f * ringScale[(i + 1) % 6]);
+                glm::vec3 outward = (p0 + p1) * 0.5f;
+                addTriangle(mesh, p0, p1, top, 1.0f, 1.0f, 1.0f, outward + glm::vec3(0.0f, 0.5f, 0.0f));
+                addTriangle(mesh, p0, p1, bottom, 0.0f, 0.0f, 0.0f, outward - glm::vec3(0.0f, 0.5f, 0.0f));
+            }
+            break;
+        }
+    }
+    return mesh;
+}
+
+Vegetation::Vegetation() : billboardVbo(0), chunksX(0), chunksZ(0), sampledWidth(0), sampledDepth(0),
+    placementSeed(0), scene(Scene::SUMMER), density(1.0f) {
+    for (TypeData& data : types) {
+        data.meshVao = data.billboardVao = data.meshVbo = data.instanceVbo = 0;
+        data.meshVertexCount = 0;
+    }
+}
+
+Vegetation::~Vegetation() {
+    cleanup();
+}
+
+size_t Vegetation::getInstanceCount() const {
+    size_t total = 0;
+    for (size_t count : stats.instanceCount) total += count;
+    return total;
+}
+
+void Vegetation::generate(const Terrain& terrain, Scene newScene) {
+    scene = newScene;
+    ++placementSeed;
+    if (terrain.getWidth() != sampledWidth || terrain.getDepth() != sampledDepth) {
+        sampleCandidates(terrain);
+    }
+
+    std::vector<int> allChunks(chunksX * chunksZ);
+    for (int i = 0; i < chunksX * chunksZ; ++i) allChunks[i] = i;
+    placeChunks(terrain, allChunks);
+}
+
+void Vegetation::updateRegion(const Terrain& terrain, float xMin, float xMax) {
+    if (chunksX == 0) return;
+
+    const float chunkWidth = Terrain::CHUNK_SIZE * 2.0f;
+    int firstColumn = std::max(0, static_cast<int>(std::floor(xMin / chunkWidth)));
+    int lastColumn = std::min(chunksX - 1, static_cast<int>(std::floor(xMax / chunkWidth)));
+    std::vector<int> chunkList;
+    for (int z = 0; z < chunksZ; ++z) {
+        for (int x = firstColumn; x <= lastColumn; ++x) chunkList.push_back(z * chunksX + x);
+    }
+    placeChunks(terrain, chunkList);
+}
+
+void Vegetation::setDensity(const Terrain& terrain, float newDensity) {
+    density = newDensity;
+    std::vector<int> allChunks(chunksX * chunksZ);
+    for (int i = 0; i < chunksX * chunksZ; ++i) allChunks[i] = i;
+    placeChunks(terrain, allChunks);
+}
+
+void Vegetation::sampleCandidates(const Terrain& terrain) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    sampledWidth = terrain.getWidth();
+    sampledDepth = terrain.getDepth();
+    chunksX = (sampledWidth - 1 + Terrain::CHUNK_SIZE - 1) / Terrain::CHUNK_SIZE;
+    chunksZ = (sampledDepth - 1 + Terrain::CHUNK_SIZE - 1) / Terrain::CHUNK_SIZE;
+    const int chunkCount = chunksX * chunksZ;
+    const float chunkWidth = Terrain::CHUNK_SIZE * 2.0f;
+    const float chunkDepth = Terrain::CHUNK_SIZE * 5.0f;
+    float extentX = (sampledWidth - 1) * 2.0f;
+    float extentZ = (sampledDepth - 1) * 5.0f;
+
+    stats.candidateCount = 0;
+    for (int type = 0; type < TYPE_COUNT; ++type) {
+        TypeData& data = types[type];
+        std::vector<glm::vec2> points = PoissonDiskSampler::sample(extentX, extentZ, typeSettings[type].spacing,
+            static_cast<uint32_t>(type) * 7919u + 17u, chunkWidth);
+
+        // Counting sort by chunk so every chunk's candidates are contiguous
+        auto chunkOf = [&](const glm::vec2& p) {
+            int cx = std::min(chunksX - 1, static_cast<int>(p.x / chunkWidth));
+            int cz = std::min(chunksZ - 1, static_cast<int>(p.y / chunkDepth));
+            return cz * chunksX + cx;
+        };
+        data.chunkCandidateOffsets.assign(chunkCount + 1, 0);
+        for (const glm::vec2& p : points) ++data.chunkCandidateOffsets[chunkOf(p) + 1];
+        for (int i = 0; i < chunkCount; ++i) data.chunkCandidateOffsets[i + 1] += data.chunkCandidateOffsets[i];
+        std::vector<int> cursor(data.chunkCandidateOffsets.begin(), data.chunkCandidateOffsets.end() - 1);
+        data.candidates.resize(points.size());
+        for (const glm::vec2& p : points) data.candidates[cursor[chunkOf(p)]++] = p;
+
+        data.chunkInstances.assign(chunkCount, std::vector<VegetationInstance>());
+        data.chunkInstanceOffsets.assign(chunkCount + 1, 0);
+        data.chunkLods.assign(chunkCount, Lod::HIDDEN);
+        stats.candidateCount += points.size();
+    }
+
+    chunkBoundsMin.assign(chunkCount, glm::vec3(0.0f));
+    chunkBoundsMax.assign(chunkCount, glm::vec3(0.0f));
+    chunkVisible.assign(chunkCount, 0);
+    stats.totalChunks = chunkCount;
+    stats.samplingMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void Vegetation::placeChunks(const Terrain& terrain, const std::vector<int>& chunkList) {
+    if (chunkList.empty()) return;
+    auto start = std::chrono::high_resolution_clock::now();
+
+    ThreadPool::shared().parallelFor(static_cast<int>(chunkList.size()), 4, [&](int begin, int end, int) {
+        for (int i = begin; i < end; ++i) placeChunk(terrain, chunkList[i]);
+    });
+    uploadInstances();
+
+    stats.updatedChunks = static_cast<int>(chunkList.size());
+    stats.placementMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void Vegetation::placeChunk(const Terrain& terrain, int chunk) {
+    const std::vector<float>& heights = terrain.getHeights();
+    const std::vector<float>& normals = terrain.getNormals();
+    const int width = terrain.getWidth();
+    const int depth = terrain.getDepth();
+    const float heightRange = std::max(terrain.getColorHeightRange(), 1.0f);
+
+    glm::vec3 boundsMin(FLT_MAX);
+    glm::vec3 boundsMax(-FLT_MAX);
+
+    for (int type = 0; type < TYPE_COUNT; ++type) {
+        TypeData& data = types[type];
+        const VegetationTypeSettings& settings = typeSettings[type];
+        VegetationStyle style = getStyle(scene, static_cast<VegetationType>(type));
+        std::vector<VegetationInstance>& instances = data.chunkInstances[chunk];
+        instances.clear();
+
+        for (int c = data.chunkCandidateOffsets[chunk]; c < data.chunkCandidateOffsets[chunk + 1]; ++c) {
+            const glm::vec2& p = data.candidates[c];
+            float gx = p.x / 2.0f;
+            float gz = p.y / 5.0f;
+            int x0 = std::min(static_cast<int>(gx), width - 2);
+            int z0 = std::min(static_cast<int>(gz), depth - 2);
+            float fx = gx - x0;
+            float fz = gz - z0;
+            float height = (heights[z0 * width + x0] * (1.0f - fx) + heights[z0 * width + x0 + 1] * fx) * (1.0f - fz) +
+                (heights[(z0 + 1) * width + x0] * (1.0f - fx) + heights[(z0 + 1) * width + x0 + 1] * fx) * fz;
+            int nearest = static_cast<int>(gz + 0.5f) * width + static_cast<int>(gx + 0.5f);
+            float normalY = normals.empty() ? 1.0f : normals[nearest * 3 + 1];
+            float heightFactor = std::clamp((height - terrain.getColorMinHeight()) / heightRange, 0.0f, 1.0f);
+
+            float probability = style.density * density;
+            switch (static_cast<VegetationType>(type)) {
+                case VegetationType::TREE:
+                    if (normalY < settings.minNormalY || heightFactor > 0.9f) continue;
+                    probability *= 1.0f - 0.6f * heightFactor; // thinning towards the ridges
+                    break;
+                case VegetationType::GRASS:
+                    if (normalY < settings.minNormalY) continue;
+                    break;
+                default:
+                    probability *= (normalY < 0.85f) ? 1.0f : 0.3f; // rocks favour steep ground
+                    break;
+            }
+
+            uint32_t random = hashPosition(p, type, placementSeed);
+            if (nextRandom(random) >= probability) continue;
+
+            float scale = settings.minScale + (settings.maxScale - settings.minScale) * nextRandom(random);
+            VegetationInstance instance;
+            instance.positionScale = glm::vec4(p.x, height - settings.sink * scale, p.y, scale);
+            instance.params = glm::vec4(nextRandom(random) * 6.28318531f, 0.85f + 0.3f * nextRandom(random), 0.0f, 0.0f);
+            instances.push_back(instance);
+
+            // Horizontal extent is widened by the full scale because the model matrix stretches only the base point
+            boundsMin = glm::min(boundsMin, glm::vec3(p.x - scale, instance.positionScale.y, p.y - scale));
+            boundsMax = glm::max(boundsMax, glm::vec3(p.x + scale, instance.positionScale.y + scale, p.y + scale));
+        }
+    }
+
+    chunkBoundsMin[chunk] = boundsMin;
+    chunkBoundsMax[chunk] = boundsMax;
+}
+
+void Vegetation::uploadInstances() {
+    if (!billboardVbo) setupMeshes();
+
+    const int chunkCount = chunksX * chunksZ;
+    std::vector<VegetationInstance> buffer;
+    for (int type = 0; type < TYPE_COUNT; ++type) {
+        TypeData& data = types[type];
+        buffer.clear();
+        for (int chunk = 0; chunk < chunkCount; ++chunk) {
+            data.chunkInstanceOffsets[chunk] = static_cast<GLsizei>(buffer.size());
+            buffer.insert(buffer.end(), data.chunkInstances[chunk].begin(), data.chunkInstances[chunk].end());
+        }
+        data.chunkInstanceOffsets[chunkCount] = static_cast<GLsizei>(buffer.size());
+        stats.instanceCount[type] = buffer.size();
+
+        // Offsets shift when a chunk's count changes, so the whole type is re-uploaded; this only happens on edits
+        glBindBuffer(GL_ARRAY_BUFFER, data.instanceVbo);
+        glBufferData(GL_ARRAY_BUFFER, buffer.size() * sizeof(VegetationInstance), buffer.data(), GL_STATIC_DRAW);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void VegetationUniforms::resolve(GLuint shader) {
+    ShaderRegistry& registry = ShaderRegistry::shared();
+    primaryColor = registry.uniform<glm::vec3>(shader, "primaryColor");
+    secondaryColor = registry.uniform<glm::vec3>(shader, "secondaryColor");
+    shape = registry.uniform<int>(shader, "shape");
+    billboard = registry.uniform<bool>(shader, "billboard");
+}
+
+void Vegetation::render(GLuint shader, const VegetationUniforms& uniforms, const glm::mat4& model, const glm::mat4& viewProjection, const glm::vec3& cameraPos) {
+    stats.meshInstancesDrawn = 0;
+    stats.billboardInstancesDrawn = 0;
+    stats.visibleChunks = 0;
+    stats.drawCalls = 0;
+    if (!billboardVbo || chunksX == 0) return;
+
+    // Frustum planes in terrain-local space, from the rows of the combined matrix
+    glm::mat4 modelViewProjection = viewProjection * model;
+    glm::vec4 planes[6];
+    for (int i = 0; i < 3; ++i) {
+        glm::vec4 row(modelViewProjection[0][i], modelViewProjection[1][i], modelViewProjection[2][i], modelViewProjection[3][i]);
+        glm::vec4 last(modelViewProjection[0][3], modelViewProjection[1][3], modelViewProjection[2][3], modelViewProjection[3][3]);
+        planes[i * 2] = last + row;
+        planes[i * 2 + 1] = last - row;
+    }
+
+    const int chunkCount = chunksX * chunksZ;
+    for (int chunk = 0; chunk < chunkCount; ++chunk) {
+        const glm::vec3& boundsMin = chunkBoundsMin[chunk];
+        const glm::vec3& boundsMax = chunkBoundsMax[chunk];
+        bool visible = boundsMin.x <= boundsMax.x;
+        for (int p = 0; p < 6 && visible; ++p) {
+            const glm::vec4& plane = planes[p];
+            glm::vec3 farCorner(plane.x > 0.0f ? boundsMax.x : boundsMin.x,
+                plane.y > 0.0f ? boundsMax.y : boundsMin.y,
+                plane.z > 0.0f ? boundsMax.z : boundsMin.z);
+            if (plane.x * farCorner.x + plane.y * farCorner.y + plane.z * farCorner.z + plane.w < 0.0f) visible = false;
+        }
+        chunkVisible[chunk] = visible ? 1 : 0;
+        if (!visible) continue;
+        ++stats.visibleChunks;
+
+        glm::vec3 center = glm::vec3(model * glm::vec4((boundsMin + boundsMax) * 0.5f, 1.0f));
+        float distance = glm::length(center - cameraPos);
+        for (int type = 0; type < TYPE_COUNT; ++type) {
+            const VegetationTypeSettings& settings = typeSettings[type];
+            types[type].chunkLods[chunk] = distance < settings.meshDistance ? Lod::MESH :
+                (distance < settings.maxDistance ? Lod::BILLBOARD : Lod::HIDDEN);
+        }
+    }
+
+    if (!ShaderRegistry::shared().use(shader)) return;
+    for (int type = 0; type < TYPE_COUNT; ++type) {
+        TypeData& data = types[type];
+        VegetationStyle style = getStyle(scene, static_cast<VegetationType>(type));
+        uniforms.primaryColor.set(style.primaryColor);
+        uniforms.secondaryColor.set(style.secondaryColor);
+        uniforms.shape.set(type);
+
+        for (Lod lod : { Lod::MESH, Lod::BILLBOARD }) {
+            bool billboard = lod == Lod::BILLBOARD;
+            uniforms.billboard.set(billboard);
+            GLStateCache::shared().bindVertexArray(billboard ? data.billboardVao : data.meshVao);
+            GLsizei vertexCount = billboard ? 6 : data.meshVertexCount;
+
+            // Chunks are contiguous in the instance buffer; empty chunks do not break a run
+            GLsizei runStart = -1;
+            GLsizei runEnd = -1;
+            auto flush = [&]() {
+                if (runStart < 0 || runEnd <= runStart) return;
+                bindInstanceAttributes(data, runStart);
+                glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount, runEnd - runStart);
+                ++stats.drawCalls;
+                (billboard ? stats.billboardInstancesDrawn : stats.meshInstancesDrawn) += static_cast<size_t>(runEnd - runStart);
+                runStart = runEnd = -1;
+            };
+            for (int chunk = 0; chunk < chunkCount; ++chunk) {
+                GLsizei first = data.chunkInstanceOffsets[chunk];
+                GLsizei end = data.chunkInstanceOffsets[chunk + 1];
+                if (first == end) continue;
+                if (!chunkVisible[chunk] || data.chunkLods[chunk] != lod) {
+                    flush();
+                    continue;
+                }
+                if (runStart < 0) runStart = first;
+                runEnd = end;
+            }
+            flush();
+        }
+    }
+    GLStateCache::shared().bindVertexArray(0);
+}
+
+void Vegetation::bindInstanceAttributes(TypeData& data, GLsizei firstInstance) {
+    // GL 3.3 has no base instance, so the instance attributes are re-pointed at the start of each run
+    size_t offset = static_cast<size_t>(firstInstance) * sizeof(VegetationInstance);
+    glBindBuffer(GL_ARRAY_BUFFER, data.instanceVbo);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(VegetationInstance), (void*)offset);
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(VegetationInstance), (void*)(offset + sizeof(glm::vec4)));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Vegetation::setupMeshes() {
+    // Camera-facing quad standing on its base, shaped per type in the fragment shader
+    const float billboard[] = {
+        -0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f,
+         0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f,
+         0.5f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f,
+        -0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f,
+         0.5f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f,
+        -0.5f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f,
+    };
+    glGenBuffers(1, &billboardVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, billboardVbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(billboard), billboard, GL_STATIC_DRAW);
+
+    for (int type = 0; type < TYPE_COUNT; ++type) {
+        TypeData& data = types[type];
+        std::vector<float> mesh = buildMesh(static_cast<VegetationType>(type));
+        data.meshVertexCount = static_cast<GLsizei>(mesh.size() / 7);
+
+        glGenBuffers(1, &data.meshVbo);
+        glBindBuffer(GL_ARRAY_BUFFER, data.meshVbo);
+        glBufferData(GL_ARRAY_BUFFER, mesh.size() * sizeof(float), mesh.data(), GL_STATIC_DRAW);
+        glGenBuffers(1, &data.instanceVbo);
+
+        glGenVertexArrays(1, &data.meshVao);
+        glGenVertexArrays(1, &data.billboardVao);
+        GLuint vaos[2] = { data.meshVao, data.billboardVao };
+        GLuint vertexBuffers[2] = { data.meshVbo, billboardVbo };
+        for (int i = 0; i < 2; ++i) {
+            GLStateCache::shared().bindVertexArray(vaos[i]);
+            glBindBuffer(GL_ARRAY_BUFFER, vertexBuffers[i]);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)0);
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)(3 * sizeof(float)));
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)(6 * sizeof(float)));
+            glEnableVertexAttribArray(2);
+
+            glBindBuffer(GL_ARRAY_BUFFER, data.instanceVbo);
+            glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(VegetationInstance), (void*)0);
+            glEnableVertexAttribArray(3);
+            glVertexAttribDivisor(3, 1);
+            glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(VegetationInstance), (void*)sizeof(glm::vec4));
+            glEnableVertexAttribArray(4);
+            glVertexAttribDivisor(4, 1);
+        }
+    }
+    GLStateCache::shared().bindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Vegetation::cleanup() {
+    for (TypeData& data : types) {
+        if (data.meshVao) GLStateCache::shared().deleteVertexArrays(1, &data.meshVao);
+        if (data.billboardVao) GLStateCache::shared().deleteVertexArrays(1, &data.billboardVao);
+        if (data.meshVbo) glDeleteBuffers(1, &data.meshVbo);
+        if (data.instanceVbo) glDeleteBuffers(1, &data.instanceVbo);
+        data.meshVao = data.billboardVao = data.meshVbo = data.instanceVbo = 0;
+    }
+    if (billboardVbo) glDeleteBuffers(1, &billboardVbo);
+    billboardVbo = 0;
+}
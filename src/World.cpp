@@ -2,12 +2,31 @@
 #include "DataManager.hpp"
 #include <Constants.hpp>
 #include "CelestialObjectManager.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// Clock times the Time of Day bands move to, and the sun elevations (degrees) that bound the bands in the day cycle
+static const float DAWN_DAY_TIME = 0.28f;
+static const float MID_DAY_DAY_TIME = 0.5f;
+static const float DUSK_DAY_TIME = 0.72f;
+static const float NIGHT_DAY_TIME = 0.0f;
+static const float NIGHT_BELOW_ELEVATION = -6.0f;
+static const float TWILIGHT_BELOW_ELEVATION = 20.0f;
+static const float MAX_SUN_ELEVATION = 60.0f;
+// Weights of direct sunlight and skylight in the terrain light, and the moonlight that takes over at night
+static const float SUNLIGHT_SCALE = 1.0f;
+static const float SKYLIGHT_SCALE = 3.0f;
+static const glm::vec3 MOONLIGHT(0.3f, 0.3f, 0.5f);
 
 World::World() : totalTime(0.0f), immediateFadeFromNight(false), transitionCompletionDelay(0.0f), world(b2WorldId{}),
 terrainMode(TerrainGenerationMode::BOTTOM), regenerationTriggered(false), regenerateDistantTriggered(false),
 currentTimeOfDay(TimeOfDay::MID_DAY), targetTimeOfDay(TimeOfDay::MID_DAY),
 skyTransitionTime(0.0f), skyTransitionDuration(1.0f), skyTransitioning(false), transitionProgress(0.0f),
-lightColor(1.0f, 1.0f, 1.0f), targetLightColor(1.0f, 1.0f, 1.0f) {
+lightColor(1.0f, 1.0f, 1.0f), dayTime(0.5f), transitionStartDayTime(0.5f), transitionDayTimeDelta(0.0f),
+dayCycleEnabled(false), dayLength(240.0f),
+distantSimplificationEnabled(true), distantMaxPixelError(0.5f) {
     sceneNames = { "Summer", "Fall", "Winter", "Spring", "Alien" };
     scene = Scene::SUMMER;
     defaultSummerLowColor = glm::vec3(0.5f, 0.35f, 0.15f);
@@ -22,6 +41,7 @@ lightColor(1.0f, 1.0f, 1.0f), targetLightColor(1.0f, 1.0f, 1.0f) {
     defaultAlienHighColor = glm::vec3(0.1f, 0.5f, 0.5f);
     resetScene();
     resetDistantTerrainParams();
+    resetBackgroundLayerParams();
     resetBottomNoiseParameters();
     resetDistantNoiseParameters();
 }
@@ -47,8 +67,22 @@ bool World::initialize() {
     int terrainDepth = 400;
     bottomTerrain = std::make_unique<Terrain>(terrainWidth, terrainDepth, glm::vec4(0.5f, 0.0f, 0.5f, 1.0f));
     distantTerrain = std::make_unique<Terrain>(terrainWidth, 200, glm::vec4(0.1f, 0.15f, 0.45f, 1.0f));
+    backgroundLayers = std::make_unique<BackgroundLayers>();
+    vegetation = std::make_unique<Vegetation>();
+    bottomTerrain->setDetailNormalMapping(true, 4);
     initializeNoiseParameters();
 
+    // The tables only depend on constants, so they are integrated or loaded once per run
+    if (!atmosphere.isReady()) {
+#ifdef _WIN32
+        const std::string cacheDirectory = "resources\\cache";
+#else
+        const std::string cacheDirectory = "./resources/cache";
+#endif
+        if (!atmosphere.create(cacheDirectory)) return false;
+    }
+    updateLightColor();
+
     noise::module::Perlin perlin;
     perlin.SetSeed(static_cast<int>(time(nullptr)));
     perlin.SetFrequency(noiseParamsBottom.frequency);
@@ -58,6 +92,14 @@ bool World::initialize() {
 
     // Generate bottom terrain with DebugTester parameters
     bottomTerrain->generate(perlin, noiseParamsBottom.baseHeight, noiseParamsBottom.minHeight, noiseParamsBottom.maxHeight, terrainLowColor, terrainHighColor, nullptr);
+    vegetation->generate(*bottomTerrain, scene);
+
+    const VegetationStats& vegetationStats = vegetation->getStats();
+    DataManager::LogDebug(DebugCategory::RENDERING, "World", "initialize",
+        "vegetation placed: instances=" + std::to_string(vegetation->getInstanceCount()) +
+        ", candidates=" + std::to_string(vegetationStats.candidateCount) +
+        ", sampling " + std::to_string(vegetationStats.samplingMilliseconds) + " ms" +
+        ", placement " + std::to_string(vegetationStats.placementMilliseconds) + " ms");
 
     perlin.SetFrequency(noiseParamsDistant.frequency);
     perlin.SetPersistence(noiseParamsDistant.persistence);
@@ -66,10 +108,12 @@ bool World::initialize() {
 
     // Generate distant terrain with DebugTester parameters
     distantTerrain->generate(perlin, noiseParamsDistant.baseHeight, noiseParamsDistant.minHeight, noiseParamsDistant.maxHeight, terrainLowColor, terrainHighColor, nullptr);
+    generateBackgroundLayers(perlin);
 
     DataManager::LogDebug(DebugCategory::RENDERING, "World", "initialize",
         "distantTerrain generated: vertices=" + std::to_string(distantTerrain->getVertices().size()) +
         ", indices=" + std::to_string(distantTerrain->getIndices().size()));
+    startDistantSimplification();
 
     setupPhysicsTerrain();
 
@@ -84,10 +128,28 @@ void World::update(float dt) {
 
     b2World_Step(world, dt, 8);
 
+    // While a Time of Day selection eases the clock it owns it; otherwise the clock runs if the cycle is on and the
+    // band follows the sun, so the stars, satellites and clouds switch over as it crosses the band edges
+    bool easingClock = skyTransitioning && transitionDayTimeDelta != 0.0f;
+    if (!easingClock) {
+        if (dayCycleEnabled) dayTime = std::fmod(dayTime + dt / dayLength, 1.0f);
+        float elevation = glm::degrees(getSunElevation());
+        TimeOfDay band = TimeOfDay::MID_DAY;
+        if (elevation < NIGHT_BELOW_ELEVATION) band = TimeOfDay::NIGHT;
+        else if (elevation < TWILIGHT_BELOW_ELEVATION) band = dayTime < 0.5f ? TimeOfDay::DAWN : TimeOfDay::DUSK;
+        if (band != targetTimeOfDay) {
+            transitionDayTimeDelta = 0.0f;
+            beginTimeOfDayTransition(band);
+        }
+    }
+
     if (skyTransitioning) {
         skyTransitionTime += dt;
         float t = std::min(skyTransitionTime / skyTransitionDuration, 1.0f);
-        lightColor = glm::mix(lightColor, targetLightColor, t);
+        float eased = t * t * (3.0f - 2.0f * t);
+        if (transitionDayTimeDelta != 0.0f) {
+            dayTime = std::fmod(transitionStartDayTime + transitionDayTimeDelta * eased + 1.0f, 1.0f);
+        }
         transitionProgress = t;
 
         if (t >= 1.0f) {
@@ -95,8 +157,10 @@ void World::update(float dt) {
             skyTransitionTime = 0.0f;
             currentTimeOfDay = targetTimeOfDay;
             transitionProgress = 1.0f;
+            transitionDayTimeDelta = 0.0f;
         }
     }
+    updateLightColor();
 
     // Check if bottom terrain regeneration is triggered
     if (regenerationTriggered) {
@@ -108,6 +172,7 @@ void World::update(float dt) {
         perlin.SetOctaveCount(static_cast<int>(noiseParamsBottom.octaves));
 
         bottomTerrain->generate(perlin, noiseParamsBottom.baseHeight, noiseParamsBottom.minHeight, noiseParamsBottom.maxHeight, terrainLowColor, terrainHighColor, nullptr);
+        vegetation->generate(*bottomTerrain, scene);
         setupPhysicsTerrain();
         regenerationTriggered = false;
     }
@@ -122,13 +187,57 @@ void World::update(float dt) {
         perlin.SetOctaveCount(static_cast<int>(noiseParamsDistant.octaves));
 
         distantTerrain->generate(perlin, noiseParamsDistant.baseHeight, noiseParamsDistant.minHeight, noiseParamsDistant.maxHeight, terrainLowColor, terrainHighColor, nullptr);
+        generateBackgroundLayers(perlin);
+        startDistantSimplification();
         regenerateDistantTriggered = false;
     }
 
+    pollDistantSimplification();
+
     celestialObjectManager->update(dt, currentTimeOfDay);
 }
 
 void World::setTimeOfDay(TimeOfDay newTime) {
+    float target = MID_DAY_DAY_TIME;
+    switch (newTime) {
+        case TimeOfDay::DAWN:
+            target = DAWN_DAY_TIME;
+            break;
+        case TimeOfDay::MID_DAY:
+            target = MID_DAY_DAY_TIME;
+            break;
+        case TimeOfDay::DUSK:
+            target = DUSK_DAY_TIME;
+            break;
+        case TimeOfDay::NIGHT:
+            target = NIGHT_DAY_TIME;
+            break;
+    }
+    // The clock takes the shorter way round, forwards on a tie, so noon to night passes through dusk
+    float delta = target - dayTime;
+    delta -= std::floor(delta + 0.5f);
+    if (delta <= -0.5f + 1e-4f) delta += 1.0f;
+    transitionStartDayTime = dayTime;
+    transitionDayTimeDelta = delta;
+    beginTimeOfDayTransition(newTime);
+}
+
+void World::setDayTime(float time) {
+    dayTime = time - std::floor(time);
+    // Cancels a clock ease in progress; update() then moves the band to wherever the sun now is
+    transitionDayTimeDelta = 0.0f;
+    updateLightColor();
+}
+
+float World::getSunElevation() const {
+    return glm::radians(MAX_SUN_ELEVATION) * std::sin(6.2831853f * (dayTime - 0.25f));
+}
+
+float World::getSunProgress() const {
+    return glm::clamp((dayTime - 0.25f) / 0.5f, 0.0f, 1.0f);
+}
+
+void World::beginTimeOfDayTransition(TimeOfDay newTime) {
     skyTransitioning = true;
     skyTransitionTime = 0.0f;
     targetTimeOfDay = newTime;
@@ -142,21 +251,15 @@ void World::setTimeOfDay(TimeOfDay newTime) {
     } else {
         immediateFadeFromNight = false;
     }
+}
 
-    switch (newTime) {
-        case TimeOfDay::DAWN:
-            targetLightColor = glm::vec3(0.9f, 0.8f, 0.7f);
-            break;
-        case TimeOfDay::MID_DAY:
-            targetLightColor = glm::vec3(1.0f, 1.0f, 0.95f);
-            break;
-        case TimeOfDay::DUSK:
-            targetLightColor = glm::vec3(0.8f, 0.7f, 0.6f);
-            break;
-        case TimeOfDay::NIGHT:
-            targetLightColor = glm::vec3(0.3f, 0.3f, 0.5f);
-            break;
-    }
+// Sunlight and skylight from the atmosphere tables, with moonlight fading in once the sun is well below the horizon
+void World::updateLightColor() {
+    float sunElevation = getSunElevation();
+    float night = glm::smoothstep(0.0f, glm::radians(-NIGHT_BELOW_ELEVATION), -sunElevation);
+    glm::vec3 light = atmosphere.getSunTransmittance(sunElevation) * SUNLIGHT_SCALE +
+        atmosphere.getSkyIrradiance(sunElevation) * SKYLIGHT_SCALE + MOONLIGHT * night;
+    lightColor = glm::clamp(light, 0.0f, 1.0f);
 }
 
 void World::initializeNoiseParameters() {
@@ -191,6 +294,14 @@ void World::resetDistantTerrainParams() {
     distantParams.depthFade = 0.567f;
 }
 
+void World::resetBackgroundLayerParams() {
+    backgroundParams.layerCount = 6;
+    backgroundParams.spacing = 500.0f;
+    backgroundParams.minHeight = WINDOW_HEIGHT * 0.55f;
+    backgroundParams.maxHeight = WINDOW_HEIGHT * 0.75f;
+    backgroundParams.haze = 0.85f;
+}
+
 void World::resetScene() {
     switch (scene) {
         case Scene::SUMMER:
@@ -225,6 +336,37 @@ void World::triggerRegeneration(TerrainGenerationMode mode) {
     }
 }
 
+void World::regenerateBackgroundLayers() {
+    noise::module::Perlin perlin;
+    perlin.SetSeed(static_cast<int>(time(nullptr)));
+    perlin.SetFrequency(noiseParamsDistant.frequency);
+    perlin.SetPersistence(noiseParamsDistant.persistence);
+    perlin.SetLacunarity(noiseParamsDistant.lacunarity);
+    perlin.SetOctaveCount(static_cast<int>(noiseParamsDistant.octaves));
+    generateBackgroundLayers(perlin);
+}
+
+void World::generateBackgroundLayers(noise::module::Perlin& perlin) {
+    // Each layer is wide enough to fill the default view at its distance, with some margin for camera movement
+    float pitch = glm::radians(DEFAULT_CAMERA_PITCH);
+    float cameraZ = DEFAULT_CAMERA_ZOOM * cos(pitch);
+    float halfWidthPerUnit = tan(glm::radians(CAMERA_FOV_DEGREES) / 2.0f) * static_cast<float>(WINDOW_WIDTH) / WINDOW_HEIGHT;
+    int layerCount = std::max(0, std::min(backgroundParams.layerCount, BackgroundLayers::MAX_LAYERS));
+
+    std::vector<BackgroundLayer> layers;
+    for (int i = 0; i < layerCount; ++i) {
+        BackgroundLayer layer;
+        layer.zPosition = distantParams.zPosition - backgroundParams.spacing * (i + 1);
+        layer.width = 2.5f * halfWidthPerUnit * (cameraZ - layer.zPosition);
+        layer.xStart = WINDOW_WIDTH / 2.0f - layer.width / 2.0f;
+        layer.yBase = 0.0f;
+        layer.color = glm::mix(terrainLowColor, terrainHighColor, 0.5f) * 0.6f;
+        layer.fade = backgroundParams.haze * (i + 1) / layerCount;
+        layers.push_back(layer);
+    }
+    backgroundLayers->generate(perlin, layers, backgroundParams.minHeight, backgroundParams.maxHeight);
+}
+
 void World::setupPhysicsTerrain() {
     std::vector<float> bottomHeightmap = bottomTerrain->getHeightmap(50);
     std::vector<b2Vec2> bottomPoints;
@@ -245,4 +387,74 @@ void World::setupPhysicsTerrain() {
     bottomChainDef.points = bottomPoints.data();
     bottomChainDef.count = static_cast<int32_t>(bottomPoints.size());
     b2CreateChain(bottomGroundBody, &bottomChainDef);
-}
\ No newline at end of file
+}
+
+void World::deformBottomTerrain(float x, float radius, float intensity, bool addTerrain) {
+    bottomTerrain->deform(x, radius, intensity, addTerrain);
+    // deform() works on whole columns of cells within radius of x / 2
+    vegetation->updateRegion(*bottomTerrain, x - radius * 2.0f - 2.0f, x + radius * 2.0f + 2.0f);
+}
+
+void World::setDistantSimplification(bool enabled, float maxPixelError) {
+    bool rebuild = enabled && (maxPixelError != distantMaxPixelError || !distantTerrain->hasSimplifiedMesh());
+    distantSimplificationEnabled = enabled;
+    distantMaxPixelError = maxPixelError;
+    distantTerrain->setUseSimplifiedMesh(enabled);
+    if (rebuild) {
+        startDistantSimplification();
+    }
+}
+
+void World::startDistantSimplification() {
+    // Replacing the future drops any job still running for older heights; its result is never uploaded
+    distantSimplification = std::future<SimplifiedTerrainMesh>();
+    if (!distantSimplificationEnabled) return;
+
+    std::vector<float> heights = distantTerrain->getHeights();
+    std::vector<float> errorScale = computeDistantErrorScale();
+    int width = distantTerrain->getWidth();
+    int depth = distantTerrain->getDepth();
+    float maxError = distantMaxPixelError;
+
+    distantSimplification = ThreadPool::shared().submit([heights = std::move(heights), errorScale = std::move(errorScale), width, depth, maxError]() {
+        return TerrainSimplifier::simplify(heights, width, depth, errorScale, maxError, Terrain::CHUNK_SIZE);
+    });
+}
+
+void World::pollDistantSimplification() {
+    if (!distantSimplification.valid()) return;
+    if (distantSimplification.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+
+    SimplifiedTerrainMesh mesh = distantSimplification.get();
+    distantTerrain->setSimplifiedMesh(mesh);
+    distantSimplificationStats = mesh.stats;
+
+    DataManager::LogDebug(DebugCategory::RENDERING, "World", "pollDistantSimplification",
+        "Distant terrain simplified: triangles " + std::to_string(mesh.stats.sourceTriangles) +
+        " -> " + std::to_string(mesh.stats.simplifiedTriangles) +
+        ", vertices " + std::to_string(mesh.stats.simplifiedVertices) +
+        ", build time " + std::to_string(mesh.stats.buildMilliseconds) + " ms on " +
+        std::to_string(mesh.stats.threadCount) + " threads");
+}
+
+std::vector<float> World::computeDistantErrorScale() const {
+    // Pixels per world unit for every row of the distant terrain, seen from the default camera.
+    // Mirrors the distant terrain placement in Renderer::renderDistantTerrain.
+    float pitch = glm::radians(DEFAULT_CAMERA_PITCH);
+    glm::vec3 target(WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f, 0.0f);
+    glm::vec3 camera = target + glm::vec3(0.0f, DEFAULT_CAMERA_ZOOM * sin(pitch), DEFAULT_CAMERA_ZOOM * cos(pitch));
+    glm::vec3 forward = glm::normalize(target - camera);
+    float focalLength = (WINDOW_HEIGHT / 2.0f) / tan(glm::radians(CAMERA_FOV_DEGREES) / 2.0f);
+
+    int width = distantTerrain->getWidth();
+    int depth = distantTerrain->getDepth();
+    const std::vector<float>& heights = distantTerrain->getHeights();
+    std::vector<float> scale(depth);
+    for (int z = 0; z < depth; ++z) {
+        float rowMax = *std::max_element(heights.begin() + z * width, heights.begin() + (z + 1) * width);
+        glm::vec3 point(target.x, rowMax + distantParams.yOffset, distantParams.zPosition + z * 5.0f);
+        float viewDepth = std::max(glm::dot(point - camera, forward), 1.0f);
+        scale[z] = focalLength / viewDepth;
+    }
+    return scale;
+}
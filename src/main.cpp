@@ -28,6 +28,12 @@ int main(int argc, char* argv[]) {
         std::cerr.rdbuf(logFile.rdbuf());
     }
 
+    // --serial-shaders compiles every program where it is created and waits for it, as older builds did,
+    // to compare the time to the first frame against
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--serial-shaders") ShaderRegistry::shared().setDeferredCompilation(false);
+    }
+
     Game game;
     if (!game.initialize()) {
         return 1;